@@ -28,15 +28,81 @@
 #include <vector>
 #include <memory>
 #include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
 #include <algorithm>
 
-// TODO: It'd be nice to have a 'BufferView' or similar functionality
-// - would not own the internal buffer, but would point to another one, with offset + size
-// - alt. would be for BufferBaseT to take an alternate constructor
-//		- requires T* as data storage gain, which is also necessary to ensure 16byte alignment
-
 namespace cinder { namespace audio {
 
+//! Returns a block of at least \a size bytes whose address is a multiple of \a alignment, which must be a power of two. The block must be released with alignedFree(). Returns null if the allocation fails.
+inline void* alignedAlloc( size_t size, size_t alignment )
+{
+	CI_ASSERT( alignment >= sizeof( void * ) && ( alignment & ( alignment - 1 ) ) == 0 );
+
+	// over-allocate, then store the pointer returned by malloc() directly before the aligned block so that alignedFree() can find it.
+	void *ptr = std::malloc( size + alignment + sizeof( void * ) );
+	if( ! ptr )
+		return nullptr;
+
+	uintptr_t aligned = ( reinterpret_cast<uintptr_t>( ptr ) + sizeof( void * ) + alignment - 1 ) & ~uintptr_t( alignment - 1 );
+	reinterpret_cast<void **>( aligned )[-1] = ptr;
+	return reinterpret_cast<void *>( aligned );
+}
+
+//! Releases a block that was returned by alignedAlloc(). \a ptr may be null.
+inline void alignedFree( void *ptr )
+{
+	if( ptr )
+		std::free( static_cast<void **>( ptr )[-1] );
+}
+
+//! Standard library allocator that aligns storage to \a Alignment bytes. The default of 64 bytes is a cache line, which also satisfies aligned SSE and AVX loads.
+template <typename T, size_t Alignment = 64>
+class AlignedAllocator {
+  public:
+	typedef T				value_type;
+	typedef T*				pointer;
+	typedef const T*		const_pointer;
+	typedef T&				reference;
+	typedef const T&		const_reference;
+	typedef size_t			size_type;
+	typedef std::ptrdiff_t	difference_type;
+
+	template <typename U>
+	struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+	AlignedAllocator()	{}
+	template <typename U>
+	AlignedAllocator( const AlignedAllocator<U, Alignment> & )	{}
+
+	T* allocate( size_t n, const void * = nullptr )
+	{
+		void *ptr = alignedAlloc( n * sizeof( T ), Alignment );
+		if( ! ptr )
+			throw std::bad_alloc();
+
+		return static_cast<T *>( ptr );
+	}
+
+	void deallocate( T *ptr, size_t )			{ alignedFree( ptr ); }
+
+	size_t max_size() const						{ return std::numeric_limits<size_t>::max() / sizeof( T ); }
+	T* address( T &x ) const					{ return &x; }
+	const T* address( const T &x ) const		{ return &x; }
+
+	template <typename U, typename... Args>
+	void construct( U *ptr, Args&&... args )	{ ::new( static_cast<void *>( ptr ) ) U( std::forward<Args>( args )... ); }
+	template <typename U>
+	void destroy( U *ptr )						{ ptr->~U(); }
+
+	template <typename U>
+	bool operator==( const AlignedAllocator<U, Alignment> & ) const	{ return true; }
+	template <typename U>
+	bool operator!=( const AlignedAllocator<U, Alignment> & ) const	{ return false; }
+};
+
 //! Base class for the various Buffer classes.  The template parameter T defined the sample type (precision).
 template <typename T>
 class BufferBaseT {
@@ -53,34 +119,41 @@ class BufferBaseT {
 	//! Returns true if number of frames is zero, false otherwise.
 	bool isEmpty() const			{ return mNumFrames == 0; }
 	//! Returns a pointer to the first sample in the data buffer.
-	T* getData() { return mData.data(); }
+	T* getData() { return mExternalData ? mExternalData : mData.data(); }
 	//! Returns a const pointer to the first sample in the data buffer.
-	const T* getData() const { return mData.data(); }
+	const T* getData() const { return mExternalData ? mExternalData : mData.data(); }
+	//! Returns true if the samples are owned by this buffer, false if it references external storage.
+	bool isDataOwned() const	{ return ! mExternalData; }
 
 	T& operator[]( size_t n )
 	{
 		CI_ASSERT( n < getSize() );
-		return mData[n];
+		return getData()[n];
 	}
 
 	const T& operator[]( size_t n ) const
 	{
 		CI_ASSERT( n < getSize() );
-		return mData[n];
+		return getData()[n];
 	}
 
 	//! Sets all samples to the value zero.
 	void zero()
 	{
-		std::memset( mData.data(), 0, mData.size() * sizeof( T ) );
+		std::memset( getData(), 0, ( mExternalData ? getSize() : mData.size() ) * sizeof( T ) );
 	}
 
   protected:
 	BufferBaseT( size_t numFrames, size_t numChannels )
-		: mNumFrames( numFrames ), mNumChannels( numChannels ), mData( numFrames * numChannels )
+		: mNumFrames( numFrames ), mNumChannels( numChannels ), mData( numFrames * numChannels ), mExternalData( nullptr )
+	{}
+
+	BufferBaseT( T *externalData, size_t numFrames, size_t numChannels )
+		: mNumFrames( numFrames ), mNumChannels( numChannels ), mExternalData( externalData )
 	{}
 
-	std::vector<T> mData;
+	std::vector<T, AlignedAllocator<T> > mData; // aligned to a cache line, as are all channels when the number of frames is a multiple of 16
+	T* mExternalData; // when non-null, samples live here and mData is unused. Copies reference the same storage.
 	size_t mNumChannels, mNumFrames;
 };
 
@@ -92,19 +165,23 @@ class BufferT : public BufferBaseT<T> {
 	BufferT( size_t numFrames = 0, size_t numChannels = 1 )
 		: BufferBaseT<T>( numFrames, numChannels )
 	{}
+	//! Constructs a BufferT that references \a numFrames * \a numChannels non-interleaved samples at \a data, which is neither copied nor freed. \a data must outlive this buffer and any copies made of it.
+	BufferT( T *data, size_t numFrames, size_t numChannels )
+		: BufferBaseT<T>( data, numFrames, numChannels )
+	{}
 
 	//! Returns a pointer offset to the first sample of channel \a ch.
 	T* getChannel( size_t ch )
 	{
 		CI_ASSERT_MSG( ch < this->mNumChannels, "ch out of range" );
-		return &this->mData[ch * this->mNumFrames];
+		return &this->getData()[ch * this->mNumFrames];
 	}
 
 	//! Returns a const pointer offset to the first sample of channel \a ch.
 	const T* getChannel( size_t ch ) const
 	{
 		CI_ASSERT_MSG( ch < this->mNumChannels, "ch out of range" );
-		return &this->mData[ch * this->mNumFrames];
+		return &this->getData()[ch * this->mNumFrames];
 	}
 
 	using BufferBaseT<T>::zero;
@@ -177,7 +254,7 @@ class BufferInterleavedT : public BufferBaseT<T> {
 	void zero( size_t startFrame, size_t numFrames )
 	{
 		CI_ASSERT( startFrame + numFrames <= this->mNumFrames );
-		std::memset( &this->mData[startFrame * this->mNumChannels], 0, numFrames * this->mNumChannels * sizeof( T ) );
+		std::memset( &this->getData()[startFrame * this->mNumChannels], 0, numFrames * this->mNumChannels * sizeof( T ) );
 	}
 };
 
@@ -192,14 +269,14 @@ class BufferSpectralT : public BufferT<T> {
 	BufferSpectralT( size_t numFrames = 0 ) : BufferT<T>( numFrames / 2, 2 ) {}
 
 	//! Returns a pointer to the first sample in the real component channel.
-	T* getReal()				{ return &this->mData[0]; }
+	T* getReal()				{ return this->getData(); }
 	//! Returns a const pointer to the first sample in the real component channel.
-	const T* getReal() const	{ return &this->mData[0]; }
+	const T* getReal() const	{ return this->getData(); }
 
 	//! Returns a pointer to the first sample in the imaginary component channel.
-	T* getImag()				{ return &this->mData[this->mNumFrames]; }
+	T* getImag()				{ return &this->getData()[this->mNumFrames]; }
 	//! Returns a const pointer to the first sample in the imaginary component channel.
-	const T* getImag() const	{ return &this->mData[this->mNumFrames]; }
+	const T* getImag() const	{ return &this->getData()[this->mNumFrames]; }
 };
 
 //! A resizable BufferT. The internally allocated buffer will grow as needed, but it will not shrink unless shrinkToFit() is called. TODO: enable move operator to convert BufferT to this
@@ -233,13 +310,39 @@ class BufferDynamicT : public BufferTT {
 		resizeIfNecessary();
 	}
 
-	//! Shrinks the allocated size to match the specified size, freeing any extra memory.
+	//! Shrinks the allocated size to match the specified size, freeing any extra memory. Has no effect when the buffer references external storage.
 	void shrinkToFit()
 	{
+		if( this->mExternalData )
+			return;
+
 		mAllocatedSize = this->getSize();
 		this->mData.resize( mAllocatedSize );
 	}
 
+	//! \brief Makes the buffer reference the \a capacity samples at \a data instead of its own storage, which is released.
+	//!
+	//! \a data is neither copied nor freed and must outlive this buffer's use of it. If the current size doesn't fit within \a capacity the number of frames is reduced.
+	//! Later resizes within \a capacity don't allocate, resizing beyond it returns the buffer to owned storage. Passing a null \a data returns the buffer to owned storage.
+	void setExternalStorage( typename BufferTT::SampleType *data, size_t capacity )
+	{
+		if( ! data ) {
+			if( this->mExternalData ) {
+				this->mExternalData = nullptr;
+				mAllocatedSize = this->getSize();
+				this->mData.resize( mAllocatedSize );
+			}
+			return;
+		}
+
+		this->mExternalData = data;
+		this->mData.clear();
+		this->mData.shrink_to_fit();
+		mAllocatedSize = capacity;
+		if( this->getSize() > capacity )
+			this->mNumFrames = capacity / std::max<size_t>( this->mNumChannels, 1 );
+	}
+
 	//! Returns the number of samples allocated in this buffer (may be larger than getSize()).
 	size_t getAllocatedSize() const		{ return mAllocatedSize; }
 
@@ -248,6 +351,12 @@ class BufferDynamicT : public BufferTT {
 	{
 		size_t size = this->getSize();
 		if( mAllocatedSize < size ) {
+			if( this->mExternalData ) {
+				// outgrew the external storage, keep the samples it held
+				this->mData.assign( this->mExternalData, this->mExternalData + mAllocatedSize );
+				this->mExternalData = nullptr;
+			}
+
 			mAllocatedSize = size;
 			this->mData.resize( mAllocatedSize );
 		}
@@ -262,22 +371,26 @@ struct FreeDeleter {
 	void operator()( T *x ) { std::free( x ); }
 };
 
-//! Returns an array of \a size elements of type \a T, aligned by \a alignment.
+//! Simple functor wrapping alignedFree(), suitable for unique_ptr's that allocate memory with alignedAlloc().
 template<typename T>
-std::unique_ptr<T, FreeDeleter<T> > makeAlignedArray( size_t size, size_t alignment = 16 )
+struct AlignedDeleter {
+	void operator()( T *x ) { alignedFree( x ); }
+};
+
+//! Returns a zero-initialized array of \a size elements of type \a T, aligned by \a alignment. \throws std::bad_alloc if the allocation fails.
+template<typename T>
+std::unique_ptr<T, AlignedDeleter<T> > makeAlignedArray( size_t size, size_t alignment = 16 )
 {
-	void *ptr = std::calloc( size, sizeof( T ) );
-
-	// FIXME: broken on windows, this is returning NULL.
-	// unnecessary at the moment anyway, so it is commented out until fixed
-	//ptr = std::align( alignment, size, ptr, size );
-	//CI_ASSERT( ptr );
-	
-	return std::unique_ptr<T, FreeDeleter<T> >( static_cast<T *>( ptr ) );
+	void *ptr = alignedAlloc( size * sizeof( T ), alignment );
+	if( ! ptr )
+		throw std::bad_alloc();
+
+	std::memset( ptr, 0, size * sizeof( T ) );
+	return std::unique_ptr<T, AlignedDeleter<T> >( static_cast<T *>( ptr ) );
 }
 
-typedef std::unique_ptr<float, FreeDeleter<float> >		AlignedArrayPtr;
-typedef std::unique_ptr<double, FreeDeleter<double> >	AlignedArrayPtrd;
+typedef std::unique_ptr<float, AlignedDeleter<float> >		AlignedArrayPtr;
+typedef std::unique_ptr<double, AlignedDeleter<double> >	AlignedArrayPtrd;
 
 // ---------------------------------------------------------------------------------
 // typedef's for the various flavors of Buffer's.
@@ -24,13 +24,43 @@
 #pragma once
 
 #include "cinder/audio/Node.h"
+#include "cinder/audio/Param.h"
 
 #include <list>
+#include <vector>
 
 namespace cinder { namespace audio {
 
 typedef std::shared_ptr<class ChannelRouterNode>	ChannelRouterNodeRef;
 
+//! \brief Gains from each channel of an input to each channel of a ChannelRouterNode, used for upmixing, downmixing, ambisonic decoding and the like.
+//!
+//! There is one row per output channel and one column per input channel, all zero unless set.
+class GainMatrix {
+  public:
+	//! Constructs a GainMatrix with \a numInputChannels columns and \a numOutputChannels rows, where all gains are zero.
+	GainMatrix( size_t numInputChannels = 0, size_t numOutputChannels = 0 );
+
+	//! Returns a GainMatrix that maps input channel n to output channel n with unity gain.
+	static GainMatrix identity( size_t numInputChannels, size_t numOutputChannels );
+
+	//! Sets the gain applied to \a inputChannel when it is mixed into \a outputChannel.
+	void	setGain( size_t inputChannel, size_t outputChannel, float gain );
+	//! Returns the gain applied to \a inputChannel when it is mixed into \a outputChannel.
+	float	getGain( size_t inputChannel, size_t outputChannel ) const;
+
+	//! Returns the number of input channels (columns).
+	size_t	getNumInputChannels() const		{ return mNumInputChannels; }
+	//! Returns the number of output channels (rows).
+	size_t	getNumOutputChannels() const	{ return mNumOutputChannels; }
+	//! Returns the gains applied to each input channel when mixing \a outputChannel.
+	const float*	getRow( size_t outputChannel ) const	{ return &mGains[outputChannel * mNumInputChannels]; }
+
+  private:
+	size_t				mNumInputChannels, mNumOutputChannels;
+	std::vector<float>	mGains;
+};
+
 //! \brief Node for mapping input channels to output channels.
 //!
 //! ChannelRouterNode allows one to route the channels of connected inputs to specific output channels, which
@@ -49,6 +79,19 @@ typedef std::shared_ptr<class ChannelRouterNode>	ChannelRouterNodeRef;
 //! samplePlayer >> router->route( 1, 0, 1 );	// routes channel 1 of samplePlayer to router's channel 0, taking only one channel.
 //! \endcode
 //!
+//! Inputs can also be mixed into all of the ChannelRouterNode's channels through a GainMatrix, which can later be changed with a ramp:
+//!
+//! \code
+//! auto gains = GainMatrix( 2, 4 );
+//! gains.setGain( 0, 0, 1 );	// front left
+//! gains.setGain( 1, 1, 1 );	// front right
+//! gains.setGain( 0, 2, 0.5f );	// rear left
+//! gains.setGain( 1, 3, 0.5f );	// rear right
+//! stereoPlayer >> router->route( gains );
+//! \endcode
+//!
+//! Only the non-zero gains of a GainMatrix are applied, each one as a SIMD multiply-add over the processing block, so sparse matrices are cheap and
+//! a dense matrix costs about one multiply-add per input channel, output channel and frame.
 class ChannelRouterNode : public Node {
   public:
 	//! Constructs a ChannelRouterNode object, with an optional \a format.
@@ -60,6 +103,8 @@ class ChannelRouterNode : public Node {
 		RouteConnector( const ChannelRouterNodeRef &outputRouter, size_t inputChannelIndex, size_t outputChannelIndex );
 		//! Constructs a RouteConnector that will route \a numChannels from the input to the output ChannelRouterNode.
 		RouteConnector( const ChannelRouterNodeRef &outputRouter, size_t inputChannelIndex, size_t outputChannelIndex, size_t numChannels );
+		//! Constructs a RouteConnector that will mix the input into the output ChannelRouterNode through \a gains.
+		RouteConnector( const ChannelRouterNodeRef &outputRouter, const GainMatrix &gains );
 
 		//! Returns the output ChannelRouterNode.
 		const ChannelRouterNodeRef& getOutputRouter() const		{ return mOutputRouter; }
@@ -69,34 +114,63 @@ class ChannelRouterNode : public Node {
 		size_t	getOutputChannelIndex() const				{ return mOutputChannelIndex; }
 		//! Returns the number of channels to route in the connection.
 		size_t	getNumChannels() const						{ return mNumChannels; }
+		//! Returns the gains to mix the input with, or null if the connection routes a range of channels.
+		const GainMatrix*	getGains() const				{ return mGains.get(); }
 
 	  private:
 		ChannelRouterNodeRef mOutputRouter;
 		size_t	mInputChannelIndex, mOutputChannelIndex, mNumChannels;
+		std::shared_ptr<GainMatrix>	mGains;
 	};
 
 	//! Used in conjunction with `operator>>`, specified that the routing is to map the input's \a inputChannelIndex to the output's (this ChannelRouterNode) \a outputChannelIndex, routing as many channels as possible.
 	RouteConnector route( size_t inputChannelIndex, size_t outputChannelIndex );
 	//! Used in conjunction with `operator>>`, specified that the routing is to map the input's \a inputChannelIndex to the output's (this ChannelRouterNode) \a outputChannelIndex, routing \a numChannels number of channels.
 	RouteConnector route( size_t inputChannelIndex, size_t outputChannelIndex, size_t numChannels );
+	//! Used in conjunction with `operator>>`, specifies that the input is mixed into this ChannelRouterNode's channels through \a gains, which must have one row per channel.
+	RouteConnector route( const GainMatrix &gains );
 
 	//! Adds \a input to the route list, routing \a numChannels starting at \a inputChannelIndex of \a input to \a outputChannelIndex.
 	void addInputRoute( const NodeRef &input, size_t inputChannelIndex, size_t outputChannelIndex, size_t numChannels );
+	//! Adds \a input to the route list, mixing its channels into this ChannelRouterNode's channels through \a gains, which must have one row per channel.
+	void addInputMatrix( const NodeRef &input, const GainMatrix &gains );
+	//! Sets the gains that \a input is mixed with, which must have been routed with a GainMatrix. The gains are interpolated from their current values over \a rampSeconds with \a rampFn, or changed at the next processing block if \a rampSeconds is 0.
+	void setInputGains( const NodeRef &input, const GainMatrix &gains, float rampSeconds = 0, const RampFn &rampFn = rampLinear );
+	//! Returns the gains that \a input is mixed with (the target gains if they are ramping), or an empty GainMatrix if \a input isn't routed with a GainMatrix.
+	GainMatrix getInputGains( const NodeRef &input ) const;
 
 	virtual void disconnectAllInputs()									override;
 	
   protected:
+	virtual void initialize()											override;
 	virtual bool supportsInputNumChannels( size_t numChannels ) const	override;
 	virtual bool supportsProcessInPlace() const							override;
 	virtual void sumInputs()											override;
 	virtual void disconnectInput( const NodeRef &input )				override;
 
+	// Non-zero gains of a GainMatrix route, stored per output channel. While ramping, the applied gains are mGains + ramp * mGainDeltas.
+	struct MatrixGains {
+		GainMatrix			mTarget;
+		std::vector<size_t>	mRowBegin, mInputChannels;
+		std::vector<float>	mGains, mGainDeltas;
+		Buffer				mRampedInput;	// input scaled by the ramp curve
+		RampFn				mRampFn;
+		uint64_t			mRampBeginFrame, mRampNumFrames;
+		bool				mIsRamping;
+	};
+
 	struct Route {
 		NodeRef	mInput;
 		size_t	mInputChannelIndex, mOutputChannelIndex, mNumChannels;
+		std::shared_ptr<MatrixGains>	mMatrix;	// null for channel range routes
 	};
 
+	Route*	findRoute( const NodeRef &input );
+	void	setMatrixGains( MatrixGains *matrix, const GainMatrix &gainsBegin, const GainMatrix &gainsEnd );
+	void	mixMatrix( MatrixGains *matrix, const Buffer *sourceBuffer, Buffer *destBuffer );
+
 	std::list<Route>	mRoutes;
+	Buffer				mRampBuffer;
 };
 
 //! Enable routing connection syntax: \code input >> output->route( inputChannelIndex, outputChannelIndex, numChannels ); \endcode.  \return the output ChannelRouterNode after connection is made.
@@ -26,8 +26,10 @@
 #include "cinder/audio/Node.h"
 #include "cinder/audio/InputNode.h"
 #include "cinder/audio/OutputNode.h"
+#include "cinder/audio/Profiler.h"
+#include "cinder/audio/FileStreamScheduler.h"
+#include "cinder/audio/dsp/RingBuffer.h"
 
-#include <list>
 #include <mutex>
 #include <set>
 #include <thread>
@@ -43,7 +45,7 @@ class DeviceManager;
 //! which is the only hardware-facing Context.
 //!
 //! All Node's are created using the Context, which is necessary for thread synchronization.
-class Context : public std::enable_shared_from_this<Context> {
+class Context : public std::enable_shared_from_this<Context>, private FileStreamScheduler::Client {
   public:
 	virtual ~Context();
 
@@ -108,8 +110,24 @@ class Context : public std::enable_shared_from_this<Context> {
 	//! \note Callers on the non-audio thread must synchronize with getMutex().
 	void removeAutoPulledNode( const NodeRef &node );
 
-	//! Schedule \a node to be enabled or disabled with with \a func on the audio thread, to be called at \a when seconds measured against getNumProcessedSeconds(). \a node is owned until the scheduled event completes.
+	//! \brief Schedule \a node to be enabled or disabled with with \a func on the audio thread, to be called at \a when seconds measured against getNumProcessedSeconds().
+	//!
+	//! The event takes effect at the exact frame within the processing block, by way of \a node's Node::getProcessFramesRange(). Events are passed to the audio
+	//! thread through a lock-free queue with preallocated storage, so scheduling never blocks the audio thread. \a node and \a func are owned until the
+	//! processing block the event completes in, after which they are released on one of the FileStreamScheduler's threads so they are never destroyed on the audio thread.
+	//!
+	//! Events take effect in the order of their times. As a Node's process range can't have a gap, an enable that falls after a disable of the same
+	//! Node within one processing block is deferred to the start of the next block.
+	//! \throws AudioContextExc if getMaxScheduledEvents() events are already pending.
 	void schedule( double when, const NodeRef &node, bool enable, const std::function<void ()> &func );
+	//! Returns the maximum number of events that can be pending at one time with schedule().
+	size_t getMaxScheduledEvents() const	{ return mScheduledEvents.size(); }
+
+	//! \brief Returns the number of samples in the arena that summing buffers are carved from.
+	//!
+	//! Node's that sum their inputs and are pulled by the output or as auto-pulled Node's use storage in this arena, rather than each owning a buffer.
+	//! Node's whose summing buffers are never in use at the same time share storage, so the arena is typically much smaller than the sum of those buffers.
+	size_t getSummingArenaSize() const		{ return mSummingArenaSize; }
 
 	//! Returns the mutex used to synchronize the audio thread. This is also used internally by the Node class when making connections.
 	std::mutex& getMutex() const			{ return mMutex; }
@@ -124,19 +142,26 @@ class Context : public std::enable_shared_from_this<Context> {
 	//! Returns a string representation of the Node graph for debugging purposes.
 	std::string printGraphToString();
 
+	//! Enables or disables measuring the time spent processing each Node and each block. \see Profiler
+	void		setProfilingEnabled( bool enable = true );
+	//! Returns whether the Profiler is enabled.
+	bool		isProfilingEnabled() const		{ return mActiveProfiler.load() != nullptr; }
+	//! Returns the Profiler that holds timing statistics for this Context, creating it if necessary. Its results remain readable after profiling is disabled.
+	Profiler*	getProfiler();
+	//! Returns the Profiler if profiling is enabled, otherwise null. Safe to call from the audio thread.
+	Profiler*	getActiveProfiler() const		{ return mActiveProfiler.load( std::memory_order_acquire ); }
+
   protected:
 	Context();
 
   private:
 	struct ScheduledEvent {
-		ScheduledEvent( uint64_t eventFrameThreshold, const NodeRef &node, bool enable, const std::function<void ()> &fn )
-			: mEventFrameThreshold( eventFrameThreshold ), mNode( node ), mEnable( enable ), mFunc( fn ), mFinished( false )
-		{}
+		ScheduledEvent() : mFrame( 0 ), mSequence( 0 ), mEnable( false )	{}
 
-		uint64_t				mEventFrameThreshold;
+		uint64_t				mFrame;		// the frame the event takes effect at, as in getNumProcessedFrames()
+		uint64_t				mSequence;	// orders events that fall on the same frame by when they were scheduled
 		NodeRef					mNode;
 		bool					mEnable;
-		bool					mFinished;
 		std::function<void ()>	mFunc;
 	};
 
@@ -147,6 +172,10 @@ class Context : public std::enable_shared_from_this<Context> {
 	void	processAutoPulledNodes();
 	void	preProcessScheduledEvents();
 	void	postProcessScheduledEvents();
+	bool	isEventDeferred( const ScheduledEvent &event ) const;
+	void	reclaimRetiredEvents();
+	void	serviceStream() override;
+	void	updateSummingBuffers();
 	void	incrementFrameCount();
 
 	static void registerClearStatics();
@@ -154,7 +183,16 @@ class Context : public std::enable_shared_from_this<Context> {
 	bool						mEnabled;
 	std::atomic<uint64_t>		mNumProcessedFrames;
 	OutputNodeRef				mOutput;
-	std::list<ScheduledEvent>	mScheduledEvents;
+
+	// Scheduled events live in a fixed pool and are passed between threads by index. The non-audio threads fill free events and push them to
+	// mPendingEventIndices, the audio thread keeps them in a heap ordered by frame and pushes them to mRetiredEventIndices once they complete.
+	std::vector<ScheduledEvent>		mScheduledEvents;
+	std::vector<uint32_t>			mFreeEventIndices;			// only accessed with mScheduleMutex locked
+	uint64_t						mNextEventSequence;			// only accessed with mScheduleMutex locked
+	dsp::RingBufferT<uint32_t>		mPendingEventIndices, mRetiredEventIndices;
+	std::vector<uint32_t>			mEventHeap, mFiringEventIndices, mDeferredEventIndices;	// only accessed on the audio thread
+	std::mutex						mScheduleMutex;
+	bool							mIsEventReleaseClient;		// whether this Context has registered with the FileStreamScheduler to release retired events
 
 	// other nodes that don't have any outputs and need to be explictly pulled
 	std::set<NodeRef>		mAutoPulledNodes;
@@ -162,9 +200,20 @@ class Context : public std::enable_shared_from_this<Context> {
 	bool					mAutoPullRequired, mAutoPullCacheDirty;
 	BufferDynamic			mAutoPullBuffer;
 
+	// Summing buffers of the Node's that are pulled by this Context reference storage in this arena, see updateSummingBuffers()
+	AlignedArrayPtr						mSummingArena;
+	size_t								mSummingArenaSize;
+	std::vector<std::weak_ptr<Node> >	mSummingArenaNodes;
+
 	mutable std::mutex		mMutex;
 	std::thread::id			mAudioThreadId;
 
+	std::unique_ptr<Profiler>	mProfiler;
+	std::atomic<Profiler *>		mActiveProfiler;
+
+	friend class Node;
+	friend class Profiler;
+
 	// - Context is stored in Node classes as a weak_ptr, so it needs to (for now) be created as a shared_ptr
 	static std::shared_ptr<Context>			sMasterContext;
 	static std::unique_ptr<DeviceManager>	sDeviceManager; // TODO: consider turning DeviceManager into a HardwareContext class
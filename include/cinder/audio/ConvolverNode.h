@@ -0,0 +1,95 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/audio/Node.h"
+#include "cinder/audio/Source.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class ConvolverNode>	ConvolverNodeRef;
+
+//! \brief Convolves its input with an impulse response, for example to apply a reverb.
+//!
+//! Uses non-uniformly partitioned FFT convolution. The head of the impulse response is processed on the audio thread with partitions
+//! that match the processing block size, so no latency is added. The tail is split into segments with increasingly larger partitions
+//! that are computed on a background thread, each segment starting far enough into the impulse response that its results arrive
+//! before they are needed. Each channel is convolved with the impulse response channel of the same index, or the last one if the
+//! impulse response has fewer channels.
+//!
+//! \note When no impulse response is set, the input passes through unchanged.
+class ConvolverNode : public Node {
+  public:
+	//! Constructs a ConvolverNode with an optional \a format.
+	ConvolverNode( const Format &format = Format() );
+	//! Constructs a ConvolverNode that convolves its input with \a impulseResponse, and an optional \a format.
+	ConvolverNode( const BufferRef &impulseResponse, const Format &format = Format() );
+	virtual ~ConvolverNode();
+
+	//! Sets the impulse response, which is expected to be at the Context's samplerate. The partitions are prepared on the calling thread, so this is safe to call while processing.
+	void setImpulseResponse( const BufferRef &impulseResponse );
+	//! Loads the impulse response from \a sourceFile with SourceFile::loadBuffer(), resampling it to the Context's samplerate if necessary.
+	void loadImpulseResponse( const SourceFileRef &sourceFile );
+	//! Returns the current impulse response, or an empty BufferRef if none is set.
+	const BufferRef& getImpulseResponse() const	{ return mImpulseResponse; }
+
+	//! Sets the largest partition size in frames used for the tail of the impulse response (default = 8192). Takes effect the next time the impulse response is set or the Node is initialized.
+	void	setMaxPartitionSize( size_t frames )	{ mMaxPartitionSize = frames; }
+	//! Returns the largest partition size in frames used for the tail of the impulse response.
+	size_t	getMaxPartitionSize() const				{ return mMaxPartitionSize; }
+
+	//! Returns the frame of the last tail underrun (the background thread did not deliver a partition in time), or 0 if none since the last time this method was called.
+	uint64_t getLastUnderrun();
+
+  protected:
+	void initialize()				override;
+	void uninitialize()				override;
+	void process( Buffer *buffer )	override;
+
+  private:
+	struct Segment;
+
+	std::vector<std::unique_ptr<Segment> > makeSegments( const BufferRef &impulseResponse ) const;
+	void startWorkerThread();
+	void stopWorkerThread();
+	void workerThreadImpl();
+
+	BufferRef									mImpulseResponse;
+	size_t										mMaxPartitionSize;
+	uint64_t									mNumFramesConvolved;
+	Buffer										mInputBuffer;
+	std::vector<std::unique_ptr<Segment> >		mSegments;		// first is the head, processed on the audio thread. The rest are processed on the worker thread.
+
+	std::unique_ptr<std::thread>				mWorkerThread;
+	std::mutex									mWorkerMutex;
+	std::condition_variable						mWorkerCond;
+	bool										mWorkerShouldQuit;
+	std::atomic<uint64_t>						mLastUnderrun;
+};
+
+} } // namespace cinder::audio
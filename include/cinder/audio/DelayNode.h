@@ -26,16 +26,29 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "cinder/audio/Node.h"
 #include "cinder/audio/Param.h"
 
+#include <vector>
+
 namespace cinder { namespace audio {
 
 typedef std::shared_ptr<class DelayNode>		DelayNodeRef;
 
-//! \brief General purpose delay line, supporting variable delay with linear interpolation.
+//! \brief General purpose multichannel delay line, supporting fractional and per-sample modulated delay times.
 //!
-//! Enables feedback if connected in a graph cycle.
-//! \note Restrictions: The current minimum delay length is one processing block. Restricts channel count to 1 (mixes down inputs).
+//! Enables feedback if connected in a graph cycle. The delay may be shorter than one processing block, however within
+//! a cycle the feedback path is still delayed by at least one block, since that is the soonest its output can be processed again.
+//! By default the number of channels matches the input; all channels share the same delay time.
 class DelayNode : public Node {
   public:
+	//! The method used to read the delay line in between samples.
+	enum class Interpolation {
+		//! Cheapest. Slightly low-passes fractional delays, which is audible as a varying dullness when the delay is modulated.
+		LINEAR,
+		//! First order allpass, which has a flat magnitude response. Best suited to fixed or slowly changing delays, such as tuning a physical model.
+		ALLPASS,
+		//! Four-point Hermite, for the highest quality modulated delays (chorus, flanger, vibrato). The minimum delay is one frame.
+		CUBIC
+	};
+
 	//! Constructs a DelayNode with an optional \a format.
 	DelayNode( const Format &format = Format() );
 
@@ -44,13 +57,18 @@ class DelayNode : public Node {
 	//! Returns the maximum delay in seconds.
 	float	getMaxDelaySeconds() const		{ return mMaxDelaySeconds; }
 
-	//! Sets the delay value in seconds. Must be at least at least the length of one processing block.
+	//! Sets the delay value in seconds. Values that aren't a multiple of the sample period are interpolated. \see setInterpolation()
 	void	setDelaySeconds( float seconds );
 	//! Returns the delay value in seconds.
 	float	getDelaySeconds() const				{ return mParamDelaySeconds.getValue(); }
-	//! Returns the Param used to automate the delay seconds. \note Values over max delay seconds will be clipped, causing pops.
+	//! Returns the Param used to automate the delay seconds, which is evaluated per sample. \note Values over max delay seconds will be clipped, causing pops.
 	Param*	getParamDelaySeconds()			{ return &mParamDelaySeconds; }
 
+	//! Sets the interpolation used for fractional delays (default = Interpolation::LINEAR). Safe to call while processing.
+	void			setInterpolation( Interpolation interpolation )	{ mInterpolation = interpolation; }
+	//! Returns the interpolation used for fractional delays.
+	Interpolation	getInterpolation() const						{ return mInterpolation; }
+
 	//! Clears any samples in the delay buffer (sets them to zero).
 	void clearBuffer();
 
@@ -59,10 +77,18 @@ class DelayNode : public Node {
 	void process( Buffer *buffer )	override;
 	bool supportsCycles() const		override	{ return true; }
 
+	//! Computes the read index and interpolation fraction of each frame from the delay times in mDelayFrames.
+	void computeReadPositions( size_t numFrames, Interpolation interpolation );
+
 	size_t			mWriteIndex;
 	float			mMaxDelaySeconds, mSampleRate;
 	Param			mParamDelaySeconds;
 	BufferDynamic	mDelayBuffer;
+
+	std::atomic<Interpolation>	mInterpolation;
+	std::vector<float>			mDelayFrames, mReadFractions;	// per frame of the current block
+	std::vector<uint32_t>		mReadIndices;					// per frame of the current block, the older of the two samples being interpolated
+	std::vector<float>			mAllpassStates;					// previous output, per channel
 };
 
 } } // namespace cinder::audio
@@ -0,0 +1,89 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/audio/Source.h"
+
+#include <cstdint>
+
+namespace cinder { namespace audio {
+
+class MappedFile;
+
+//! \brief SourceFile implementation for decoding FLAC files, without depending on libFLAC.
+//!
+//! Like SourceFilePcm, file paths are memory-mapped and frames are decoded straight from the file's contents. Seeking uses the file's
+//! SEEKTABLE when it has one and otherwise bisects the file on frame headers, then decodes forward to the requested frame.
+//! Vorbis comments are returned by getMetaData(). Streams with more than 32 bits per sample are unsupported.
+class SourceFileFlac : public SourceFile {
+  public:
+	SourceFileFlac( const DataSourceRef &dataSource, size_t sampleRate );
+	virtual ~SourceFileFlac();
+
+	SourceFileRef	cloneWithSampleRate( size_t sampleRate ) const	override;
+
+	size_t		getNumChannels() const	override		{ return mNumChannels; }
+	size_t		getSampleRateNative() const	override	{ return mNativeSampleRate; }
+
+	size_t		performRead( Buffer *buffer, size_t bufferFrameOffset, size_t numFramesNeeded )		override;
+	void		performSeek( size_t readPositionFrames )											override;
+	std::string getMetaData() const																	override;
+
+	//! Returns the file extensions that SourceFileFlac can read.
+	static std::vector<std::string>	getSupportedExtensions();
+
+  private:
+	struct FrameHeader {
+		uint64_t	mFirstSample;
+		size_t		mBlockSize, mBitsPerSample, mChannelAssignment, mHeaderSize;
+	};
+
+	struct SeekPoint {
+		uint64_t	mSample, mOffset;
+	};
+
+	SourceFileFlac( const SourceFileFlac &other, size_t sampleRate );
+
+	void	parseMetaData();
+	bool	parseFrameHeader( size_t offset, FrameHeader *header ) const;
+	size_t	findFrame( size_t beginOffset, size_t endOffset, FrameHeader *header ) const;
+	void	decodeFrame( size_t offset );
+	void	resetBlock();
+
+	DataSourceRef					mDataSource;
+	std::shared_ptr<MappedFile>		mMappedFile;
+	const uint8_t*					mFileData;
+	size_t							mFileSize, mFirstFrameOffset;
+
+	size_t					mNumChannels, mNativeSampleRate, mBitsPerSample, mMinBlockSize, mMaxBlockSize;
+	std::vector<SeekPoint>	mSeekPoints;
+	std::string				mMetaData;
+
+	// decoded samples of the current frame, one channel after the other with mMaxBlockSize samples each
+	std::vector<int32_t>	mBlock;
+	uint64_t				mBlockFirstSample;
+	size_t					mBlockNumFrames, mBlockBitsPerSample, mNextFrameOffset, mFramePosition;
+};
+
+} } // namespace cinder::audio
@@ -24,6 +24,10 @@
 #pragma once
 
 #include "cinder/audio/Source.h"
+#include "cinder/audio/FileStreamScheduler.h"
+#include "cinder/audio/dsp/RingBuffer.h"
+
+#include <mutex>
 
 //! don't include ogg's static callbacks (we rely on cinder's stream utils instead)
 #define OV_EXCLUDE_STATIC_CALLBACKS
@@ -37,8 +41,12 @@ namespace dsp {
 	class Converter;
 }
 
-//! SourceFile implementation for decoding ogg vorbis files.
-class SourceFileOggVorbis : public SourceFile {
+//! \brief SourceFile implementation for decoding ogg vorbis files.
+//!
+//! Seeks use an index of the file's pages, which is built on the first seek away from the beginning and shared with clones, so they
+//! decode from a nearby page instead of bisecting the file. Decoding can optionally run ahead of reads on the FileStreamScheduler's I/O
+//! threads, see setDecodeAheadFrames().
+class SourceFileOggVorbis : public SourceFile, private FileStreamScheduler::Client {
   public:
 	SourceFileOggVorbis();
 	SourceFileOggVorbis( const DataSourceRef &dataSource, size_t sampleRate );
@@ -53,8 +61,25 @@ class SourceFileOggVorbis : public SourceFile {
 	void		performSeek( size_t readPositionFrames )											override;
 	std::string getMetaData() const																	override;
 
+	//! Sets the number of frames that are decoded ahead of the read position on the FileStreamScheduler's I/O threads, so that reads mostly
+	//! copy samples that are already decoded. Reads that get ahead of the I/O threads decode the remainder themselves. 0 (default) disables
+	//! decoding ahead. Must not be called while reading or seeking on another thread.
+	void	setDecodeAheadFrames( size_t numFrames );
+	//! Returns the number of frames that are decoded ahead of the read position, or 0 if decoding ahead is disabled.
+	size_t	getDecodeAheadFrames() const	{ return mDecodeAheadFrames; }
+
   private:
+	struct SeekIndex;
+
 	void init();
+	size_t	decode( Buffer *buffer, size_t bufferFrameOffset, size_t numFramesNeeded );
+	size_t	readDecodedAhead( Buffer *buffer, size_t bufferFrameOffset, size_t numFramesNeeded );
+	void	seekDecoder( size_t readPositionFrames );
+	void	buildSeekIndex();
+
+	// FileStreamScheduler::Client
+	void	serviceStream() override;
+	float	getStreamFill() const override;
 
 	// ov_callbacks
 	static size_t	readFn( void *ptr, size_t size, size_t count, void *datasource );
@@ -67,6 +92,13 @@ class SourceFileOggVorbis : public SourceFile {
 	ci::DataSourceRef	mDataSource;
 	ci::IStreamRef		mStream;
 	size_t				mNumChannels, mSampleRate;
+
+	std::shared_ptr<SeekIndex>	mSeekIndex;
+
+	std::mutex						mDecoderMutex;			// guards mOggVorbisFile while decoding ahead
+	std::vector<dsp::RingBuffer>	mDecodeAheadBuffers;	// one per channel, from the I/O threads to the reading thread
+	BufferDynamic					mDecodeAheadChunk;		// only used on the I/O threads
+	size_t							mDecodeAheadFrames;
 };
 
 //class TargetFileImplOggVorbis : public TargetFile {
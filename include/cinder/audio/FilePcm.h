@@ -0,0 +1,103 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/audio/Source.h"
+#include "cinder/audio/Target.h"
+
+namespace cinder { namespace audio {
+
+class MappedFile;
+
+//! \brief SourceFile implementation for uncompressed WAV (including RF64) and AIFF / AIFF-C files.
+//!
+//! File paths are memory-mapped and other DataSources are read from their in-memory buffer, so samples are converted straight from the
+//! file's contents into the destination Buffer, without an intermediate stream. Clones share the mapping. 8, 16, 24 and 32-bit integer
+//! and 32 and 64-bit floating point samples are supported in either byte order. \throws AudioFormatExc for other encodings.
+class SourceFilePcm : public SourceFile {
+  public:
+	SourceFilePcm( const DataSourceRef &dataSource, size_t sampleRate );
+	virtual ~SourceFilePcm();
+
+	SourceFileRef	cloneWithSampleRate( size_t sampleRate ) const	override;
+
+	size_t		getNumChannels() const	override		{ return mNumChannels; }
+	size_t		getSampleRateNative() const	override	{ return mNativeSampleRate; }
+
+	size_t		performRead( Buffer *buffer, size_t bufferFrameOffset, size_t numFramesNeeded )		override;
+	void		performSeek( size_t readPositionFrames )											override;
+	std::string getMetaData() const																	override;
+
+	//! Returns the file extensions that SourceFilePcm can read.
+	static std::vector<std::string>	getSupportedExtensions();
+
+  private:
+	enum class Encoding { INT_8_UNSIGNED, INT_8, INT_16, INT_24, INT_32, FLOAT_32, FLOAT_64 };
+
+	SourceFilePcm( const SourceFilePcm &other, size_t sampleRate );
+
+	void	parseWav();
+	void	parseAiff();
+	void	setEncoding( Encoding encoding, bool bigEndian, size_t bytesPerSample );
+	void	convertToFloat( const char *source, float *dest, size_t numSamples );
+
+	DataSourceRef					mDataSource;
+	std::shared_ptr<MappedFile>		mMappedFile;
+	const char*						mFileData;
+	size_t							mFileSize, mDataOffset;
+
+	Encoding			mEncoding;
+	bool				mBigEndian;
+	size_t				mNumChannels, mNativeSampleRate, mBytesPerSample, mBytesPerFrame, mFramePosition;
+	std::string			mMetaData;
+	std::vector<float>	mConversionBuffer;
+};
+
+//! \brief TargetFile implementation that writes uncompressed WAV or AIFF files, chosen by the file extension.
+//!
+//! All SampleType's are supported. Floating point AIFF files are written as AIFF-C. The sizes in the header are written when the TargetFilePcm is destroyed.
+class TargetFilePcm : public TargetFile {
+  public:
+	TargetFilePcm( const DataTargetRef &dataTarget, size_t sampleRate, size_t numChannels, SampleType sampleType, const std::string &extension );
+	virtual ~TargetFilePcm();
+
+	//! Returns the file extensions that TargetFilePcm can write.
+	static std::vector<std::string>	getSupportedExtensions();
+
+  protected:
+	void performWrite( const Buffer *buffer, size_t numFrames, size_t frameOffset ) override;
+
+  private:
+	void writeHeader();
+	void updateHeaderSizes();
+
+	OStreamRef			mStream;
+	bool				mIsAiff;
+	size_t				mBytesPerSample, mNumFramesWritten;
+	size_t				mDataOffset, mFrameCountOffset, mDataSizeOffset; // byte offsets of the samples and of header fields that are written last
+	std::vector<float>	mInterleavedBuffer;
+	std::vector<char>	mEncodedBuffer;
+};
+
+} } // namespace cinder::audio
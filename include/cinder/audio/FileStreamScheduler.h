@@ -0,0 +1,94 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cinder { namespace audio {
+
+//! \brief Process-wide pool of I/O threads that serves all streaming file readers and writers, such as FilePlayerNode.
+//!
+//! Clients register themselves with addClient() and call Client::requestService() (lock-free, safe from the audio thread)
+//! when they need I/O. Each waiting Client is serviced by one thread at a time, those with the lowest Client::getStreamFill()
+//! first, so a small number of threads can keep many streams fed without contending for the disk.
+class FileStreamScheduler {
+  public:
+	//! Interface for objects serviced by the FileStreamScheduler.
+	class Client {
+	  public:
+		virtual ~Client()	{}
+
+		//! Flags this Client as needing service and wakes an I/O thread. Lock-free, though it may make a system call to wake the thread.
+		void requestService();
+
+	  protected:
+		Client() : mServiceRequested( false ), mIsBeingServiced( false )	{}
+
+		//! Called on one of the I/O threads when service was requested. Never called concurrently for the same Client.
+		virtual void serviceStream() = 0;
+		//! Returns how full this Client's stream buffer is (0 = empty, 1 = full). Used to service the most urgent Client's first.
+		virtual float getStreamFill() const		{ return 0; }
+
+	  private:
+		std::atomic<bool>	mServiceRequested;
+		bool				mIsBeingServiced;	// guarded by FileStreamScheduler::mMutex
+
+		friend class FileStreamScheduler;
+	};
+
+	//! Returns the process-wide FileStreamScheduler, creating it if necessary.
+	static FileStreamScheduler* get();
+
+	~FileStreamScheduler();
+
+	//! Registers \a client to be serviced.
+	void addClient( Client *client );
+	//! Unregisters \a client. Blocks until \a client is no longer being serviced, so it must not be called from the audio thread.
+	void removeClient( Client *client );
+
+	//! Sets the number of I/O threads (default = 2).
+	void	setNumThreads( size_t numThreads );
+	//! Returns the number of I/O threads.
+	size_t	getNumThreads() const;
+
+  private:
+	FileStreamScheduler();
+
+	void	threadImpl( size_t threadIndex );
+	Client*	nextClientLocked();
+	void	notify();
+
+	std::vector<Client *>						mClients;
+	std::vector<std::unique_ptr<std::thread> >	mThreads;
+	size_t										mNumThreads;
+	mutable std::mutex							mMutex;
+	std::condition_variable						mServiceCond, mClientDoneCond;
+};
+
+} } // namespace cinder::audio
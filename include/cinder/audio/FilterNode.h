@@ -25,8 +25,7 @@
 
 #include "cinder/audio/Node.h"
 #include "cinder/audio/dsp/Biquad.h"
-
-#include <vector>
+#include "cinder/audio/dsp/BiquadBank.h"
 
 // TODO: add api for setting biquad with arbitrary set of coefficients, similar to pd's [biquad~]
 
@@ -36,7 +35,7 @@ typedef std::shared_ptr<class FilterLowPassNode>		FilterLowPassNodeRef;
 typedef std::shared_ptr<class FilterHighPassNode>		FilterHighPassNodeRef;
 typedef std::shared_ptr<class FilterBandPassNode>		FilterBandPassNodeRef;
 
-//! General class for filtering nodes based on a biquad (two pole, two zero) filter.
+//! General class for filtering nodes based on a biquad (two pole, two zero) filter. All channels are processed together with a dsp::BiquadBank.
 class FilterBiquadNode : public Node {
   public:
 	//! The modes that are available as 'preset' coefficients, which set the frequency response to a common type of filter.
@@ -70,10 +69,10 @@ class FilterBiquadNode : public Node {
 
 	void updateBiquadParams();
 
-	std::vector<dsp::Biquad> mBiquads;
-	std::atomic<bool> mCoeffsDirty;
-	BufferT<double> mBufferd;
-	size_t mNiquist;
+	dsp::Biquad			mBiquad;		// used to design the coefficients, which are then copied to each channel of mBiquadBank
+	dsp::BiquadBank		mBiquadBank;
+	std::atomic<bool>	mCoeffsDirty;
+	size_t				mNiquist;
 
 	Mode mMode;
 	float mFreq, mQ, mGain;
@@ -38,6 +38,7 @@ typedef std::shared_ptr<class GenTriangleNode>		GenTriangleNodeRef;
 typedef std::shared_ptr<class GenTableNode>			GenTableNodeRef;
 typedef std::shared_ptr<class GenOscNode>			GenOscNodeRef;
 typedef std::shared_ptr<class GenPulseNode>			GenPulseNodeRef;
+typedef std::shared_ptr<class GenOscBankNode>		GenOscBankNodeRef;
 
 //! Base class for InputNode's that generate audio samples. Gen's are always mono channel.
 class GenNode : public InputNode {
@@ -179,4 +180,78 @@ class GenPulseNode : public GenNode {
 	Param					mWidth;
 };
 
+//! \brief Bank of band-limited wavetable oscillators that are summed to one output, for additive synthesis or dense clusters of voices.
+//!
+//! All oscillators share one WaveTable2d, so they have the same waveform. Oscillator state is stored in parallel arrays and
+//! four oscillators are rendered at a time with SSE where available, making this much cheaper than the equivalent number of GenOscNode's.
+//! Frequency changes take effect at the next processing block and gain changes are ramped over one processing block.
+//! Like GenNode's, a GenOscBankNode is mono.
+class GenOscBankNode : public InputNode {
+  public:
+	struct Format : public Node::Format {
+		Format() : mMaxNumOscillators( 256 )	{}
+
+		//! Sets the number of oscillators that are allocated when the GenOscBankNode is constructed. Default = 256.
+		Format&		maxNumOscillators( size_t numOscillators )	{ mMaxNumOscillators = numOscillators; return *this; }
+
+		size_t		getMaxNumOscillators() const	{ return mMaxNumOscillators; }
+
+		// reimpl Node::Format
+		Format&		autoEnable( bool autoEnable = true )	{ Node::Format::autoEnable( autoEnable ); return *this; }
+
+	  protected:
+		size_t		mMaxNumOscillators;
+	};
+
+	GenOscBankNode( const Format &format = Format() );
+	GenOscBankNode( WaveformType waveformType, const Format &format = Format() );
+
+	//! Sets the frequency in hertz and \a gain of the oscillator at \a index, which must be less than getMaxNumOscillators().
+	void	setOscillator( size_t index, float freq, float gain );
+	//! Sets the frequency in hertz of the oscillator at \a index.
+	void	setFreq( size_t index, float freq );
+	//! Returns the frequency in hertz of the oscillator at \a index.
+	float	getFreq( size_t index ) const;
+	//! Sets the gain of the oscillator at \a index. Oscillators with a gain of zero (the default) are not rendered.
+	void	setGain( size_t index, float gain );
+	//! Returns the gain of the oscillator at \a index.
+	float	getGain( size_t index ) const;
+	//! Resets the phase of all oscillators to zero at the beginning of the next processing block.
+	void	resetPhases()						{ mNeedsPhaseReset = true; }
+
+	//! Returns the number of oscillators allocated when this GenOscBankNode was constructed.
+	size_t	getMaxNumOscillators() const		{ return mFreqs.size(); }
+
+	//! Sets the WaveformType of the shared wavetable. This can be a heavy operation and requires thread synchronization, so be careful not to block the audio thread for too long.
+	void setWaveform( WaveformType waveformType );
+	//! Assigns \a waveTable as the internal wavetable. This allows one to share a WaveTable2d with GenOscNode's and other GenOscBankNode's.
+	void setWaveTable( const WaveTable2dRef &waveTable )	{ mWaveTable = waveTable; }
+	//! Returns a reference to the current wavetable.
+	const WaveTable2dRef getWaveTable() const				{ return mWaveTable; }
+	//! Returns the current WaveformType
+	WaveformType	getWaveForm() const						{ return mWaveformType; }
+
+  protected:
+	void initialize() override;
+	void process( Buffer *buffer ) override;
+
+  private:
+	void initImpl();
+	void updateOscillators();
+	void renderGroup( size_t firstOscillator, float *output, size_t numFrames );
+
+	float				mSamplePeriod;
+	WaveTable2dRef		mWaveTable;
+	const WaveTable2d*	mTablesSource;	// the WaveTable2d that mTables point into
+	WaveformType		mWaveformType;
+	std::atomic<bool>	mNeedsPhaseReset;
+
+	// values set from the user thread, read once per block
+	std::vector<std::atomic<float>>	mFreqs, mGains;
+
+	// oscillator state owned by the audio thread. Arrays are padded to a multiple of four, with the padded oscillators silent.
+	std::vector<float>			mPhases, mPhaseIncrs, mGainsApplied, mGainsTarget;
+	std::vector<const float*>	mTables;
+};
+
 } } // namespace cinder::audio
@@ -0,0 +1,164 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/audio/InputNode.h"
+#include "cinder/audio/Param.h"
+#include "cinder/audio/Source.h"
+#include "cinder/audio/dsp/Dsp.h"
+#include "cinder/Rand.h"
+
+#include <atomic>
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class GranularNode>		GranularNodeRef;
+
+//! \brief InputNode that plays many short, windowed grains from a shared Buffer.
+//!
+//! Grains are started at a rate given by the density Param, each reading from the position Param (plus a random jitter) at a
+//! playback rate given by the pitch Param (plus a random jitter), and fading in and out with the window chosen in Format::windowType().
+//! The Params are sampled at the frame each grain begins, so automating them has sample accurate results.
+//!
+//! Grains are drawn from a pool allocated when the GranularNode is constructed, so nothing is allocated while processing. When
+//! all grains are in use new ones are dropped, which can be monitored with getNumDroppedGrains().
+//! Like BufferPlayerNode, the channel count matches the Buffer and the Buffer can be shared with other players. Reading wraps
+//! around the ends of the Buffer.
+class GranularNode : public InputNode {
+  public:
+	struct Format : public Node::Format {
+		Format() : mMaxNumGrains( 512 ), mWindowType( dsp::WindowType::HANN )	{}
+
+		//! Sets the number of grains that can play at once. Default = 512.
+		Format&				maxNumGrains( size_t numGrains )			{ mMaxNumGrains = numGrains; return *this; }
+		//! Sets the window applied to each grain. Default = dsp::WindowType::HANN.
+		Format&				windowType( dsp::WindowType windowType )	{ mWindowType = windowType; return *this; }
+
+		size_t				getMaxNumGrains() const		{ return mMaxNumGrains; }
+		dsp::WindowType		getWindowType() const		{ return mWindowType; }
+
+		// reimpl Node::Format
+		Format&		channels( size_t ch )					{ Node::Format::channels( ch ); return *this; }
+		Format&		autoEnable( bool autoEnable = true )	{ Node::Format::autoEnable( autoEnable ); return *this; }
+
+	  protected:
+		size_t				mMaxNumGrains;
+		dsp::WindowType		mWindowType;
+	};
+
+	//! Constructs a GranularNode without a buffer, with the assumption one will be set later. \note Format::channels() can still be used to allocate the expected channel count ahead of time.
+	GranularNode( const Format &format = Format() );
+	//! Constructs a GranularNode that plays grains from \a buffer. The number of channels matches \a buffer, Format::channels() is ignored.
+	GranularNode( const BufferRef &buffer, const Format &format = Format() );
+
+	//! Sets the Buffer that grains are read from. Safe to do while enabled, grains that are playing continue from the new Buffer.
+	void setBuffer( const BufferRef &buffer );
+	//! Returns the Buffer that grains are read from.
+	const BufferRef& getBuffer() const	{ return mBuffer; }
+	//! Loads the entire contents of \a sourceFile through the SampleCache, resampled to the Context's samplerate if necessary. \see BufferPlayerNode::loadBuffer()
+	void loadBuffer( const SourceFileRef &sourceFile );
+	//! Loads \a dataSource through the SampleCache, resampled to the Context's samplerate if necessary. \see BufferPlayerNode::loadBuffer()
+	void loadBuffer( const DataSourceRef &dataSource );
+
+	//! Sets the number of grains started per second (default = 20).
+	void	setDensity( float grainsPerSecond )		{ mParamDensity.setValue( grainsPerSecond ); }
+	//! Returns the number of grains started per second.
+	float	getDensity() const						{ return mParamDensity.getValue(); }
+	//! Returns the Param that controls the number of grains started per second.
+	Param*	getParamDensity()						{ return &mParamDensity; }
+
+	//! Sets the length of each grain in seconds (default = 0.1).
+	void	setGrainDuration( float seconds )		{ mParamGrainDuration.setValue( seconds ); }
+	//! Returns the length of each grain in seconds.
+	float	getGrainDuration() const				{ return mParamGrainDuration.getValue(); }
+	//! Returns the Param that controls the length of each grain in seconds.
+	Param*	getParamGrainDuration()					{ return &mParamGrainDuration; }
+
+	//! Sets the position in seconds within the Buffer that new grains begin reading from (default = 0).
+	void	setPosition( float seconds )			{ mParamPosition.setValue( seconds ); }
+	//! Returns the position in seconds within the Buffer that new grains begin reading from.
+	float	getPosition() const						{ return mParamPosition.getValue(); }
+	//! Returns the Param that controls the position in seconds within the Buffer that new grains begin reading from.
+	Param*	getParamPosition()						{ return &mParamPosition; }
+
+	//! Sets the playback rate of new grains, where 1 is the original pitch and 2 is an octave higher (default = 1). Must be greater than zero.
+	void	setPitch( float rate )					{ mParamPitch.setValue( rate ); }
+	//! Returns the playback rate of new grains.
+	float	getPitch() const						{ return mParamPitch.getValue(); }
+	//! Returns the Param that controls the playback rate of new grains.
+	Param*	getParamPitch()							{ return &mParamPitch; }
+
+	//! Sets the maximum random offset in seconds added to the position of each grain (default = 0).
+	void	setPositionJitter( float seconds )		{ mPositionJitter = seconds; }
+	//! Returns the maximum random offset in seconds added to the position of each grain.
+	float	getPositionJitter() const				{ return mPositionJitter; }
+	//! Sets the maximum random offset in semitones applied to the pitch of each grain (default = 0).
+	void	setPitchJitter( float semitones )		{ mPitchJitter = semitones; }
+	//! Returns the maximum random offset in semitones applied to the pitch of each grain.
+	float	getPitchJitter() const					{ return mPitchJitter; }
+
+	//! Returns the maximum number of grains that can play at once.
+	size_t	getMaxNumGrains() const					{ return mGrains.size(); }
+	//! Returns the number of grains that were playing during the last processing block.
+	size_t	getNumActiveGrains() const				{ return mNumActiveGrains; }
+	//! Returns the number of grains that were not started because all grains were in use, since this GranularNode was created.
+	size_t	getNumDroppedGrains() const				{ return mNumDroppedGrains; }
+
+  protected:
+	void initialize()				override;
+	void process( Buffer *buffer )	override;
+
+  private:
+	struct Grain {
+		double	mReadPos;		// in frames of the Buffer
+		float	mRate;
+		float	mWindowPos, mWindowIncr;
+		size_t	mFramesLeft;
+		size_t	mStartFrame;	// offset into the current block, non-zero only for the block the grain begins in
+	};
+
+	void initImpl();
+	void startGrain( size_t startFrame, float durationSeconds, float positionSeconds, float pitch );
+	void renderGrain( Grain *grain, const Buffer *source, Buffer *dest, size_t frameOffset, size_t numFrames );
+
+	BufferRef			mBuffer;
+	Param				mParamDensity, mParamGrainDuration, mParamPosition, mParamPitch;
+	std::atomic<float>	mPositionJitter, mPitchJitter;
+
+	std::vector<Grain>	mGrains;
+	std::vector<size_t>	mActiveGrains, mFreeGrains;	// indices into mGrains, capacity is reserved up front
+	std::vector<float>	mWindow;					// one extra sample so interpolation never wraps
+	double				mFramesUntilNextGrain;
+	float				mSampleRate;
+	Rand				mRand;
+
+	// per frame of the current block, shared by all channels of a grain
+	std::vector<size_t>	mReadIndices;
+	std::vector<float>	mReadFractions, mGrainGains;
+
+	std::atomic<size_t>	mNumActiveGrains, mNumDroppedGrains;
+};
+
+} } // namespace cinder::audio
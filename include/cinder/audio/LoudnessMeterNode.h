@@ -0,0 +1,104 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/audio/Node.h"
+#include "cinder/audio/dsp/BiquadBank.h"
+
+#include <atomic>
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class LoudnessMeterNode>	LoudnessMeterNodeRef;
+
+//! \brief Node that measures loudness according to ITU-R BS.1770-4 and EBU R128, along with the true peak level.
+//!
+//! Each channel is K-weighted, squared and summed with its channel weight into 100 ms sub-blocks. Running sums over the last 4 and 30 sub-blocks
+//! give the momentary (400 ms) and short-term (3 s) loudness, updated every 100 ms. Integrated loudness is gated as specified by BS.1770: each 400 ms
+//! block above the absolute gate (-70 LUFS) is added to a histogram with 0.1 LU bins, from which the relative gate (-10 LU) is applied, so the
+//! cost of an update doesn't grow with the length of the program. The true peak is measured on the unweighted input oversampled by four.
+//!
+//! Everything is computed on the audio thread and published through atomics, so the getters are lock-free and can be called from any thread.
+//! Loudness is in LUFS and is negative infinity until there is something to measure. The input is passed through unmodified.
+class LoudnessMeterNode : public NodeAutoPullable {
+  public:
+	//! Constructs a LoudnessMeterNode with an optional \a format.
+	LoudnessMeterNode( const Format &format = Format() );
+	virtual ~LoudnessMeterNode();
+
+	//! Returns the momentary loudness in LUFS, measured over the last 400 ms.
+	float	getMomentaryLoudness() const		{ return mMomentaryLoudness; }
+	//! Returns the short-term loudness in LUFS, measured over the last 3 seconds.
+	float	getShortTermLoudness() const		{ return mShortTermLoudness; }
+	//! Returns the gated integrated loudness in LUFS, measured since the LoudnessMeterNode was initialized or reset().
+	float	getIntegratedLoudness() const		{ return mIntegratedLoudness; }
+	//! Returns the highest momentary loudness in LUFS since the LoudnessMeterNode was initialized or reset().
+	float	getMaxMomentaryLoudness() const		{ return mMaxMomentaryLoudness; }
+	//! Returns the highest true peak across all channels in dBTP since the LoudnessMeterNode was initialized or reset().
+	float	getTruePeak() const					{ return mTruePeak; }
+
+	//! Sets the weight applied to \a channel's mean square before it is summed. By default surround channels 4 and 5 of a 5.1 input are weighted 1.41, the LFE channel (3) is 0, and all other channels are 1.
+	void	setChannelWeight( size_t channel, float weight );
+	//! Returns the weight applied to \a channel's mean square before it is summed.
+	float	getChannelWeight( size_t channel ) const;
+
+	//! Clears all measurements at the beginning of the next processing block. Safe to call from any thread.
+	void	reset()		{ mResetRequested = true; }
+
+  protected:
+	void initialize()				override;
+	void process( Buffer *buffer )	override;
+
+  private:
+	void	resetMeasurements();
+	void	finishSubBlock();
+	void	updateIntegratedLoudness();
+	float	measureTruePeak( const float *channel, size_t numFrames, float *history );
+
+	dsp::BiquadBank				mKWeighting;
+	Buffer						mWeightedBuffer;
+	Buffer						mTruePeakHistory;	// last input frames of each channel, kept for the oversampling filter
+	std::vector<float>			mTruePeakScratch;
+	AlignedArrayPtr				mTruePeakCoeffs;	// [tap][phase]
+	std::vector<float>			mChannelWeights;
+	std::vector<bool>			mChannelWeightIsSet;	// whether the user has overridden the default weight
+
+	size_t						mSubBlockFrames, mSubBlockPos, mNumSubBlocks;
+	double						mSubBlockEnergy;
+	std::vector<double>			mSubBlockEnergies;	// circular record of the last 30 sub-blocks, already weighted
+	double						mMomentarySum, mShortTermSum;
+
+	// histogram of the mean square energies of the gating blocks that pass the absolute gate
+	std::vector<double>			mGatingBinEnergies;
+	std::vector<size_t>			mGatingBinCounts;
+	double						mGatedEnergy;
+	size_t						mNumGatedBlocks;
+
+	float						mTruePeakLinear;
+	std::atomic<float>			mMomentaryLoudness, mShortTermLoudness, mIntegratedLoudness, mMaxMomentaryLoudness, mTruePeak;
+	std::atomic<bool>			mResetRequested;
+};
+
+} } // namespace cinder::audio
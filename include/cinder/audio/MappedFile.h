@@ -0,0 +1,56 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/Filesystem.h"
+
+#include <cstddef>
+
+namespace cinder { namespace audio {
+
+//! \brief Maps an entire file into memory for reading.
+//!
+//! Pages are loaded by the operating system as they are first accessed, so reading from the mapping avoids copying the file through stream buffers.
+//! The mapping is copy-on-write: its memory may be modified, but changes stay private to the process and are never written back to the file.
+class MappedFile {
+  public:
+	//! Maps the file at \a path. \throws AudioFileExc if the file cannot be opened, is empty or cannot be mapped.
+	MappedFile( const fs::path &path );
+	~MappedFile();
+
+	//! Returns a pointer to the first byte of the file.
+	char*	getData() const	{ return mData; }
+	//! Returns the size of the file in bytes.
+	size_t	getSize() const	{ return mSize; }
+
+  private:
+	MappedFile( const MappedFile & );
+	MappedFile& operator=( const MappedFile & );
+
+	char*	mData;
+	size_t	mSize;
+	void*	mMapping; // file mapping handle, only used on Windows
+};
+
+} } // namespace cinder::audio
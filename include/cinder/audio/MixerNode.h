@@ -0,0 +1,128 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/audio/Node.h"
+
+#include <atomic>
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class MixerNode>	MixerNodeRef;
+
+//! \brief Node that sums any number of inputs, applying a gain and stereo pan to each one as it is summed.
+//!
+//! Each input occupies one 'voice' of a pool that is allocated when the MixerNode is constructed, so connecting an input
+//! doesn't require adding GainNode's or Pan2dNode's to the graph. When all voices are in use, connecting another input reuses
+//! a voice whose input is disabled and has no inputs of its own (ex. a finished one-shot SamplePlayerNode), as those are not
+//! pulled while processing. Otherwise it throws, unless voice stealing is enabled with Format::voiceStealing().
+//!
+//! Panning uses the same equal power law as Pan2dNode and is only applied when the MixerNode has two channels.
+//! Gain and pan changes are ramped over one processing block.
+class MixerNode : public Node {
+  public:
+	//! Specifies which voice is replaced when an input is connected and all voices are in use.
+	enum class VoiceStealing {
+		//! Only voices whose input has finished are reused, otherwise connecting throws an AudioExc.
+		NONE,
+		//! The voice whose input was connected first is stolen.
+		OLDEST,
+		//! The voice that produced the lowest peak level during the last processing block is stolen.
+		QUIETEST
+	};
+
+	struct Format : public Node::Format {
+		Format() : mMaxNumVoices( 64 ), mVoiceStealing( VoiceStealing::NONE )	{}
+
+		//! Sets the maximum number of inputs that can be connected at once. Default = 64.
+		Format&			maxNumVoices( size_t numVoices )			{ mMaxNumVoices = numVoices; return *this; }
+		//! Sets how a voice is chosen when an input is connected and all voices are in use. Default = VoiceStealing::NONE.
+		Format&			voiceStealing( VoiceStealing stealing )		{ mVoiceStealing = stealing; return *this; }
+
+		size_t			getMaxNumVoices() const		{ return mMaxNumVoices; }
+		VoiceStealing	getVoiceStealing() const	{ return mVoiceStealing; }
+
+		// reimpl Node::Format
+		Format&		channels( size_t ch )					{ Node::Format::channels( ch ); return *this; }
+		Format&		channelMode( ChannelMode mode )			{ Node::Format::channelMode( mode ); return *this; }
+		Format&		autoEnable( bool autoEnable = true )	{ Node::Format::autoEnable( autoEnable ); return *this; }
+
+	  protected:
+		size_t			mMaxNumVoices;
+		VoiceStealing	mVoiceStealing;
+	};
+
+	//! Constructs a MixerNode with optional \a format. If Format::channels() isn't specified, the MixerNode is stereo.
+	MixerNode( const Format &format = Format() );
+	virtual ~MixerNode();
+
+	//! Sets the gain applied to \a input, which must be connected to this MixerNode.
+	void	setVoiceGain( const NodeRef &input, float gain );
+	//! Returns the gain applied to \a input, or 0 if it isn't connected to this MixerNode.
+	float	getVoiceGain( const NodeRef &input ) const;
+	//! Sets the panning position of \a input in range of [0:1]: 0 = left, 1 = right, and 0.5 = center (default).
+	void	setVoicePan( const NodeRef &input, float pos );
+	//! Returns the panning position of \a input, or 0.5 if it isn't connected to this MixerNode.
+	float	getVoicePan( const NodeRef &input ) const;
+
+	//! Returns the maximum number of inputs that can be connected at once.
+	size_t			getMaxNumVoices() const		{ return mVoices.size(); }
+	//! Returns how a voice is chosen when an input is connected and all voices are in use.
+	VoiceStealing	getVoiceStealing() const	{ return mVoiceStealing; }
+	//! Returns the number of voices that have been stolen since this MixerNode was created.
+	size_t			getNumStolenVoices() const	{ return mNumStolenVoices; }
+
+	void disconnectAllInputs() override;
+
+  protected:
+	void connectInput( const NodeRef &input )		override;
+	void disconnectInput( const NodeRef &input )	override;
+	void sumInputs()								override;
+	bool supportsProcessInPlace() const				override	{ return false; }
+
+  private:
+	struct VoiceSlot {
+		VoiceSlot() : mInput( nullptr ), mGain( 1 ), mPan( 0.5f ), mPeak( 0 ), mConnectedOrder( 0 ), mNeedsGainReset( true )	{}
+
+		Node*				mInput;
+		std::atomic<float>	mGain, mPan;
+		std::atomic<float>	mPeak;
+		uint64_t			mConnectedOrder;
+		float				mAppliedGains[2];	// last gains applied per output channel, used to ramp to new values
+		bool				mNeedsGainReset;
+	};
+
+	VoiceSlot*			findVoice( const Node *input );
+	const VoiceSlot*	findVoice( const Node *input ) const;
+	size_t				findVoiceToSteal() const;
+	void				mixVoice( VoiceSlot *voice, const Buffer *sourceBuffer, Buffer *destBuffer );
+
+	std::vector<VoiceSlot>	mVoices;
+	VoiceStealing			mVoiceStealing;
+	uint64_t				mNumConnections;
+	std::atomic<size_t>		mNumStolenVoices;
+};
+
+} } // namespace cinder::audio
@@ -0,0 +1,159 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/audio/MonitorNode.h"
+
+#include <atomic>
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class MonitorFeatureNode>	MonitorFeatureNodeRef;
+
+//! \brief A MonitorSpectralNode that extracts onsets, tempo, beats, pitch and spectral centroid from its input.
+//!
+//! All features are computed once per hop on the analysis thread shared by all MonitorSpectralNodes, from the same FFT that
+//! getMagSpectrum() returns, and are published through atomics. The getters are therefore lock-free and cost nothing, so any
+//! number of consumers on any thread can poll them as often as they like. Multi-channel input is averaged to mono.
+//!
+//! - Onsets are peaks in the spectral flux (the summed increase of log-compressed magnitudes) that rise above a running mean.
+//! - Tempo is the strongest period in the autocorrelation of the last few seconds of spectral flux, weighted towards 120 BPM to avoid octave errors.
+//! - Beats are predicted from the tempo and pulled into phase with the detected onsets.
+//! - Pitch is estimated from the unwindowed samples with the YIN algorithm (de Cheveigné and Kawahara, 2002).
+//!
+//! Times are in seconds measured against Context::getNumProcessedSeconds(), and refer to when the event happened in the input.
+//! Results lag the input by about one window, and windows may be skipped if the analysis thread falls behind.
+class MonitorFeatureNode : public MonitorSpectralNode {
+  public:
+	struct Format : public MonitorSpectralNode::Format {
+		Format() : MonitorSpectralNode::Format(), mMinPitch( 50 ), mMaxPitch( 2000 ), mMinTempo( 60 ), mMaxTempo( 200 )
+		{
+			mWindowSize = 2048;
+			mHopSize = 512;
+		}
+
+		//! Sets the lowest (default = 50) and highest (default = 2000) pitch in hertz that will be detected. The lowest pitch is limited to two periods per window.
+		Format&		pitchRange( float minPitch, float maxPitch )	{ mMinPitch = minPitch; mMaxPitch = maxPitch; return *this; }
+		//! Sets the lowest (default = 60) and highest (default = 200) tempo in beats per minute that will be detected.
+		Format&		tempoRange( float minTempo, float maxTempo )	{ mMinTempo = minTempo; mMaxTempo = maxTempo; return *this; }
+
+		float		getMinPitch() const		{ return mMinPitch; }
+		float		getMaxPitch() const		{ return mMaxPitch; }
+		float		getMinTempo() const		{ return mMinTempo; }
+		float		getMaxTempo() const		{ return mMaxTempo; }
+
+		// reimpl MonitorSpectralNode::Format
+		//! \see MonitorNode::Format::windowSize(). Default is 2048.
+		Format&		windowSize( size_t size )				{ MonitorSpectralNode::Format::windowSize( size ); return *this; }
+		//! \see MonitorNode::Format::hopSize(). Default is 512, which is also the resolution of onset and beat times.
+		Format&		hopSize( size_t size )					{ MonitorSpectralNode::Format::hopSize( size ); return *this; }
+		Format&		fftSize( size_t size )					{ MonitorSpectralNode::Format::fftSize( size ); return *this; }
+		Format&		windowType( dsp::WindowType type )		{ MonitorSpectralNode::Format::windowType( type ); return *this; }
+		Format&		channels( size_t ch )					{ Node::Format::channels( ch ); return *this; }
+		Format&		channelMode( ChannelMode mode )			{ Node::Format::channelMode( mode ); return *this; }
+		Format&		autoEnable( bool autoEnable = true )	{ Node::Format::autoEnable( autoEnable ); return *this; }
+
+	  protected:
+		float	mMinPitch, mMaxPitch, mMinTempo, mMaxTempo;
+	};
+
+	MonitorFeatureNode( const Format &format = Format() );
+	virtual ~MonitorFeatureNode();
+
+	//! Returns the spectral centroid in hertz, the magnitude weighted mean frequency of the last window. 0 when the input is silent.
+	float		getSpectralCentroid() const		{ return mSpectralCentroid; }
+	//! Returns the spectral flux of the last window, the onset detection function. Its scale depends on the input level, with 0 meaning nothing got louder.
+	float		getSpectralFlux() const			{ return mSpectralFlux; }
+
+	//! Returns the number of onsets detected since the MonitorFeatureNode was initialized or reset(). Consumers can detect new onsets by comparing this with the last value they read.
+	uint64_t	getNumOnsets() const			{ return mNumOnsets; }
+	//! Returns the time in seconds of the last detected onset, or a negative value if there hasn't been one.
+	double		getLastOnsetTime() const		{ return mLastOnsetTime; }
+	//! Sets how far (default = 0.5) the spectral flux must rise above its running mean, relative to the mean, for a peak to count as an onset. Lower values detect more onsets.
+	void		setOnsetThreshold( float threshold )	{ mOnsetThreshold = threshold; }
+	//! Returns the onset threshold. \see setOnsetThreshold()
+	float		getOnsetThreshold() const		{ return mOnsetThreshold; }
+
+	//! Returns the estimated tempo in beats per minute, or 0 until there has been enough input to estimate it.
+	float		getTempo() const				{ return mTempo; }
+	//! Returns how periodic (0 - 1) the spectral flux is at the estimated tempo. Beats are only tracked while this is above a small threshold.
+	float		getTempoConfidence() const		{ return mTempoConfidence; }
+	//! Returns the number of beats since the MonitorFeatureNode was initialized or reset(). \see getNumOnsets()
+	uint64_t	getNumBeats() const				{ return mNumBeats; }
+	//! Returns the time in seconds of the last beat, or a negative value if there hasn't been one.
+	double		getLastBeatTime() const			{ return mLastBeatTime; }
+
+	//! Returns the fundamental frequency of the last window in hertz, or 0 if it is unpitched.
+	float		getPitch() const				{ return mPitch; }
+	//! Returns how periodic (0 - 1) the last window is at getPitch(), which is 1 - the YIN aperiodicity.
+	float		getPitchConfidence() const		{ return mPitchConfidence; }
+	//! Sets the YIN threshold (default = 0.15), the highest aperiodicity that still counts as pitched. Higher values detect pitch in noisier input.
+	void		setPitchThreshold( float threshold )	{ mPitchThreshold = threshold; }
+	//! Returns the YIN threshold. \see setPitchThreshold()
+	float		getPitchThreshold() const		{ return mPitchThreshold; }
+
+	//! Clears all features and history before the next window is analyzed. Safe to call from any thread.
+	void		reset()		{ mResetRequested = true; }
+
+  protected:
+	void initialize()	override;
+	void analyzeSpectrum( const Buffer &samples, const BufferSpectral &spectrum, uint64_t frame )	override;
+
+  private:
+	void	resetAnalysis( size_t numBins );
+	//! Returns the spectral flux of \a spectrum against the previous window, filling \a centroid with the spectral centroid in hertz.
+	float	computeSpectralFlux( const BufferSpectral &spectrum, float *centroid );
+	//! Returns the spectral flux from \a hopsAgo hops before the last one pushed.
+	float	getFlux( size_t hopsAgo ) const		{ return mFluxHistory[( mFluxHistoryPos + mFluxHistory.size() - 1 - hopsAgo ) % mFluxHistory.size()]; }
+	//! Peak picks the spectral flux of the previous hop. \return `true` and fills \a onsetFrame if it is an onset.
+	bool	detectOnset( uint64_t frame, uint64_t *onsetFrame );
+	void	updateTempo();
+	void	updateBeats( double time, bool onset, double onsetTime );
+	void	updatePitch();
+
+	double	getTimeForFrame( uint64_t frame ) const;
+
+	float	mMinPitchFormat, mMaxPitchFormat, mMinTempoFormat, mMaxTempoFormat;
+	size_t	mSampleRate;
+
+	// analysis thread state
+	std::vector<float>	mMono;					// samples averaged to mono
+	std::vector<float>	mLogMagnitudes;			// log compressed magnitudes of the previous window
+	std::vector<float>	mFluxHistory;			// circular record of the spectral flux, one value per hop
+	size_t				mFluxHistoryPos, mNumFluxValues, mOnsetMeanHops;
+	std::vector<float>	mOnsetEnvelope;			// mean removed spectral flux, oldest first, used for the tempo autocorrelation
+	std::vector<float>	mAutocorrelation;		// indexed by lag in hops
+	std::vector<float>	mYinDifference;			// cumulative mean normalized difference, indexed by lag in samples
+	size_t				mMinPitchLag, mMaxPitchLag, mMinTempoLag, mMaxTempoLag;
+	uint64_t			mLastFrame, mLastOnsetFrame;
+	double				mNextBeatTime, mPrevBeatTime;
+
+	std::atomic<float>		mSpectralCentroid, mSpectralFlux, mOnsetThreshold, mTempo, mTempoConfidence, mPitch, mPitchConfidence, mPitchThreshold;
+	std::atomic<uint64_t>	mNumOnsets, mNumBeats;
+	std::atomic<double>		mLastOnsetTime, mLastBeatTime;
+	std::atomic<bool>		mResetRequested;
+};
+
+} } // namespace cinder::audio
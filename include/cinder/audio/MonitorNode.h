@@ -26,6 +26,7 @@
 #include "cinder/audio/Context.h"
 #include "cinder/audio/dsp/Dsp.h"
 #include "cinder/audio/dsp/RingBuffer.h"
+#include "cinder/audio/dsp/TripleBuffer.h"
 
 #include "cinder/Thread.h"
 
@@ -45,18 +46,28 @@ typedef std::shared_ptr<class MonitorSpectralNode>	MonitorSpectralNodeRef;
 //!
 //! This Node does not modify the incoming Buffer in its process() function and does not need to be connected to a OutputNode.
 //!
-//! \note Internally, a dsp::RingBuffer is used, which has a limited size. Once it fills up, more samples will not be written
+//! \note By default a dsp::RingBuffer is used, which has a limited size. Once it fills up, more samples will not be written
 //! until space is made by calling getBuffer(). In practice, this isn't a problem since this method is normally called from within the update() or draw() loop.
+//! With Format::snapshot() enabled, the audio thread instead publishes the most recent window every hop through a dsp::TripleBuffer,
+//! so getBuffer() never copies or misses samples and any number of readers can poll at their own rate.
 class MonitorNode : public NodeAutoPullable {
   public:
 	struct Format : public Node::Format {
-		Format() : mWindowSize( 0 ) {}
+		Format() : mWindowSize( 0 ), mHopSize( 0 ), mSnapshot( false ) {}
 
 		//! Sets the window size, the number of samples that are recorded for one 'window' into the audio signal. Default is the Context's frames-per-block.
 		//! \note will be rounded up to the nearest power of two.
 		Format&		windowSize( size_t size )		{ mWindowSize = size; return *this; }
 		//! Returns the window size.
 		size_t		getWindowSize() const			{ return mWindowSize; }
+		//! Enables snapshot mode, where the latest window is published every hop instead of streamed through a RingBuffer. Default is false.
+		Format&		snapshot( bool enable = true )	{ mSnapshot = enable; return *this; }
+		//! Returns whether snapshot mode is enabled.
+		bool		isSnapshot() const				{ return mSnapshot; }
+		//! Sets the number of frames between published windows in snapshot mode. Default (0) is the window size, so windows don't overlap.
+		Format&		hopSize( size_t size )			{ mHopSize = size; return *this; }
+		//! Returns the hop size.
+		size_t		getHopSize() const				{ return mHopSize; }
 
 		// reimpl Node::Format
 		Format&		channels( size_t ch )					{ Node::Format::channels( ch ); return *this; }
@@ -64,17 +75,22 @@ class MonitorNode : public NodeAutoPullable {
 		Format&		autoEnable( bool autoEnable = true )	{ Node::Format::autoEnable( autoEnable ); return *this; }
 
 	  protected:
-		size_t mWindowSize;
+		size_t	mWindowSize, mHopSize;
+		bool	mSnapshot;
 	};
 
 	MonitorNode( const Format &format = Format() );
 	virtual ~MonitorNode();
 
 	//! Returns a filled Buffer of the sampled audio stream, suitable for consuming on the main UI thread.
-	//! \note samples will only be copied if there is enough available in the internal dsp::RingBuffer.
+	//! \note samples will only be copied if there is enough available in the internal dsp::RingBuffer. In snapshot mode, nothing is copied and the Buffer is the most recently published window.
 	const Buffer& getBuffer();
 	//! Returns the window size, which is the number of samples that are copied from the audio stream. Equivalent to: \code getBuffer().size() \endcode.
 	size_t getWindowSize() const	{ return mWindowSize; }
+	//! Returns the number of frames between published windows in snapshot mode.
+	size_t getHopSize() const		{ return mHopSize; }
+	//! Returns whether snapshot mode is enabled. \see Format::snapshot()
+	bool isSnapshot() const			{ return mSnapshot; }
 	//! Compute the average (RMS) volume across all channels
 	float getVolume();
 	//! Compute the average (RMS) volume across \a channel
@@ -84,31 +100,54 @@ class MonitorNode : public NodeAutoPullable {
 	void initialize()				override;
 	void process( Buffer *buffer )	override;
 
-	//! Copies audio frames from the RingBuffer into mCopiedBuffer, which is suitable for operation on the main thread.
-	void fillCopiedBuffer();
-	
+	//! Copies audio frames from the RingBuffer into mCopiedBuffer, or in snapshot mode acquires the latest published window, either of which is then returned by getCopiedBuffer(). \return `true` if the samples have changed.
+	bool fillCopiedBuffer();
+	//! Returns the samples acquired by the last fillCopiedBuffer(), which are safe to use on the main thread.
+	const Buffer& getCopiedBuffer() const	{ return mSnapshot ? mSnapshots.getReadBuffer() : mCopiedBuffer; }
+	//! Called on the audio thread in snapshot mode each time \a hopSize frames have been recorded. Publishes the current window, which subclasses can also copy with copyWindow().
+	virtual void publishSnapshot();
+	//! Copies the most recent window of samples, oldest first, into \a dest (which must have getWindowSize() frames). \note only safe to call from the audio thread, normally within publishSnapshot().
+	void copyWindow( Buffer *dest ) const;
+
 	std::vector<dsp::RingBuffer>	mRingBuffers;	// one per channel
 	Buffer							mCopiedBuffer;	// used to safely read audio frames on a non-audio thread
-	size_t							mWindowSize;
+	size_t							mWindowSize, mHopSize;
 	size_t							mRingBufferPaddingFactor;
+	bool							mSnapshot;
+
+	dsp::TripleBuffer<Buffer>		mSnapshots;			// windows published by the audio thread in snapshot mode
+	bool							mHasNewSnapshot;	// set when fillCopiedBuffer() acquires a new window, subclasses clear it once they have consumed the window
+	Buffer							mHistory;			// circular record of the last mWindowSize frames, audio thread only
+	size_t							mHistoryPos, mFramesSinceSnapshot;
+	uint64_t						mSnapshotFrame;		// Context frame just past the end of the window being published, audio thread only
 };
 
-//! A Scope that performs spectral (Fourier) analysis.
+//! \brief A Scope that performs spectral (Fourier) analysis.
+//!
+//! By default the FFT is computed on the thread calling getMagSpectrum(). With Format::analysisThread() enabled, it is instead computed
+//! once per hop on a worker thread shared by all MonitorSpectralNodes, and getMagSpectrum() only acquires the latest result.
 class MonitorSpectralNode : public MonitorNode {
   public:
 	struct Format : public MonitorNode::Format {
-		Format() : MonitorNode::Format(), mFftSize( 0 ), mWindowType( dsp::WindowType::BLACKMAN ) {}
+		Format() : MonitorNode::Format(), mFftSize( 0 ), mWindowType( dsp::WindowType::BLACKMAN ), mAnalysisThread( false ) {}
 
-		//! Sets the FFT size, rounded up to the nearest power of 2 greater or equal to \a windowSize. Setting this larger than \a windowSize causes the FFT transform to be 'zero-padded'. Default is the same as windowSize.
+		//! Sets the FFT size, rounded up to an even number greater or equal to \a windowSize. Sizes that are not a power of two are transformed with dsp::FftMixedRadix. Setting this larger than \a windowSize causes the FFT transform to be 'zero-padded'. Default is the same as windowSize.
 		//! \note resulting number of output spectral bins is equal to (\a size / 2)
 		Format&     fftSize( size_t size )              { mFftSize = size; return *this; }
 		//! defaults to WindowType::BLACKMAN
 		Format&		windowType( dsp::WindowType type )	{ mWindowType = type; return *this; }
 		//! \see Scope::windowSize()
 		Format&		windowSize( size_t size )			{ MonitorNode::Format::windowSize( size ); return *this; }
+		//! \see MonitorNode::Format::snapshot()
+		Format&		snapshot( bool enable = true )		{ MonitorNode::Format::snapshot( enable ); return *this; }
+		//! \see MonitorNode::Format::hopSize()
+		Format&		hopSize( size_t size )				{ MonitorNode::Format::hopSize( size ); return *this; }
+		//! Computes the magnitude spectrum once per hop on a shared worker thread rather than in getMagSpectrum(). Implies snapshot(). Default is false.
+		Format&		analysisThread( bool enable = true )	{ mAnalysisThread = enable; return *this; }
 
 		size_t			getFftSize() const				{ return mFftSize; }
 		dsp::WindowType	getWindowType() const			{ return mWindowType; }
+		bool			isAnalysisThread() const		{ return mAnalysisThread; }
 
 		// reimpl Node::Format
 		Format&		channels( size_t ch )					{ Node::Format::channels( ch ); return *this; }
@@ -118,12 +157,13 @@ class MonitorSpectralNode : public MonitorNode {
       protected:
 		size_t			mFftSize;
 		dsp::WindowType	mWindowType;
+		bool			mAnalysisThread;
 	};
 
 	MonitorSpectralNode( const Format &format = Format() );
 	virtual ~MonitorSpectralNode();
 
-	//! Returns the magnitude spectrum of the currently sampled audio stream, suitable for consuming on the main UI thread.
+	//! Returns the magnitude spectrum of the currently sampled audio stream, suitable for consuming on the main UI thread. In snapshot mode, the spectrum is only recomputed when a new window has been published.
 	const	std::vector<float>& getMagSpectrum();
 	//! Returns the number of frequency bins in the analyzed magnitude spectrum. Equivilant to fftSize / 2.
 	size_t	getNumBins() const				{ return mFftSize / 2; }
@@ -135,11 +175,30 @@ class MonitorSpectralNode : public MonitorNode {
 	float	getSmoothingFactor() const		{ return mSmoothingFactor; }
 	//! Sets the factor (0 - 1, default = 0.5) used when smoothing the magnitude spectrum between sequential calls to getMagSpectrum()
 	void	setSmoothingFactor( float factor );
+	//! Returns whether the magnitude spectrum is computed on the shared worker thread. \see Format::analysisThread()
+	bool	isAnalysisThread() const		{ return mAnalysisThread; }
 
   protected:
-	void initialize() override;
+	void initialize()		override;
+	void uninitialize()		override;
+	void publishSnapshot()	override;
+
+	//! Called on the analysis thread each time a window has been transformed, with the unwindowed \a samples, their unsmoothed
+	//! \a spectrum, and the Context frame just past the end of the window (as in Context::getNumProcessedFrames()). Subclasses
+	//! can override this to derive further analysis from the same FFT. \note only called when Format::analysisThread() is enabled.
+	virtual void analyzeSpectrum( const Buffer &samples, const BufferSpectral &spectrum, uint64_t frame )	{}
 
   private:
+	struct AnalysisWindow {
+		Buffer		mSamples;
+		uint64_t	mFrame;
+	};
+
+	//! Windows and transforms \a samples, smoothing the result into \a magSpectrum.
+	void computeMagSpectrum( const Buffer &samples, std::vector<float> *magSpectrum );
+	//! Called on the analysis thread.
+	void analyze();
+
 	std::unique_ptr<dsp::Fft>	mFft;
 	Buffer						mFftBuffer;			// windowed samples before transform
 	BufferSpectral				mBufferSpectral;	// transformed samples
@@ -147,7 +206,13 @@ class MonitorSpectralNode : public MonitorNode {
 	AlignedArrayPtr				mWindowingTable;
 	size_t						mFftSize;
 	dsp::WindowType				mWindowType;
-	float						mSmoothingFactor;
+	std::atomic<float>			mSmoothingFactor;
+	bool						mAnalysisThread;
+
+	dsp::TripleBuffer<AnalysisWindow>		mAnalysisSnapshots;		// windows handed from the audio thread to the analysis thread
+	dsp::TripleBuffer<std::vector<float> >	mMagSpectrumSnapshots;	// spectra handed from the analysis thread to getMagSpectrum()
+
+	friend class SpectralAnalysisThread;
 };
 
 } } // namespace cinder::audio
@@ -184,6 +184,8 @@ class Node : public std::enable_shared_from_this<Node>, public boost::noncopyabl
 	virtual void disableProcessing()		{}
 	//! Override to perform audio processing on \t buffer.
 	virtual void process( Buffer *buffer )	{}
+	//! Calls process(), timing it if the Context's Profiler is enabled. Subclasses that override sumInputs() should call this rather than process().
+	void processInstrumented( Buffer *buffer );
 
 	virtual void sumInputs();
 
@@ -218,6 +220,7 @@ class Node : public std::enable_shared_from_this<Node>, public boost::noncopyabl
 	void initializeImpl();
 	void uninitializeImpl();
 
+	//! Returns the buffer that inputs are summed into. Its storage may be shared with other Node's by way of the Context's summing arena, so its contents are only valid while this Node is being pulled.
 	BufferDynamic*			getSummingBuffer()			{ return &mSummingBuffer; }
 	const BufferDynamic*	getSummingBuffer() const	{ return &mSummingBuffer; }
 
@@ -30,3 +30,5 @@
 #include "cinder/audio/DelayNode.h"
 #include "cinder/audio/PanNode.h"
 #include "cinder/audio/FilterNode.h"
+#include "cinder/audio/ConvolverNode.h"
+#include "cinder/audio/SpectralProcessNode.h"
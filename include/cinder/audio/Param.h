@@ -45,6 +45,8 @@ void rampLinear( float *array, size_t count, float t, float tIncr, const std::pa
 void rampInQuad( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange );
 //! Array-based quadradic (t^2) ease-out ramping function.
 void rampOutQuad( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange );
+//! Array-based exponential ramping function, suitable for frequencies and gains. Falls back to rampLinear() if the values are zero or differ in sign.
+void rampExponential( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange );
 
 //! Class representing a sample-accurate parameter control instruction. \see Param::applyRamp(), Param::appendRamp()
 class Event {
@@ -122,6 +124,8 @@ class Param {
 	void	setValue( float value );
 	//! Returns the current value of the Param.
 	float	getValue() const	{ return mValue; }
+	//! Returns whether the Param is varying over the current processing block, as determined by the last call to eval(). If false, getValue() can be used for the entire block.
+	bool	isVaryingThisBlock() const	{ return mIsVaryingThisBlock; }
 	//! Returns a pointer to the buffer used when evaluating a Param that is varying over the current processing block, of equal size to the owning Context's frames per block.
 	//! \note If not varying (eval() returns false), the returned pointer will be invalid.
 
@@ -149,6 +153,7 @@ class Param {
 
 	//! Evaluates the Param for the current processing block, with current time determined from the parent Node's Context.
 	//! \return true if the Param is varying this block (there are Event's or a processing Node) and getValueArray() should be used, or false if the Param's value is constant for this block (use getValue()).
+	//! No values are rendered when there are no Event's, and Event's that hold a constant value that the Param already has are not considered varying.
 	//! \note Safe to call on the audio thread.
 	bool	eval();
 	//! Evaluates the Param from \a timeBegin for \a arrayLength samples at \a sampleRate.
@@ -171,7 +176,7 @@ class Param {
 
 	std::list<EventRef>	mEvents;
 	std::atomic<float>	mValue;
-	bool				mIsVaryingThisBlock;
+	bool				mIsVaryingThisBlock, mIsInternalBufferConstant;
 	Node*				mParentNode;
 	NodeRef				mProcessor;
 	BufferDynamic		mInternalBuffer;
@@ -0,0 +1,127 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/audio/dsp/RingBuffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cinder { namespace audio {
+
+class Context;
+class Node;
+
+//! \brief Measures how much of the audio callback's time budget is spent per Node, along with the total load of each processing block and dropouts.
+//!
+//! A Profiler belongs to a Context and is enabled with Context::setProfilingEnabled(). While enabled, every Node's process() is timed
+//! on the audio thread and accumulated into a fixed size table, and the load of each processing block is pushed into a lock-free
+//! ring buffer, so nothing is allocated or locked on the audio thread. The results can be read at any time from another thread.
+//! When no Profiler is enabled, the only cost is one atomic load per Node per processing block.
+class Profiler {
+  public:
+	//! Timing statistics for one Node, accumulated since the last reset().
+	struct NodeStats {
+		//! The profiled Node, which should only be dereferenced if it is still known to be alive.
+		const Node*	mNode;
+		//! The Node's name, or an empty string if it is no longer connected to the Context.
+		std::string	mName;
+		//! The number of times the Node's process() was called.
+		uint64_t	mNumCalls;
+		//! The average and longest duration of a call to process(), in microseconds.
+		double		mAverageMicroseconds, mMaxMicroseconds;
+		//! The average fraction of the processing block's time budget spent in process() (1 = the entire budget).
+		double		mAverageLoad;
+	};
+
+	//! Constructs a Profiler that can track up to \a maxNumNodes Node's and keeps the load of the last \a historyLength processing blocks.
+	Profiler( Context *context, size_t maxNumNodes = 1024, size_t historyLength = 1024 );
+
+	//! Clears all statistics. The statistics are cleared on the audio thread at the beginning of the next processing block.
+	void	reset()		{ mResetRequested = true; }
+
+	//! Returns the statistics of every profiled Node, sorted by total time spent in process(), highest first. At most \a maxCount are returned (0 = all).
+	std::vector<NodeStats>	getNodeStats( size_t maxCount = 0 ) const;
+	//! Returns a readable table of the \a maxCount Node's that spent the most time in process(), along with the block load and number of dropouts.
+	std::string				dumpHottestNodes( size_t maxCount = 10 ) const;
+
+	//! Returns the load of the last processing block, as a fraction of the block's duration (1 = the entire budget was used).
+	float		getLastLoad() const			{ return mLastLoad; }
+	//! Returns the highest load of any processing block since the last reset().
+	float		getPeakLoad() const			{ return mPeakLoad; }
+	//! Moves the loads of the processing blocks since this method was last called into \a loads, oldest first. Only one thread may read the history.
+	void		readLoadHistory( std::vector<float> *loads );
+
+	//! Returns the number of dropouts detected since the last reset(). A dropout is a processing block that took longer than its duration,
+	//! or that began more than one and a half block durations after the previous one.
+	uint64_t	getNumDropouts() const		{ return mNumDropouts; }
+	//! Moves the frame numbers (as in Context::getNumProcessedFrames()) of the dropouts since this method was last called into \a frames.
+	void		readDropouts( std::vector<uint64_t> *frames );
+	//! Returns the number of Node's that could not be profiled because the table was full.
+	size_t		getNumUntrackedNodes() const	{ return mNumUntrackedNodes; }
+
+	// Audio thread interface, called by Context and Node.
+
+	//! Called at the beginning of each processing block, which lasts \a blockNanoseconds at the current samplerate.
+	void beginBlock( uint64_t blockNanoseconds );
+	//! Called at the end of each processing block, \a processedFrames is the frame number the block began at.
+	void endBlock( uint64_t processedFrames );
+	//! Records that \a node spent \a nanoseconds in process().
+	void recordNode( const Node *node, uint64_t nanoseconds );
+
+	//! Returns the current time in nanoseconds from a monotonic clock.
+	static uint64_t	now()	{ return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count(); }
+	//! Returns whether any Profiler is enabled, used to skip all profiling work with a single atomic load.
+	static bool		isAnyEnabled()	{ return sNumEnabled.load( std::memory_order_relaxed ) != 0; }
+
+  private:
+	// written only by the audio thread, read by any thread
+	struct Entry {
+		std::atomic<const Node*>	mNode;
+		std::atomic<uint64_t>		mNumCalls, mTotalNanoseconds, mMaxNanoseconds, mTotalBudgetNanoseconds;
+	};
+
+	void	clearEntries();
+
+	Context*					mContext;
+	std::unique_ptr<Entry[]>	mEntries;
+	size_t						mNumEntries;
+	std::atomic<bool>			mResetRequested;
+	std::atomic<size_t>			mNumUntrackedNodes;
+
+	uint64_t					mBlockBeginTime, mLastBlockBeginTime, mBlockNanoseconds;
+	std::atomic<float>			mLastLoad, mPeakLoad;
+	std::atomic<uint64_t>		mNumDropouts;
+	dsp::RingBufferT<float>		mLoadHistory;
+	dsp::RingBufferT<uint64_t>	mDropoutFrames;
+
+	static std::atomic<size_t>	sNumEnabled;
+
+	friend class Context;
+};
+
+} } // namespace cinder::audio
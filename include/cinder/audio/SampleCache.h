@@ -0,0 +1,99 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/audio/Source.h"
+#include "cinder/Filesystem.h"
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace cinder { namespace audio {
+
+//! \brief Process-wide cache of decoded samples, shared by every BufferPlayerNode and Voice that loads the same file.
+//!
+//! Entries are evicted in least-recently-used order once the decoded samples held by the cache exceed the memory budget.
+//! Buffers returned from the cache stay valid after eviction for as long as they are referenced, but they should be
+//! treated as read-only since other players may be sharing them.
+//!
+//! When a pre-decoded directory is set, files loaded by path are also written there as raw float samples
+//! (see writePreDecoded()), so that subsequent runs memory-map them with loadPreDecoded() instead of decoding again.
+class SampleCache {
+  public:
+	//! Returns the process-wide SampleCache, creating it if necessary.
+	static SampleCache* get();
+
+	//! Returns the samples of \a dataSource at \a sampleRate (0 = the file's native samplerate), decoding them if they aren't already cached.
+	BufferRef loadBuffer( const DataSourceRef &dataSource, size_t sampleRate = 0 );
+	//! Returns the samples of \a sourceFile at \a sampleRate (0 = \a sourceFile's samplerate), decoding them if they aren't already cached. Entries are keyed by the \a sourceFile instance.
+	BufferRef loadBuffer( const SourceFileRef &sourceFile, size_t sampleRate = 0 );
+
+	//! Sets the maximum number of bytes of samples held by the cache (default = 256 MB). Least recently used entries are evicted as needed.
+	void	setMemoryBudget( size_t bytes );
+	//! Returns the maximum number of bytes of samples held by the cache.
+	size_t	getMemoryBudget() const;
+	//! Returns the number of bytes of samples currently held by the cache.
+	size_t	getMemoryUsage() const;
+	//! Returns the number of entries currently held by the cache.
+	size_t	getNumEntries() const;
+	//! Removes all entries. Buffers already handed out remain valid.
+	void	clear();
+
+	//! Sets the directory where pre-decoded copies of files loaded by path are stored and looked up. An empty path (the default) disables it.
+	void		setPreDecodedDirectory( const fs::path &directory );
+	//! Returns the directory where pre-decoded files are stored, or an empty path if disabled.
+	fs::path	getPreDecodedDirectory() const;
+
+	//! Writes \a buffer, sampled at \a sampleRate, to \a path in the pre-decoded format: a small header followed by each channel as native-endian 32-bit floats. \throws AudioFileExc on failure.
+	static void			writePreDecoded( const Buffer &buffer, size_t sampleRate, const fs::path &path );
+	//! Memory-maps the pre-decoded file at \a path and returns a Buffer referencing its samples without copying them. The mapping is released when the last reference to the Buffer goes away. If \a sampleRate is non-null it is set to the file's samplerate. \throws AudioFileExc if the file can't be mapped or isn't in the pre-decoded format.
+	static BufferRef	loadPreDecoded( const fs::path &path, size_t *sampleRate = nullptr );
+
+  private:
+	SampleCache();
+
+	struct Entry {
+		BufferRef					mBuffer;
+		std::weak_ptr<void>			mInstance;		// the SourceFile or DataSource for entries keyed by object identity, which are stale once it expires.
+		bool						mIsKeyedByInstance;
+		std::list<std::string>::iterator	mLruPos;
+	};
+
+	BufferRef	findLocked( const std::string &key );
+	BufferRef	insert( const std::string &key, const BufferRef &buffer, const std::shared_ptr<void> &instance );
+	void		eraseLocked( std::map<std::string, Entry>::iterator it );
+	void		evictLocked();
+	fs::path	getPreDecodedPath( const fs::path &sourcePath, size_t sampleRate ) const;
+
+	std::map<std::string, Entry>	mEntries;
+	std::list<std::string>			mLruKeys;		// front is the most recently used
+	size_t							mMemoryBudget, mMemoryUsage;
+	fs::path						mPreDecodedDirectory;
+	mutable std::mutex				mMutex;
+};
+
+} } // namespace cinder::audio
@@ -25,11 +25,9 @@
 
 #include "cinder/audio/InputNode.h"
 #include "cinder/audio/Source.h"
+#include "cinder/audio/FileStreamScheduler.h"
 #include "cinder/audio/dsp/RingBuffer.h"
-
-#include <thread>
-#include <mutex>
-#include <condition_variable>
+#include "cinder/audio/dsp/PhaseVocoder.h"
 
 namespace cinder { namespace audio {
 
@@ -41,6 +39,9 @@ typedef std::shared_ptr<class FilePlayerNode>				FilePlayerNodeRef;
 //!
 //! SamplePlayerNode itself doesn't process any audio, but contains the common interface for InputNode's that do.
 //! The ChannelMode is set to Node::ChannelMode::SPECIED and it always matches the sample's number of channels (or is equal to 1 if there is no source).
+//!
+//! The playback rate and pitch can be changed independently of each other, in which case the samples are processed by a dsp::PhaseVocoder.
+//! This delays the output by dsp::PhaseVocoder::getLatency() frames, while the read position reflects the frames that have been consumed.
 //! \see BufferPlayerNode, FilePlayerNode
 class SamplePlayerNode : public InputNode {
   public:
@@ -91,12 +92,51 @@ class SamplePlayerNode : public InputNode {
 	//! Returns the end loop marker in seconds.
 	double getLoopEndTime() const;
 
+	//! Sets the playback speed without changing the pitch, so that 2 plays twice as fast and 0.5 half as fast. Clamped to [1/16, 16]. Default is 1.
+	//! \note The first time that this or the pitch shift is set to something other than 1, a dsp::PhaseVocoder is allocated while blocking the audio thread.
+	void setPlaybackRate( float rate );
+	//! Returns the playback speed.
+	float getPlaybackRate() const	{ return mPlaybackRate; }
+	//! Sets the ratio that the pitch is shifted by without changing the playback speed, so that 2 shifts up an octave. Clamped to [1/16, 16]. Default is 1.
+	void setPitchShift( float ratio );
+	//! Returns the ratio that the pitch is shifted by.
+	float getPitchShift() const		{ return mPitchShift; }
+	//! Sets the quality used for time-stretching and pitch-shifting (default = dsp::PhaseVocoder::Quality::MEDIUM). Higher quality costs more cpu and adds more latency.
+	void setStretchQuality( dsp::PhaseVocoder::Quality quality );
+	//! Returns the quality used for time-stretching and pitch-shifting.
+	dsp::PhaseVocoder::Quality getStretchQuality() const	{ return mStretchQuality; }
+
   protected:
 	SamplePlayerNode( const Format &format = Format() );
 
+	void initialize() override;
+
+	//! Reads up to \a numFrames from the sample into \a buffer starting at \a frameOffset and advances the read position, wrapping at the loop end. Frames that could not be read are zeroed. Returns the number of frames read.
+	virtual size_t readFrames( Buffer *buffer, size_t frameOffset, size_t numFrames ) = 0;
+	//! Returns whether the read position is at the end of the sample and won't wrap around to the loop begin.
+	bool isReadEnd() const;
+
+	//! Fills \a numFrames of \a buffer starting at \a frameOffset through the dsp::PhaseVocoder if the playback rate or pitch shift is not 1, handling EOF once the tail has played out. Returns false if time-stretching isn't active, in which case \a buffer is untouched.
+	bool processStretched( Buffer *buffer, size_t frameOffset, size_t numFrames );
+	//! Returns the largest number of sample frames consumed in a single processing block at the current playback rate.
+	size_t getMaxFramesReadPerBlock() const;
+	//! Returns whether the stretch settings require allocating.
+	virtual bool isStretchAllocationNeeded() const;
+	//! Allocates the dsp::PhaseVocoder and its buffers, called with the Context's mutex locked.
+	virtual void allocateStretch();
+	void updateStretch();
+
 	size_t				mNumFrames;
 	std::atomic<size_t> mReadPos, mLoopBegin, mLoopEnd;
 	std::atomic<bool>	mLoop, mIsEof;
+
+	std::unique_ptr<dsp::PhaseVocoder>	mStretch;
+	dsp::PhaseVocoder::Quality			mStretchQuality;
+	std::atomic<float>					mPlaybackRate, mPitchShift;
+	std::atomic<bool>					mStretchResetNeeded;
+	Buffer								mStretchInput, mStretchOutput;
+	size_t								mStretchOutputPos, mStretchTailFrames;
+	bool								mStretchActive, mStretchDraining;
 };
 
 //! Buffer-based SamplePlayerNode, where all samples are loaded into memory before playback.
@@ -111,8 +151,10 @@ class BufferPlayerNode : public SamplePlayerNode {
 
 	virtual void seek( size_t readPositionFrames ) override;
 
-	//! Loads and stores a reference to a Buffer created from the entire contents of \a sourceFile.
+	//! Loads and stores a reference to a Buffer created from the entire contents of \a sourceFile, resampled to the Context's samplerate if necessary. The Buffer is shared through the SampleCache with other players that load \a sourceFile.
 	void loadBuffer( const SourceFileRef &sourceFile );
+	//! Loads and stores a reference to a Buffer decoded from \a dataSource, resampled to the Context's samplerate if necessary. The Buffer is shared through the SampleCache with other players loading the same file, and may be memory-mapped from a pre-decoded copy. \see SampleCache::setPreDecodedDirectory()
+	void loadBuffer( const DataSourceRef &dataSource );
 	//! Sets the current Buffer. Safe to do while enabled.
 	void setBuffer( const BufferRef &buffer );
 	//! returns a shared_ptr to the current Buffer.
@@ -122,11 +164,16 @@ class BufferPlayerNode : public SamplePlayerNode {
 	virtual void enableProcessing()			override;
 	virtual void process( Buffer *buffer )	override;
 
+	size_t readFrames( Buffer *buffer, size_t frameOffset, size_t numFrames ) override;
+
 	BufferRef mBuffer;
 };
 
-//! File-based SamplePlayerNode, where samples are constantly streamed from file. Suitable for large audio files.
-class FilePlayerNode : public SamplePlayerNode {
+//! \brief File-based SamplePlayerNode, where samples are constantly streamed from file. Suitable for large audio files.
+//!
+//! In async mode, reading is done by the shared FileStreamScheduler, so many FilePlayerNodes can stream without each owning a thread.
+//! Samples are read ahead into a lock-free ring buffer, and seeks are handed to the I/O thread without blocking the caller or the audio thread.
+class FilePlayerNode : public SamplePlayerNode, private FileStreamScheduler::Client {
   public:
 	//! Constructs a FilePlayerNode with optional \a format.
 	FilePlayerNode( const Format &format = Format() );
@@ -134,20 +181,27 @@ class FilePlayerNode : public SamplePlayerNode {
 	FilePlayerNode( const SourceFileRef &sourceFile, bool isReadAsync = true, const Format &format = Node::Format() );
 	virtual ~FilePlayerNode();
 
-	virtual void stop() override;
+	//! Seeks to \a readPositionFrames. In async mode this is lock-free, playback resumes from the new position as soon as the I/O thread has prefetched it.
 	virtual void seek( size_t readPositionFrames ) override;
 
-	//! Returns whether reading occurs asynchronously (default is false). If true, file reading is done from an internal thread, if false it is done directly on the audio thread.
+	//! Returns whether reading occurs asynchronously (default is false). If true, file reading is done by the FileStreamScheduler's I/O threads, if false it is done directly on the audio thread.
 	bool isReadAsync() const	{ return mIsReadAsync; }
 
 	//! \note \a sourceFile's samplerate is forced to match this Node's Context.
 	void setSourceFile( const SourceFileRef &sourceFile );
 	const SourceFileRef& getSourceFile() const	{ return mSourceFile; }
 
+	//! Sets the number of frames that are read ahead of the playback position. 0 (default) uses twice the SourceFile's max frames per read. Restarts streaming from the current position if initialized.
+	void	setReadAheadFrames( size_t frames );
+	//! Returns the number of frames that are read ahead of the playback position, or 0 if it is determined by the SourceFile.
+	size_t	getReadAheadFrames() const	{ return mReadAheadFrames; }
+
 	//! Returns the frame of the last buffer underrun or 0 if none since the last time this method was called.
 	uint64_t getLastUnderrun();
 	//! Returns the frame of the last buffer overrun or 0 if none since the last time this method was called.
 	uint64_t getLastOverrun();
+	//! Returns the total number of processing blocks that could not be filled because the I/O thread fell behind.
+	size_t getNumUnderruns() const	{ return mNumUnderruns; }
 
   protected:
 	void initialize()				override;
@@ -156,23 +210,33 @@ class FilePlayerNode : public SamplePlayerNode {
 	void disableProcessing()		override;
 	void process( Buffer *buffer )	override;
 
-	void readAsyncImpl();
-	void readImpl();
+	void	serviceStream()			override;
+	float	getStreamFill() const	override;
+
+	size_t	readFrames( Buffer *buffer, size_t frameOffset, size_t numFrames ) override;
+	bool	isStretchAllocationNeeded() const	override;
+	void	allocateStretch()					override;
+
+	size_t getRingBufferSize() const;
 	void seekImpl( size_t readPos );
-	void stopImpl();
-	void destroyReadThreadImpl();
+	void startStreamImpl();
+	void stopStreamImpl();
 
 	std::vector<dsp::RingBuffer>				mRingBuffers;	// used to transfer samples from io to audio thread, one ring buffer per channel
-	BufferDynamic								mIoBuffer;		// used to read samples from the file on read thread, resizeable so the ringbuffer can be filled
+	BufferDynamic								mIoBuffer;		// used to read samples from the file on the io thread
 
 	SourceFileRef								mSourceFile;
-	size_t										mBufferFramesThreshold, mRingBufferPaddingFactor;
+	size_t										mReadAheadFrames, mBufferFramesThreshold;
 	std::atomic<uint64_t>						mLastUnderrun, mLastOverrun;
-
-	std::unique_ptr<std::thread>				mReadThread;
-	std::mutex									mAsyncReadMutex;
-	std::condition_variable						mIssueAsyncReadCond;
-	bool										mIsReadAsync, mAsyncReadShouldQuit;
+	std::atomic<size_t>							mNumUnderruns;
+	bool										mIsReadAsync, mIsStreaming;
+
+	// Async seeks are tagged with a generation. When the io thread starts a new generation it publishes the number of frames
+	// it had written up to that point, so the audio thread can discard the samples that were read before the seek.
+	std::atomic<uint64_t>						mSeekGeneration, mIoGeneration, mIoGenerationStartFrame;
+	std::atomic<size_t>							mSeekPos, mIoGenerationStartPos;
+	uint64_t									mAudioGeneration, mNumFramesRead, mNumFramesWritten;
+	size_t										mIoReadPos;
 };
 
 } } // namespace cinder::audio
@@ -25,12 +25,16 @@
 
 #include "cinder/audio/Node.h"
 #include "cinder/audio/SampleType.h"
+#include "cinder/audio/Target.h"
+#include "cinder/audio/FileStreamScheduler.h"
+#include "cinder/audio/dsp/RingBuffer.h"
 #include "cinder/Filesystem.h"
 
 namespace cinder { namespace audio {
 
 typedef std::shared_ptr<class SampleRecorderNode> SampleRecorderNodeRef;
 typedef std::shared_ptr<class BufferRecorderNode> BufferRecorderNodeRef;
+typedef std::shared_ptr<class FileRecorderNode> FileRecorderNodeRef;
 
 //! Base Node class for recording audio samples. Inherits from NodeAudioPullable, and therefore does not need to be connected to an output.
 class SampleRecorderNode : public NodeAutoPullable {
@@ -93,4 +97,55 @@ class BufferRecorderNode : public SampleRecorderNode {
 	std::atomic<uint64_t>	mLastOverrun;
 };
 
+//! \brief Records its inputs directly to a file, for recordings of any length with constant memory use.
+//!
+//! Each processing block is pushed into a lock-free ring buffer, which is written to the TargetFile by the shared FileStreamScheduler's
+//! I/O threads. If the disk falls behind for longer than the ring buffer can hold, blocks are dropped rather than blocking the audio
+//! thread, which can be monitored with getNumDroppedBlocks(). The number of channels recorded matches the inputs, so make connections before calling start().
+class FileRecorderNode : public SampleRecorderNode, private FileStreamScheduler::Client {
+  public:
+	FileRecorderNode( const Format &format = Format() );
+	virtual ~FileRecorderNode();
+
+	//! \brief Starts recording to a new file at \a filePath, finishing any recording in progress.
+	//!
+	//! The encoding format is derived from \a filePath's extension and \a sampleType (default = SampleType::INT_16).
+	//! \note throws AudioFileExc if the file cannot be created.
+	void start( const ci::fs::path &filePath, SampleType sampleType = SampleType::INT_16 );
+	//! Starts recording to \a targetFile, finishing any recording in progress. \a targetFile must have the same number of channels as this Node.
+	void start( const TargetFileRef &targetFile );
+	//! Stops recording, waits for all recorded samples to be written and closes the file. Must not be called from the audio thread.
+	void stop();
+	//! Returns whether a recording is in progress.
+	bool isRecording() const	{ return mTargetFile != nullptr; }
+
+	//! Sets the number of frames that can be queued for writing before blocks are dropped. 0 (default) uses two seconds at the Context's samplerate. Takes effect when the next recording starts.
+	void	setRingBufferFrames( size_t frames )	{ mRingBufferFrames = frames; }
+	//! Returns the number of frames that can be queued for writing, or 0 if it is determined by the samplerate.
+	size_t	getRingBufferFrames() const				{ return mRingBufferFrames; }
+
+	//! Returns the number of frames written to the file during the current or last recording.
+	uint64_t	getNumFramesWritten() const		{ return mNumFramesWritten; }
+	//! Returns the number of processing blocks that were dropped because the writer fell behind, during the current or last recording.
+	size_t		getNumDroppedBlocks() const		{ return mNumDroppedBlocks; }
+	//! Returns the frame of the last dropped block or 0 if none since the last time this method was called.
+	uint64_t	getLastOverrun();
+
+  protected:
+	void process( Buffer *buffer )	override;
+
+	void	serviceStream()			override;
+	float	getStreamFill() const	override;
+
+	void	writeAvailable();
+
+	std::vector<dsp::RingBuffer>	mRingBuffers;	// used to transfer samples from the audio to io thread, one ring buffer per channel
+	BufferDynamic					mIoBuffer;		// used to write samples to the file on the io thread
+	TargetFileRef					mTargetFile;
+	size_t							mRingBufferFrames, mServiceThresholdFrames;
+	std::atomic<bool>				mIsWriting;
+	std::atomic<uint64_t>			mNumFramesWritten, mLastOverrun;
+	std::atomic<size_t>				mNumDroppedBlocks;
+};
+
 } } // namespace cinder::audio
@@ -0,0 +1,200 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/audio/Node.h"
+#include "cinder/audio/dsp/Dsp.h"
+
+#include <functional>
+
+namespace cinder { namespace audio {
+
+namespace dsp {
+	class Fft;
+}
+
+typedef std::shared_ptr<class SpectralProcessNode>			SpectralProcessNodeRef;
+typedef std::shared_ptr<class SpectralGateNode>				SpectralGateNodeRef;
+typedef std::shared_ptr<class SpectralFreezeNode>			SpectralFreezeNodeRef;
+typedef std::shared_ptr<class SpectralCrossSynthesisNode>	SpectralCrossSynthesisNodeRef;
+
+//! Callback used to process spectral frames without subclassing SpectralProcessNode. The first parameter holds one BufferSpectral per channel, which are modified in place. The second parameter is the samplerate.
+typedef std::function<void( std::vector<BufferSpectral> *, size_t )> SpectralProcessFn;
+
+//! \brief Base class for Node's that process their input in the frequency domain.
+//!
+//! The input is analyzed with a Short-Time Fourier Transform: every getHopSize() frames, the last getFftSize() frames of each channel are
+//! windowed and transformed, processSpectral() modifies the spectra, and the result is transformed back, windowed again and overlap-added
+//! into the output. The output is normalized for the window and hop size, so an unmodified spectrum reproduces the input delayed by getLatency() frames.
+//! Frames are processed as soon as they are complete, regardless of the Context's frames per block.
+//!
+//! All buffers are allocated in initialize(), so subclasses and callbacks can process in realtime as long as they don't allocate either.
+class SpectralProcessNode : public Node {
+  public:
+	struct Format : public Node::Format {
+		Format() : mFftSize( 1024 ), mHopSize( 0 ), mWindowType( dsp::WindowType::HANN ) {}
+
+		//! Sets the FFT size, which is also the length of the analysis window. Rounded up to an even number. Sizes that are not a power of two are transformed with dsp::FftMixedRadix. Default is 1024.
+		Format&		fftSize( size_t size )				{ mFftSize = size; return *this; }
+		//! Sets the number of frames between sequential spectral frames. Default (0) is a quarter of the FFT size.
+		Format&		hopSize( size_t size )				{ mHopSize = size; return *this; }
+		//! Sets the window applied before analysis and after resynthesis. Default is WindowType::HANN.
+		Format&		windowType( dsp::WindowType type )	{ mWindowType = type; return *this; }
+
+		size_t			getFftSize() const				{ return mFftSize; }
+		size_t			getHopSize() const				{ return mHopSize; }
+		dsp::WindowType	getWindowType() const			{ return mWindowType; }
+
+		// reimpl Node::Format
+		Format&		channels( size_t ch )					{ Node::Format::channels( ch ); return *this; }
+		Format&		channelMode( ChannelMode mode )			{ Node::Format::channelMode( mode ); return *this; }
+		Format&		autoEnable( bool autoEnable = true )	{ Node::Format::autoEnable( autoEnable ); return *this; }
+
+	  protected:
+		size_t			mFftSize, mHopSize;
+		dsp::WindowType	mWindowType;
+	};
+
+	//! Constructs a SpectralProcessNode with an optional \a format. Without a SpectralProcessFn the spectra are left unmodified, unless processSpectral() is overridden.
+	SpectralProcessNode( const Format &format = Format() );
+	//! Constructs a SpectralProcessNode that calls \a processFn on the audio thread for each spectral frame, with an optional \a format.
+	SpectralProcessNode( const SpectralProcessFn &processFn, const Format &format = Format() );
+	virtual ~SpectralProcessNode();
+
+	//! Returns the size of the FFT.
+	size_t	getFftSize() const		{ return mFftSize; }
+	//! Returns the number of frames between spectral frames.
+	size_t	getHopSize() const		{ return mHopSize; }
+	//! Returns the number of frequency bins in each spectral frame. Equivalent to getFftSize() / 2.
+	size_t	getNumBins() const		{ return mFftSize / 2; }
+	//! Returns the number of frames the output is delayed relative to the input, which is the time it takes to fill one frame. Equivalent to getFftSize().
+	size_t	getLatency() const		{ return mFftSize; }
+	//! Returns the corresponding frequency for \a bin. Computed as \code bin * getSampleRate() / getFftSize() \endcode
+	float	getFreqForBin( size_t bin ) const;
+
+  protected:
+	void initialize()				override;
+	void process( Buffer *buffer )	override;
+
+	//! Called on the audio thread with one spectrum per channel each time a spectral frame is complete. Spectra are modified in place. The default implementation calls the SpectralProcessFn, if there is one.
+	//! \note As with dsp::Fft, the DC component is stored in the real part and the nyquist component in the imaginary part of bin zero.
+	virtual void processSpectral( std::vector<BufferSpectral> *spectra );
+
+	//! Returns the factor that converts a bin's magnitude to the amplitude of a sinusoid centered on that bin, given the current window.
+	float	getMagnitudeScale() const	{ return mMagnitudeScale; }
+
+  private:
+	void processFrame();
+
+	SpectralProcessFn			mProcessFn;
+	std::unique_ptr<dsp::Fft>	mFft;
+	size_t						mFftSize, mHopSize;
+	dsp::WindowType				mWindowType;
+	float						mMagnitudeScale;
+
+	AlignedArrayPtr				mWindow;			// applied at analysis and resynthesis
+	AlignedArrayPtr				mNormalization;		// one per hop frame, inverse of the summed squared windows that overlap it
+	Buffer						mInputFifo;			// last mFftSize input frames
+	Buffer						mOutputFifo;		// mHopSize finished output frames
+	Buffer						mOutputAccum;		// overlap-added resynthesized frames, not yet finished
+	Buffer						mFrameBuffer;		// windowed time-domain frame
+	std::vector<BufferSpectral>	mSpectra;			// one per channel
+	size_t						mFifoPos;
+};
+
+//! \brief Spectral noise gate.
+//!
+//! Bins whose magnitude falls below the threshold are attenuated, while the remaining bins pass unchanged. Processing is branch-free and four bins wide with SSE.
+class SpectralGateNode : public SpectralProcessNode {
+  public:
+	//! Constructs a SpectralGateNode with an optional \a format.
+	SpectralGateNode( const Format &format = Format() );
+
+	//! Sets the threshold as the linear amplitude (0 - 1) of a sinusoid, below which bins are attenuated. Default is 0.01.
+	void	setThreshold( float threshold )		{ mThreshold = threshold; }
+	//! Returns the threshold as a linear amplitude.
+	float	getThreshold() const				{ return mThreshold; }
+	//! Sets the linear gain (0 - 1) applied to bins below the threshold. Default is 0, which removes them.
+	void	setAttenuation( float gain )		{ mAttenuation = gain; }
+	//! Returns the linear gain applied to bins below the threshold.
+	float	getAttenuation() const				{ return mAttenuation; }
+
+  protected:
+	void processSpectral( std::vector<BufferSpectral> *spectra ) override;
+
+  private:
+	std::atomic<float>	mThreshold, mAttenuation;
+};
+
+//! \brief Holds the spectrum of a moment in time.
+//!
+//! While frozen, the magnitudes of the last spectral frame are held and each bin's phase keeps advancing at the rate measured over the last
+//! hop, so the frozen sound sustains rather than repeating one frame. The phases are rotated with complex multiplies, so no trigonometry is computed.
+class SpectralFreezeNode : public SpectralProcessNode {
+  public:
+	//! Constructs a SpectralFreezeNode with an optional \a format.
+	SpectralFreezeNode( const Format &format = Format() );
+
+	//! Sets whether the spectrum is frozen. Takes effect at the next spectral frame.
+	void	setFrozen( bool frozen = true )		{ mFrozen = frozen; }
+	//! Returns whether the spectrum is frozen.
+	bool	isFrozen() const					{ return mFrozen; }
+
+  protected:
+	void initialize()											override;
+	void processSpectral( std::vector<BufferSpectral> *spectra ) override;
+
+  private:
+	void capture( const std::vector<BufferSpectral> &spectra );
+
+	std::atomic<bool>			mFrozen;
+	bool						mIsCaptured;
+	std::vector<BufferSpectral>	mPrevSpectra;		// the last unfrozen frame, used to measure the phase advance
+	std::vector<BufferSpectral>	mPhasors;			// unit phase of each frozen bin, advanced each frame. Bin zero holds the frozen DC and nyquist values.
+	std::vector<BufferSpectral>	mRotations;			// unit phase advance per frame for each bin
+	std::vector<Buffer>			mMagnitudes;		// magnitude of each frozen bin
+};
+
+//! \brief Imposes the spectral magnitudes of a modulator onto a carrier.
+//!
+//! Expects two channels: channel 0 is the carrier and channel 1 is the modulator, which can be routed with a ChannelRouterNode. Each carrier bin
+//! keeps its phase while its magnitude is moved towards the modulator's magnitude by the amount (0 - 1). The result is written to both channels.
+class SpectralCrossSynthesisNode : public SpectralProcessNode {
+  public:
+	//! Constructs a SpectralCrossSynthesisNode with an optional \a format. The number of channels is always two.
+	SpectralCrossSynthesisNode( const Format &format = Format() );
+
+	//! Sets how much of the modulator's magnitude is applied (0 - 1). Default is 1.
+	void	setAmount( float amount )	{ mAmount = amount; }
+	//! Returns how much of the modulator's magnitude is applied.
+	float	getAmount() const			{ return mAmount; }
+
+  protected:
+	void processSpectral( std::vector<BufferSpectral> *spectra ) override;
+
+  private:
+	std::atomic<float>	mAmount;
+};
+
+} } // namespace cinder::audio
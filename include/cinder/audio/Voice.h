@@ -63,6 +63,8 @@ class Voice {
 		//! \brief Sets whether the Voice's output is automatically connected to master()->getOutput().
 		//!
 		//! If set to false, the user must manage the connection of its output node. Default = true, automaitically connects to master output.
+		//! Up to 1024 Voices can be connected to master at once. After that, creating another Voice replaces one that has finished playing,
+		//! or throws an AudioExc if none have.
 		Options& connectToMaster( bool shouldConnect )			{ mConnectToMaster = shouldConnect; return *this; }
 
 		//! Returns the number of configured channels. \see channels()
@@ -94,7 +96,11 @@ class Voice {
 	virtual bool isPlaying() const;
 	//! Returns the Node that is the source of this Voice's audio production. The Node type is determined by the Voice subclassed.
 	virtual NodeRef getInputNode() const = 0;
-	//! Returns the Node that is used for connected the Voice to the greater audio graph (by default, it is connected to Context::master()).
+	//! \brief Returns the Node that is used for connected the Voice to the greater audio graph.
+	//!
+	//! If Options::connectToMaster() is true (default), the Voice is mixed into Context::master() by a MixerNode shared by all Voices,
+	//! and this returns the Voice's input Node. Its volume and pan are applied by the shared MixerNode, so audio routed from it is
+	//! unaffected by them. If Options::connectToMaster() is false, this returns a MixerNode owned by the Voice, which applies its volume and pan.
 	virtual NodeRef getOutputNode() const;
 
 	void setVolume( float volume );
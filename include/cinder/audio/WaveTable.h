@@ -83,6 +83,8 @@ class WaveTable2d : public WaveTable {
 	void copyFrom( const float *array, size_t tableIndex );
 
 	float calcBandlimitedTableIndex( float f0 ) const;
+	//! Returns the table that contains as many harmonics as possible without aliasing at fundamental frequency \a f0. The table has getTableSize() samples.
+	const float*	getBandLimitedTable( float f0 ) const;
 
 	size_t getNumTables() const	{ return mNumTables; }
 
@@ -91,7 +93,6 @@ class WaveTable2d : public WaveTable {
 	void		fillBandLimitedTable( WaveformType type, float *table, size_t numPartials );
 	size_t		getMaxHarmonicsForTable( size_t tableIndex ) const;
 
-	const float*	getBandLimitedTable( float f0 ) const;
 	std::tuple<const float*, const float*, float> getBandLimitedTablesLerp( float f0 ) const;
 
 	size_t			mNumTables;
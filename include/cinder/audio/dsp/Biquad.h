@@ -84,6 +84,8 @@ class Biquad {
     void getFrequencyResponse( int nFrequencies, const float *frequency, float *magResponse, float *phaseResponse );
 	//! Resets filter state
     void reset();
+	//! Fills \a b0, \a b1, \a b2, \a a1 and \a a2 with the current normalized coefficients (a0 is always 1). \see BiquadBank::setCoefficients()
+	void getCoefficients( double *b0, double *b1, double *b2, double *a1, double *a2 ) const	{ *b0 = mB0; *b1 = mB1; *b2 = mB2; *a1 = mA1; *a2 = mA2; }
 
   private:
     void setNormalizedCoefficients( double b0, double b1, double b2, double a0, double a1, double a2 );
@@ -0,0 +1,78 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/audio/Buffer.h"
+
+#include <vector>
+
+namespace cinder { namespace audio { namespace dsp {
+
+class Biquad;
+
+//! \brief Processes a bank of biquad filters, one cascade of second-order sections per channel.
+//!
+//! Each channel of a non-interleaved Buffer is run through \a numStages biquad sections in transposed direct form II, which
+//! behaves well with single precision state. When SSE is available, four channels are processed at once, one per SIMD lane.
+//! Coefficients are typically designed with a dsp::Biquad and then copied into the bank with setCoefficients().
+class BiquadBank {
+  public:
+	//! Constructs a BiquadBank with \a numChannels channels, each running a cascade of \a numStages sections. All sections are initialized as pass-thru.
+	BiquadBank( size_t numChannels = 0, size_t numStages = 1 );
+
+	//! Resizes the bank to \a numChannels channels of \a numStages sections. All coefficients are reset to pass-thru and the filter memory is cleared.
+	void setSize( size_t numChannels, size_t numStages = 1 );
+	//! Returns the number of channels in the bank.
+	size_t getNumChannels() const	{ return mNumChannels; }
+	//! Returns the number of cascaded sections per channel.
+	size_t getNumStages() const		{ return mNumStages; }
+
+	//! Copies the coefficients of \a biquad into section \a stage of channel \a channel.
+	void setCoefficients( size_t channel, size_t stage, const Biquad &biquad );
+	//! Copies the coefficients of \a biquad into section \a stage of every channel.
+	void setCoefficients( size_t stage, const Biquad &biquad );
+	//! Sets the normalized coefficients for section \a stage of channel \a channel, such that `y[n] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] - a1 * y[n-1] - a2 * y[n-2]`.
+	void setCoefficients( size_t channel, size_t stage, double b0, double b1, double b2, double a1, double a2 );
+
+	//! Processes \a numFrames frames of each channel in \a buffer in-place. Channels beyond getNumChannels() are left untouched.
+	void process( Buffer *buffer, size_t numFrames );
+	//! Processes all frames of each channel in \a buffer in-place. Channels beyond getNumChannels() are left untouched.
+	void process( Buffer *buffer )	{ process( buffer, buffer->getNumFrames() ); }
+	//! Clears the filter memory of all sections.
+	void reset();
+
+  private:
+	void processGroup( float * const *channels, size_t numLanes, size_t numFrames, size_t laneOffset );
+	void processLane( float *channel, size_t numFrames, size_t lane );
+	void flushDenormals();
+
+	size_t	mNumChannels, mNumStages, mNumLanes;
+
+	// Coefficients and filter memory, laid out as [stage][lane], where the number of lanes is padded to a multiple of the SIMD width.
+	std::vector<float>	mB0, mB1, mB2, mA1, mA2;
+	std::vector<float>	mS1, mS2;
+	std::vector<float>	mStateStash;
+};
+
+} } } // namespace cinder::audio::dsp
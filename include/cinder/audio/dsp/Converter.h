@@ -25,15 +25,23 @@
 
 #include "cinder/audio/Buffer.h"
 
+#include <functional>
 #include <memory>
 
 namespace cinder { namespace audio { namespace dsp {
 
+class Converter;
+
+//! Function that creates a Converter, with the same arguments as Converter::create(). \see Converter::setDefaultFactory()
+typedef std::function<std::unique_ptr<Converter> ( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock )>	ConverterFactoryFn;
+
 //! A platform-specific converter that supports samplerate and channel conversion.
 class Converter {
   public:
-	//! If \a destSampleRate is 0, it is set to match \a sourceSampleRate. If \a destNumChannels is 0, it is set to match \a sourceNumChannels.
+	//! If \a destSampleRate is 0, it is set to match \a sourceSampleRate. If \a destNumChannels is 0, it is set to match \a sourceNumChannels. The implementation is platform-specific unless one was set with setDefaultFactory().
 	static std::unique_ptr<Converter> create( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock );
+	//! Sets the \a factory used by create() (ex. one returning ConverterImplPolyphase). Pass an empty function to restore the platform-specific implementation.
+	static void setDefaultFactory( const ConverterFactoryFn &factory );
 
 	virtual ~Converter() {}
 
@@ -99,6 +107,9 @@ void convertInt24ToFloat( const char *sourceArray, FloatT *destArray, size_t len
 	}
 }
 
+//! Converts the 24-bit int \a sourceArray to float, placing the result in \a destArray. \a length samples are converted, four at a time with SIMD when available.
+void convertInt24ToFloat( const char *sourceArray, float *destArray, size_t length );
+
 //! Converts the floating point \a sourceArray to 24-bit int precision, placing the result in \a destArray. \a length samples are converted.
 template<typename FloatT>
 void convertFloatToInt24( const FloatT *sourceArray, char *destArray, size_t length )
@@ -127,6 +138,9 @@ void interleave( const T *nonInterleavedSourceArray, T *interleavedDestArray, si
 	}
 }
 
+//! Interleaves \a numCopyFrames of float \a nonInterleavedSourceArray, placing the result in \a interleavedDestArray. 1, 2, 4, 6 and 8 channels use SIMD kernels when available, other channel counts use the generic version.
+void interleave( const float *nonInterleavedSourceArray, float *interleavedDestArray, size_t numFramesPerChannel, size_t numChannels, size_t numCopyFrames );
+
 //! Interleaves \a numCopyFrames of \a nonInterleavedSourceArray and converts from floating point to 16-bit int precision at the same time, placing the result in \a interleavedDestArray. \a numFramesPerChannel and \a numChannels describe the layout of the non-interleaved array.
 template<typename FloatT>
 void interleave( const FloatT *nonInterleavedFloatSourceArray, int16_t *interleavedInt16DestArray, size_t numFramesPerChannel, size_t numChannels, size_t numCopyFrames )
@@ -143,6 +157,9 @@ void interleave( const FloatT *nonInterleavedFloatSourceArray, int16_t *interlea
 	}
 }
 
+//! Interleaves \a numCopyFrames of float \a nonInterleavedFloatSourceArray and converts to 16-bit int precision, using SIMD when available. Samples outside of [-1, 1) are clamped.
+void interleave( const float *nonInterleavedFloatSourceArray, int16_t *interleavedInt16DestArray, size_t numFramesPerChannel, size_t numChannels, size_t numCopyFrames );
+
 //! De-interleaves \a numCopyFrames of \a interleavedSourceArray, placing the result in \a nonInterleavedDestArray. \a numFramesPerChannel and \a numChannels describe the layout of the non-interleaved array.
 template<typename T>
 void deinterleave( const T *interleavedSourceArray, T *nonInterleavedDestArray, size_t numFramesPerChannel, size_t numChannels, size_t numCopyFrames )
@@ -157,6 +174,9 @@ void deinterleave( const T *interleavedSourceArray, T *nonInterleavedDestArray,
 	}
 }
 
+//! De-interleaves \a numCopyFrames of float \a interleavedSourceArray, placing the result in \a nonInterleavedDestArray. 1, 2, 4, 6 and 8 channels use SIMD kernels when available, other channel counts use the generic version.
+void deinterleave( const float *interleavedSourceArray, float *nonInterleavedDestArray, size_t numFramesPerChannel, size_t numChannels, size_t numCopyFrames );
+
 //! De-interleaves \a numCopyFrames of \a interleavedSourceArray and converts from 16-bit int to floating point precision at the same time, placing the result in \a nonInterleavedDestArray. \a numFramesPerChannel and \a numChannels describe the layout of the non-interleaved array.
 template<typename FloatT>
 void deinterleave( const int16_t *interleavedInt16SourceArray, FloatT *nonInterleavedFloatDestArray, size_t numFramesPerChannel, size_t numChannels, size_t numCopyFrames )
@@ -173,6 +193,9 @@ void deinterleave( const int16_t *interleavedInt16SourceArray, FloatT *nonInterl
 	}
 }
 
+//! De-interleaves \a numCopyFrames of 16-bit int \a interleavedInt16SourceArray and converts to float precision, using SIMD when available.
+void deinterleave( const int16_t *interleavedInt16SourceArray, float *nonInterleavedFloatDestArray, size_t numFramesPerChannel, size_t numChannels, size_t numCopyFrames );
+
 //! Interleaves \a nonInterleavedSource, placing the result in \a interleavedDest.
 template<typename T>
 void interleaveBuffer( const BufferT<T> *nonInterleavedSource, BufferInterleavedT<T> *interleavedDest )
@@ -180,7 +203,7 @@ void interleaveBuffer( const BufferT<T> *nonInterleavedSource, BufferInterleaved
 	CI_ASSERT( interleavedDest->getNumChannels() == nonInterleavedSource->getNumChannels() );
 	CI_ASSERT( interleavedDest->getSize() <= nonInterleavedSource->getSize() );
 
-	interleave( nonInterleavedSource->getData(), interleavedDest->getData(), interleavedDest->getNumFrames(), interleavedDest->getNumChannels(), interleavedDest->getNumFrames() );
+	interleave( nonInterleavedSource->getData(), interleavedDest->getData(), nonInterleavedSource->getNumFrames(), interleavedDest->getNumChannels(), interleavedDest->getNumFrames() );
 }
 
 //! De-interleaves \a interleavedSource, placing the result in \a nonInterleavedDest.
@@ -193,43 +216,22 @@ void deinterleaveBuffer( const BufferInterleavedT<T> *interleavedSource, BufferT
 	deinterleave( interleavedSource->getData(), nonInterleavedDest->getData(), nonInterleavedDest->getNumFrames(), nonInterleavedDest->getNumChannels(), nonInterleavedDest->getNumFrames() );
 }
 
-//! Interleaves \a nonInterleavedSource, placing the result in \a interleavedDest. This method is only slightly faster than interleaveBuffer(), which can handle an arbitrary number of channels.
+//! Interleaves \a nonInterleavedSource, placing the result in \a interleavedDest. Both must be stereo. Equivalent to interleaveBuffer(), which uses the stereo SIMD kernel for float.
 template<typename T>
 void interleaveStereoBuffer( const BufferT<T> *nonInterleavedSource, BufferInterleavedT<T> *interleavedDest )
 {
 	CI_ASSERT( interleavedDest->getNumChannels() == 2 && nonInterleavedSource->getNumChannels() == 2 );
-	CI_ASSERT( interleavedDest->getSize() <= nonInterleavedSource->getSize() );
-
-	size_t numFrames = interleavedDest->getNumFrames();
-	const T *left = nonInterleavedSource->getChannel( 0 );
-	const T *right = nonInterleavedSource->getChannel( 1 );
 
-	T *mixed = interleavedDest->getData();
-
-	size_t i, j;
-	for( i = 0, j = 0; i < numFrames; i++, j += 2 ) {
-		mixed[j] = left[i];
-		mixed[j + 1] = right[i];
-	}
+	interleaveBuffer( nonInterleavedSource, interleavedDest );
 }
 
-//! De-interleaves \a interleavedSource, placing the result in \a nonInterleavedDest. This method is only slightly faster than deinterleaveStereoBuffer(), which can handle an arbitrary number of channels.
+//! De-interleaves \a interleavedSource, placing the result in \a nonInterleavedDest. Both must be stereo. Equivalent to deinterleaveBuffer(), which uses the stereo SIMD kernel for float.
 template<typename T>
 void deinterleaveStereoBuffer( const BufferInterleavedT<T> *interleavedSource, BufferT<T> *nonInterleavedDest )
 {
 	CI_ASSERT( interleavedSource->getNumChannels() == 2 && nonInterleavedDest->getNumChannels() == 2 );
-	CI_ASSERT( nonInterleavedDest->getSize() <= interleavedSource->getSize() );
-
-	size_t numFrames = nonInterleavedDest->getNumFrames();
-	T *left = nonInterleavedDest->getChannel( 0 );
-	T *right = nonInterleavedDest->getChannel( 1 );
-	const T *mixed = interleavedSource->getData();
 
-	size_t i, j;
-	for( i = 0, j = 0; i < numFrames; i++, j += 2 ) {
-		left[i] = mixed[j];
-		right[i] = mixed[j + 1];
-	}
+	deinterleaveBuffer( interleavedSource, nonInterleavedDest );
 }
 
 } } } // namespace cinder::audio::dsp
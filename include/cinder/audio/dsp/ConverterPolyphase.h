@@ -0,0 +1,77 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/audio/dsp/Converter.h"
+
+#include <vector>
+
+namespace cinder { namespace audio { namespace dsp {
+
+//! \brief \a Converter implementation using a polyphase windowed-sinc FIR filter.
+//!
+//! All channels are filtered together from one interleaved history, sharing a single coefficient lookup per output frame, and the
+//! inner product is vectorized with SSE where available. It is considerably cheaper to construct and run than ConverterImplR8brain,
+//! at the cost of a wider transition band. The output is delayed by getLatencyFrames() source frames, which depends on the Quality.
+//! To use it for all conversions: \code Converter::setDefaultFactory( ConverterImplPolyphase::makeFactory() ); \endcode
+class ConverterImplPolyphase : public Converter {
+  public:
+	//! Quality / latency presets, which determine the number of filter taps per phase (16, 32 or 64) and the stopband attenuation.
+	enum class Quality { LOW, MEDIUM, HIGH };
+
+	ConverterImplPolyphase( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock, Quality quality = Quality::MEDIUM );
+	virtual ~ConverterImplPolyphase();
+
+	std::pair<size_t, size_t>	convert( const Buffer *sourceBuffer, Buffer *destBuffer )	override;
+	void						clear()														override;
+
+	//! Returns the Quality preset.
+	Quality	getQuality() const			{ return mQuality; }
+	//! Returns the number of filter taps applied per output frame.
+	size_t	getNumTaps() const			{ return mNumTaps; }
+	//! Returns the delay introduced by the filter, in source frames.
+	size_t	getLatencyFrames() const	{ return mNumTaps / 2; }
+
+	//! Returns a ConverterFactoryFn that creates ConverterImplPolyphase's with \a quality. \see Converter::setDefaultFactory()
+	static ConverterFactoryFn makeFactory( Quality quality = Quality::MEDIUM );
+
+  private:
+	void	designFilter();
+	size_t	process( size_t numChannels, Buffer *destBuffer );
+	void	computeFrame( size_t numChannels, float *result );
+
+	Quality				mQuality;
+	size_t				mNumTaps;			// per phase
+	size_t				mUpFactor, mDownFactor;	// the samplerate ratio reduced to dest / source = mUpFactor / mDownFactor
+	size_t				mNumPhases;			// equal to mUpFactor, unless that is too large and phases are interpolated
+	size_t				mCoeffStride;		// floats per phase, taps repeated per channel for mono and stereo
+	AlignedArrayPtr		mCoeffs;			// mNumPhases + 1 rows, the last one used for interpolation
+
+	std::vector<float>	mHistory;			// interleaved source frames
+	size_t				mNumHistoryFrames, mWindowStart, mPhase;
+	std::vector<float>	mFrame, mFrameNext;	// one output frame, per channel
+	Buffer				mMixingBuffer;
+};
+
+} } } // namespace cinder::audio::dsp
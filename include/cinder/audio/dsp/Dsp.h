@@ -31,6 +31,10 @@
 	#define CINDER_AUDIO_VDSP
 #endif
 
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+	#define CINDER_AUDIO_SSE
+#endif
+
 #include <atomic>
 #include <vector>
 #include <cmath>
@@ -60,6 +64,10 @@ void generateWindow( WindowType windowType, float *window, size_t length );
 
 //! fills \a array with value \a value
 void fill( float value, float *array, size_t length );
+//! fills \a array with a linear ramp, where \a array[i] = \a begin + i * \a increment.
+void ramp( float begin, float increment, float *array, size_t length );
+//! fills \a array with a geometric ramp, where \a array[i] = \a begin * \a ratio^i.
+void rampGeometric( float begin, float ratio, float *array, size_t length );
 //! add \a scalar to \a array of length \a length, into \a result.
 void add( const float *array, float scalar, float *result, size_t length );
 //! add \a length elements of \a arrayA and \a arrayB (element-wise) into \a result.
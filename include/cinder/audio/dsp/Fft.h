@@ -29,43 +29,78 @@
 #include "cinder/Cinder.h"
 
 #include <vector>
+#include <memory>
+#include <functional>
 
-#if defined( CINDER_AUDIO_VDSP )
-	#include <Accelerate/Accelerate.h>
-#else
+#if ! defined( CINDER_AUDIO_VDSP )
 	#define CINDER_AUDIO_FFT_OOURA
 #endif
 
 namespace cinder { namespace audio { namespace dsp {
 
+//! \brief Interface for the implementation of a real DFT used by Fft.
+//!
+//! The forward transform is unscaled, X[k] = sum( x[n] * e^(-2 pi i k n / N) ), and the inverse transform is scaled by 1 / N so that a
+//! round trip returns the original samples. The spectrum holds N / 2 bins, with the (purely real) nyquist component packed into imag[0].
+class FftBackend {
+  public:
+	virtual ~FftBackend()	{}
+
+	//! Transforms getSize() samples of \a waveform, filling getSize() / 2 bins of \a real and \a imag.
+	virtual void forward( const float *waveform, float *real, float *imag ) = 0;
+	//! Transforms getSize() / 2 bins of \a real and \a imag into getSize() samples of \a waveform. Must not modify \a real or \a imag.
+	virtual void inverse( const float *real, const float *imag, float *waveform ) = 0;
+	//! Computes forward() for \a count transforms. The default implementation calls forward() for each.
+	virtual void forwardBatch( const float * const *waveforms, float * const *reals, float * const *imags, size_t count );
+	//! Computes inverse() for \a count transforms. The default implementation calls inverse() for each.
+	virtual void inverseBatch( const float * const *reals, const float * const *imags, float * const *waveforms, size_t count );
+
+	//! Returns the size of the transform.
+	size_t getSize() const	{ return mSize; }
+
+  protected:
+	FftBackend( size_t size ) : mSize( size )	{}
+
+	size_t mSize;
+};
+
+typedef std::function<std::unique_ptr<FftBackend> ( size_t fftSize )>	FftBackendFactoryFn;
+
+//! Returns an FftBackend that uses the platform's FFT (vDSP on OS X and iOS, otherwise the bundled Ooura FFT). \a fftSize must be a power of two.
+std::unique_ptr<FftBackend> makeFftBackendNative( size_t fftSize );
+//! Returns an FftBackend that uses FftMixedRadix. \a fftSize must be even.
+std::unique_ptr<FftBackend> makeFftBackendMixedRadix( size_t fftSize );
+
 //! Real Discrete Fourier Transform (DFT).
 class Fft {
   public:
-	//! Constructs an Fft object. \a fftSize must be a power of two and greater than two.
+	//! Constructs an Fft object with the default backend. \a fftSize must be even and greater than zero. \see setDefaultBackendFactory()
 	Fft( size_t fftSize );
+	//! Constructs an Fft object that uses \a backend.
+	Fft( std::unique_ptr<FftBackend> &&backend );
 	~Fft();
 
 	//! Computes the Forward DFT of \a waveform, filling \a spectral with freqency-domain audio data
 	void forward( const Buffer *waveform, BufferSpectral *spectral );
 	//! Computes the Inverse DFT of \a spectral, filling \a waveform with time-domain audio data
 	void inverse( const BufferSpectral *spectral, Buffer *waveform );
+	//! Computes the Forward DFT of each channel in \a waveforms, filling the BufferSpectral at the same index in \a spectra, which must have at least as many elements as \a waveforms has channels.
+	void forward( const Buffer *waveforms, std::vector<BufferSpectral> *spectra );
+	//! Computes the Inverse DFT of each element in \a spectra, filling the channel at the same index in \a waveforms, which must have at least as many channels as \a spectra has elements.
+	void inverse( const std::vector<BufferSpectral> &spectra, Buffer *waveforms );
 	//! Returns the size of the FFT.
 	size_t getSize() const	{ return mSize; }
+	//! Returns the backend that computes the transforms.
+	FftBackend* getBackend() const	{ return mBackend.get(); }
+
+	//! Sets the function used to create the backend of Fft objects constructed with only a size, such as those used internally by MonitorSpectralNode. Passing an empty function restores the default, which uses the native backend for powers of two when vDSP is available or SSE is not, and FftMixedRadix otherwise.
+	static void setDefaultBackendFactory( const FftBackendFactoryFn &factory );
 
   protected:
-	void init();
-
-	size_t				mSize, mSizeOverTwo;
-
-#if defined( CINDER_AUDIO_VDSP )
-	size_t				mLog2FftSize;
-	::FFTSetup			mFftSetup;
-	::DSPSplitComplex	mSplitComplexSignal, mSplitComplexResult;
-#elif defined( CINDER_AUDIO_FFT_OOURA )
-	Buffer				mBufferCopy;
-	int					*mOouraIp;
-	float				*mOouraW;
-#endif
+	std::unique_ptr<FftBackend>	mBackend;
+	size_t						mSize, mSizeOverTwo;
+	std::vector<const float *>	mBatchInputs;
+	std::vector<float *>		mBatchOutputs, mBatchOutputsImag;
 };
 
 } } } // namespace cinder::audio::dsp
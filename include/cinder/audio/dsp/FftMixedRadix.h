@@ -0,0 +1,67 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/audio/dsp/Fft.h"
+
+#include <vector>
+
+namespace cinder { namespace audio { namespace dsp {
+
+//! \brief FftBackend for any even size, using a mixed-radix Stockham FFT with SSE butterflies where available.
+//!
+//! A real transform of size N is computed as a complex transform of size N / 2 that is then split into the real spectrum.
+//! The complex transform is factored into radix-4 stages, at most one radix-2 stage, radix-3 and -5 stages and general odd radix stages, so sizes
+//! whose half has only small prime factors (for example 2^a * 3^b * 5^c) are the fastest. Data is kept in split (real,
+//! imaginary) arrays and each stage's twiddle factors are stored in the order that they are accessed.
+class FftMixedRadix : public FftBackend {
+  public:
+	//! Constructs an FftMixedRadix object. \a fftSize must be even.
+	FftMixedRadix( size_t fftSize );
+
+	void forward( const float *waveform, float *real, float *imag ) override;
+	void inverse( const float *real, const float *imag, float *waveform ) override;
+
+  private:
+	struct Stage {
+		size_t mRadix, mStride, mNumButterflies;	// mNumButterflies == sub-transform length / radix
+		size_t mTwiddleOffset, mRootsOffset;
+	};
+
+	void transformComplex( float *re, float *im, float *outRe, float *outIm );
+	void processRadix2( const Stage &stage, const float *xr, const float *xi, float *yr, float *yi );
+	void processRadix4( const Stage &stage, const float *xr, const float *xi, float *yr, float *yi );
+	void processRadix3( const Stage &stage, const float *xr, const float *xi, float *yr, float *yi );
+	void processRadix5( const Stage &stage, const float *xr, const float *xi, float *yr, float *yi );
+	void processRadixGeneric( const Stage &stage, const float *xr, const float *xi, float *yr, float *yi );
+
+	size_t				mComplexSize;
+	std::vector<Stage>	mStages;
+	std::vector<float>	mTwiddlesRe, mTwiddlesIm;		// per stage: w^(p * k) for k in [1, radix) and p in [0, mNumButterflies), in that order
+	std::vector<float>	mRootsRe, mRootsIm;				// per stage with a radix greater than five: e^(-2 pi i j / radix)
+	std::vector<float>	mSplitRe, mSplitIm;				// e^(-2 pi i k / N) used to split the complex transform into the real spectrum
+	std::vector<float>	mBufferRe, mBufferIm, mWorkRe, mWorkIm, mResultRe, mResultIm;
+};
+
+} } } // namespace cinder::audio::dsp
@@ -0,0 +1,121 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "cinder/audio/Buffer.h"
+
+#include <memory>
+
+namespace cinder { namespace audio { namespace dsp {
+
+class Fft;
+
+//! \brief Phase vocoder that time-stretches and pitch-shifts multichannel audio independently.
+//!
+//! Input is analyzed with a Short-Time Fourier Transform whose hop is the output hop scaled by the rate. Each spectral peak is resynthesized at its
+//! measured instantaneous frequency scaled by the pitch, and the phases of the bins surrounding it are locked to the peak, which avoids the 'phasiness'
+//! of a plain phase vocoder. When pitch-shifting, each peak's region is moved as a whole so that its shape is preserved. Frames where the high frequency
+//! energy rises sharply are treated as transients: their phases are reset to the analyzed phases rather than propagated, which keeps attacks from
+//! smearing. Detection is done across all channels at once, so the stereo image stays intact.
+//!
+//! Processing is pull-based: getNumInputFramesNeeded() returns how many new input frames the next call to process() consumes, and each call
+//! writes getHopSize() output frames. All memory is allocated at construction.
+class PhaseVocoder {
+  public:
+	//! Trade-offs between quality and cpu usage.
+	enum class Quality {
+		LOW,	//!< 1024 point FFT with 4x overlap. Cheapest, but low frequencies are poorly resolved.
+		MEDIUM,	//!< 2048 point FFT with 4x overlap.
+		HIGH	//!< 4096 point FFT with 8x overlap, at about four times the cost of MEDIUM.
+	};
+
+	//! Constructs a PhaseVocoder that processes \a numChannels channels at \a quality.
+	PhaseVocoder( size_t numChannels, Quality quality = Quality::MEDIUM );
+	~PhaseVocoder();
+
+	//! Sets the number of input frames consumed per output frame, so that 2 plays twice as fast and 0.5 half as fast. Clamped to [1/16, 16]. Default is 1.
+	void	setRate( float rate );
+	//! Returns the number of input frames consumed per output frame.
+	float	getRate() const			{ return mRate; }
+	//! Sets the ratio that frequencies are scaled by, so that 2 shifts up an octave. Clamped to [1/16, 16]. Default is 1.
+	void	setPitch( float pitch );
+	//! Returns the ratio that frequencies are scaled by.
+	float	getPitch() const		{ return mPitch; }
+	//! Sets whether transients reset the phases (default = true).
+	void	setTransientDetectionEnabled( bool enable = true )	{ mTransientDetection = enable; }
+	//! Returns whether transients reset the phases.
+	bool	isTransientDetectionEnabled() const					{ return mTransientDetection; }
+
+	//! Returns the number of input frames that the next call to process() will consume.
+	size_t	getNumInputFramesNeeded() const	{ return mNumInputFramesNeeded; }
+	//! Returns the largest number of input frames that a call to process() can consume, which is reached at the maximum rate.
+	size_t	getMaxInputFramesNeeded() const;
+	//! Consumes getNumInputFramesNeeded() frames from the beginning of \a input and writes getHopSize() frames to the beginning of \a output.
+	void	process( const Buffer &input, Buffer *output );
+	//! Clears all analysis and synthesis state, as if nothing had been processed.
+	void	reset();
+
+	//! Returns the number of channels.
+	size_t	getNumChannels() const	{ return mNumChannels; }
+	//! Returns the quality.
+	Quality	getQuality() const		{ return mQuality; }
+	//! Returns the size of the FFT.
+	size_t	getFftSize() const		{ return mFftSize; }
+	//! Returns the number of output frames written by each call to process().
+	size_t	getHopSize() const		{ return mHopSize; }
+	//! Returns the number of output frames that come out before the first input frame is heard.
+	size_t	getLatency() const		{ return mFftSize - mHopSize; }
+	//! Returns the number of output frames it takes for the last input frame to be heard completely, at the current rate.
+	size_t	getTailFrames() const;
+	//! Returns the number of transients detected since construction.
+	size_t	getNumTransients() const	{ return mNumTransients; }
+
+  private:
+	void analyze();
+	bool detectTransient() const;
+	void synthesize( bool resetPhases, size_t analysisHop, Buffer *output );
+	void findPeaks( const float *magnitudes );
+
+	size_t	mNumChannels, mFftSize, mHopSize, mNumBins;
+	Quality	mQuality;
+	float	mRate, mPitch;
+	bool	mTransientDetection;
+	size_t	mNumInputFramesNeeded, mNumPrimingFrames, mNumTransients;
+	double	mAnalysisHopRemainder;
+
+	std::unique_ptr<Fft>	mFft;
+	AlignedArrayPtr			mWindow;
+	AlignedArrayPtr			mNormalization;		// one per hop frame, inverse of the summed squared windows that overlap it
+	Buffer					mFrame;
+	BufferSpectral			mSpectrum;			// synthesized spectrum of the channel being processed
+	std::vector<size_t>		mPeaks;				// spectral peaks of the channel being processed
+
+	// per channel state
+	Buffer						mInputWindows, mOutputAccum;
+	Buffer						mMagnitudes, mPrevMagnitudes;	// squared
+	Buffer						mRotations;						// difference between the synthesized and analyzed phase of each bin
+	std::vector<BufferSpectral>	mSpectra, mPrevSpectra;
+};
+
+} } } // namespace cinder::audio::dsp
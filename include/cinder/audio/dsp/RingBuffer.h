@@ -25,7 +25,9 @@
 
 #include "cinder/CinderAssert.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstring>
 
 namespace cinder { namespace audio { namespace dsp {
 
@@ -160,6 +162,21 @@ class RingBufferT {
 		mReadIndex.store( readIndexAfter, std::memory_order_release );
 		return true;
 	}
+	//! Discards up to \a count elements without reading them. \return the number of elements discarded. \note only safe to call from the read thread.
+	size_t discard( size_t count )
+	{
+		const size_t writeIndex = mWriteIndex.load( std::memory_order_acquire );
+		const size_t readIndex = mReadIndex.load( std::memory_order_relaxed );
+
+		count = std::min( count, getAvailableRead( writeIndex, readIndex ) );
+
+		size_t readIndexAfter = readIndex + count;
+		if( readIndexAfter >= mAllocatedSize )
+			readIndexAfter -= mAllocatedSize;
+
+		mReadIndex.store( readIndexAfter, std::memory_order_release );
+		return count;
+	}
 
   private:
 	size_t getAvailableWrite( size_t writeIndex, size_t readIndex ) const
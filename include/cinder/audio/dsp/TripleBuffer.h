@@ -0,0 +1,89 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace cinder { namespace audio { namespace dsp {
+
+//! \brief Triple buffer for handing the latest complete value of \a T from one thread to another without locks or copies.
+//!
+//! The writer fills getWriteBuffer() and calls publish(), the reader calls update() and then reads getReadBuffer(). The
+//! third buffer sits between the two, so neither side ever waits on the other: both operations are a single atomic exchange.
+//! Unlike a RingBuffer, values are not queued; the reader always sees the most recently published one and intermediate ones are skipped.
+//!
+//! \note Wait-free within a single write thread / single read thread context.
+template <typename T>
+class TripleBuffer {
+  public:
+	TripleBuffer() : mWriteIndex( 0 ), mMiddle( 1 ), mReadIndex( 2 )	{}
+
+	//! Assigns \a value to all three buffers and marks nothing as published. \note Must be synchronized with both read and write threads.
+	void reset( const T &value )
+	{
+		for( size_t i = 0; i < 3; i++ )
+			mBuffers[i] = value;
+
+		mWriteIndex = 0;
+		mMiddle = 1;
+		mReadIndex = 2;
+	}
+
+	//! Returns the buffer to be filled by the write thread. \note only safe to call from the write thread.
+	T&	getWriteBuffer()	{ return mBuffers[mWriteIndex]; }
+	//! Makes the contents of getWriteBuffer() available to the read thread. getWriteBuffer() refers to a different buffer afterwards, whose contents are stale. \note only safe to call from the write thread.
+	void publish()
+	{
+		mWriteIndex = mMiddle.exchange( uint8_t( mWriteIndex | FRESH_BIT ), std::memory_order_acq_rel ) & INDEX_MASK;
+	}
+
+	//! Acquires the most recently published buffer, if one was published since the last call. \return `true` if getReadBuffer() has changed. \note only safe to call from the read thread.
+	bool update()
+	{
+		if( ! ( mMiddle.load( std::memory_order_relaxed ) & FRESH_BIT ) )
+			return false;
+
+		mReadIndex = mMiddle.exchange( mReadIndex, std::memory_order_acq_rel ) & INDEX_MASK;
+		return true;
+	}
+	//! Returns the buffer acquired by the last update(). \note only safe to call from the read thread.
+	const T&	getReadBuffer() const	{ return mBuffers[mReadIndex]; }
+	//! Returns the buffer acquired by the last update(). \note only safe to call from the read thread.
+	T&			getReadBuffer()			{ return mBuffers[mReadIndex]; }
+
+  private:
+	TripleBuffer( const TripleBuffer &other );
+	TripleBuffer& operator=( const TripleBuffer &other );
+
+	static const uint8_t INDEX_MASK = 0x3;
+	static const uint8_t FRESH_BIT = 0x4;
+
+	T						mBuffers[3];
+	uint8_t					mWriteIndex;	// owned by the write thread
+	std::atomic<uint8_t>	mMiddle;		// index of the buffer between the threads, plus FRESH_BIT if it hasn't been read yet
+	uint8_t					mReadIndex;		// owned by the read thread
+};
+
+} } } // namespace cinder::audio::dsp
@@ -28,10 +28,134 @@
 
 #include <limits>
 
+#if defined( CINDER_AUDIO_SSE )
+	#include <emmintrin.h>
+#endif
+
 using namespace std;
 
 namespace cinder { namespace audio {
 
+namespace {
+
+// number of input channels mixed into an output channel at once, so that it is loaded and stored once per group
+const size_t MIX_GROUP_SIZE = 4;
+
+// dest += gain * source
+void mixChannel( const float *source, float gain, float *dest, size_t numFrames )
+{
+	size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	const __m128 gain4 = _mm_set1_ps( gain );
+	for( ; i + 4 <= numFrames; i += 4 )
+		_mm_storeu_ps( dest + i, _mm_add_ps( _mm_loadu_ps( dest + i ), _mm_mul_ps( gain4, _mm_loadu_ps( source + i ) ) ) );
+#endif
+
+	for( ; i < numFrames; i++ )
+		dest[i] += gain * source[i];
+}
+
+// dest += gains[0] * sources[0] + ... + gains[3] * sources[3]
+void mixChannelGroup( const float *const *sources, const float *gains, float *dest, size_t numFrames )
+{
+	const float *s0 = sources[0], *s1 = sources[1], *s2 = sources[2], *s3 = sources[3];
+	size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	const __m128 g0 = _mm_set1_ps( gains[0] );
+	const __m128 g1 = _mm_set1_ps( gains[1] );
+	const __m128 g2 = _mm_set1_ps( gains[2] );
+	const __m128 g3 = _mm_set1_ps( gains[3] );
+	for( ; i + 4 <= numFrames; i += 4 ) {
+		__m128 sum01 = _mm_add_ps( _mm_mul_ps( g0, _mm_loadu_ps( s0 + i ) ), _mm_mul_ps( g1, _mm_loadu_ps( s1 + i ) ) );
+		__m128 sum23 = _mm_add_ps( _mm_mul_ps( g2, _mm_loadu_ps( s2 + i ) ), _mm_mul_ps( g3, _mm_loadu_ps( s3 + i ) ) );
+		_mm_storeu_ps( dest + i, _mm_add_ps( _mm_loadu_ps( dest + i ), _mm_add_ps( sum01, sum23 ) ) );
+	}
+#endif
+
+	for( ; i < numFrames; i++ )
+		dest[i] += gains[0] * s0[i] + gains[1] * s1[i] + gains[2] * s2[i] + gains[3] * s3[i];
+}
+
+// mixes each row's non-zero \a gains of \a source into \a dest, skipping input channels past \a numSourceChannels
+void mixRows( const vector<size_t> &rowBegin, const vector<size_t> &inputChannels, const float *gains, const Buffer *source, size_t numSourceChannels, Buffer *dest, size_t numFrames )
+{
+	const size_t numRows = min( rowBegin.size() - 1, dest->getNumChannels() );
+
+	const float *groupSources[MIX_GROUP_SIZE];
+	float groupGains[MIX_GROUP_SIZE];
+
+	for( size_t row = 0; row < numRows; row++ ) {
+		float *destChannel = dest->getChannel( row );
+		size_t groupSize = 0;
+		for( size_t i = rowBegin[row]; i < rowBegin[row + 1]; i++ ) {
+			size_t inputChannel = inputChannels[i];
+			if( gains[i] == 0 || inputChannel >= numSourceChannels )
+				continue;
+
+			groupSources[groupSize] = source->getChannel( inputChannel );
+			groupGains[groupSize] = gains[i];
+			if( ++groupSize == MIX_GROUP_SIZE ) {
+				mixChannelGroup( groupSources, groupGains, destChannel, numFrames );
+				groupSize = 0;
+			}
+		}
+
+		for( size_t i = 0; i < groupSize; i++ )
+			mixChannel( groupSources[i], groupGains[i], destChannel, numFrames );
+	}
+}
+
+// returns the ramp curve's value at \a t, which is clamped to [0:1]
+float evalRamp( const RampFn &rampFn, float t )
+{
+	if( t >= 1 )
+		return 1;
+
+	float result;
+	rampFn( &result, 1, t, 0, make_pair( 0.0f, 1.0f ) );
+	return result;
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - GainMatrix
+// ----------------------------------------------------------------------------------------------------
+
+GainMatrix::GainMatrix( size_t numInputChannels, size_t numOutputChannels )
+	: mNumInputChannels( numInputChannels ), mNumOutputChannels( numOutputChannels ), mGains( numInputChannels * numOutputChannels, 0.0f )
+{
+}
+
+GainMatrix GainMatrix::identity( size_t numInputChannels, size_t numOutputChannels )
+{
+	GainMatrix result( numInputChannels, numOutputChannels );
+	for( size_t ch = 0; ch < min( numInputChannels, numOutputChannels ); ch++ )
+		result.setGain( ch, ch, 1 );
+
+	return result;
+}
+
+void GainMatrix::setGain( size_t inputChannel, size_t outputChannel, float gain )
+{
+	CI_ASSERT_MSG( inputChannel < mNumInputChannels && outputChannel < mNumOutputChannels, "channel out of range" );
+
+	mGains[outputChannel * mNumInputChannels + inputChannel] = gain;
+}
+
+float GainMatrix::getGain( size_t inputChannel, size_t outputChannel ) const
+{
+	CI_ASSERT_MSG( inputChannel < mNumInputChannels && outputChannel < mNumOutputChannels, "channel out of range" );
+
+	return mGains[outputChannel * mNumInputChannels + inputChannel];
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - ChannelRouterNode
+// ----------------------------------------------------------------------------------------------------
+
 ChannelRouterNode::RouteConnector ChannelRouterNode::route( size_t inputChannelIndex, size_t outputChannelIndex )
 {
 	return RouteConnector( static_pointer_cast<ChannelRouterNode>( shared_from_this() ), inputChannelIndex, outputChannelIndex );
@@ -42,6 +166,11 @@ ChannelRouterNode::RouteConnector ChannelRouterNode::route( size_t inputChannelI
 	return RouteConnector( static_pointer_cast<ChannelRouterNode>( shared_from_this() ), inputChannelIndex, outputChannelIndex, numChannels );
 }
 
+ChannelRouterNode::RouteConnector ChannelRouterNode::route( const GainMatrix &gains )
+{
+	return RouteConnector( static_pointer_cast<ChannelRouterNode>( shared_from_this() ), gains );
+}
+
 ChannelRouterNode::RouteConnector::RouteConnector( const ChannelRouterNodeRef &outputRouter, size_t inputChannelIndex, size_t outputChannelIndex )
 : mOutputRouter( outputRouter ), mInputChannelIndex( inputChannelIndex ), mOutputChannelIndex( outputChannelIndex ), mNumChannels( numeric_limits<size_t>::max() )
 {
@@ -52,8 +181,18 @@ ChannelRouterNode::RouteConnector::RouteConnector( const ChannelRouterNodeRef &o
 {
 }
 
+ChannelRouterNode::RouteConnector::RouteConnector( const ChannelRouterNodeRef &outputRouter, const GainMatrix &gains )
+: mOutputRouter( outputRouter ), mInputChannelIndex( 0 ), mOutputChannelIndex( 0 ), mNumChannels( gains.getNumOutputChannels() ), mGains( new GainMatrix( gains ) )
+{
+}
+
 const ChannelRouterNodeRef& operator>>( const NodeRef &input, const ChannelRouterNode::RouteConnector &route )
 {
+	if( route.getGains() ) {
+		route.getOutputRouter()->addInputMatrix( input, *route.getGains() );
+		return route.getOutputRouter();
+	}
+
 	size_t numChannels = route.getNumChannels();
 	if( numChannels == numeric_limits<size_t>::max() )
 		numChannels = min( input->getNumChannels(), route.getOutputRouter()->getNumChannels() - route.getOutputChannelIndex() );
@@ -62,6 +201,11 @@ const ChannelRouterNodeRef& operator>>( const NodeRef &input, const ChannelRoute
 	return route.getOutputRouter();
 }
 
+void ChannelRouterNode::initialize()
+{
+	mRampBuffer = Buffer( getFramesPerBlock() );
+}
+
 bool ChannelRouterNode::supportsInputNumChannels( size_t numChannels ) const
 {
 	return true;
@@ -90,6 +234,118 @@ void ChannelRouterNode::addInputRoute( const NodeRef &input, size_t inputChannel
 	mRoutes.push_back( route );
 }
 
+void ChannelRouterNode::addInputMatrix( const NodeRef &input, const GainMatrix &gains )
+{
+	CI_ASSERT_MSG( input, "bad input" );
+	CI_ASSERT_MSG( gains.getNumOutputChannels() == getNumChannels(), "GainMatrix must have one row per channel." );
+
+	Route route;
+	route.mInput = input;
+	route.mInputChannelIndex = route.mOutputChannelIndex = 0;
+	route.mNumChannels = gains.getNumOutputChannels();
+	route.mMatrix = make_shared<MatrixGains>();
+	setMatrixGains( route.mMatrix.get(), gains, gains );
+
+	input->connect( shared_from_this() );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	mRoutes.push_back( route );
+}
+
+void ChannelRouterNode::setInputGains( const NodeRef &input, const GainMatrix &gains, float rampSeconds, const RampFn &rampFn )
+{
+	CI_ASSERT_MSG( gains.getNumOutputChannels() == getNumChannels(), "GainMatrix must have one row per channel." );
+
+	auto ctx = getContext();
+	lock_guard<mutex> lock( ctx->getMutex() );
+
+	Route *route = findRoute( input );
+	if( ! route || ! route->mMatrix )
+		return;
+
+	MatrixGains *matrix = route->mMatrix.get();
+	const uint64_t currentFrame = ctx->getNumProcessedFrames();
+	const size_t rampNumFrames = size_t( std::max( 0.0f, rampSeconds ) * (float)ctx->getSampleRate() );
+	if( ! rampNumFrames ) {
+		setMatrixGains( matrix, gains, gains );
+		return;
+	}
+
+	// ramp from the gains that are currently applied
+	GainMatrix gainsBegin( gains.getNumInputChannels(), gains.getNumOutputChannels() );
+	float rampValue = matrix->mIsRamping ? evalRamp( matrix->mRampFn, float( currentFrame - matrix->mRampBeginFrame ) / float( matrix->mRampNumFrames ) ) : 0;
+	for( size_t row = 0; row + 1 < matrix->mRowBegin.size(); row++ ) {
+		for( size_t i = matrix->mRowBegin[row]; i < matrix->mRowBegin[row + 1]; i++ ) {
+			size_t inputChannel = matrix->mInputChannels[i];
+			if( inputChannel < gainsBegin.getNumInputChannels() )
+				gainsBegin.setGain( inputChannel, row, matrix->mGains[i] + rampValue * matrix->mGainDeltas[i] );
+		}
+	}
+
+	setMatrixGains( matrix, gainsBegin, gains );
+
+	if( matrix->mRampedInput.getNumChannels() < gains.getNumInputChannels() || matrix->mRampedInput.getNumFrames() != getFramesPerBlock() )
+		matrix->mRampedInput = Buffer( getFramesPerBlock(), gains.getNumInputChannels() );
+
+	matrix->mRampFn = rampFn;
+	matrix->mRampBeginFrame = currentFrame;
+	matrix->mRampNumFrames = rampNumFrames;
+	matrix->mIsRamping = true;
+}
+
+GainMatrix ChannelRouterNode::getInputGains( const NodeRef &input ) const
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	for( const auto &route : mRoutes ) {
+		if( route.mInput == input && route.mMatrix )
+			return route.mMatrix->mTarget;
+	}
+
+	return GainMatrix();
+}
+
+ChannelRouterNode::Route* ChannelRouterNode::findRoute( const NodeRef &input )
+{
+	for( auto &route : mRoutes ) {
+		if( route.mInput == input )
+			return &route;
+	}
+
+	return nullptr;
+}
+
+void ChannelRouterNode::setMatrixGains( MatrixGains *matrix, const GainMatrix &gainsBegin, const GainMatrix &gainsEnd )
+{
+	const size_t numInputChannels = gainsEnd.getNumInputChannels();
+	const size_t numOutputChannels = gainsEnd.getNumOutputChannels();
+
+	matrix->mTarget = gainsEnd;
+	matrix->mRowBegin.clear();
+	matrix->mInputChannels.clear();
+	matrix->mGains.clear();
+	matrix->mGainDeltas.clear();
+	matrix->mIsRamping = false;
+
+	// only gains that are non-zero at either end are stored
+	for( size_t row = 0; row < numOutputChannels; row++ ) {
+		matrix->mRowBegin.push_back( matrix->mInputChannels.size() );
+
+		const float *rowBegin = gainsBegin.getRow( row );
+		const float *rowEnd = gainsEnd.getRow( row );
+		for( size_t inputChannel = 0; inputChannel < numInputChannels; inputChannel++ ) {
+			if( rowBegin[inputChannel] == 0 && rowEnd[inputChannel] == 0 )
+				continue;
+
+			matrix->mInputChannels.push_back( inputChannel );
+			matrix->mGains.push_back( rowBegin[inputChannel] );
+			matrix->mGainDeltas.push_back( rowEnd[inputChannel] - rowBegin[inputChannel] );
+		}
+	}
+
+	matrix->mRowBegin.push_back( matrix->mInputChannels.size() );
+}
+
 void ChannelRouterNode::disconnectInput( const NodeRef &input )
 {
 	Node::disconnectInput( input );
@@ -128,6 +384,11 @@ void ChannelRouterNode::sumInputs()
 
 		const Buffer *processedBuffer = input->getProcessesInPlace() ? summingBuffer : input->getInternalBuffer();
 
+		if( route.mMatrix ) {
+			mixMatrix( route.mMatrix.get(), processedBuffer, internalBuffer );
+			continue;
+		}
+
 		for( size_t ch = 0; ch < route.mNumChannels; ch++ ) {
 			float *destChannel = internalBuffer->getChannel( ch + route.mOutputChannelIndex );
 			dsp::add( destChannel, processedBuffer->getChannel( ch + route.mInputChannelIndex ), destChannel, numFrames );
@@ -135,4 +396,40 @@ void ChannelRouterNode::sumInputs()
 	}
 }
 
+void ChannelRouterNode::mixMatrix( MatrixGains *matrix, const Buffer *sourceBuffer, Buffer *destBuffer )
+{
+	const size_t numFrames = destBuffer->getNumFrames();
+	const uint64_t rampFrame = matrix->mIsRamping ? getContext()->getNumProcessedFrames() - matrix->mRampBeginFrame : 0;
+
+	if( matrix->mIsRamping ) {
+		if( rampFrame >= matrix->mRampNumFrames ) {
+			// the ramp is complete, the end gains are applied from now on
+			for( size_t i = 0; i < matrix->mGains.size(); i++ ) {
+				matrix->mGains[i] += matrix->mGainDeltas[i];
+				matrix->mGainDeltas[i] = 0;
+			}
+
+			matrix->mIsRamping = false;
+		}
+	}
+
+	mixRows( matrix->mRowBegin, matrix->mInputChannels, matrix->mGains.data(), sourceBuffer, sourceBuffer->getNumChannels(), destBuffer, numFrames );
+
+	if( ! matrix->mIsRamping )
+		return;
+
+	// gains = begin + ramp * delta, so the deltas are applied to the input scaled by the ramp curve
+	const size_t rampCount = (size_t)min<uint64_t>( numFrames, matrix->mRampNumFrames - rampFrame );
+	float *ramp = mRampBuffer.getData();
+	matrix->mRampFn( ramp, rampCount, float( rampFrame ) / float( matrix->mRampNumFrames ), 1.0f / float( matrix->mRampNumFrames ), make_pair( 0.0f, 1.0f ) );
+	dsp::fill( 1, ramp + rampCount, numFrames - rampCount );
+
+	Buffer *rampedInput = &matrix->mRampedInput;
+	const size_t numChannels = min( sourceBuffer->getNumChannels(), rampedInput->getNumChannels() );
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		dsp::mul( sourceBuffer->getChannel( ch ), ramp, rampedInput->getChannel( ch ), numFrames );
+
+	mixRows( matrix->mRowBegin, matrix->mInputChannels, matrix->mGainDeltas.data(), rampedInput, numChannels, destBuffer, numFrames );
+}
+
 } } // namespace cinder::audio
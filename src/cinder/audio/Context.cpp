@@ -30,7 +30,10 @@
 #include "cinder/Cinder.h"
 #include "cinder/app/App.h"
 
+#include <algorithm>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 
 #if defined( CINDER_COCOA )
 	#include "cinder/audio/cocoa/ContextAudioUnit.h"
@@ -54,6 +57,21 @@ std::unique_ptr<DeviceManager>	Context::sDeviceManager;
 
 bool sIsRegisteredForShutdown = false;
 
+namespace {
+
+const size_t MAX_SCHEDULED_EVENTS = 4096;
+const size_t SUMMING_ARENA_ALIGNMENT = 64 / sizeof( float ); // in samples, each summing buffer begins on a cache line
+
+// Returns the number of samples reserved for \a node's summing buffer, which also holds the pulled inputs of a ChannelRouterNode.
+size_t getSummingCapacity( const Node *node, size_t framesPerBlock )
+{
+	size_t numChannels = max( node->getNumChannels(), node->getMaxNumInputChannels() );
+	size_t result = framesPerBlock * numChannels;
+	return ( result + SUMMING_ARENA_ALIGNMENT - 1 ) & ~( SUMMING_ARENA_ALIGNMENT - 1 );
+}
+
+} // anonymous namespace
+
 // static
 void Context::registerClearStatics()
 {
@@ -117,15 +135,37 @@ void Context::setMaster( Context *masterContext, DeviceManager *deviceManager )
 }
 
 Context::Context()
-	: mEnabled( false ), mAutoPullRequired( false ), mAutoPullCacheDirty( false ), mNumProcessedFrames( 0 )
+	: mEnabled( false ), mAutoPullRequired( false ), mAutoPullCacheDirty( false ), mNumProcessedFrames( 0 ), mActiveProfiler( nullptr ), mSummingArenaSize( 0 ),
+		mScheduledEvents( MAX_SCHEDULED_EVENTS ), mNextEventSequence( 0 ), mPendingEventIndices( MAX_SCHEDULED_EVENTS ), mRetiredEventIndices( MAX_SCHEDULED_EVENTS ),
+		mIsEventReleaseClient( false )
 {
+	// all storage used by the audio thread for scheduled events is allocated up front
+	mFreeEventIndices.reserve( MAX_SCHEDULED_EVENTS );
+	for( size_t i = 0; i < MAX_SCHEDULED_EVENTS; i++ )
+		mFreeEventIndices.push_back( uint32_t( MAX_SCHEDULED_EVENTS - 1 - i ) );
+
+	mEventHeap.reserve( MAX_SCHEDULED_EVENTS );
+	mFiringEventIndices.reserve( MAX_SCHEDULED_EVENTS );
+	mDeferredEventIndices.reserve( MAX_SCHEDULED_EVENTS );
 }
 
 Context::~Context()
 {
 	disable();
+	setProfilingEnabled( false );
+
+	if( mIsEventReleaseClient )
+		FileStreamScheduler::get()->removeClient( this );
+
 	lock_guard<mutex> lock( mMutex );
 	uninitializeAllNodes();
+
+	// Node's may outlive the Context, so they can't continue to reference its arena
+	for( const auto &weakNode : mSummingArenaNodes ) {
+		NodeRef node = weakNode.lock();
+		if( node )
+			node->mSummingBuffer = BufferDynamic();
+	}
 }
 
 void Context::enable()
@@ -272,15 +312,52 @@ void Context::removeAutoPulledNode( const NodeRef &node )
 
 void Context::schedule( double when, const NodeRef &node, bool enable, const std::function<void ()> &func )
 {
-	const uint64_t framesPerBlock = (uint64_t)getFramesPerBlock();
-	uint64_t eventFrameThreshold = timeToFrame( when, getSampleRate() );
+	// mScheduleMutex only serializes callers of this method, the audio thread never waits on it.
+	lock_guard<mutex> lock( mScheduleMutex );
 
-	// Place the threshold back one block so we can process the block first, guarding against wrap around
-	if( eventFrameThreshold >= framesPerBlock )
-		eventFrameThreshold -= framesPerBlock;
+	// retired events are released on an I/O thread, which is only started once something is scheduled
+	if( ! mIsEventReleaseClient ) {
+		FileStreamScheduler::get()->addClient( this );
+		mIsEventReleaseClient = true;
+	}
 
-	lock_guard<mutex> lock( mMutex );
-	mScheduledEvents.push_back( ScheduledEvent( eventFrameThreshold, node, enable, func ) );
+	reclaimRetiredEvents();
+	if( mFreeEventIndices.empty() )
+		throw AudioContextExc( "cannot schedule more than " + to_string( MAX_SCHEDULED_EVENTS ) + " pending events." );
+
+	uint32_t eventIndex = mFreeEventIndices.back();
+	mFreeEventIndices.pop_back();
+
+	ScheduledEvent &event = mScheduledEvents[eventIndex];
+	event.mFrame = timeToFrame( when, getSampleRate() );
+	event.mSequence = mNextEventSequence++;
+	event.mNode = node;
+	event.mEnable = enable;
+	event.mFunc = func;
+
+	// there is always room, since the queue holds as many indices as there are events
+	bool written = mPendingEventIndices.write( &eventIndex, 1 );
+	CI_VERIFY( written );
+}
+
+void Context::serviceStream()
+{
+	// called on a FileStreamScheduler thread after a processing block retired events
+	lock_guard<mutex> lock( mScheduleMutex );
+	reclaimRetiredEvents();
+}
+
+void Context::reclaimRetiredEvents()
+{
+	// Called with mScheduleMutex locked. Releasing the event's Node and function here ensures they aren't destroyed on the audio thread.
+	uint32_t eventIndex;
+	while( mRetiredEventIndices.read( &eventIndex, 1 ) ) {
+		ScheduledEvent &event = mScheduledEvents[eventIndex];
+		event.mNode.reset();
+		event.mFunc = nullptr;
+
+		mFreeEventIndices.push_back( eventIndex );
+	}
 }
 
 bool Context::isAudioThread() const
@@ -292,6 +369,10 @@ void Context::preProcess()
 {
 	mAudioThreadId = std::this_thread::get_id();
 
+	Profiler *profiler = getActiveProfiler();
+	if( profiler )
+		profiler->beginBlock( uint64_t( (double)getFramesPerBlock() * 1e9 / (double)getSampleRate() ) );
+
 	preProcessScheduledEvents();
 }
 
@@ -299,9 +380,37 @@ void Context::postProcess()
 {
 	processAutoPulledNodes();
 	postProcessScheduledEvents();
+
+	Profiler *profiler = getActiveProfiler();
+	if( profiler )
+		profiler->endBlock( getNumProcessedFrames() );
+
 	incrementFrameCount();
 }
 
+void Context::setProfilingEnabled( bool enable )
+{
+	if( enable == isProfilingEnabled() )
+		return;
+
+	if( enable ) {
+		mActiveProfiler = getProfiler();
+		Profiler::sNumEnabled++;
+	}
+	else {
+		mActiveProfiler = nullptr;
+		Profiler::sNumEnabled--;
+	}
+}
+
+Profiler* Context::getProfiler()
+{
+	if( ! mProfiler )
+		mProfiler.reset( new Profiler( this ) );
+
+	return mProfiler.get();
+}
+
 void Context::incrementFrameCount()
 {
 	mNumProcessedFrames += getFramesPerBlock();
@@ -322,43 +431,98 @@ void Context::processAutoPulledNodes()
 
 void Context::preProcessScheduledEvents()
 {
-	const uint64_t framesPerBlock = (uint64_t)getFramesPerBlock();
-	const uint64_t numProcessedFrames = mNumProcessedFrames;
+	// the heap is ordered so that the earliest event is at the front, with events on the same frame in the order they were scheduled
+	const auto &events = mScheduledEvents;
+	auto isLater = [&events]( uint32_t a, uint32_t b ) {
+		return events[a].mFrame != events[b].mFrame ? events[a].mFrame > events[b].mFrame : events[a].mSequence > events[b].mSequence;
+	};
+
+	// move newly scheduled events into the heap, which never allocates because it has room for every event
+	uint32_t eventIndex;
+	while( mPendingEventIndices.read( &eventIndex, 1 ) ) {
+		mEventHeap.push_back( eventIndex );
+		push_heap( mEventHeap.begin(), mEventHeap.end(), isLater );
+	}
 
-	for( auto &event : mScheduledEvents ) {
-		if( numProcessedFrames >= event.mEventFrameThreshold ) {
-			uint64_t frameOffset = numProcessedFrames - event.mEventFrameThreshold;
-			if( event.mEnable ) {
-				event.mNode->mProcessFramesRange.first = size_t( framesPerBlock - frameOffset );
-				event.mFunc();
-			}
-			else {
-				// set the process range but don't call its function until postProcess() (which should be disable()'ing the Node)
-				event.mNode->mProcessFramesRange.second = (size_t)frameOffset;
-			}
+	const uint64_t blockBegin = mNumProcessedFrames;
+	const uint64_t blockEnd = blockBegin + (uint64_t)getFramesPerBlock();
+
+	while( ! mEventHeap.empty() && mScheduledEvents[mEventHeap.front()].mFrame < blockEnd ) {
+		pop_heap( mEventHeap.begin(), mEventHeap.end(), isLater );
+		eventIndex = mEventHeap.back();
+		mEventHeap.pop_back();
+
+		ScheduledEvent &event = mScheduledEvents[eventIndex];
+		if( isEventDeferred( event ) ) {
+			mDeferredEventIndices.push_back( eventIndex );
+			continue;
+		}
+
+		// events whose time has already passed take effect at the beginning of the block
+		const size_t frameOffset = event.mFrame > blockBegin ? size_t( event.mFrame - blockBegin ) : 0;
 
-			event.mFinished = true;
+		auto &range = event.mNode->mProcessFramesRange;
+		if( event.mEnable ) {
+			range.first = min( frameOffset, range.second );
+			event.mFunc();
 		}
+		else {
+			// set the process range but don't call its function until postProcess() (which should be disable()'ing the Node)
+			range.second = max( frameOffset, range.first );
+		}
+
+		mFiringEventIndices.push_back( eventIndex );
+	}
+
+	// deferred events have already passed, so they are at the front of the heap next block
+	for( uint32_t deferredIndex : mDeferredEventIndices ) {
+		mEventHeap.push_back( deferredIndex );
+		push_heap( mEventHeap.begin(), mEventHeap.end(), isLater );
 	}
+
+	mDeferredEventIndices.clear();
+}
+
+bool Context::isEventDeferred( const ScheduledEvent &event ) const
+{
+	// once an event for a Node is deferred, all later events for it are too so that they keep their order
+	for( uint32_t eventIndex : mDeferredEventIndices ) {
+		if( mScheduledEvents[eventIndex].mNode == event.mNode )
+			return true;
+	}
+
+	// disable functions are called in postProcess(), so an enable after a disable has to wait until then
+	if( event.mEnable ) {
+		for( uint32_t eventIndex : mFiringEventIndices ) {
+			const ScheduledEvent &firing = mScheduledEvents[eventIndex];
+			if( firing.mNode == event.mNode && ! firing.mEnable )
+				return true;
+		}
+	}
+
+	return false;
 }
 
 void Context::postProcessScheduledEvents()
 {
-	for( auto eventIt = mScheduledEvents.begin(); eventIt != mScheduledEvents.end(); /* */ ) {
-		if( eventIt->mFinished ) {
-			if( ! eventIt->mEnable )
-				eventIt->mFunc();
+	for( uint32_t eventIndex : mFiringEventIndices ) {
+		ScheduledEvent &event = mScheduledEvents[eventIndex];
+		if( ! event.mEnable )
+			event.mFunc();
 
-			// reset process frame range
-			auto &range = eventIt->mNode->mProcessFramesRange;
-			range.first = 0;
-			range.second = getFramesPerBlock();
+		// reset process frame range
+		auto &range = event.mNode->mProcessFramesRange;
+		range.first = 0;
+		range.second = getFramesPerBlock();
 
-			eventIt = mScheduledEvents.erase( eventIt );
-		}
-		else
-			++eventIt;
+		// the event is released on an I/O thread. There is always room, since the queue holds as many indices as there are events.
+		mRetiredEventIndices.write( &eventIndex, 1 );
 	}
+
+	if( ! mFiringEventIndices.empty() )
+		requestService();
+
+	mFiringEventIndices.clear();
 }
 
 const std::vector<Node *>& Context::getAutoPulledNodes()
@@ -371,6 +535,113 @@ const std::vector<Node *>& Context::getAutoPulledNodes()
 	return mAutoPullCache;
 }
 
+// Summing buffers are only in use while their Node sums its inputs within pullInputs(), so the buffers of two Node's can share storage unless
+// one is pulled while the other sums. That happens only when the one is upstream of the other, so each Node is placed in the arena after the
+// summing buffers of all Node's downstream of it, much like a stack frame that is sized for the deepest call that reaches it.
+void Context::updateSummingBuffers()
+{
+	lock_guard<mutex> lock( mMutex );
+
+	vector<Node *> roots;
+	if( mOutput )
+		roots.push_back( mOutput.get() );
+	for( const auto &node : mAutoPulledNodes )
+		roots.push_back( node.get() );
+
+	// Search depth-first through the inputs of each root, listing Node's in post-order (each Node after all of its inputs). The value
+	// in searchedNodes is false while a Node's inputs are being searched, so reaching it again means it is part of a feedback cycle.
+	unordered_map<Node *, bool> searchedNodes;
+	vector<Node *> sortedNodes;
+	vector<pair<Node *, set<NodeRef>::const_iterator> > searchStack;
+	bool hasCycle = false;
+
+	for( Node *root : roots ) {
+		if( searchedNodes.count( root ) )
+			continue;
+
+		searchedNodes[root] = false;
+		searchStack.push_back( make_pair( root, root->mInputs.cbegin() ) );
+		while( ! searchStack.empty() ) {
+			Node *node = searchStack.back().first;
+			auto &inputIt = searchStack.back().second;
+			if( inputIt == node->mInputs.cend() ) {
+				searchedNodes[node] = true;
+				sortedNodes.push_back( node );
+				searchStack.pop_back();
+				continue;
+			}
+
+			Node *input = ( inputIt++ )->get();
+			auto searchedIt = searchedNodes.find( input );
+			if( searchedIt == searchedNodes.end() ) {
+				searchedNodes[input] = false;
+				searchStack.push_back( make_pair( input, input->mInputs.cbegin() ) );
+			}
+			else if( ! searchedIt->second )
+				hasCycle = true;
+		}
+	}
+
+	// Visit outputs before their inputs, placing each input's summing buffer after the buffers of the Node's that pull it. Feedback
+	// cycles can be pulled in an order that this doesn't account for, so Node's in graphs that contain one keep their own buffers.
+	const size_t framesPerBlock = mOutput ? mOutput->getOutputFramesPerBlock() : 0;
+	unordered_map<Node *, size_t> offsets;
+	size_t arenaSize = 0;
+	if( ! hasCycle && framesPerBlock ) {
+		for( auto nodeIt = sortedNodes.rbegin(); nodeIt != sortedNodes.rend(); ++nodeIt ) {
+			Node *node = *nodeIt;
+			size_t end = offsets[node];
+			if( ! node->mProcessInPlace ) {
+				end += getSummingCapacity( node, framesPerBlock );
+				arenaSize = max( arenaSize, end );
+			}
+
+			for( const auto &input : node->mInputs ) {
+				size_t &inputOffset = offsets[input.get()];
+				inputOffset = max( inputOffset, end );
+			}
+		}
+	}
+
+	// only reallocate when the arena must grow, or when it has become much larger than necessary
+	if( arenaSize > mSummingArenaSize || arenaSize < mSummingArenaSize / 2 ) {
+		if( arenaSize )
+			mSummingArena = makeAlignedArray<float>( arenaSize, SUMMING_ARENA_ALIGNMENT * sizeof( float ) );
+		else
+			mSummingArena.reset();
+
+		mSummingArenaSize = arenaSize;
+	}
+
+	vector<weak_ptr<Node> > previousNodes;
+	previousNodes.swap( mSummingArenaNodes );
+
+	unordered_set<Node *> arenaNodes;
+	if( arenaSize ) {
+		for( Node *node : sortedNodes ) {
+			if( node->mProcessInPlace )
+				continue;
+
+			node->mSummingBuffer.setExternalStorage( mSummingArena.get() + offsets[node], getSummingCapacity( node, framesPerBlock ) );
+			node->mSummingBuffer.setSize( framesPerBlock, node->mNumChannels );
+			mSummingArenaNodes.push_back( node->shared_from_this() );
+			arenaNodes.insert( node );
+		}
+	}
+
+	// Node's that were disconnected or now process in-place no longer use the arena. Those that still sum return to owning their buffer.
+	for( const auto &weakNode : previousNodes ) {
+		NodeRef node = weakNode.lock();
+		if( ! node || arenaNodes.count( node.get() ) || node->mSummingBuffer.isDataOwned() )
+			continue;
+
+		if( node->mProcessInPlace )
+			node->mSummingBuffer = BufferDynamic();
+		else
+			node->mSummingBuffer.setExternalStorage( nullptr, 0 );
+	}
+}
+
 namespace {
 
 void printRecursive( ostream &stream, const NodeRef &node, size_t depth, set<NodeRef> &traversedNodes )
@@ -0,0 +1,417 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/ConvolverNode.h"
+#include "cinder/audio/Context.h"
+#include "cinder/audio/dsp/Fft.h"
+
+#include <chrono>
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+const size_t PARTITION_GROWTH_FACTOR = 4;
+
+// Multiplies the spectra \a a and \a b and adds the result to \a accum. The DC and nyquist bins are real and packed into bin zero.
+void multiplyAccumulate( const BufferSpectral &a, const BufferSpectral &b, BufferSpectral *accum )
+{
+	const float *aReal = a.getReal();
+	const float *aImag = a.getImag();
+	const float *bReal = b.getReal();
+	const float *bImag = b.getImag();
+	float *real = accum->getReal();
+	float *imag = accum->getImag();
+
+	real[0] += aReal[0] * bReal[0];
+	imag[0] += aImag[0] * bImag[0];
+
+	const size_t numBins = accum->getNumFrames();
+	for( size_t k = 1; k < numBins; k++ ) {
+		real[k] += aReal[k] * bReal[k] - aImag[k] * bImag[k];
+		imag[k] += aReal[k] * bImag[k] + aImag[k] * bReal[k];
+	}
+}
+
+} // anonymous namespace
+
+// MARK: - ConvolverNode::Segment
+
+// Uniformly partitioned overlap-save convolution of the impulse response range [offset, offset + numPartitions * partitionSize)
+// with a frequency-domain delay line. Tail segments exchange partitions with the worker thread through two slots that are
+// handed back and forth by sequence number, which is safe because a segment's output is not needed until two partitions
+// after its input has been submitted.
+struct ConvolverNode::Segment {
+	Segment( const Buffer &impulseResponse, size_t partitionSize, size_t offset, size_t length, size_t numChannels, bool isTail );
+
+	//! Convolves one partition of \a input, writing (not summing) the result to \a output. Both are partitionSize frames.
+	void convolve( const Buffer &input, Buffer *output );
+
+	//! Called on the audio thread: sums the worker's output for the block starting at \a frame into \a buffer.
+	bool readTail( Buffer *buffer, uint64_t frame );
+	//! Called on the audio thread: collects \a input and submits it once a full partition is available. Returns true if a partition was submitted.
+	bool writeTail( const Buffer &input, uint64_t *lastUnderrun, uint64_t frame );
+	//! Called on the worker thread: convolves all partitions that were submitted. Returns true if any work was done.
+	bool processTail();
+
+	bool hasPendingTail() const		{ return mNumProcessed.load( memory_order_acquire ) < mNumSubmitted.load( memory_order_acquire ); }
+
+	size_t	mPartitionSize, mOffset, mNumPartitions, mFdlPos;
+
+	unique_ptr<dsp::Fft>			mFft;
+	vector<BufferSpectral>			mImpulseResponseSpectra;	// [irChannel * mNumPartitions + partition]
+	vector<BufferSpectral>			mFdl;						// [channel * mNumPartitions + partition], circular in partition
+	vector<Buffer>					mInputWindows;				// one per channel, the previous and current partition
+	vector<size_t>					mChannelMap;				// channel -> impulse response channel
+	BufferSpectral					mAccum;
+	Buffer							mTimeDomain;
+
+	static const size_t NUM_SLOTS = 2;
+
+	Buffer							mInputAccum, mZeroInput;
+	size_t							mInputAccumPos;
+	uint64_t						mNumSubmittedLocal;
+	Buffer							mInputSlots[NUM_SLOTS], mOutputSlots[NUM_SLOTS];
+	atomic<uint64_t>				mInputSlotSeq[NUM_SLOTS], mOutputSlotSeq[NUM_SLOTS];	// sequence number + 1 of the partition in the slot
+	atomic<uint64_t>				mNumSubmitted, mNumProcessed;
+};
+
+ConvolverNode::Segment::Segment( const Buffer &impulseResponse, size_t partitionSize, size_t offset, size_t length, size_t numChannels, bool isTail )
+	: mPartitionSize( partitionSize ), mOffset( offset ), mFdlPos( 0 ), mInputAccumPos( 0 ), mNumSubmittedLocal( 0 ), mNumSubmitted( 0 ), mNumProcessed( 0 )
+{
+	const size_t fftSize = partitionSize * 2;
+	const size_t numIrChannels = impulseResponse.getNumChannels();
+
+	mNumPartitions = ( length + partitionSize - 1 ) / partitionSize;
+	mFft.reset( new dsp::Fft( fftSize ) );
+	mAccum = BufferSpectral( fftSize );
+	mTimeDomain = Buffer( fftSize );
+
+	for( size_t ch = 0; ch < numIrChannels; ch++ ) {
+		const float *irChannel = impulseResponse.getChannel( ch );
+		for( size_t p = 0; p < mNumPartitions; p++ ) {
+			size_t begin = offset + p * partitionSize;
+			size_t numFrames = min( partitionSize, offset + length - begin );
+
+			mTimeDomain.zero();
+			memcpy( mTimeDomain.getData(), irChannel + begin, numFrames * sizeof( float ) );
+
+			mImpulseResponseSpectra.emplace_back( fftSize );
+			mFft->forward( &mTimeDomain, &mImpulseResponseSpectra.back() );
+		}
+	}
+
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		mChannelMap.push_back( min( ch, numIrChannels - 1 ) );
+		mInputWindows.emplace_back( fftSize );
+		for( size_t p = 0; p < mNumPartitions; p++ ) {
+			mFdl.emplace_back( fftSize );
+			mFdl.back().zero();
+		}
+	}
+
+	if( isTail ) {
+		mInputAccum = Buffer( partitionSize, numChannels );
+		mZeroInput = Buffer( partitionSize, numChannels );
+		for( size_t i = 0; i < NUM_SLOTS; i++ ) {
+			mInputSlots[i] = Buffer( partitionSize, numChannels );
+			mOutputSlots[i] = Buffer( partitionSize, numChannels );
+			mInputSlotSeq[i] = 0;
+			mOutputSlotSeq[i] = 0;
+		}
+	}
+}
+
+void ConvolverNode::Segment::convolve( const Buffer &input, Buffer *output )
+{
+	const size_t partitionSize = mPartitionSize;
+	const size_t numChannels = mChannelMap.size();
+
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		// slide the input window by one partition and transform it into the newest slot of the delay line
+		float *window = mInputWindows[ch].getData();
+		memmove( window, window + partitionSize, partitionSize * sizeof( float ) );
+		memcpy( window + partitionSize, input.getChannel( ch ), partitionSize * sizeof( float ) );
+
+		BufferSpectral *fdl = &mFdl[ch * mNumPartitions];
+		mFft->forward( &mInputWindows[ch], &fdl[mFdlPos] );
+
+		mAccum.zero();
+		const BufferSpectral *irSpectra = &mImpulseResponseSpectra[mChannelMap[ch] * mNumPartitions];
+		for( size_t p = 0; p < mNumPartitions; p++ ) {
+			size_t fdlIndex = ( mFdlPos + mNumPartitions - p ) % mNumPartitions;
+			multiplyAccumulate( fdl[fdlIndex], irSpectra[p], &mAccum );
+		}
+
+		// overlap-save: the first half of the inverse transform is circular aliasing and is discarded
+		mFft->inverse( &mAccum, &mTimeDomain );
+		memcpy( output->getChannel( ch ), mTimeDomain.getData() + partitionSize, partitionSize * sizeof( float ) );
+	}
+
+	mFdlPos = ( mFdlPos + 1 ) % mNumPartitions;
+}
+
+bool ConvolverNode::Segment::readTail( Buffer *buffer, uint64_t frame )
+{
+	if( frame < mOffset )
+		return true;
+
+	const uint64_t seq = ( frame - mOffset ) / mPartitionSize;
+	const size_t pos = size_t( ( frame - mOffset ) % mPartitionSize );
+	const size_t slot = size_t( seq % NUM_SLOTS );
+
+	if( mOutputSlotSeq[slot].load( memory_order_acquire ) != seq + 1 )
+		return false;
+
+	const Buffer &output = mOutputSlots[slot];
+	for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ )
+		dsp::add( buffer->getChannel( ch ), output.getChannel( ch ) + pos, buffer->getChannel( ch ), buffer->getNumFrames() );
+
+	return true;
+}
+
+bool ConvolverNode::Segment::writeTail( const Buffer &input, uint64_t *lastUnderrun, uint64_t frame )
+{
+	const size_t numFrames = input.getNumFrames();
+	for( size_t ch = 0; ch < input.getNumChannels(); ch++ )
+		memcpy( mInputAccum.getChannel( ch ) + mInputAccumPos, input.getChannel( ch ), numFrames * sizeof( float ) );
+
+	mInputAccumPos += numFrames;
+	if( mInputAccumPos < mPartitionSize )
+		return false;
+
+	mInputAccumPos = 0;
+
+	// only hand off the partition if the worker is done with the slot, otherwise it convolves silence in its place
+	const uint64_t seq = mNumSubmittedLocal++;
+	const size_t slot = size_t( seq % NUM_SLOTS );
+	if( seq - mNumProcessed.load( memory_order_acquire ) < NUM_SLOTS ) {
+		mInputSlots[slot].copy( mInputAccum );
+		mInputSlotSeq[slot].store( seq + 1, memory_order_release );
+	}
+	else
+		*lastUnderrun = frame;
+
+	mNumSubmitted.store( mNumSubmittedLocal, memory_order_release );
+	return true;
+}
+
+bool ConvolverNode::Segment::processTail()
+{
+	bool didWork = false;
+	uint64_t seq = mNumProcessed.load( memory_order_relaxed );
+	while( seq < mNumSubmitted.load( memory_order_acquire ) ) {
+		const size_t slot = size_t( seq % NUM_SLOTS );
+		const Buffer &input = mInputSlotSeq[slot].load( memory_order_acquire ) == seq + 1 ? mInputSlots[slot] : mZeroInput;
+
+		convolve( input, &mOutputSlots[slot] );
+		mOutputSlotSeq[slot].store( seq + 1, memory_order_release );
+		mNumProcessed.store( ++seq, memory_order_release );
+		didWork = true;
+	}
+
+	return didWork;
+}
+
+// MARK: - ConvolverNode
+
+ConvolverNode::ConvolverNode( const Format &format )
+	: Node( format ), mMaxPartitionSize( 8192 ), mNumFramesConvolved( 0 ), mWorkerShouldQuit( false ), mLastUnderrun( 0 )
+{
+}
+
+ConvolverNode::ConvolverNode( const BufferRef &impulseResponse, const Format &format )
+	: Node( format ), mImpulseResponse( impulseResponse ), mMaxPartitionSize( 8192 ), mNumFramesConvolved( 0 ), mWorkerShouldQuit( false ), mLastUnderrun( 0 )
+{
+}
+
+ConvolverNode::~ConvolverNode()
+{
+	stopWorkerThread();
+}
+
+void ConvolverNode::initialize()
+{
+	mInputBuffer = Buffer( getFramesPerBlock(), getNumChannels() );
+	mSegments = makeSegments( mImpulseResponse );
+	mNumFramesConvolved = 0;
+
+	startWorkerThread();
+}
+
+void ConvolverNode::uninitialize()
+{
+	stopWorkerThread();
+	mSegments.clear();
+}
+
+void ConvolverNode::setImpulseResponse( const BufferRef &impulseResponse )
+{
+	if( ! isInitialized() ) {
+		mImpulseResponse = impulseResponse;
+		return;
+	}
+
+	// the partitions are transformed before taking the lock, so processing isn't blocked while doing so
+	auto segments = makeSegments( impulseResponse );
+
+	stopWorkerThread();
+	{
+		lock_guard<mutex> lock( getContext()->getMutex() );
+
+		mImpulseResponse = impulseResponse;
+		mSegments.swap( segments );
+		mNumFramesConvolved = 0;
+	}
+	startWorkerThread();
+}
+
+void ConvolverNode::loadImpulseResponse( const SourceFileRef &sourceFile )
+{
+	size_t sampleRate = getSampleRate();
+	if( sampleRate == sourceFile->getSampleRate() )
+		setImpulseResponse( sourceFile->loadBuffer() );
+	else {
+		auto sf = sourceFile->cloneWithSampleRate( sampleRate );
+		setImpulseResponse( sf->loadBuffer() );
+	}
+}
+
+uint64_t ConvolverNode::getLastUnderrun()
+{
+	uint64_t result = mLastUnderrun;
+	mLastUnderrun = 0;
+	return result;
+}
+
+vector<unique_ptr<ConvolverNode::Segment> > ConvolverNode::makeSegments( const BufferRef &impulseResponse ) const
+{
+	vector<unique_ptr<Segment> > result;
+	if( ! impulseResponse || ! impulseResponse->getNumFrames() || ! impulseResponse->getNumChannels() )
+		return result;
+
+	const size_t framesPerBlock = getFramesPerBlock();
+	const size_t numChannels = getNumChannels();
+	const size_t length = impulseResponse->getNumFrames();
+
+	// A tail segment with partition size P can start at 2P into the impulse response: its input is complete P frames
+	// later and the worker then has at least another P frames to finish before the output is needed. The head covers
+	// everything before the first tail segment.
+	size_t partitionSize = framesPerBlock * PARTITION_GROWTH_FACTOR;
+	size_t end = min( length, partitionSize * 2 );
+	result.emplace_back( new Segment( *impulseResponse, framesPerBlock, 0, end, numChannels, false ) );
+
+	while( end < length ) {
+		size_t offset = end;
+		size_t nextPartitionSize = partitionSize * PARTITION_GROWTH_FACTOR;
+		end = nextPartitionSize <= mMaxPartitionSize ? min( length, nextPartitionSize * 2 ) : length;
+
+		result.emplace_back( new Segment( *impulseResponse, partitionSize, offset, end - offset, numChannels, true ) );
+		partitionSize = nextPartitionSize;
+	}
+
+	return result;
+}
+
+void ConvolverNode::process( Buffer *buffer )
+{
+	if( mSegments.empty() )
+		return;
+
+	const uint64_t frame = mNumFramesConvolved;
+	mInputBuffer.copy( *buffer );
+
+	mSegments[0]->convolve( mInputBuffer, buffer );
+
+	bool submitted = false;
+	for( size_t i = 1; i < mSegments.size(); i++ ) {
+		auto &segment = mSegments[i];
+		if( ! segment->readTail( buffer, frame ) )
+			mLastUnderrun = getContext()->getNumProcessedFrames();
+
+		uint64_t lastUnderrun = 0;
+		submitted |= segment->writeTail( mInputBuffer, &lastUnderrun, getContext()->getNumProcessedFrames() );
+		if( lastUnderrun )
+			mLastUnderrun = lastUnderrun;
+	}
+
+	mNumFramesConvolved += buffer->getNumFrames();
+
+	if( submitted )
+		mWorkerCond.notify_one();
+}
+
+void ConvolverNode::startWorkerThread()
+{
+	if( mSegments.size() < 2 || mWorkerThread )
+		return;
+
+	mWorkerShouldQuit = false;
+	mWorkerThread.reset( new thread( bind( &ConvolverNode::workerThreadImpl, this ) ) );
+}
+
+void ConvolverNode::stopWorkerThread()
+{
+	if( ! mWorkerThread )
+		return;
+
+	{
+		lock_guard<mutex> lock( mWorkerMutex );
+		mWorkerShouldQuit = true;
+	}
+	mWorkerCond.notify_one();
+	mWorkerThread->join();
+	mWorkerThread.reset();
+}
+
+void ConvolverNode::workerThreadImpl()
+{
+	// The audio thread notifies without taking mWorkerMutex, so the wait also times out every block in case a notification was missed.
+	const auto timeout = chrono::microseconds( uint64_t( 1000000.0 * getFramesPerBlock() / getSampleRate() ) );
+
+	auto hasPendingWork = [this] {
+		for( size_t i = 1; i < mSegments.size(); i++ ) {
+			if( mSegments[i]->hasPendingTail() )
+				return true;
+		}
+		return false;
+	};
+
+	while( true ) {
+		{
+			unique_lock<mutex> lock( mWorkerMutex );
+			mWorkerCond.wait_for( lock, timeout, [&] { return mWorkerShouldQuit || hasPendingWork(); } );
+
+			if( mWorkerShouldQuit )
+				return;
+		}
+
+		// smaller partitions have the earlier deadlines, so they are processed first
+		for( size_t i = 1; i < mSegments.size(); i++ )
+			mSegments[i]->processTail();
+	}
+}
+
+} } // namespace cinder::audio
@@ -22,11 +22,17 @@
  */
 
 #include "cinder/audio/DelayNode.h"
-#include "cinder/audio/Utilities.h" // currently for lroundf TODO: remove once this is moved to CinderMath
 #include "cinder/audio/Debug.h"
 #include "cinder/audio/Context.h"
+#include "cinder/audio/dsp/Dsp.h"
 #include "cinder/CinderMath.h"
 
+#if defined( CINDER_AUDIO_SSE )
+	#include <emmintrin.h>
+#endif
+
+#include <cstring>
+
 using namespace ci;
 using namespace std;
 
@@ -34,24 +40,74 @@ namespace cinder { namespace audio {
 
 namespace {
 
-inline float interpLinear( const float *array, size_t arraySize, float readPos )
+// Extra frames in the delay line, beyond the max delay and the block that is written before reading, for the interpolation taps.
+const size_t NUM_GUARD_FRAMES = 3;
+
+// Linear interpolation between array[i0] and array[i1] (the newer sample), weighted by frac.
+void readLinear( const float *array, const uint32_t *indices, const float *fractions, size_t arraySize, float *result, size_t numFrames )
+{
+	for( size_t i = 0; i < numFrames; i++ ) {
+		const size_t i0 = indices[i];
+		size_t i1 = i0 + 1;
+		if( i1 == arraySize )
+			i1 = 0;
+
+		const float val0 = array[i0];
+		result[i] = val0 + fractions[i] * ( array[i1] - val0 );
+	}
+}
+
+// Four-point, third order Hermite (Catmull-Rom) interpolation between array[i0] and array[i0 + 1].
+void readCubic( const float *array, const uint32_t *indices, const float *fractions, size_t arraySize, float *result, size_t numFrames )
 {
-	size_t index1 = (size_t)readPos;
-	size_t index2 = ( index1 + 1 ) % arraySize;
-	float val1 = array[index1];
-	float val2 = array[index2];
-	float frac = readPos - (float)index1;
+	for( size_t i = 0; i < numFrames; i++ ) {
+		const size_t i0 = indices[i];
+		const size_t im1 = ( i0 == 0 ? arraySize : i0 ) - 1;
+		size_t i1 = i0 + 1;
+		if( i1 == arraySize )
+			i1 = 0;
+		size_t i2 = i1 + 1;
+		if( i2 == arraySize )
+			i2 = 0;
+
+		const float xm1 = array[im1];
+		const float x0 = array[i0];
+		const float x1 = array[i1];
+		const float x2 = array[i2];
+		const float f = fractions[i];
+
+		const float c1 = 0.5f * ( x1 - xm1 );
+		const float c2 = xm1 - 2.5f * x0 + 2 * x1 - 0.5f * x2;
+		const float c3 = 0.5f * ( x2 - xm1 ) + 1.5f * ( x0 - x1 );
+		result[i] = ( ( c3 * f + c2 ) * f + c1 ) * f + x0;
+	}
+}
 
-	return val2 + frac * ( val2 - val1 );
+// First order allpass interpolation, which delays array[i0 + 1] by ( 1 - frac ) frames. The filter is recursive so
+// the previous output is carried over between blocks in *state.
+void readAllpass( const float *array, const uint32_t *indices, const float *fractions, size_t arraySize, float *state, float *result, size_t numFrames )
+{
+	float prev = *state;
+	for( size_t i = 0; i < numFrames; i++ ) {
+		const size_t i0 = indices[i];
+		size_t i1 = i0 + 1;
+		if( i1 == arraySize )
+			i1 = 0;
+
+		const float f = fractions[i];
+		const float eta = f / ( 2 - f );
+		prev = eta * ( array[i1] - prev ) + array[i0];
+		result[i] = prev;
+	}
+
+	*state = prev;
 }
 
 } // anonymous namespace
 
 DelayNode::DelayNode( const Format &format )
-	: Node( format ), mParamDelaySeconds( this, 0 ), mWriteIndex( 0 ), mSampleRate( 0 ), mMaxDelaySeconds( 0 )
+	: Node( format ), mParamDelaySeconds( this, 0 ), mWriteIndex( 0 ), mSampleRate( 0 ), mMaxDelaySeconds( 0 ), mInterpolation( Interpolation::LINEAR )
 {
-	setNumChannels( 1 );
-	setChannelMode( ChannelMode::SPECIFIED );
 }
 
 void DelayNode::setDelaySeconds( float seconds )
@@ -66,9 +122,10 @@ void DelayNode::setDelaySeconds( float seconds )
 
 void DelayNode::setMaxDelaySeconds( float seconds )
 {
-	size_t delayFrames = lroundf( seconds * getSampleRate() );
+	size_t delayFrames = (size_t)ceil( seconds * getSampleRate() );
 
-	size_t delayBufferFrames = max( getFramesPerBlock(), delayFrames ) + 1;
+	// The block is written before it is read, so room is needed for the max delay plus one block, along with the interpolation taps.
+	size_t delayBufferFrames = delayFrames + getFramesPerBlock() + NUM_GUARD_FRAMES;
 
 	mDelayBuffer.setSize( delayBufferFrames, getNumChannels() );
 	mDelayBuffer.zero();
@@ -82,6 +139,7 @@ void DelayNode::clearBuffer()
 	lock_guard<mutex> lock( getContext()->getMutex() );
 
 	mDelayBuffer.zero();
+	fill( mAllpassStates.begin(), mAllpassStates.end(), 0.0f );
 }
 
 void DelayNode::initialize()
@@ -89,61 +147,136 @@ void DelayNode::initialize()
 	mSampleRate = (float)getSampleRate();
 	mWriteIndex = 0;
 
-	if( mDelayBuffer.getNumChannels() != getNumChannels() )
-		mDelayBuffer.setNumChannels( getNumChannels() );
+	// the samplerate, frames per block or channel count may have changed since the delay buffer was last sized.
+	setMaxDelaySeconds( mMaxDelaySeconds );
 
-	mDelayBuffer.zero();
+	const size_t framesPerBlock = getFramesPerBlock();
+	mDelayFrames.resize( framesPerBlock );
+	mReadFractions.resize( framesPerBlock );
+	mReadIndices.resize( framesPerBlock );
+	mAllpassStates.assign( getNumChannels(), 0.0f );
 }
 
 void DelayNode::process( Buffer *buffer )
 {
-	const float sampleRate = mSampleRate;
 	const size_t numFrames = buffer->getNumFrames();
+	const size_t numChannels = buffer->getNumChannels();
 	const size_t delayBufferFrames = mDelayBuffer.getNumFrames();
-	float *inChannel = buffer->getData();
-	float *delayChannel = mDelayBuffer.getData();
+	const size_t writeIndex = mWriteIndex;
 
-	// currently doesn't support delay buffer size smaller than one processing block.
-	// TODO: with more work this can support smaller delay sizes (and more effects).
-	if( delayBufferFrames < numFrames )
+	if( delayBufferFrames < numFrames + NUM_GUARD_FRAMES || mDelayBuffer.getNumChannels() != numChannels )
 		return;
 
-	size_t writeIndex = mWriteIndex;
+	// Write the entire block first, so that delays shorter than one block can read from it.
+	const size_t framesBeforeWrap = min( numFrames, delayBufferFrames - writeIndex );
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		const float *inChannel = buffer->getChannel( ch );
+		float *delayChannel = mDelayBuffer.getChannel( ch );
 
-	if( mParamDelaySeconds.eval() ) {
-		const float *delaySecondsArray = mParamDelaySeconds.getValueArray();
+		memcpy( delayChannel + writeIndex, inChannel, framesBeforeWrap * sizeof( float ) );
+		if( framesBeforeWrap < numFrames )
+			memcpy( delayChannel, inChannel + framesBeforeWrap, ( numFrames - framesBeforeWrap ) * sizeof( float ) );
+	}
 
-		for( size_t i = 0; i < numFrames; i++ ) {
-			const float delayFrames = delaySecondsArray[i] * sampleRate;
-			float readPos = float( writeIndex + delayBufferFrames ) - delayFrames;
+	if( mParamDelaySeconds.eval() )
+		dsp::mul( mParamDelaySeconds.getValueArray(), mSampleRate, mDelayFrames.data(), numFrames );
+	else
+		dsp::fill( mParamDelaySeconds.getValue() * mSampleRate, mDelayFrames.data(), numFrames );
+
+	const Interpolation interpolation = mInterpolation;
+	computeReadPositions( numFrames, interpolation );
+
+	// The read positions are shared by all channels.
+	const uint32_t *readIndices = mReadIndices.data();
+	const float *readFractions = mReadFractions.data();
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		const float *delayChannel = mDelayBuffer.getChannel( ch );
+		float *outChannel = buffer->getChannel( ch );
+
+		switch( interpolation ) {
+			case Interpolation::LINEAR:
+				readLinear( delayChannel, readIndices, readFractions, delayBufferFrames, outChannel, numFrames );
+				break;
+			case Interpolation::ALLPASS:
+				readAllpass( delayChannel, readIndices, readFractions, delayBufferFrames, &mAllpassStates[ch], outChannel, numFrames );
+				break;
+			case Interpolation::CUBIC:
+				readCubic( delayChannel, readIndices, readFractions, delayBufferFrames, outChannel, numFrames );
+				break;
+		}
+	}
 
-			if( readPos >= delayBufferFrames )
-				readPos -= delayBufferFrames;
-			else if( readPos < 0 )
-				readPos = float( delayBufferFrames - 1 ); // value was over delayBufferFrames, set to last available frame (will cause distortion)
+	mWriteIndex = ( writeIndex + numFrames ) % delayBufferFrames;
+}
 
-			float sample = *inChannel;
-			*inChannel++ = interpLinear( delayChannel, delayBufferFrames, readPos );
+void DelayNode::computeReadPositions( size_t numFrames, Interpolation interpolation )
+{
+	const size_t delayBufferFrames = mDelayBuffer.getNumFrames();
+	const size_t writeIndex = mWriteIndex;
+
+	// Cubic interpolation needs one frame newer than the read position, which must already be written.
+	const float minDelayFrames = interpolation == Interpolation::CUBIC ? 1.0f : 0.0f;
+	// Delays that would read from frames already overwritten by this block are clipped.
+	const float maxDelayFrames = float( delayBufferFrames - numFrames - NUM_GUARD_FRAMES + 1 );
+
+	const float *delayFrames = mDelayFrames.data();
+	float *fractions = mReadFractions.data();
+	uint32_t *indices = mReadIndices.data();
+
+	// Frame i is read from ( writeIndex + i - delay ), which lies between the indices ( writeIndex + i - floor( delay ) - 1 ) and
+	// one frame after it. As the block is no longer than the buffer, the write position ( writeIndex + i ) wraps with one conditional
+	// subtract. The delay is less than the buffer size, so the read index then wraps with one conditional add.
+	size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	const __m128 minDelay = _mm_set1_ps( minDelayFrames );
+	const __m128 maxDelay = _mm_set1_ps( maxDelayFrames );
+	const __m128 one = _mm_set1_ps( 1 );
+	const __m128i bufferFrames = _mm_set1_epi32( int32_t( delayBufferFrames ) );
+	const __m128i lastBufferFrame = _mm_set1_epi32( int32_t( delayBufferFrames - 1 ) );
+	const __m128i oneFrame = _mm_set1_epi32( 1 );
+	const __m128i fourFrames = _mm_set1_epi32( 4 );
+	__m128i writePos = _mm_add_epi32( _mm_set1_epi32( int32_t( writeIndex ) ), _mm_set_epi32( 3, 2, 1, 0 ) );
+
+	for( ; i + 4 <= numFrames; i += 4 ) {
+		const __m128 delay = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( delayFrames + i ), minDelay ), maxDelay );
+		const __m128i delayWhole = _mm_cvttps_epi32( delay );
+		_mm_storeu_ps( fractions + i, _mm_sub_ps( one, _mm_sub_ps( delay, _mm_cvtepi32_ps( delayWhole ) ) ) );
+
+		const __m128i wrappedPos = _mm_sub_epi32( writePos, _mm_and_si128( _mm_cmpgt_epi32( writePos, lastBufferFrame ), bufferFrames ) );
+		__m128i index = _mm_sub_epi32( _mm_sub_epi32( wrappedPos, delayWhole ), oneFrame );
+		index = _mm_add_epi32( index, _mm_and_si128( _mm_cmplt_epi32( index, _mm_setzero_si128() ), bufferFrames ) );
+		_mm_storeu_si128( (__m128i *)( indices + i ), index );
+
+		writePos = _mm_add_epi32( writePos, fourFrames );
+	}
+#endif
 
-			delayChannel[writeIndex] = sample;
-			writeIndex = ( writeIndex + 1 ) % delayBufferFrames;
-		}
+	for( ; i < numFrames; i++ ) {
+		const float delay = math<float>::clamp( delayFrames[i], minDelayFrames, maxDelayFrames );
+		const int32_t delayWhole = (int32_t)delay;
+		fractions[i] = 1 - ( delay - (float)delayWhole );
+
+		int32_t writePos = int32_t( writeIndex + i );
+		if( writePos >= int32_t( delayBufferFrames ) )
+			writePos -= int32_t( delayBufferFrames );
+
+		int32_t index = writePos - delayWhole - 1;
+		if( index < 0 )
+			index += int32_t( delayBufferFrames );
+
+		indices[i] = uint32_t( index );
 	}
-	else {
-		const size_t delayFrames = size_t( mParamDelaySeconds.getValue() * sampleRate );
-		size_t readIndex = writeIndex + delayBufferFrames - delayFrames;
 
+	// The allpass is only stable for fractions less than one, so integer delays read the newer frame with no fractional part.
+	if( interpolation == Interpolation::ALLPASS ) {
 		for( size_t i = 0; i < numFrames; i++ ) {
-			float sample = *inChannel;
-			*inChannel++ = delayChannel[readIndex];
-			delayChannel[writeIndex] = sample;
-
-			writeIndex = ( writeIndex + 1 ) % delayBufferFrames;
-			readIndex = ( readIndex + 1 ) % delayBufferFrames;
+			if( fractions[i] >= 1 ) {
+				fractions[i] = 0;
+				indices[i] = uint32_t( ( indices[i] + 1 ) % delayBufferFrames );
+			}
 		}
 	}
-
-	mWriteIndex = writeIndex;
 }
 
 } } // namespace cinder::audio
@@ -0,0 +1,714 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/FileFlac.h"
+#include "cinder/audio/MappedFile.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/audio/Debug.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_ARM64 ) )
+	#include <intrin.h>
+#endif
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+// When seeking without a seek table, bisection stops once the remaining range is this many bytes, which are then decoded forward.
+const size_t SEEK_BISECTION_THRESHOLD = 64 * 1024;
+
+// The number of bytes from the end of the file searched for the last frame, when STREAMINFO doesn't know the total number of samples.
+const size_t LAST_FRAME_SEARCH_SIZE = 64 * 1024;
+
+uint32_t readBE16( const uint8_t *p )	{ return ( uint32_t( p[0] ) << 8 ) | p[1]; }
+uint32_t readBE24( const uint8_t *p )	{ return ( uint32_t( p[0] ) << 16 ) | ( uint32_t( p[1] ) << 8 ) | p[2]; }
+uint32_t readBE32( const uint8_t *p )	{ return ( uint32_t( p[0] ) << 24 ) | readBE24( p + 1 ); }
+uint64_t readBE64( const uint8_t *p )	{ return ( uint64_t( readBE32( p ) ) << 32 ) | readBE32( p + 4 ); }
+uint32_t readLE32( const uint8_t *p )	{ return uint32_t( p[0] ) | ( uint32_t( p[1] ) << 8 ) | ( uint32_t( p[2] ) << 16 ) | ( uint32_t( p[3] ) << 24 ); }
+
+inline int countLeadingZeros( uint64_t x )
+{
+	CI_ASSERT( x != 0 );
+#if defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_ARM64 ) )
+	unsigned long index;
+	_BitScanReverse64( &index, x );
+	return 63 - int( index );
+#elif defined( __GNUC__ )
+	return __builtin_clzll( x );
+#else
+	int result = 0;
+	for( ; ! ( x & 0x8000000000000000ULL ); x <<= 1 )
+		result++;
+	return result;
+#endif
+}
+
+uint8_t crc8( const uint8_t *data, size_t size )
+{
+	uint8_t crc = 0;
+	for( size_t i = 0; i < size; i++ ) {
+		crc ^= data[i];
+		for( int bit = 0; bit < 8; bit++ )
+			crc = uint8_t( ( crc & 0x80 ) ? ( crc << 1 ) ^ 0x07 : crc << 1 );
+	}
+
+	return crc;
+}
+
+//! Reads big endian bit fields from a FLAC frame, keeping up to 64 bits cached and left-aligned so that unary codes can be counted with a single instruction.
+class BitReader {
+  public:
+	BitReader( const uint8_t *data, size_t size )
+		: mData( data ), mEnd( data + size ), mCache( 0 ), mNumBits( 0 )
+	{}
+
+	//! Reads \a numBits (up to 32) as an unsigned integer.
+	uint32_t readBits( size_t numBits )
+	{
+		if( numBits == 0 )
+			return 0;
+
+		if( mNumBits < numBits ) {
+			refill();
+			if( mNumBits < numBits )
+				throw AudioFileExc( "unexpected end of FLAC frame" );
+		}
+
+		uint32_t result = uint32_t( mCache >> ( 64 - numBits ) );
+		mCache <<= numBits;
+		mNumBits -= numBits;
+		return result;
+	}
+
+	//! Reads \a numBits (up to 32) as a two's complement signed integer.
+	int32_t readSigned( size_t numBits )
+	{
+		if( numBits == 0 )
+			return 0;
+
+		uint32_t value = readBits( numBits );
+		return int32_t( value << ( 32 - numBits ) ) >> ( 32 - numBits );
+	}
+
+	//! Returns the number of zero bits before the next one bit, consuming them and the one bit.
+	uint32_t readUnary()
+	{
+		uint32_t result = 0;
+		while( true ) {
+			if( mCache ) {
+				// bits beyond mNumBits are always zero, so the leading one is within the cached bits
+				int zeros = countLeadingZeros( mCache );
+				mCache <<= zeros;
+				mCache <<= 1;
+				mNumBits -= zeros + 1;
+				return result + zeros;
+			}
+
+			result += uint32_t( mNumBits );
+			mNumBits = 0;
+			refill();
+			if( ! mNumBits )
+				throw AudioFileExc( "unexpected end of FLAC frame" );
+		}
+	}
+
+	void alignToByte()
+	{
+		size_t remainder = mNumBits % 8;
+		mCache <<= remainder;
+		mNumBits -= remainder;
+	}
+
+	//! Returns the position of the next unread byte, only valid when aligned to a byte.
+	const uint8_t* getPosition() const	{ return mData - mNumBits / 8; }
+
+  private:
+	void refill()
+	{
+		while( mNumBits <= 56 && mData < mEnd ) {
+			mCache |= uint64_t( *mData++ ) << ( 56 - mNumBits );
+			mNumBits += 8;
+		}
+	}
+
+	const uint8_t	*mData, *mEnd;
+	uint64_t		mCache;
+	size_t			mNumBits;
+};
+
+void decodeResidual( BitReader &reader, int32_t *dest, size_t blockSize, size_t predictorOrder )
+{
+	const uint32_t method = reader.readBits( 2 );
+	if( method > 1 )
+		throw AudioFileExc( "reserved FLAC residual coding method" );
+
+	const size_t parameterBits = ( method == 0 ? 4 : 5 );
+	const uint32_t escapeParameter = ( method == 0 ? 15 : 31 );
+	const size_t partitionOrder = reader.readBits( 4 );
+	const size_t numPartitions = size_t( 1 ) << partitionOrder;
+	const size_t partitionSize = blockSize >> partitionOrder;
+	if( partitionSize * numPartitions != blockSize || partitionSize < predictorOrder )
+		throw AudioFileExc( "invalid FLAC residual partition order" );
+
+	for( size_t partition = 0; partition < numPartitions; partition++ ) {
+		// the first partition's size includes the warm-up samples
+		const size_t numSamples = ( partition == 0 ? partitionSize - predictorOrder : partitionSize );
+		const uint32_t parameter = reader.readBits( parameterBits );
+
+		if( parameter == escapeParameter ) {
+			const size_t numBits = reader.readBits( 5 );
+			for( size_t i = 0; i < numSamples; i++ )
+				*dest++ = reader.readSigned( numBits );
+		}
+		else {
+			for( size_t i = 0; i < numSamples; i++ ) {
+				// rice coded: unary quotient, then the remainder, zigzag mapped to signed
+				uint32_t value = ( reader.readUnary() << parameter ) | reader.readBits( parameter );
+				*dest++ = int32_t( value >> 1 ) ^ -int32_t( value & 1 );
+			}
+		}
+	}
+}
+
+void decodeSubframe( BitReader &reader, int32_t *dest, size_t blockSize, size_t bitsPerSample )
+{
+	if( reader.readBits( 1 ) != 0 )
+		throw AudioFileExc( "invalid FLAC subframe padding" );
+
+	const uint32_t type = reader.readBits( 6 );
+
+	size_t wastedBits = 0;
+	if( reader.readBits( 1 ) ) {
+		wastedBits = reader.readUnary() + 1;
+		if( wastedBits >= bitsPerSample )
+			throw AudioFileExc( "invalid FLAC wasted bits" );
+
+		bitsPerSample -= wastedBits;
+	}
+
+	if( type == 0 ) {
+		// constant
+		fill( dest, dest + blockSize, reader.readSigned( bitsPerSample ) );
+	}
+	else if( type == 1 ) {
+		// verbatim
+		for( size_t i = 0; i < blockSize; i++ )
+			dest[i] = reader.readSigned( bitsPerSample );
+	}
+	else if( type >= 8 && type <= 12 ) {
+		// fixed polynomial prediction
+		const size_t order = type - 8;
+		if( order > blockSize )
+			throw AudioFileExc( "invalid FLAC predictor order" );
+
+		for( size_t i = 0; i < order; i++ )
+			dest[i] = reader.readSigned( bitsPerSample );
+
+		decodeResidual( reader, dest + order, blockSize, order );
+
+		switch( order ) {
+			case 1:
+				for( size_t i = 1; i < blockSize; i++ )
+					dest[i] += dest[i - 1];
+				break;
+			case 2:
+				for( size_t i = 2; i < blockSize; i++ )
+					dest[i] += int32_t( 2 * int64_t( dest[i - 1] ) - dest[i - 2] );
+				break;
+			case 3:
+				for( size_t i = 3; i < blockSize; i++ )
+					dest[i] += int32_t( 3 * ( int64_t( dest[i - 1] ) - dest[i - 2] ) + dest[i - 3] );
+				break;
+			case 4:
+				for( size_t i = 4; i < blockSize; i++ )
+					dest[i] += int32_t( 4 * ( int64_t( dest[i - 1] ) + dest[i - 3] ) - 6 * int64_t( dest[i - 2] ) - dest[i - 4] );
+				break;
+			default:
+				break;
+		}
+	}
+	else if( type >= 32 ) {
+		// linear prediction
+		const size_t order = type - 31;
+		if( order > blockSize )
+			throw AudioFileExc( "invalid FLAC predictor order" );
+
+		for( size_t i = 0; i < order; i++ )
+			dest[i] = reader.readSigned( bitsPerSample );
+
+		const size_t precision = reader.readBits( 4 ) + 1;
+		const int32_t shift = reader.readSigned( 5 );
+		if( precision == 16 || shift < 0 )
+			throw AudioFileExc( "invalid FLAC linear predictor" );
+
+		int32_t coefficients[32];
+		for( size_t i = 0; i < order; i++ )
+			coefficients[i] = reader.readSigned( precision );
+
+		decodeResidual( reader, dest + order, blockSize, order );
+
+		for( size_t i = order; i < blockSize; i++ ) {
+			int64_t prediction = 0;
+			for( size_t j = 0; j < order; j++ )
+				prediction += int64_t( coefficients[j] ) * dest[i - 1 - j];
+
+			dest[i] += int32_t( prediction >> shift );
+		}
+	}
+	else
+		throw AudioFileExc( "reserved FLAC subframe type: " + to_string( type ) );
+
+	if( wastedBits ) {
+		for( size_t i = 0; i < blockSize; i++ )
+			dest[i] = int32_t( uint32_t( dest[i] ) << wastedBits );
+	}
+}
+
+} // anonymous namespace
+
+SourceFileFlac::SourceFileFlac( const DataSourceRef &dataSource, size_t sampleRate )
+	: SourceFile( sampleRate ), mDataSource( dataSource ), mFileData( nullptr ), mFileSize( 0 ), mFirstFrameOffset( 0 ), mNumChannels( 0 ),
+		mNativeSampleRate( 0 ), mBitsPerSample( 0 ), mMinBlockSize( 0 ), mMaxBlockSize( 0 )
+{
+	CI_ASSERT( mDataSource );
+
+	if( mDataSource->isFilePath() ) {
+		mMappedFile = make_shared<MappedFile>( mDataSource->getFilePath() );
+		mFileData = reinterpret_cast<const uint8_t *>( mMappedFile->getData() );
+		mFileSize = mMappedFile->getSize();
+	}
+	else {
+		// the DataSource keeps its buffer for as long as it is alive
+		const cinder::Buffer &buffer = mDataSource->getBuffer();
+		mFileData = static_cast<const uint8_t *>( buffer.getData() );
+		mFileSize = buffer.getDataSize();
+	}
+
+	parseMetaData();
+
+	mBlock.resize( mNumChannels * mMaxBlockSize );
+	resetBlock();
+}
+
+SourceFileFlac::SourceFileFlac( const SourceFileFlac &other, size_t sampleRate )
+	: SourceFile( sampleRate ), mDataSource( other.mDataSource ), mMappedFile( other.mMappedFile ), mFileData( other.mFileData ), mFileSize( other.mFileSize ),
+		mFirstFrameOffset( other.mFirstFrameOffset ), mNumChannels( other.mNumChannels ), mNativeSampleRate( other.mNativeSampleRate ),
+		mBitsPerSample( other.mBitsPerSample ), mMinBlockSize( other.mMinBlockSize ), mMaxBlockSize( other.mMaxBlockSize ),
+		mSeekPoints( other.mSeekPoints ), mMetaData( other.mMetaData ), mBlock( other.mBlock.size() )
+{
+	mNumFrames = mFileNumFrames = other.mFileNumFrames;
+	resetBlock();
+}
+
+SourceFileFlac::~SourceFileFlac()
+{
+}
+
+SourceFileRef SourceFileFlac::cloneWithSampleRate( size_t sampleRate ) const
+{
+	// the clone shares this file's mapping and metadata, but decodes on its own
+	shared_ptr<SourceFileFlac> result( new SourceFileFlac( *this, sampleRate ) );
+	result->setupSampleRateConversion();
+
+	return result;
+}
+
+// static
+vector<string> SourceFileFlac::getSupportedExtensions()
+{
+	vector<string> result;
+	result.push_back( "flac" );
+
+	return result;
+}
+
+void SourceFileFlac::parseMetaData()
+{
+	size_t pos = 0;
+
+	// skip an ID3v2 tag, which some taggers prepend to FLAC files
+	if( mFileSize >= 10 && memcmp( mFileData, "ID3", 3 ) == 0 ) {
+		const uint8_t *size = mFileData + 6;
+		pos = 10 + ( ( size[0] & 0x7F ) << 21 | ( size[1] & 0x7F ) << 14 | ( size[2] & 0x7F ) << 7 | ( size[3] & 0x7F ) );
+		if( mFileData[5] & 0x10 )
+			pos += 10; // footer
+	}
+
+	if( pos + 4 > mFileSize || memcmp( mFileData + pos, "fLaC", 4 ) != 0 )
+		throw AudioFileExc( "not a FLAC file" );
+
+	pos += 4;
+	uint64_t totalSamples = 0;
+	bool foundStreamInfo = false, isLast = false;
+
+	while( ! isLast ) {
+		if( pos + 4 > mFileSize )
+			throw AudioFileExc( "unexpected end of FLAC metadata" );
+
+		isLast = ( mFileData[pos] & 0x80 ) != 0;
+		const uint32_t type = mFileData[pos] & 0x7F;
+		const size_t size = readBE24( mFileData + pos + 1 );
+		const uint8_t *body = mFileData + pos + 4;
+		pos += 4 + size;
+		if( pos > mFileSize )
+			throw AudioFileExc( "unexpected end of FLAC metadata" );
+
+		if( type == 0 && size >= 34 ) {
+			// STREAMINFO: 20-bit samplerate, 3-bit channels - 1, 5-bit bits per sample - 1 and 36-bit total samples, packed into 64 bits
+			mMinBlockSize = readBE16( body );
+			mMaxBlockSize = readBE16( body + 2 );
+			const uint64_t fields = readBE64( body + 10 );
+			mNativeSampleRate = size_t( fields >> 44 );
+			mNumChannels = size_t( ( fields >> 41 ) & 0x07 ) + 1;
+			mBitsPerSample = size_t( ( fields >> 36 ) & 0x1F ) + 1;
+			totalSamples = fields & 0xFFFFFFFFFULL;
+			foundStreamInfo = true;
+		}
+		else if( type == 3 ) {
+			// SEEKTABLE, offsets are relative to the first frame. Placeholder points have all bits of their sample number set.
+			for( size_t i = 0; i + 18 <= size; i += 18 ) {
+				const SeekPoint point = { readBE64( body + i ), readBE64( body + i + 8 ) };
+				if( point.mSample != 0xFFFFFFFFFFFFFFFFULL )
+					mSeekPoints.push_back( point );
+			}
+		}
+		else if( type == 4 && size >= 8 ) {
+			// VORBIS_COMMENT, in little endian unlike the rest of the format: vendor string, then a list of NAME=value entries
+			const uint8_t *end = body + size;
+			const uint8_t *entry = body + 4 + readLE32( body );
+			if( entry + 4 <= end ) {
+				const size_t numEntries = readLE32( entry );
+				entry += 4;
+				for( size_t i = 0; i < numEntries && entry + 4 <= end; i++ ) {
+					const size_t length = readLE32( entry );
+					entry += 4;
+					if( length > size_t( end - entry ) )
+						break;
+
+					string comment( reinterpret_cast<const char *>( entry ), length );
+					size_t separator = comment.find( '=' );
+					if( separator != string::npos )
+						mMetaData += comment.substr( 0, separator ) + ": " + comment.substr( separator + 1 ) + "\n";
+
+					entry += length;
+				}
+			}
+		}
+	}
+
+	if( ! foundStreamInfo )
+		throw AudioFileExc( "FLAC file is missing its STREAMINFO block" );
+	if( mNativeSampleRate == 0 || mMaxBlockSize < 16 || mMinBlockSize > mMaxBlockSize )
+		throw AudioFileExc( "invalid FLAC STREAMINFO block" );
+
+	mFirstFrameOffset = pos;
+
+	if( totalSamples == 0 ) {
+		// the encoder didn't know the length (e.g. it was streaming), so find the last frame by decoding forward from near the end of the file
+		mBlock.resize( mNumChannels * mMaxBlockSize );
+		for( size_t searchSize = LAST_FRAME_SEARCH_SIZE; ; searchSize *= 2 ) {
+			const size_t searchOffset = ( mFileSize - mFirstFrameOffset > searchSize ) ? mFileSize - searchSize : mFirstFrameOffset;
+
+			FrameHeader header;
+			size_t offset = findFrame( searchOffset, mFileSize, &header );
+			while( offset < mFileSize ) {
+				try {
+					decodeFrame( offset );
+					totalSamples = mBlockFirstSample + mBlockNumFrames;
+					offset = mNextFrameOffset;
+				}
+				catch( AudioFileExc & ) {
+					// a false frame sync within another frame's samples
+					offset = findFrame( offset + 1, mFileSize, &header );
+				}
+			}
+
+			if( totalSamples || searchOffset == mFirstFrameOffset )
+				break;
+		}
+	}
+
+	mNumFrames = mFileNumFrames = size_t( totalSamples );
+}
+
+bool SourceFileFlac::parseFrameHeader( size_t offset, FrameHeader *header ) const
+{
+	// the longest header is 16 bytes: 4 fixed, up to 7 for the coded number, 2 + 2 for the block size and samplerate and the CRC-8
+	const uint8_t *p = mFileData + offset;
+	const size_t available = mFileSize - offset;
+	if( available < 6 || p[0] != 0xFF || ( p[1] & 0xFE ) != 0xF8 )
+		return false;
+
+	const bool isVariableBlockSize = ( p[1] & 0x01 ) != 0;
+	const uint32_t blockSizeCode = p[2] >> 4;
+	const uint32_t sampleRateCode = p[2] & 0x0F;
+	const uint32_t channelAssignment = p[3] >> 4;
+	const uint32_t sampleSizeCode = ( p[3] >> 1 ) & 0x07;
+	if( blockSizeCode == 0 || sampleRateCode == 15 || channelAssignment > 10 || sampleSizeCode == 3 || ( p[3] & 0x01 ) )
+		return false;
+
+	// frame or sample number, coded like UTF-8 but extended up to 36 bits
+	size_t pos = 4;
+	uint64_t number = p[pos++];
+	if( number & 0x80 ) {
+		size_t numContinuationBytes = 0;
+		for( uint64_t mask = 0x40; number & mask; mask >>= 1 )
+			numContinuationBytes++;
+
+		if( numContinuationBytes == 0 || numContinuationBytes > 6 || pos + numContinuationBytes > available )
+			return false;
+
+		number &= ( 0x3F >> numContinuationBytes );
+		for( size_t i = 0; i < numContinuationBytes; i++ ) {
+			if( ( p[pos] & 0xC0 ) != 0x80 )
+				return false;
+
+			number = ( number << 6 ) | ( p[pos++] & 0x3F );
+		}
+	}
+
+	size_t blockSize;
+	if( blockSizeCode == 1 )
+		blockSize = 192;
+	else if( blockSizeCode <= 5 )
+		blockSize = size_t( 576 ) << ( blockSizeCode - 2 );
+	else if( blockSizeCode == 6 ) {
+		if( pos + 1 > available )
+			return false;
+		blockSize = size_t( p[pos] ) + 1;
+		pos += 1;
+	}
+	else if( blockSizeCode == 7 ) {
+		if( pos + 2 > available )
+			return false;
+		blockSize = size_t( readBE16( p + pos ) ) + 1;
+		pos += 2;
+	}
+	else
+		blockSize = size_t( 256 ) << ( blockSizeCode - 8 );
+
+	// the samplerate is always taken from STREAMINFO, only skip over it here
+	if( sampleRateCode == 12 )
+		pos += 1;
+	else if( sampleRateCode == 13 || sampleRateCode == 14 )
+		pos += 2;
+
+	if( pos + 1 > available || crc8( p, pos ) != p[pos] )
+		return false;
+
+	const size_t numChannels = ( channelAssignment < 8 ? channelAssignment + 1 : 2 );
+	if( numChannels != mNumChannels || blockSize > mMaxBlockSize )
+		return false;
+
+	const size_t sampleSizes[] = { mBitsPerSample, 8, 12, 0, 16, 20, 24, 32 };
+
+	header->mBitsPerSample = sampleSizes[sampleSizeCode];
+	header->mBlockSize = blockSize;
+	header->mChannelAssignment = channelAssignment;
+	header->mHeaderSize = pos + 1;
+
+	// fixed block size streams number their frames, the last one may be shorter than the others
+	if( isVariableBlockSize )
+		header->mFirstSample = number;
+	else
+		header->mFirstSample = number * ( mMinBlockSize == mMaxBlockSize ? mMaxBlockSize : blockSize );
+
+	return true;
+}
+
+size_t SourceFileFlac::findFrame( size_t beginOffset, size_t endOffset, FrameHeader *header ) const
+{
+	for( size_t offset = beginOffset; offset + 1 < endOffset; offset++ ) {
+		const void *sync = memchr( mFileData + offset, 0xFF, endOffset - offset - 1 );
+		if( ! sync )
+			break;
+
+		offset = static_cast<const uint8_t *>( sync ) - mFileData;
+		if( parseFrameHeader( offset, header ) )
+			return offset;
+	}
+
+	return mFileSize;
+}
+
+void SourceFileFlac::decodeFrame( size_t offset )
+{
+	FrameHeader header;
+	if( ! parseFrameHeader( offset, &header ) )
+		throw AudioFileExc( "invalid FLAC frame header" );
+
+	BitReader reader( mFileData + offset + header.mHeaderSize, mFileSize - offset - header.mHeaderSize );
+	const size_t blockSize = header.mBlockSize;
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		// the side channel of a stereo decorrelated frame has one extra bit
+		size_t bitsPerSample = header.mBitsPerSample;
+		if( ( header.mChannelAssignment == 8 && ch == 1 ) || ( header.mChannelAssignment == 9 && ch == 0 ) || ( header.mChannelAssignment == 10 && ch == 1 ) )
+			bitsPerSample++;
+
+		if( bitsPerSample > 32 )
+			throw AudioFormatExc( "FLAC samples wider than 32 bits are unsupported" );
+
+		decodeSubframe( reader, &mBlock[ch * mMaxBlockSize], blockSize, bitsPerSample );
+	}
+
+	// frames end with a CRC-16 of the whole frame, which isn't checked as the header's CRC-8 already guards against false syncs
+	reader.alignToByte();
+	mNextFrameOffset = size_t( reader.getPosition() - mFileData ) + 2;
+
+	int32_t *left = &mBlock[0];
+	int32_t *right = &mBlock[mMaxBlockSize];
+	switch( header.mChannelAssignment ) {
+		case 8: // left, side
+			for( size_t i = 0; i < blockSize; i++ )
+				right[i] = left[i] - right[i];
+			break;
+		case 9: // side, right
+			for( size_t i = 0; i < blockSize; i++ )
+				left[i] += right[i];
+			break;
+		case 10: // mid, side
+			for( size_t i = 0; i < blockSize; i++ ) {
+				const int64_t side = right[i];
+				const int64_t mid = ( int64_t( left[i] ) * 2 ) | ( side & 1 );
+				left[i] = int32_t( ( mid + side ) >> 1 );
+				right[i] = int32_t( ( mid - side ) >> 1 );
+			}
+			break;
+		default:
+			break;
+	}
+
+	mBlockFirstSample = header.mFirstSample;
+	mBlockNumFrames = blockSize;
+	mBlockBitsPerSample = header.mBitsPerSample;
+}
+
+void SourceFileFlac::resetBlock()
+{
+	mBlockFirstSample = 0;
+	mBlockNumFrames = 0;
+	mBlockBitsPerSample = mBitsPerSample;
+	mNextFrameOffset = mFirstFrameOffset;
+	mFramePosition = 0;
+}
+
+size_t SourceFileFlac::performRead( Buffer *buffer, size_t bufferFrameOffset, size_t numFramesNeeded )
+{
+	CI_ASSERT( buffer->getNumFrames() >= bufferFrameOffset + numFramesNeeded );
+
+	const size_t numFrames = min( numFramesNeeded, mFileNumFrames - mFramePosition );
+
+	size_t numRead = 0;
+	while( numRead < numFrames ) {
+		if( mFramePosition >= mBlockFirstSample + mBlockNumFrames ) {
+			if( mNextFrameOffset >= mFileSize )
+				break; // truncated file
+
+			decodeFrame( mNextFrameOffset );
+			continue;
+		}
+		else if( mFramePosition < mBlockFirstSample )
+			throw AudioFileExc( "FLAC frames are out of order" );
+
+		const size_t blockOffset = size_t( mFramePosition - mBlockFirstSample );
+		const size_t count = min( numFrames - numRead, mBlockNumFrames - blockOffset );
+		const float scale = 1.0f / float( uint64_t( 1 ) << ( mBlockBitsPerSample - 1 ) );
+
+		for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+			const int32_t *source = &mBlock[ch * mMaxBlockSize + blockOffset];
+			float *dest = buffer->getChannel( ch ) + bufferFrameOffset + numRead;
+			for( size_t i = 0; i < count; i++ )
+				dest[i] = float( source[i] ) * scale;
+		}
+
+		numRead += count;
+		mFramePosition += count;
+	}
+
+	return numRead;
+}
+
+void SourceFileFlac::performSeek( size_t readPositionFrames )
+{
+	const size_t target = min( readPositionFrames, mFileNumFrames );
+	if( target >= mBlockFirstSample && target < mBlockFirstSample + mBlockNumFrames ) {
+		mFramePosition = target;
+		return;
+	}
+
+	resetBlock();
+	mFramePosition = target;
+	if( target == mFileNumFrames )
+		return;
+
+	// narrow down the range of bytes containing the target's frame, first with the seek table and then by bisecting on frame headers
+	size_t lowerOffset = mFirstFrameOffset;
+	size_t upperOffset = mFileSize;
+	for( const auto &point : mSeekPoints ) {
+		if( point.mOffset >= mFileSize - mFirstFrameOffset )
+			continue;
+
+		const size_t offset = size_t( mFirstFrameOffset + point.mOffset );
+		if( point.mSample <= target )
+			lowerOffset = max( lowerOffset, offset );
+		else
+			upperOffset = min( upperOffset, offset );
+	}
+
+	FrameHeader header;
+	while( upperOffset > lowerOffset && upperOffset - lowerOffset > SEEK_BISECTION_THRESHOLD ) {
+		const size_t middleOffset = lowerOffset + ( upperOffset - lowerOffset ) / 2;
+		const size_t offset = findFrame( middleOffset, upperOffset, &header );
+		if( offset < upperOffset && header.mFirstSample <= target )
+			lowerOffset = offset;
+		else
+			upperOffset = middleOffset;
+	}
+
+	// decode forward until the frame containing the target, starting over from the beginning if a false frame sync overshot it
+	size_t offset = lowerOffset;
+	while( offset < mFileSize ) {
+		decodeFrame( offset );
+		if( mBlockFirstSample > target && offset != mFirstFrameOffset ) {
+			offset = mFirstFrameOffset;
+			continue;
+		}
+		if( target < mBlockFirstSample + mBlockNumFrames )
+			break;
+
+		offset = mNextFrameOffset;
+	}
+}
+
+string SourceFileFlac::getMetaData() const
+{
+	return mMetaData;
+}
+
+} } // namespace cinder::audio
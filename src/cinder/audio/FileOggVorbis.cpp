@@ -26,18 +26,37 @@
 #include "cinder/audio/Exception.h"
 #include "cinder/audio/Debug.h"
 
+#include <algorithm>
 #include <sstream>
 
 using namespace std;
 
 namespace cinder { namespace audio {
 
+namespace {
+
+// The maximum number of frames decoded at a time on the I/O threads, the reading thread may wait for one chunk if it gets ahead of them.
+const size_t DECODE_AHEAD_CHUNK_FRAMES = 2048;
+
+} // anonymous namespace
+
+//! The granule position (the number of frames decoded at the end of the page) and byte offset of each audio page in the file.
+struct SourceFileOggVorbis::SeekIndex {
+	struct Page {
+		int64_t		mGranulePos;
+		int64_t		mOffset;
+	};
+
+	std::once_flag		mBuildFlag;
+	std::vector<Page>	mPages;
+};
+
 SourceFileOggVorbis::SourceFileOggVorbis()
-	: SourceFile( 0 )
+	: SourceFile( 0 ), mDecodeAheadFrames( 0 )
 {}
 
 SourceFileOggVorbis::SourceFileOggVorbis( const DataSourceRef &dataSource, size_t sampleRate )
-	: SourceFile( sampleRate )
+	: SourceFile( sampleRate ), mSeekIndex( make_shared<SeekIndex>() ), mDecodeAheadFrames( 0 )
 {
 	mDataSource = dataSource;
 	init();
@@ -46,13 +65,18 @@ SourceFileOggVorbis::SourceFileOggVorbis( const DataSourceRef &dataSource, size_
 SourceFileRef SourceFileOggVorbis::cloneWithSampleRate( size_t sampleRate ) const
 {
 	auto result = make_shared<SourceFileOggVorbis>( mDataSource, sampleRate );
+	result->mSeekIndex = mSeekIndex;
 	result->setupSampleRateConversion();
+	result->setDecodeAheadFrames( mDecodeAheadFrames );
 
 	return result;
 }
 
 SourceFileOggVorbis::~SourceFileOggVorbis()
 {
+	if( mDecodeAheadFrames )
+		FileStreamScheduler::get()->removeClient( this );
+
 	ov_clear( &mOggVorbisFile );
 }
 
@@ -89,6 +113,24 @@ size_t SourceFileOggVorbis::performRead( Buffer *buffer, size_t bufferFrameOffse
 {
 	CI_ASSERT( buffer->getNumFrames() >= bufferFrameOffset + numFramesNeeded );
 
+	if( ! mDecodeAheadFrames )
+		return decode( buffer, bufferFrameOffset, numFramesNeeded );
+
+	size_t readCount = readDecodedAhead( buffer, bufferFrameOffset, numFramesNeeded );
+	if( readCount < numFramesNeeded ) {
+		// The I/O threads are behind. With the decoder locked they can't add to the ring buffers, so once whatever they had decoded
+		// has been read, the decoder is positioned at the next frame needed.
+		lock_guard<mutex> lock( mDecoderMutex );
+		readCount += readDecodedAhead( buffer, bufferFrameOffset + readCount, numFramesNeeded - readCount );
+		readCount += decode( buffer, bufferFrameOffset + readCount, numFramesNeeded - readCount );
+	}
+
+	requestService();
+	return readCount;
+}
+
+size_t SourceFileOggVorbis::decode( Buffer *buffer, size_t bufferFrameOffset, size_t numFramesNeeded )
+{
 	size_t readCount = 0;
 	while( readCount < numFramesNeeded ) {
 		float **outChannels;
@@ -112,12 +154,223 @@ size_t SourceFileOggVorbis::performRead( Buffer *buffer, size_t bufferFrameOffse
 	return static_cast<size_t>( readCount );
 }
 
+size_t SourceFileOggVorbis::readDecodedAhead( Buffer *buffer, size_t bufferFrameOffset, size_t numFramesNeeded )
+{
+	// channels are written one after the other, so only what is available in all of them can be read
+	size_t readCount = numFramesNeeded;
+	for( const auto &ringBuffer : mDecodeAheadBuffers )
+		readCount = min( readCount, ringBuffer.getAvailableRead() );
+
+	if( readCount ) {
+		for( size_t ch = 0; ch < mNumChannels; ch++ )
+			mDecodeAheadBuffers[ch].read( buffer->getChannel( ch ) + bufferFrameOffset, readCount );
+	}
+
+	return readCount;
+}
+
 void SourceFileOggVorbis::performSeek( size_t readPositionFrames )
 {
+	if( ! mDecodeAheadFrames ) {
+		seekDecoder( readPositionFrames );
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock( mDecoderMutex );
+
+		// Seeks forward within what was already decoded ahead (e.g. when scrubbing) only skip over it. Otherwise it is discarded.
+		const int64_t decoderPos = ov_pcm_tell( &mOggVorbisFile );
+		const int64_t readPos = decoderPos - (int64_t)mDecodeAheadBuffers[0].getAvailableRead();
+		const int64_t target = (int64_t)readPositionFrames;
+		if( target >= readPos && target <= decoderPos ) {
+			size_t skipFrames = size_t( target - readPos );
+			while( skipFrames ) {
+				size_t chunkFrames = min( skipFrames, mDecodeAheadChunk.getNumFrames() );
+				for( size_t ch = 0; ch < mNumChannels; ch++ )
+					mDecodeAheadBuffers[ch].read( mDecodeAheadChunk.getChannel( ch ), chunkFrames );
+
+				skipFrames -= chunkFrames;
+			}
+		}
+		else {
+			for( auto &ringBuffer : mDecodeAheadBuffers )
+				ringBuffer.clear();
+
+			seekDecoder( readPositionFrames );
+		}
+	}
+
+	requestService();
+}
+
+void SourceFileOggVorbis::seekDecoder( size_t readPositionFrames )
+{
+	const int64_t target = (int64_t)readPositionFrames;
+	if( ov_pcm_tell( &mOggVorbisFile ) == target )
+		return;
+
+	// Seeks near the beginning are as fast without the index, so it is only built once seeking elsewhere. This avoids scanning the whole file when playback starts.
+	if( mSeekIndex && target > 0 ) {
+		call_once( mSeekIndex->mBuildFlag, [this] { buildSeekIndex(); } );
+
+		const auto &pages = mSeekIndex->mPages;
+		auto containingPage = lower_bound( pages.begin(), pages.end(), target, []( const SeekIndex::Page &page, int64_t pos ) { return page.mGranulePos < pos; } );
+		size_t pageIndex = size_t( containingPage - pages.begin() );
+
+		// A raw seek to the start of the page containing the target positions the decoder at the previous page's granule position, as the
+		// first packet decoded is only used to overlap with the next one. Step further back in the rare case that is still past the target.
+		// The index is empty for chained streams and may end early for truncated ones, in which case ov_pcm_seek() is used below.
+		if( pageIndex < pages.size() ) {
+			for( size_t preroll = 0; pageIndex >= preroll; preroll++ ) {
+				if( ov_raw_seek( &mOggVorbisFile, (ogg_int64_t)pages[pageIndex - preroll].mOffset ) != 0 )
+					break;
+
+				int64_t pos = ov_pcm_tell( &mOggVorbisFile );
+				if( pos > target )
+					continue;
+
+				// decode up to the target, the samples are discarded without being copied
+				while( pos < target ) {
+					float **outChannels;
+					int section;
+					long outNumFrames = ov_read_float( &mOggVorbisFile, &outChannels, int( min<int64_t>( target - pos, DECODE_AHEAD_CHUNK_FRAMES ) ), &section );
+					if( outNumFrames <= 0 )
+						break;
+
+					pos += outNumFrames;
+				}
+
+				if( pos == target )
+					return;
+
+				break;
+			}
+		}
+	}
+
 	int status = ov_pcm_seek( &mOggVorbisFile, (ogg_int64_t)readPositionFrames );
 	CI_VERIFY( status == 0 );
 }
 
+void SourceFileOggVorbis::buildSeekIndex()
+{
+	// Reads only the page headers, skipping over their contents. The index is left empty for chained files, which libvorbisfile seeks across better.
+	auto stream = mDataSource->createStream();
+	const off_t fileSize = stream->size();
+
+	uint8_t header[27];
+	uint8_t segmentTable[255];
+	uint32_t firstSerialNumber = 0;
+
+	vector<SeekIndex::Page> pages;
+	while( stream->tell() + (off_t)sizeof( header ) <= fileSize ) {
+		const off_t offset = stream->tell();
+		stream->readData( header, sizeof( header ) );
+		if( memcmp( header, "OggS", 4 ) != 0 )
+			break;
+
+		int64_t granulePos = 0;
+		uint32_t serialNumber = 0;
+		for( int i = 7; i >= 0; i-- )
+			granulePos = ( granulePos << 8 ) | header[6 + i];
+		for( int i = 3; i >= 0; i-- )
+			serialNumber = ( serialNumber << 8 ) | header[14 + i];
+
+		if( offset == 0 )
+			firstSerialNumber = serialNumber;
+		else if( serialNumber != firstSerialNumber ) {
+			pages.clear();
+			break;
+		}
+
+		const size_t numSegments = header[26];
+		if( stream->tell() + (off_t)numSegments > fileSize )
+			break;
+
+		stream->readData( segmentTable, numSegments );
+		off_t bodySize = 0;
+		for( size_t i = 0; i < numSegments; i++ )
+			bodySize += segmentTable[i];
+
+		// header pages have a granule position of 0, pages without a packet ending on them have -1
+		if( granulePos > 0 ) {
+			SeekIndex::Page page;
+			page.mGranulePos = granulePos;
+			page.mOffset = (int64_t)offset;
+			pages.push_back( page );
+		}
+
+		if( stream->tell() + bodySize > fileSize )
+			break;
+
+		stream->seekRelative( bodySize );
+	}
+
+	mSeekIndex->mPages = move( pages );
+}
+
+void SourceFileOggVorbis::setDecodeAheadFrames( size_t numFrames )
+{
+	if( numFrames == mDecodeAheadFrames )
+		return;
+
+	if( mDecodeAheadFrames )
+		FileStreamScheduler::get()->removeClient( this );
+
+	// anything decoded ahead is thrown away, so the decoder is moved back to the read position afterwards
+	const int64_t decoderPos = ov_pcm_tell( &mOggVorbisFile );
+	int64_t readPos = decoderPos;
+	for( const auto &ringBuffer : mDecodeAheadBuffers )
+		readPos = min( readPos, decoderPos - (int64_t)ringBuffer.getAvailableRead() );
+
+	mDecodeAheadFrames = numFrames;
+	mDecodeAheadBuffers.clear();
+	for( size_t ch = 0; ch < mNumChannels && mDecodeAheadFrames; ch++ )
+		mDecodeAheadBuffers.emplace_back( mDecodeAheadFrames );
+
+	if( readPos != decoderPos )
+		seekDecoder( size_t( max<int64_t>( 0, readPos ) ) );
+
+	if( mDecodeAheadFrames ) {
+		mDecodeAheadChunk.setSize( min( mDecodeAheadFrames, DECODE_AHEAD_CHUNK_FRAMES ), mNumChannels );
+		FileStreamScheduler::get()->addClient( this );
+		requestService();
+	}
+	else
+		mDecodeAheadChunk = BufferDynamic();
+}
+
+void SourceFileOggVorbis::serviceStream()
+{
+	// the decoder is unlocked between chunks, so that a read that has caught up only waits for one of them
+	while( true ) {
+		lock_guard<mutex> lock( mDecoderMutex );
+
+		size_t availableWrite = mDecodeAheadChunk.getNumFrames();
+		for( const auto &ringBuffer : mDecodeAheadBuffers )
+			availableWrite = min( availableWrite, ringBuffer.getAvailableWrite() );
+
+		if( availableWrite == 0 )
+			break;
+
+		size_t numDecoded = decode( &mDecodeAheadChunk, 0, availableWrite );
+		if( numDecoded == 0 )
+			break;
+
+		for( size_t ch = 0; ch < mNumChannels; ch++ )
+			mDecodeAheadBuffers[ch].write( mDecodeAheadChunk.getChannel( ch ), numDecoded );
+	}
+}
+
+float SourceFileOggVorbis::getStreamFill() const
+{
+	if( mDecodeAheadBuffers.empty() )
+		return 1;
+
+	return float( mDecodeAheadBuffers[0].getAvailableRead() ) / float( mDecodeAheadBuffers[0].getSize() );
+}
+
 string SourceFileOggVorbis::getMetaData() const
 {
 	ostringstream str;
@@ -0,0 +1,647 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/FilePcm.h"
+#include "cinder/audio/MappedFile.h"
+#include "cinder/audio/dsp/Converter.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/audio/Debug.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+// Number of samples converted at a time when the file's encoding can't be de-interleaved directly from the file's contents.
+const size_t CONVERSION_CHUNK_SIZE = 4096;
+
+uint16_t readLE16( const char *p )	{ const uint8_t *b = (const uint8_t *)p; return uint16_t( b[0] | ( b[1] << 8 ) ); }
+uint32_t readLE32( const char *p )	{ const uint8_t *b = (const uint8_t *)p; return uint32_t( b[0] ) | ( uint32_t( b[1] ) << 8 ) | ( uint32_t( b[2] ) << 16 ) | ( uint32_t( b[3] ) << 24 ); }
+uint64_t readLE64( const char *p )	{ return uint64_t( readLE32( p ) ) | ( uint64_t( readLE32( p + 4 ) ) << 32 ); }
+uint16_t readBE16( const char *p )	{ const uint8_t *b = (const uint8_t *)p; return uint16_t( ( b[0] << 8 ) | b[1] ); }
+uint32_t readBE32( const char *p )	{ const uint8_t *b = (const uint8_t *)p; return ( uint32_t( b[0] ) << 24 ) | ( uint32_t( b[1] ) << 16 ) | ( uint32_t( b[2] ) << 8 ) | uint32_t( b[3] ); }
+uint64_t readBE64( const char *p )	{ return ( uint64_t( readBE32( p ) ) << 32 ) | uint64_t( readBE32( p + 4 ) ); }
+
+void appendLE16( vector<char> *bytes, uint32_t value )	{ bytes->push_back( char( value ) ); bytes->push_back( char( value >> 8 ) ); }
+void appendLE32( vector<char> *bytes, uint32_t value )	{ appendLE16( bytes, value & 0xFFFF ); appendLE16( bytes, value >> 16 ); }
+void appendBE16( vector<char> *bytes, uint32_t value )	{ bytes->push_back( char( value >> 8 ) ); bytes->push_back( char( value ) ); }
+void appendBE32( vector<char> *bytes, uint32_t value )	{ appendBE16( bytes, value >> 16 ); appendBE16( bytes, value & 0xFFFF ); }
+void appendId( vector<char> *bytes, const char *id )		{ bytes->insert( bytes->end(), id, id + 4 ); }
+
+bool isId( const char *p, const char *id )	{ return memcmp( p, id, 4 ) == 0; }
+
+bool isAligned( const void *ptr, size_t alignment )	{ return reinterpret_cast<uintptr_t>( ptr ) % alignment == 0; }
+
+// AIFF stores its samplerate as an 80-bit IEEE 754 extended precision float: a sign bit, 15-bit exponent and 64-bit mantissa with an explicit integer bit.
+double readExtended( const char *p )
+{
+	int exponent = readBE16( p ) & 0x7FFF;
+	uint64_t mantissa = readBE64( p + 2 );
+	if( exponent == 0 && mantissa == 0 )
+		return 0;
+
+	double result = ldexp( (double)mantissa, exponent - 16383 - 63 );
+	return ( readBE16( p ) & 0x8000 ) ? -result : result;
+}
+
+void appendExtended( vector<char> *bytes, double value )
+{
+	int exponent = 0;
+	double fraction = frexp( value, &exponent ); // value = fraction * 2^exponent, with fraction in [0.5, 1)
+	uint64_t mantissa = uint64_t( ldexp( fraction, 64 ) );
+
+	appendBE16( bytes, value > 0 ? uint32_t( exponent - 1 + 16383 ) : 0 );
+	appendBE32( bytes, uint32_t( mantissa >> 32 ) );
+	appendBE32( bytes, uint32_t( mantissa ) );
+}
+
+void appendTextEntry( string *text, const string &key, const char *value, size_t length )
+{
+	// values are zero terminated or padded in most writers
+	length = strnlen( value, length );
+	if( length )
+		*text += key + ": " + string( value, length ) + "\n";
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SourceFilePcm
+// ----------------------------------------------------------------------------------------------------
+
+SourceFilePcm::SourceFilePcm( const DataSourceRef &dataSource, size_t sampleRate )
+	: SourceFile( sampleRate ), mDataSource( dataSource ), mFileData( nullptr ), mFileSize( 0 ), mDataOffset( 0 ), mEncoding( Encoding::INT_16 ),
+		mBigEndian( false ), mNumChannels( 0 ), mNativeSampleRate( 0 ), mBytesPerSample( 0 ), mBytesPerFrame( 0 ), mFramePosition( 0 )
+{
+	CI_ASSERT( mDataSource );
+
+	if( mDataSource->isFilePath() ) {
+		mMappedFile = make_shared<MappedFile>( mDataSource->getFilePath() );
+		mFileData = mMappedFile->getData();
+		mFileSize = mMappedFile->getSize();
+	}
+	else {
+		// the DataSource keeps its buffer for as long as it is alive
+		const cinder::Buffer &buffer = mDataSource->getBuffer();
+		mFileData = static_cast<const char *>( buffer.getData() );
+		mFileSize = buffer.getDataSize();
+	}
+
+	if( mFileSize >= 12 && ( isId( mFileData, "RIFF" ) || isId( mFileData, "RF64" ) ) && isId( mFileData + 8, "WAVE" ) )
+		parseWav();
+	else if( mFileSize >= 12 && isId( mFileData, "FORM" ) && ( isId( mFileData + 8, "AIFF" ) || isId( mFileData + 8, "AIFC" ) ) )
+		parseAiff();
+	else
+		throw AudioFileExc( "not a WAV or AIFF file" );
+
+	size_t chunkFrames = max<size_t>( 1, CONVERSION_CHUNK_SIZE / mNumChannels );
+	mConversionBuffer.resize( chunkFrames * mNumChannels );
+}
+
+SourceFilePcm::SourceFilePcm( const SourceFilePcm &other, size_t sampleRate )
+	: SourceFile( sampleRate ), mDataSource( other.mDataSource ), mMappedFile( other.mMappedFile ), mFileData( other.mFileData ), mFileSize( other.mFileSize ),
+		mDataOffset( other.mDataOffset ), mEncoding( other.mEncoding ), mBigEndian( other.mBigEndian ), mNumChannels( other.mNumChannels ),
+		mNativeSampleRate( other.mNativeSampleRate ), mBytesPerSample( other.mBytesPerSample ), mBytesPerFrame( other.mBytesPerFrame ), mFramePosition( 0 ),
+		mMetaData( other.mMetaData ), mConversionBuffer( other.mConversionBuffer.size() )
+{
+	mNumFrames = mFileNumFrames = other.mFileNumFrames;
+}
+
+SourceFilePcm::~SourceFilePcm()
+{
+}
+
+SourceFileRef SourceFilePcm::cloneWithSampleRate( size_t sampleRate ) const
+{
+	// the clone shares this file's mapping
+	shared_ptr<SourceFilePcm> result( new SourceFilePcm( *this, sampleRate ) );
+	result->setupSampleRateConversion();
+
+	return result;
+}
+
+// static
+vector<string> SourceFilePcm::getSupportedExtensions()
+{
+	vector<string> result;
+	result.push_back( "wav" );
+	result.push_back( "wave" );
+	result.push_back( "aif" );
+	result.push_back( "aiff" );
+	result.push_back( "aifc" );
+
+	return result;
+}
+
+void SourceFilePcm::parseWav()
+{
+	const bool isRf64 = isId( mFileData, "RF64" );
+	uint64_t rf64DataSize = 0;
+	uint64_t dataSize = 0;
+	bool foundFormat = false, foundData = false;
+
+	size_t pos = 12;
+	while( pos + 8 <= mFileSize ) {
+		const char *chunk = mFileData + pos;
+		const char *body = chunk + 8;
+		const uint64_t chunkSize = readLE32( chunk + 4 );
+		const uint64_t bodyAvailable = mFileSize - pos - 8;
+
+		if( isId( chunk, "ds64" ) && chunkSize >= 24 && bodyAvailable >= 24 ) {
+			// RF64 files store the sizes that don't fit in 32 bits here: riff size, data size and sample count
+			rf64DataSize = readLE64( body + 8 );
+		}
+		else if( isId( chunk, "fmt " ) ) {
+			if( chunkSize < 16 || bodyAvailable < 16 )
+				throw AudioFileExc( "invalid WAV format chunk" );
+
+			uint16_t formatTag = readLE16( body );
+			mNumChannels = readLE16( body + 2 );
+			mNativeSampleRate = readLE32( body + 4 );
+			const size_t blockAlign = readLE16( body + 12 );
+
+			// WAVE_FORMAT_EXTENSIBLE stores the actual format tag in the first two bytes of its SubFormat GUID
+			if( formatTag == 0xFFFE && chunkSize >= 40 && bodyAvailable >= 40 )
+				formatTag = readLE16( body + 24 );
+
+			if( mNumChannels == 0 || blockAlign == 0 || blockAlign % mNumChannels != 0 )
+				throw AudioFileExc( "invalid WAV format chunk" );
+
+			// samples are read by their container size, valid bits less than that are zero padded in the low bits
+			const size_t bytesPerSample = blockAlign / mNumChannels;
+			if( formatTag == 1 && bytesPerSample == 1 )
+				setEncoding( Encoding::INT_8_UNSIGNED, false, 1 );
+			else if( formatTag == 1 && bytesPerSample == 2 )
+				setEncoding( Encoding::INT_16, false, 2 );
+			else if( formatTag == 1 && bytesPerSample == 3 )
+				setEncoding( Encoding::INT_24, false, 3 );
+			else if( formatTag == 1 && bytesPerSample == 4 )
+				setEncoding( Encoding::INT_32, false, 4 );
+			else if( formatTag == 3 && bytesPerSample == 4 )
+				setEncoding( Encoding::FLOAT_32, false, 4 );
+			else if( formatTag == 3 && bytesPerSample == 8 )
+				setEncoding( Encoding::FLOAT_64, false, 8 );
+			else
+				throw AudioFormatExc( "unsupported WAV encoding (format tag: " + to_string( formatTag ) + ", bytes per sample: " + to_string( bytesPerSample ) + ")" );
+
+			foundFormat = true;
+		}
+		else if( isId( chunk, "data" ) && ! foundData ) {
+			mDataOffset = pos + 8;
+			dataSize = ( isRf64 && chunkSize == 0xFFFFFFFF ) ? rf64DataSize : chunkSize;
+
+			// files that are still being written or weren't finalized can claim more data than they have
+			dataSize = min<uint64_t>( dataSize, bodyAvailable );
+			foundData = true;
+
+			// metadata may follow the samples, but an unfinished file gives no way to find it
+			if( chunkSize == 0 || chunkSize == 0xFFFFFFFF || chunkSize > bodyAvailable )
+				break;
+		}
+		else if( isId( chunk, "LIST" ) && chunkSize >= 4 && chunkSize <= bodyAvailable && isId( body, "INFO" ) ) {
+			size_t entryPos = 4;
+			while( entryPos + 8 <= chunkSize ) {
+				const char *entry = body + entryPos;
+				const size_t entrySize = readLE32( entry + 4 );
+				if( entryPos + 8 + entrySize > chunkSize )
+					break;
+
+				appendTextEntry( &mMetaData, string( entry, 4 ), entry + 8, entrySize );
+				entryPos += 8 + entrySize + ( entrySize & 1 );
+			}
+		}
+
+		// a chunk that claims more than the rest of the file can only be the last one, and on 32-bit builds its size could wrap pos around
+		if( chunkSize > bodyAvailable )
+			break;
+
+		// chunks are padded to an even size
+		pos += 8 + size_t( chunkSize ) + size_t( chunkSize & 1 );
+	}
+
+	if( ! foundFormat || ! foundData )
+		throw AudioFileExc( "WAV file is missing its format or data chunk" );
+
+	mNumFrames = mFileNumFrames = size_t( dataSize / mBytesPerFrame );
+}
+
+void SourceFilePcm::parseAiff()
+{
+	const bool isAifc = isId( mFileData + 8, "AIFC" );
+	size_t numFramesInHeader = 0;
+	bool foundCommon = false, foundData = false;
+
+	size_t pos = 12;
+	while( pos + 8 <= mFileSize ) {
+		const char *chunk = mFileData + pos;
+		const char *body = chunk + 8;
+		const size_t chunkSize = readBE32( chunk + 4 );
+		const size_t bodyAvailable = mFileSize - pos - 8;
+
+		if( isId( chunk, "COMM" ) ) {
+			if( chunkSize < 18 || bodyAvailable < 18 || ( isAifc && ( chunkSize < 22 || bodyAvailable < 22 ) ) )
+				throw AudioFileExc( "invalid AIFF common chunk" );
+
+			mNumChannels = readBE16( body );
+			numFramesInHeader = readBE32( body + 2 );
+			const size_t bitsPerSample = readBE16( body + 6 );
+			mNativeSampleRate = (size_t)lround( readExtended( body + 8 ) );
+
+			if( mNumChannels == 0 || bitsPerSample == 0 || bitsPerSample > 64 )
+				throw AudioFileExc( "invalid AIFF common chunk" );
+
+			// samples are read by their container size, left-justified samples with less bits are zero padded in the low bits
+			const size_t bytesPerSample = ( bitsPerSample + 7 ) / 8;
+			const char *compression = isAifc ? body + 18 : "NONE";
+
+			bool bigEndian = true;
+			if( isId( compression, "sowt" ) )
+				bigEndian = false;
+			else if( ! isId( compression, "NONE" ) && ! isId( compression, "twos" ) && ! isId( compression, "fl32" ) && ! isId( compression, "FL32" ) && ! isId( compression, "fl64" ) && ! isId( compression, "FL64" ) )
+				throw AudioFormatExc( "unsupported AIFF-C compression type: " + string( compression, 4 ) );
+
+			if( isId( compression, "fl32" ) || isId( compression, "FL32" ) )
+				setEncoding( Encoding::FLOAT_32, true, 4 );
+			else if( isId( compression, "fl64" ) || isId( compression, "FL64" ) )
+				setEncoding( Encoding::FLOAT_64, true, 8 );
+			else if( bytesPerSample == 1 )
+				setEncoding( Encoding::INT_8, bigEndian, 1 );
+			else if( bytesPerSample == 2 )
+				setEncoding( Encoding::INT_16, bigEndian, 2 );
+			else if( bytesPerSample == 3 )
+				setEncoding( Encoding::INT_24, bigEndian, 3 );
+			else if( bytesPerSample == 4 )
+				setEncoding( Encoding::INT_32, bigEndian, 4 );
+			else
+				throw AudioFormatExc( "unsupported AIFF sample size: " + to_string( bitsPerSample ) );
+
+			foundCommon = true;
+		}
+		else if( isId( chunk, "SSND" ) && ! foundData ) {
+			if( chunkSize < 8 || bodyAvailable < 8 )
+				throw AudioFileExc( "invalid AIFF sound data chunk" );
+
+			// samples begin after the offset and block size fields, plus the offset
+			const size_t offset = readBE32( body );
+			mDataOffset = pos + 16 + offset;
+			if( mDataOffset > mFileSize )
+				throw AudioFileExc( "invalid AIFF sound data chunk" );
+
+			foundData = true;
+		}
+		else if( ( isId( chunk, "NAME" ) || isId( chunk, "AUTH" ) || isId( chunk, "(c) " ) || isId( chunk, "ANNO" ) ) && chunkSize <= bodyAvailable )
+			appendTextEntry( &mMetaData, string( chunk, 4 ), body, chunkSize );
+
+		// a chunk that claims more than the rest of the file can only be the last one, and on 32-bit builds its size could wrap pos around
+		if( chunkSize > bodyAvailable )
+			break;
+
+		pos += 8 + chunkSize + ( chunkSize & 1 );
+	}
+
+	if( ! foundCommon || ! foundData )
+		throw AudioFileExc( "AIFF file is missing its common or sound data chunk" );
+
+	// the frame count is from the header, but unfinished files may have less
+	mNumFrames = mFileNumFrames = min( numFramesInHeader, ( mFileSize - mDataOffset ) / mBytesPerFrame );
+}
+
+void SourceFilePcm::setEncoding( Encoding encoding, bool bigEndian, size_t bytesPerSample )
+{
+	mEncoding = encoding;
+	mBigEndian = bigEndian;
+	mBytesPerSample = bytesPerSample;
+	mBytesPerFrame = bytesPerSample * mNumChannels;
+}
+
+size_t SourceFilePcm::performRead( Buffer *buffer, size_t bufferFrameOffset, size_t numFramesNeeded )
+{
+	CI_ASSERT( buffer->getNumFrames() >= bufferFrameOffset + numFramesNeeded );
+
+	const size_t numFrames = min( numFramesNeeded, mFileNumFrames - mFramePosition );
+	const char *source = mFileData + mDataOffset + mFramePosition * mBytesPerFrame;
+	float *dest = buffer->getData() + bufferFrameOffset;
+	const size_t destFramesPerChannel = buffer->getNumFrames();
+
+	// The most common encodings are de-interleaved directly from the file's contents. Others are first converted
+	// to interleaved floats, a chunk at a time, which is small enough to stay in cache before it is de-interleaved.
+	if( mEncoding == Encoding::INT_16 && ! mBigEndian && isAligned( source, sizeof( int16_t ) ) )
+		dsp::deinterleave( reinterpret_cast<const int16_t *>( source ), dest, destFramesPerChannel, mNumChannels, numFrames );
+	else if( mEncoding == Encoding::FLOAT_32 && ! mBigEndian && isAligned( source, sizeof( float ) ) )
+		dsp::deinterleave( reinterpret_cast<const float *>( source ), dest, destFramesPerChannel, mNumChannels, numFrames );
+	else {
+		const size_t chunkFrames = mConversionBuffer.size() / mNumChannels;
+		for( size_t frame = 0; frame < numFrames; frame += chunkFrames ) {
+			const size_t framesThisChunk = min( chunkFrames, numFrames - frame );
+			convertToFloat( source + frame * mBytesPerFrame, mConversionBuffer.data(), framesThisChunk * mNumChannels );
+			dsp::deinterleave( mConversionBuffer.data(), dest + frame, destFramesPerChannel, mNumChannels, framesThisChunk );
+		}
+	}
+
+	mFramePosition += numFrames;
+	return numFrames;
+}
+
+void SourceFilePcm::convertToFloat( const char *source, float *dest, size_t numSamples )
+{
+	const uint8_t *bytes = reinterpret_cast<const uint8_t *>( source );
+
+	switch( mEncoding ) {
+		case Encoding::INT_8_UNSIGNED:
+			for( size_t i = 0; i < numSamples; i++ )
+				dest[i] = float( int( bytes[i] ) - 128 ) * ( 1.0f / 128.0f );
+			break;
+		case Encoding::INT_8:
+			for( size_t i = 0; i < numSamples; i++ )
+				dest[i] = float( int8_t( bytes[i] ) ) * ( 1.0f / 128.0f );
+			break;
+		case Encoding::INT_16:
+			for( size_t i = 0; i < numSamples; i++ )
+				dest[i] = float( int16_t( mBigEndian ? readBE16( source + i * 2 ) : readLE16( source + i * 2 ) ) ) * ( 1.0f / 32768.0f );
+			break;
+		case Encoding::INT_24:
+			if( ! mBigEndian )
+				dsp::convertInt24ToFloat( source, dest, numSamples );
+			else {
+				// same scale as dsp::convertInt24ToFloat()
+				for( size_t i = 0; i < numSamples; i++, bytes += 3 )
+					dest[i] = float( int32_t( ( uint32_t( bytes[0] ) << 24 ) | ( uint32_t( bytes[1] ) << 16 ) | ( uint32_t( bytes[2] ) << 8 ) ) >> 8 ) * ( 1.0f / 8388607.0f );
+			}
+			break;
+		case Encoding::INT_32:
+			for( size_t i = 0; i < numSamples; i++ )
+				dest[i] = float( int32_t( mBigEndian ? readBE32( source + i * 4 ) : readLE32( source + i * 4 ) ) ) * ( 1.0f / 2147483648.0f );
+			break;
+		case Encoding::FLOAT_32:
+			for( size_t i = 0; i < numSamples; i++ ) {
+				uint32_t bits = mBigEndian ? readBE32( source + i * 4 ) : readLE32( source + i * 4 );
+				memcpy( &dest[i], &bits, sizeof( float ) );
+			}
+			break;
+		case Encoding::FLOAT_64:
+			for( size_t i = 0; i < numSamples; i++ ) {
+				uint64_t bits = mBigEndian ? readBE64( source + i * 8 ) : readLE64( source + i * 8 );
+				double sample;
+				memcpy( &sample, &bits, sizeof( double ) );
+				dest[i] = float( sample );
+			}
+			break;
+		default:
+			CI_ASSERT_NOT_REACHABLE();
+	}
+}
+
+void SourceFilePcm::performSeek( size_t readPositionFrames )
+{
+	mFramePosition = min( readPositionFrames, mFileNumFrames );
+}
+
+string SourceFilePcm::getMetaData() const
+{
+	return mMetaData;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - TargetFilePcm
+// ----------------------------------------------------------------------------------------------------
+
+TargetFilePcm::TargetFilePcm( const DataTargetRef &dataTarget, size_t sampleRate, size_t numChannels, SampleType sampleType, const std::string &extension )
+	: TargetFile( dataTarget, sampleRate, numChannels, sampleType ), mNumFramesWritten( 0 ), mDataOffset( 0 ), mFrameCountOffset( 0 ), mDataSizeOffset( 0 )
+{
+	string ext = extension;
+	transform( ext.begin(), ext.end(), ext.begin(), ::tolower );
+	mIsAiff = ( ext == "aif" || ext == "aiff" || ext == "aifc" );
+
+	switch( mSampleType ) {
+		case SampleType::INT_16:	mBytesPerSample = 2; break;
+		case SampleType::INT_24:	mBytesPerSample = 3; break;
+		case SampleType::FLOAT_32:	mBytesPerSample = 4; break;
+		default: throw AudioFormatExc( "unsupported SampleType" );
+	}
+
+	mStream = dataTarget->getStream();
+	if( ! mStream )
+		throw AudioFileExc( "could not open stream for writing" );
+
+	size_t chunkFrames = max<size_t>( 1, CONVERSION_CHUNK_SIZE / mNumChannels );
+	mInterleavedBuffer.resize( chunkFrames * mNumChannels );
+	mEncodedBuffer.resize( chunkFrames * mNumChannels * mBytesPerSample );
+
+	writeHeader();
+}
+
+TargetFilePcm::~TargetFilePcm()
+{
+	try {
+		updateHeaderSizes();
+	}
+	catch( std::exception &exc ) {
+		CI_LOG_E( "failed to finish writing file header: " << exc.what() );
+	}
+}
+
+// static
+vector<string> TargetFilePcm::getSupportedExtensions()
+{
+	vector<string> result;
+	result.push_back( "wav" );
+	result.push_back( "aif" );
+	result.push_back( "aiff" );
+	result.push_back( "aifc" );
+
+	return result;
+}
+
+void TargetFilePcm::writeHeader()
+{
+	const bool isFloat = ( mSampleType == SampleType::FLOAT_32 );
+	const uint32_t bitsPerSample = uint32_t( mBytesPerSample * 8 );
+	vector<char> header;
+
+	if( mIsAiff ) {
+		// floating point samples need AIFF-C, which adds a format version chunk and names the compression type
+		appendId( &header, "FORM" );
+		appendBE32( &header, 0 );
+		appendId( &header, isFloat ? "AIFC" : "AIFF" );
+		if( isFloat ) {
+			appendId( &header, "FVER" );
+			appendBE32( &header, 4 );
+			appendBE32( &header, 0xA2805140 ); // AIFF-C version 1
+		}
+
+		const char compressionName[] = "\x15" "32-bit floating point"; // pascal string, with an even total length
+		appendId( &header, "COMM" );
+		appendBE32( &header, isFloat ? uint32_t( 18 + 4 + sizeof( compressionName ) - 1 ) : 18 );
+		appendBE16( &header, uint32_t( mNumChannels ) );
+		mFrameCountOffset = header.size();
+		appendBE32( &header, 0 );
+		appendBE16( &header, bitsPerSample );
+		appendExtended( &header, (double)mSampleRate );
+		if( isFloat ) {
+			appendId( &header, "fl32" );
+			header.insert( header.end(), compressionName, compressionName + sizeof( compressionName ) - 1 );
+		}
+
+		appendId( &header, "SSND" );
+		mDataSizeOffset = header.size();
+		appendBE32( &header, 0 );
+		appendBE32( &header, 0 ); // offset
+		appendBE32( &header, 0 ); // block size
+	}
+	else {
+		// more than two channels uses WAVE_FORMAT_EXTENSIBLE, non-PCM formats also need a fact chunk with the frame count
+		const bool isExtensible = ( mNumChannels > 2 );
+		const uint32_t formatTag = isFloat ? 3 : 1;
+
+		appendId( &header, "RIFF" );
+		appendLE32( &header, 0 );
+		appendId( &header, "WAVE" );
+
+		appendId( &header, "fmt " );
+		appendLE32( &header, isExtensible ? 40 : ( isFloat ? 18 : 16 ) );
+		appendLE16( &header, isExtensible ? 0xFFFE : formatTag );
+		appendLE16( &header, uint32_t( mNumChannels ) );
+		appendLE32( &header, uint32_t( mSampleRate ) );
+		appendLE32( &header, uint32_t( mSampleRate * mNumChannels * mBytesPerSample ) );
+		appendLE16( &header, uint32_t( mNumChannels * mBytesPerSample ) );
+		appendLE16( &header, bitsPerSample );
+		if( isExtensible ) {
+			appendLE16( &header, 22 );
+			appendLE16( &header, bitsPerSample );
+			appendLE32( &header, 0 ); // channel mask, speaker positions are unspecified
+			const char subFormatGuid[14] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, (char)0x80, 0x00, 0x00, (char)0xAA, 0x00, 0x38, (char)0x9B, 0x71 };
+			appendLE16( &header, formatTag );
+			header.insert( header.end(), subFormatGuid, subFormatGuid + sizeof( subFormatGuid ) );
+		}
+		else if( isFloat )
+			appendLE16( &header, 0 );
+
+		if( isFloat ) {
+			appendId( &header, "fact" );
+			appendLE32( &header, 4 );
+			mFrameCountOffset = header.size();
+			appendLE32( &header, 0 );
+		}
+
+		appendId( &header, "data" );
+		mDataSizeOffset = header.size();
+		appendLE32( &header, 0 );
+	}
+
+	mDataOffset = header.size();
+	mStream->writeData( header.data(), header.size() );
+}
+
+void TargetFilePcm::updateHeaderSizes()
+{
+	// sizes that don't fit in 32 bits are saturated, as the file is unreadable past that point in either format anyway
+	const uint64_t dataSize = uint64_t( mNumFramesWritten ) * mNumChannels * mBytesPerSample;
+	const bool needsPadding = ( dataSize & 1 ) != 0;
+	if( needsPadding ) {
+		const char pad = 0;
+		mStream->writeData( &pad, 1 );
+	}
+
+	const off_t endOffset = mStream->tell();
+	auto saturate = []( uint64_t size ) { return uint32_t( min<uint64_t>( size, 0xFFFFFFFF ) ); };
+
+	vector<char> field;
+	auto writeField = [&]( size_t offset, uint32_t value ) {
+		field.clear();
+		if( mIsAiff )
+			appendBE32( &field, value );
+		else
+			appendLE32( &field, value );
+
+		mStream->seekAbsolute( (off_t)offset );
+		mStream->writeData( field.data(), field.size() );
+	};
+
+	writeField( 4, saturate( mDataOffset + dataSize + ( needsPadding ? 1 : 0 ) - 8 ) );
+	writeField( mDataSizeOffset, saturate( mIsAiff ? dataSize + 8 : dataSize ) );
+	if( mFrameCountOffset )
+		writeField( mFrameCountOffset, saturate( mNumFramesWritten ) );
+
+	mStream->seekAbsolute( endOffset );
+}
+
+void TargetFilePcm::performWrite( const Buffer *buffer, size_t numFrames, size_t frameOffset )
+{
+	CI_ASSERT( buffer->getNumChannels() == mNumChannels );
+
+	const size_t sourceFramesPerChannel = buffer->getNumFrames();
+	const size_t chunkFrames = mInterleavedBuffer.size() / mNumChannels;
+	char *encoded = mEncodedBuffer.data();
+
+	for( size_t frame = 0; frame < numFrames; frame += chunkFrames ) {
+		const size_t framesThisChunk = min( chunkFrames, numFrames - frame );
+		const size_t numSamples = framesThisChunk * mNumChannels;
+		const float *source = buffer->getData() + frameOffset + frame;
+
+		switch( mSampleType ) {
+			case SampleType::INT_16:
+				dsp::interleave( source, reinterpret_cast<int16_t *>( encoded ), sourceFramesPerChannel, mNumChannels, framesThisChunk );
+				if( mIsAiff ) {
+					for( size_t i = 0; i < numSamples * 2; i += 2 )
+						swap( encoded[i], encoded[i + 1] );
+				}
+				break;
+			case SampleType::INT_24: {
+				float *interleaved = mInterleavedBuffer.data();
+				dsp::interleave( source, interleaved, sourceFramesPerChannel, mNumChannels, framesThisChunk );
+				for( size_t i = 0; i < numSamples; i++ )
+					interleaved[i] = max( -1.0f, min( interleaved[i], 1.0f ) );
+
+				dsp::convertFloatToInt24( interleaved, encoded, numSamples );
+				if( mIsAiff ) {
+					for( size_t i = 0; i < numSamples * 3; i += 3 )
+						swap( encoded[i], encoded[i + 2] );
+				}
+				break;
+			}
+			case SampleType::FLOAT_32:
+				dsp::interleave( source, reinterpret_cast<float *>( encoded ), sourceFramesPerChannel, mNumChannels, framesThisChunk );
+				if( mIsAiff ) {
+					for( size_t i = 0; i < numSamples * 4; i += 4 ) {
+						swap( encoded[i], encoded[i + 3] );
+						swap( encoded[i + 1], encoded[i + 2] );
+					}
+				}
+				break;
+			default:
+				CI_ASSERT_NOT_REACHABLE();
+		}
+
+		mStream->writeData( encoded, numSamples * mBytesPerSample );
+	}
+
+	mNumFramesWritten += numFrames;
+}
+
+} } // namespace cinder::audio
@@ -0,0 +1,175 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/FileStreamScheduler.h"
+#include "cinder/CinderAssert.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+const size_t DEFAULT_NUM_THREADS = 2;
+
+// Client::requestService() notifies without taking the mutex (it may be called from the audio thread), so idle threads
+// also wake up periodically in case a notification was missed.
+const chrono::milliseconds IDLE_TIMEOUT( 10 );
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - FileStreamScheduler::Client
+// ----------------------------------------------------------------------------------------------------
+
+void FileStreamScheduler::Client::requestService()
+{
+	mServiceRequested.store( true, memory_order_release );
+	FileStreamScheduler::get()->notify();
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - FileStreamScheduler
+// ----------------------------------------------------------------------------------------------------
+
+// static
+FileStreamScheduler* FileStreamScheduler::get()
+{
+	static unique_ptr<FileStreamScheduler> sInstance( new FileStreamScheduler );
+	return sInstance.get();
+}
+
+FileStreamScheduler::FileStreamScheduler()
+	: mNumThreads( 0 )
+{
+	setNumThreads( DEFAULT_NUM_THREADS );
+}
+
+FileStreamScheduler::~FileStreamScheduler()
+{
+	setNumThreads( 0 );
+}
+
+void FileStreamScheduler::addClient( Client *client )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	CI_ASSERT( find( mClients.begin(), mClients.end(), client ) == mClients.end() );
+	mClients.push_back( client );
+	mServiceCond.notify_one();
+}
+
+void FileStreamScheduler::removeClient( Client *client )
+{
+	unique_lock<mutex> lock( mMutex );
+
+	mClients.erase( remove( mClients.begin(), mClients.end(), client ), mClients.end() );
+	mClientDoneCond.wait( lock, [client] { return ! client->mIsBeingServiced; } );
+	client->mServiceRequested = false;
+}
+
+void FileStreamScheduler::setNumThreads( size_t numThreads )
+{
+	vector<unique_ptr<thread> > threadsToJoin;
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		mNumThreads = numThreads;
+		while( mThreads.size() < mNumThreads ) {
+			size_t threadIndex = mThreads.size();
+			mThreads.emplace_back( new thread( &FileStreamScheduler::threadImpl, this, threadIndex ) );
+		}
+
+		// threads with an index past mNumThreads exit on their own once woken
+		while( mThreads.size() > mNumThreads ) {
+			threadsToJoin.push_back( move( mThreads.back() ) );
+			mThreads.pop_back();
+		}
+	}
+
+	mServiceCond.notify_all();
+	for( auto &t : threadsToJoin )
+		t->join();
+}
+
+size_t FileStreamScheduler::getNumThreads() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mNumThreads;
+}
+
+void FileStreamScheduler::notify()
+{
+	mServiceCond.notify_one();
+}
+
+FileStreamScheduler::Client* FileStreamScheduler::nextClientLocked()
+{
+	Client *result = nullptr;
+	float resultFill = 0;
+	for( Client *client : mClients ) {
+		if( client->mIsBeingServiced || ! client->mServiceRequested.load( memory_order_acquire ) )
+			continue;
+
+		float fill = client->getStreamFill();
+		if( ! result || fill < resultFill ) {
+			result = client;
+			resultFill = fill;
+		}
+	}
+
+	if( result ) {
+		result->mServiceRequested.store( false, memory_order_release );
+		result->mIsBeingServiced = true;
+
+		// move to the back so that Clients with equal fill are serviced round-robin
+		auto it = find( mClients.begin(), mClients.end(), result );
+		rotate( it, it + 1, mClients.end() );
+	}
+
+	return result;
+}
+
+void FileStreamScheduler::threadImpl( size_t threadIndex )
+{
+	unique_lock<mutex> lock( mMutex );
+	while( threadIndex < mNumThreads ) {
+		Client *client = nextClientLocked();
+		if( ! client ) {
+			mServiceCond.wait_for( lock, IDLE_TIMEOUT );
+			continue;
+		}
+
+		lock.unlock();
+		client->serviceStream();
+		lock.lock();
+
+		client->mIsBeingServiced = false;
+		mClientDoneCond.notify_all();
+	}
+}
+
+} } // namespace cinder::audio
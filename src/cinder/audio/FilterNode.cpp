@@ -37,16 +37,15 @@ void FilterBiquadNode::initialize()
 	// Convert from Hertz to normalized frequency 0 -> 1.
 	mNiquist = getSampleRate() / 2;
 
-	mBufferd = BufferT<double>( getFramesPerBlock(), getNumChannels() );
-	mBiquads.resize( getNumChannels() );
+	mBiquadBank.setSize( getNumChannels() );
 
-	if( mCoeffsDirty )
-		updateBiquadParams();
+	// coefficients need to be copied to the newly sized bank
+	updateBiquadParams();
 }
 
 void FilterBiquadNode::uninitialize()
 {
-	mBiquads.clear();
+	mBiquadBank.setSize( 0 );
 }
 
 void FilterBiquadNode::process( Buffer *buffer )
@@ -54,12 +53,7 @@ void FilterBiquadNode::process( Buffer *buffer )
 	if( mCoeffsDirty )
 		updateBiquadParams();
 
-	size_t numFrames = buffer->getNumFrames();
-
-	for( size_t ch = 0; ch < getNumChannels(); ch++ ) {
-		float *channel = buffer->getChannel( ch );
-		mBiquads[ch].process( channel, channel, numFrames );
-	}
+	mBiquadBank.process( buffer );
 }
 
 void FilterBiquadNode::updateBiquadParams()
@@ -69,40 +63,34 @@ void FilterBiquadNode::updateBiquadParams()
 
 	switch( mMode ) {
 		case Mode::LOWPASS:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setLowpassParams( normalizedFrequency, mQ );
+			mBiquad.setLowpassParams( normalizedFrequency, mQ );
 			break;
 		case Mode::HIGHPASS:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setHighpassParams( normalizedFrequency, mQ );
+			mBiquad.setHighpassParams( normalizedFrequency, mQ );
 			break;
 		case Mode::BANDPASS:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setBandpassParams( normalizedFrequency, mQ );
+			mBiquad.setBandpassParams( normalizedFrequency, mQ );
 			break;
 		case Mode::LOWSHELF:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setLowShelfParams( mFreq, mGain );;
+			mBiquad.setLowShelfParams( mFreq, mGain );
 			break;
 		case Mode::HIGHSHELF:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setHighShelfParams( mFreq, mGain );;
+			mBiquad.setHighShelfParams( mFreq, mGain );
 			break;
 		case Mode::PEAKING:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setPeakingParams( normalizedFrequency, mQ, mGain );
+			mBiquad.setPeakingParams( normalizedFrequency, mQ, mGain );
 			break;
 		case Mode::ALLPASS:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setBandpassParams( normalizedFrequency, mQ );
+			mBiquad.setBandpassParams( normalizedFrequency, mQ );
 			break;
 		case Mode::NOTCH:
-			for( size_t ch = 0; ch < getNumChannels(); ch++ )
-				mBiquads[ch].setNotchParams( normalizedFrequency, mQ );
+			mBiquad.setNotchParams( normalizedFrequency, mQ );
 			break;
 		default:
 			break;
 	}
+
+	mBiquadBank.setCoefficients( 0, mBiquad );
 }
 
 } } // namespace cinder::audio
@@ -28,6 +28,10 @@
 #include "cinder/CinderMath.h"
 #include "cinder/Rand.h"
 
+#if defined( CINDER_AUDIO_SSE )
+	#include <emmintrin.h>
+#endif
+
 #define DEFAULT_TABLE_SIZE 4096
 #define DEFAULT_BANDLIMITED_TABLES 40
 
@@ -368,4 +372,282 @@ void GenPulseNode::process( Buffer *buffer )
 	dsp::sub( outputData, data2, outputData, numFrames );
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - GenOscBankNode
+// ----------------------------------------------------------------------------------------------------
+
+namespace {
+
+#if defined( CINDER_AUDIO_SSE )
+
+// Linearly interpolated lookup of four phases, each into its own table. There is no gather instruction in SSE so the
+// samples are loaded individually, but the index and interpolation math is done four wide.
+inline __m128 tableLookup4( const float * const *tables, __m128 phase, __m128 tableSizeF, __m128i tableMask )
+{
+	const __m128 pos = _mm_mul_ps( phase, tableSizeF );
+	const __m128i index1 = _mm_cvttps_epi32( pos );
+	const __m128 frac = _mm_sub_ps( pos, _mm_cvtepi32_ps( index1 ) );
+
+	// indices are masked, so a phase that rounded up to 1 wraps to the start of the table
+	const __m128i index2 = _mm_and_si128( _mm_add_epi32( index1, _mm_set1_epi32( 1 ) ), tableMask );
+
+	int32_t i1[4];
+	int32_t i2[4];
+	_mm_storeu_si128( (__m128i *)i1, _mm_and_si128( index1, tableMask ) );
+	_mm_storeu_si128( (__m128i *)i2, index2 );
+
+	const __m128 val1 = _mm_set_ps( tables[3][i1[3]], tables[2][i1[2]], tables[1][i1[1]], tables[0][i1[0]] );
+	const __m128 val2 = _mm_set_ps( tables[3][i2[3]], tables[2][i2[2]], tables[1][i2[1]], tables[0][i2[0]] );
+
+	return _mm_add_ps( val1, _mm_mul_ps( frac, _mm_sub_ps( val2, val1 ) ) );
+}
+
+// phase - floor( phase ), four wide
+inline __m128 fract4( __m128 phase )
+{
+	__m128 floored = _mm_cvtepi32_ps( _mm_cvttps_epi32( phase ) );
+	floored = _mm_sub_ps( floored, _mm_and_ps( _mm_cmpgt_ps( floored, phase ), _mm_set1_ps( 1 ) ) );
+	return _mm_sub_ps( phase, floored );
+}
+
+#endif // defined( CINDER_AUDIO_SSE )
+
+} // anonymous namespace
+
+GenOscBankNode::GenOscBankNode( const Format &format )
+	: InputNode( format ), mTablesSource( nullptr ), mWaveformType( WaveformType::SINE ), mNeedsPhaseReset( false ),
+		mFreqs( format.getMaxNumOscillators() ), mGains( format.getMaxNumOscillators() )
+{
+	initImpl();
+}
+
+GenOscBankNode::GenOscBankNode( WaveformType waveformType, const Format &format )
+	: InputNode( format ), mTablesSource( nullptr ), mWaveformType( waveformType ), mNeedsPhaseReset( false ),
+		mFreqs( format.getMaxNumOscillators() ), mGains( format.getMaxNumOscillators() )
+{
+	initImpl();
+}
+
+void GenOscBankNode::initImpl()
+{
+	setChannelMode( ChannelMode::SPECIFIED );
+	setNumChannels( 1 );
+
+	for( size_t i = 0; i < mFreqs.size(); i++ ) {
+		mFreqs[i] = 0;
+		mGains[i] = 0;
+	}
+
+	// pad to a multiple of four so that the render loop never needs a remainder
+	const size_t paddedSize = ( ( mFreqs.size() + 3 ) / 4 ) * 4;
+	mPhases.resize( paddedSize, 0 );
+	mPhaseIncrs.resize( paddedSize, 0 );
+	mGainsApplied.resize( paddedSize, 0 );
+	mGainsTarget.resize( paddedSize, 0 );
+	mTables.resize( paddedSize, nullptr );
+}
+
+void GenOscBankNode::setOscillator( size_t index, float freq, float gain )
+{
+	setFreq( index, freq );
+	setGain( index, gain );
+}
+
+void GenOscBankNode::setFreq( size_t index, float freq )
+{
+	if( index >= mFreqs.size() )
+		throw AudioExc( "oscillator index out of range: " + to_string( index ) );
+
+	mFreqs[index] = freq;
+}
+
+float GenOscBankNode::getFreq( size_t index ) const
+{
+	return index < mFreqs.size() ? mFreqs[index].load() : 0;
+}
+
+void GenOscBankNode::setGain( size_t index, float gain )
+{
+	if( index >= mGains.size() )
+		throw AudioExc( "oscillator index out of range: " + to_string( index ) );
+
+	mGains[index] = gain;
+}
+
+float GenOscBankNode::getGain( size_t index ) const
+{
+	return index < mGains.size() ? mGains[index].load() : 0;
+}
+
+void GenOscBankNode::initialize()
+{
+	mSamplePeriod = 1.0f / (float)getSampleRate();
+
+	size_t sampleRate = getSampleRate();
+	bool needsFill = false;
+	if( ! mWaveTable ) {
+		mWaveTable.reset( new WaveTable2d( sampleRate, DEFAULT_TABLE_SIZE, DEFAULT_BANDLIMITED_TABLES ) );
+		needsFill = true;
+	}
+	else if( sampleRate != mWaveTable->getSampleRate() )
+		needsFill = true;
+
+	if( needsFill )
+		mWaveTable->fillBandlimited( mWaveformType );
+
+	// force the table pointers to be refreshed, as the wavetable's contents may have been reallocated.
+	mTablesSource = nullptr;
+}
+
+void GenOscBankNode::setWaveform( WaveformType waveformType )
+{
+	if( mWaveformType == waveformType )
+		return;
+
+	if( ! isInitialized() )
+		getContext()->initializeNode( shared_from_this() );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	mWaveformType = waveformType;
+	mWaveTable->fillBandlimited( waveformType );
+	mTablesSource = nullptr;
+}
+
+void GenOscBankNode::updateOscillators()
+{
+	const WaveTable2d *waveTable = mWaveTable.get();
+	const bool tablesChanged = mTablesSource != waveTable;
+	mTablesSource = waveTable;
+
+	if( mNeedsPhaseReset.exchange( false ) )
+		fill( mPhases.begin(), mPhases.end(), 0.0f );
+
+	const float samplePeriod = mSamplePeriod;
+	for( size_t i = 0; i < mFreqs.size(); i++ ) {
+		const float freq = mFreqs[i].load( memory_order_relaxed );
+		const float phaseIncr = freq * samplePeriod;
+
+		// choosing the band-limited table requires a log, so only do it when the frequency changes
+		if( phaseIncr != mPhaseIncrs[i] || tablesChanged ) {
+			mPhaseIncrs[i] = phaseIncr;
+			mTables[i] = waveTable->getBandLimitedTable( freq );
+		}
+
+		mGainsTarget[i] = mGains[i].load( memory_order_relaxed );
+	}
+
+	if( tablesChanged ) {
+		for( size_t i = mFreqs.size(); i < mTables.size(); i++ )
+			mTables[i] = waveTable->getBandLimitedTable( 0 );
+	}
+}
+
+void GenOscBankNode::process( Buffer *buffer )
+{
+	const auto &frameRange = getProcessFramesRange();
+	const size_t numFrames = frameRange.second - frameRange.first;
+	float *output = buffer->getData() + frameRange.first;
+
+	// oscillators are summed into the output
+	dsp::fill( 0, output, numFrames );
+	updateOscillators();
+
+	for( size_t osc = 0; osc < mPhases.size(); osc += 4 ) {
+		float *gainsApplied = &mGainsApplied[osc];
+		const float *gainsTarget = &mGainsTarget[osc];
+
+		bool silent = true;
+		for( size_t i = 0; i < 4; i++ ) {
+			if( gainsApplied[i] != 0 || gainsTarget[i] != 0 ) {
+				silent = false;
+				break;
+			}
+		}
+
+		if( silent ) {
+			// keep the phases moving so that oscillators which are faded back in stay consistent with each other
+			for( size_t i = osc; i < osc + 4; i++ )
+				mPhases[i] = fract( mPhases[i] + mPhaseIncrs[i] * (float)numFrames );
+		}
+		else
+			renderGroup( osc, output, numFrames );
+
+		for( size_t i = 0; i < 4; i++ )
+			gainsApplied[i] = gainsTarget[i];
+	}
+}
+
+#if defined( CINDER_AUDIO_SSE )
+
+// Renders the four oscillators starting at firstOscillator and sums them into output. Each frame produces one vector of four
+// oscillator samples; every four frames these are transposed so that the oscillators can be summed with vertical adds.
+void GenOscBankNode::renderGroup( size_t firstOscillator, float *output, size_t numFrames )
+{
+	const float * const *tables = &mTables[firstOscillator];
+	const size_t tableSize = mTablesSource->getTableSize();
+	const __m128 tableSizeF = _mm_set1_ps( (float)tableSize );
+	const __m128i tableMask = _mm_set1_epi32( int32_t( tableSize - 1 ) );
+
+	__m128 phase = _mm_loadu_ps( &mPhases[firstOscillator] );
+	const __m128 phaseIncr = _mm_loadu_ps( &mPhaseIncrs[firstOscillator] );
+	__m128 gain = _mm_loadu_ps( &mGainsApplied[firstOscillator] );
+	const __m128 gainIncr = _mm_div_ps( _mm_sub_ps( _mm_loadu_ps( &mGainsTarget[firstOscillator] ), gain ), _mm_set1_ps( (float)numFrames ) );
+
+	size_t i = 0;
+	for( ; i + 4 <= numFrames; i += 4 ) {
+		__m128 frames[4];
+		for( size_t k = 0; k < 4; k++ ) {
+			frames[k] = _mm_mul_ps( tableLookup4( tables, phase, tableSizeF, tableMask ), gain );
+			phase = fract4( _mm_add_ps( phase, phaseIncr ) );
+			gain = _mm_add_ps( gain, gainIncr );
+		}
+
+		_MM_TRANSPOSE4_PS( frames[0], frames[1], frames[2], frames[3] );
+		const __m128 sum = _mm_add_ps( _mm_add_ps( frames[0], frames[1] ), _mm_add_ps( frames[2], frames[3] ) );
+		_mm_storeu_ps( output + i, _mm_add_ps( _mm_loadu_ps( output + i ), sum ) );
+	}
+
+	for( ; i < numFrames; i++ ) {
+		float lanes[4];
+		_mm_storeu_ps( lanes, _mm_mul_ps( tableLookup4( tables, phase, tableSizeF, tableMask ), gain ) );
+		output[i] += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+		phase = fract4( _mm_add_ps( phase, phaseIncr ) );
+		gain = _mm_add_ps( gain, gainIncr );
+	}
+
+	_mm_storeu_ps( &mPhases[firstOscillator], phase );
+}
+
+#else
+
+void GenOscBankNode::renderGroup( size_t firstOscillator, float *output, size_t numFrames )
+{
+	const size_t tableSize = mTablesSource->getTableSize();
+
+	for( size_t osc = firstOscillator; osc < firstOscillator + 4; osc++ ) {
+		const float *table = mTables[osc];
+		const float phaseIncr = mPhaseIncrs[osc];
+		const float gainBegin = mGainsApplied[osc];
+		const float gainIncr = ( mGainsTarget[osc] - gainBegin ) / (float)numFrames;
+		float phase = mPhases[osc];
+
+		for( size_t i = 0; i < numFrames; i++ ) {
+			const float pos = phase * tableSize;
+			const size_t index1 = size_t( pos ) & ( tableSize - 1 );
+			const size_t index2 = ( index1 + 1 ) & ( tableSize - 1 );
+			const float frac = pos - (float)size_t( pos );
+			const float val = table[index1] + frac * ( table[index2] - table[index1] );
+
+			output[i] += val * ( gainBegin + gainIncr * (float)i );
+			phase = fract( phase + phaseIncr );
+		}
+
+		mPhases[osc] = phase;
+	}
+}
+
+#endif // defined( CINDER_AUDIO_SSE )
+
 } } // namespace cinder::audio
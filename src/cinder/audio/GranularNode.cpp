@@ -0,0 +1,258 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/GranularNode.h"
+#include "cinder/audio/Context.h"
+#include "cinder/audio/SampleCache.h"
+#include "cinder/CinderMath.h"
+
+using namespace ci;
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+const size_t WINDOW_TABLE_SIZE = 1024;
+
+inline float valueAt( const Param &param, const float *valueArray, size_t frame )
+{
+	return valueArray ? valueArray[frame] : param.getValue();
+}
+
+} // anonymous namespace
+
+GranularNode::GranularNode( const Format &format )
+	: InputNode( format ), mParamDensity( this, 20 ), mParamGrainDuration( this, 0.1f ), mParamPosition( this, 0 ), mParamPitch( this, 1 ),
+		mPositionJitter( 0 ), mPitchJitter( 0 ), mGrains( format.getMaxNumGrains() ), mWindow( WINDOW_TABLE_SIZE + 1 ),
+		mFramesUntilNextGrain( 0 ), mSampleRate( 0 ), mNumActiveGrains( 0 ), mNumDroppedGrains( 0 )
+{
+	dsp::generateWindow( format.getWindowType(), mWindow.data(), mWindow.size() );
+	initImpl();
+}
+
+GranularNode::GranularNode( const BufferRef &buffer, const Format &format )
+	: InputNode( format ), mBuffer( buffer ), mParamDensity( this, 20 ), mParamGrainDuration( this, 0.1f ), mParamPosition( this, 0 ), mParamPitch( this, 1 ),
+		mPositionJitter( 0 ), mPitchJitter( 0 ), mGrains( format.getMaxNumGrains() ), mWindow( WINDOW_TABLE_SIZE + 1 ),
+		mFramesUntilNextGrain( 0 ), mSampleRate( 0 ), mNumActiveGrains( 0 ), mNumDroppedGrains( 0 )
+{
+	dsp::generateWindow( format.getWindowType(), mWindow.data(), mWindow.size() );
+	initImpl();
+
+	// force channel mode to match buffer
+	if( mBuffer )
+		setNumChannels( mBuffer->getNumChannels() );
+}
+
+void GranularNode::initImpl()
+{
+	setChannelMode( ChannelMode::SPECIFIED );
+
+	// the active and free lists never grow past the pool size, so reserving here means processing never allocates
+	mActiveGrains.reserve( mGrains.size() );
+	mFreeGrains.reserve( mGrains.size() );
+	for( size_t i = 0; i < mGrains.size(); i++ )
+		mFreeGrains.push_back( mGrains.size() - i - 1 );
+}
+
+void GranularNode::setBuffer( const BufferRef &buffer )
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	if( buffer && getNumChannels() != buffer->getNumChannels() ) {
+		setNumChannels( buffer->getNumChannels() );
+		configureConnections();
+	}
+
+	mBuffer = buffer;
+}
+
+void GranularNode::loadBuffer( const SourceFileRef &sourceFile )
+{
+	setBuffer( SampleCache::get()->loadBuffer( sourceFile, getSampleRate() ) );
+}
+
+void GranularNode::loadBuffer( const DataSourceRef &dataSource )
+{
+	setBuffer( SampleCache::get()->loadBuffer( dataSource, getSampleRate() ) );
+}
+
+void GranularNode::initialize()
+{
+	mSampleRate = (float)getSampleRate();
+	mFramesUntilNextGrain = 0;
+
+	const size_t framesPerBlock = getFramesPerBlock();
+	mReadIndices.resize( framesPerBlock );
+	mReadFractions.resize( framesPerBlock );
+	mGrainGains.resize( framesPerBlock );
+
+	for( size_t index : mActiveGrains )
+		mFreeGrains.push_back( index );
+
+	mActiveGrains.clear();
+	mNumActiveGrains = 0;
+}
+
+void GranularNode::process( Buffer *buffer )
+{
+	const auto &frameRange = getProcessFramesRange();
+	const size_t numFrames = frameRange.second - frameRange.first;
+
+	// grains are summed into the output
+	for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ )
+		dsp::fill( 0, buffer->getChannel( ch ) + frameRange.first, numFrames );
+
+	const Buffer *source = mBuffer.get();
+	if( ! source || ! source->getNumFrames() )
+		return;
+
+	// schedule the grains that begin during this block, reading the Params at each grain's first frame
+	const float *densityArray = mParamDensity.eval() ? mParamDensity.getValueArray() : nullptr;
+	const float *durationArray = mParamGrainDuration.eval() ? mParamGrainDuration.getValueArray() : nullptr;
+	const float *positionArray = mParamPosition.eval() ? mParamPosition.getValueArray() : nullptr;
+	const float *pitchArray = mParamPitch.eval() ? mParamPitch.getValueArray() : nullptr;
+
+	while( mFramesUntilNextGrain < (double)numFrames ) {
+		const size_t startFrame = (size_t)mFramesUntilNextGrain;
+		const size_t paramFrame = frameRange.first + startFrame;
+
+		const float density = valueAt( mParamDensity, densityArray, paramFrame );
+		if( density <= 0 ) {
+			// check again at the start of the next block
+			mFramesUntilNextGrain = (double)numFrames;
+			break;
+		}
+
+		startGrain( startFrame, valueAt( mParamGrainDuration, durationArray, paramFrame ), valueAt( mParamPosition, positionArray, paramFrame ), valueAt( mParamPitch, pitchArray, paramFrame ) );
+		mFramesUntilNextGrain += mSampleRate / density;
+	}
+
+	mFramesUntilNextGrain -= (double)numFrames;
+
+	// render active grains, removing those that finish by swapping in the last one
+	for( size_t i = 0; i < mActiveGrains.size(); ) {
+		const size_t index = mActiveGrains[i];
+		Grain *grain = &mGrains[index];
+
+		const size_t grainFrames = min( numFrames - grain->mStartFrame, grain->mFramesLeft );
+		renderGrain( grain, source, buffer, frameRange.first + grain->mStartFrame, grainFrames );
+		grain->mStartFrame = 0;
+
+		if( grain->mFramesLeft == 0 ) {
+			mFreeGrains.push_back( index );
+			mActiveGrains[i] = mActiveGrains.back();
+			mActiveGrains.pop_back();
+		}
+		else
+			i++;
+	}
+
+	mNumActiveGrains = mActiveGrains.size();
+}
+
+void GranularNode::startGrain( size_t startFrame, float durationSeconds, float positionSeconds, float pitch )
+{
+	if( mFreeGrains.empty() ) {
+		mNumDroppedGrains++;
+		return;
+	}
+
+	const size_t index = mFreeGrains.back();
+	mFreeGrains.pop_back();
+	mActiveGrains.push_back( index );
+
+	const float positionJitter = mPositionJitter;
+	if( positionJitter > 0 )
+		positionSeconds += mRand.nextFloat( -positionJitter, positionJitter );
+
+	const float pitchJitter = mPitchJitter;
+	if( pitchJitter > 0 )
+		pitch *= powf( 2.0f, mRand.nextFloat( -pitchJitter, pitchJitter ) / 12.0f );
+
+	const double sourceFrames = (double)mBuffer->getNumFrames();
+	double readPos = fmod( (double)positionSeconds * mSampleRate, sourceFrames );
+	if( readPos < 0 )
+		readPos += sourceFrames;
+
+	const size_t durationFrames = max<size_t>( 1, size_t( durationSeconds * mSampleRate ) );
+
+	Grain &grain = mGrains[index];
+	grain.mReadPos = readPos;
+	grain.mRate = max( pitch, 0.0f );
+	grain.mWindowPos = 0;
+	grain.mWindowIncr = (float)WINDOW_TABLE_SIZE / (float)durationFrames;
+	grain.mFramesLeft = durationFrames;
+	grain.mStartFrame = startFrame;
+}
+
+// Computes the read positions and window gains for each frame first, so they are shared by all channels and the per channel
+// overlap-add is a simple loop that can be vectorized apart from the sample loads.
+void GranularNode::renderGrain( Grain *grain, const Buffer *source, Buffer *dest, size_t frameOffset, size_t numFrames )
+{
+	const size_t sourceFrames = source->getNumFrames();
+	const double rate = grain->mRate;
+
+	// the Buffer may have been replaced with a shorter one since the grain started
+	double readPos = grain->mReadPos;
+	if( readPos >= (double)sourceFrames )
+		readPos = fmod( readPos, (double)sourceFrames );
+
+	size_t *readIndices = mReadIndices.data();
+	float *readFractions = mReadFractions.data();
+	float *gains = mGrainGains.data();
+	const float *window = mWindow.data();
+
+	for( size_t i = 0; i < numFrames; i++ ) {
+		const double pos = readPos + rate * (double)i;
+		size_t index = (size_t)pos;
+		readFractions[i] = float( pos - (double)index );
+		while( index >= sourceFrames )
+			index -= sourceFrames;
+		readIndices[i] = index;
+
+		const float windowPos = grain->mWindowPos + grain->mWindowIncr * (float)i;
+		const size_t windowIndex = min( (size_t)windowPos, WINDOW_TABLE_SIZE - 1 );
+		const float windowFrac = windowPos - (float)windowIndex;
+		gains[i] = window[windowIndex] + windowFrac * ( window[windowIndex + 1] - window[windowIndex] );
+	}
+
+	const size_t numChannels = min( source->getNumChannels(), dest->getNumChannels() );
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		const float *sourceChannel = source->getChannel( ch );
+		float *destChannel = dest->getChannel( ch ) + frameOffset;
+
+		for( size_t i = 0; i < numFrames; i++ ) {
+			const size_t i0 = readIndices[i];
+			const size_t i1 = i0 + 1 == sourceFrames ? 0 : i0 + 1;
+			const float val0 = sourceChannel[i0];
+			destChannel[i] += gains[i] * ( val0 + readFractions[i] * ( sourceChannel[i1] - val0 ) );
+		}
+	}
+
+	grain->mReadPos = fmod( readPos + rate * (double)numFrames, (double)sourceFrames );
+	grain->mWindowPos += grain->mWindowIncr * (float)numFrames;
+	grain->mFramesLeft -= numFrames;
+}
+
+} } // namespace cinder::audio
@@ -0,0 +1,391 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/LoudnessMeterNode.h"
+#include "cinder/audio/Context.h"
+#include "cinder/audio/dsp/Dsp.h"
+#include "cinder/CinderMath.h"
+
+#include <cmath>
+#include <limits>
+
+#if defined( CINDER_AUDIO_SSE )
+	#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+const size_t NUM_MOMENTARY_SUB_BLOCKS = 4;		// 400 ms
+const size_t NUM_SHORT_TERM_SUB_BLOCKS = 30;	// 3 s
+const float ABSOLUTE_GATE = -70;
+const float RELATIVE_GATE = -10;
+const float HISTOGRAM_MAX_LOUDNESS = 10;
+const size_t HISTOGRAM_BINS_PER_LU = 10;
+const size_t NUM_HISTOGRAM_BINS = size_t( ( HISTOGRAM_MAX_LOUDNESS - ABSOLUTE_GATE ) * HISTOGRAM_BINS_PER_LU );
+
+// true peak oversampling filter: 4 phases of 12 taps, as in BS.1770-4 Annex 2
+const size_t TRUE_PEAK_NUM_PHASES = 4;
+const size_t TRUE_PEAK_NUM_TAPS = 12;
+
+const float NEGATIVE_INFINITY = -numeric_limits<float>::infinity();
+
+float meanSquareToLoudness( double meanSquare )
+{
+	return meanSquare > 0 ? float( -0.691 + 10 * log10( meanSquare ) ) : NEGATIVE_INFINITY;
+}
+
+float linearToDecibels( float value )
+{
+	return value > 0 ? 20 * log10( value ) : NEGATIVE_INFINITY;
+}
+
+float defaultChannelWeight( size_t channel, size_t numChannels )
+{
+	// 5.1 in the order L, R, C, LFE, Ls, Rs
+	if( numChannels == 6 ) {
+		if( channel == 3 )
+			return 0;
+		else if( channel >= 4 )
+			return 1.41f;
+	}
+
+	return 1;
+}
+
+float sumSquares( const float *array, size_t length )
+{
+	size_t i = 0;
+	float result = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	__m128 sum4 = _mm_setzero_ps();
+	for( ; i + 4 <= length; i += 4 ) {
+		__m128 x = _mm_loadu_ps( array + i );
+		sum4 = _mm_add_ps( sum4, _mm_mul_ps( x, x ) );
+	}
+
+	float sums[4];
+	_mm_storeu_ps( sums, sum4 );
+	result = ( sums[0] + sums[1] ) + ( sums[2] + sums[3] );
+#endif
+
+	for( ; i < length; i++ )
+		result += array[i] * array[i];
+
+	return result;
+}
+
+// Designs the two stage K-weighting filter (a high shelf followed by the RLB high-pass) for \a sampleRate, from the analog prototypes that
+// the 48 kHz coefficients of BS.1770 are derived from.
+void setKWeightingCoefficients( dsp::BiquadBank *bank, size_t channel, double sampleRate )
+{
+	// stage 1: high shelf of about +4 dB
+	{
+		const double f0 = 1681.974450955533;
+		const double gainDb = 3.999843853973347;
+		const double q = 0.7071752369554196;
+
+		const double k = tan( M_PI * f0 / sampleRate );
+		const double vh = pow( 10.0, gainDb / 20.0 );
+		const double vb = pow( vh, 0.4996667741545416 );
+		const double a0 = 1.0 + k / q + k * k;
+
+		bank->setCoefficients( channel, 0, ( vh + vb * k / q + k * k ) / a0, 2.0 * ( k * k - vh ) / a0, ( vh - vb * k / q + k * k ) / a0,
+							   2.0 * ( k * k - 1.0 ) / a0, ( 1.0 - k / q + k * k ) / a0 );
+	}
+	// stage 2: RLB high-pass
+	{
+		const double f0 = 38.13547087602444;
+		const double q = 0.5003270373238773;
+
+		const double k = tan( M_PI * f0 / sampleRate );
+		const double a0 = 1.0 + k / q + k * k;
+
+		bank->setCoefficients( channel, 1, 1.0, -2.0, 1.0, 2.0 * ( k * k - 1.0 ) / a0, ( 1.0 - k / q + k * k ) / a0 );
+	}
+}
+
+} // anonymous namespace
+
+LoudnessMeterNode::LoudnessMeterNode( const Format &format )
+	: NodeAutoPullable( format ), mSubBlockFrames( 0 ), mSubBlockPos( 0 ), mNumSubBlocks( 0 ), mSubBlockEnergy( 0 ), mMomentarySum( 0 ),
+		mShortTermSum( 0 ), mGatedEnergy( 0 ), mNumGatedBlocks( 0 ), mTruePeakLinear( 0 ), mMomentaryLoudness( NEGATIVE_INFINITY ),
+		mShortTermLoudness( NEGATIVE_INFINITY ), mIntegratedLoudness( NEGATIVE_INFINITY ), mMaxMomentaryLoudness( NEGATIVE_INFINITY ),
+		mTruePeak( NEGATIVE_INFINITY ), mResetRequested( false )
+{
+	// Windowed sinc interpolator, laid out as [tap][phase] so that one input sample produces all four phases at once.
+	// Each phase is normalized to unity gain at DC.
+	const size_t filterLength = TRUE_PEAK_NUM_PHASES * TRUE_PEAK_NUM_TAPS;
+	const double center = double( filterLength - 1 ) / 2.0;
+	vector<double> filter( filterLength );
+	for( size_t i = 0; i < filterLength; i++ ) {
+		double x = ( double( i ) - center ) / double( TRUE_PEAK_NUM_PHASES );
+		double sinc = x == 0 ? 1.0 : sin( M_PI * x ) / ( M_PI * x );
+		double window = 0.42 - 0.5 * cos( 2 * M_PI * ( i + 0.5 ) / filterLength ) + 0.08 * cos( 4 * M_PI * ( i + 0.5 ) / filterLength );
+		filter[i] = sinc * window;
+	}
+
+	mTruePeakCoeffs = makeAlignedArray<float>( filterLength );
+	for( size_t phase = 0; phase < TRUE_PEAK_NUM_PHASES; phase++ ) {
+		double phaseSum = 0;
+		for( size_t tap = 0; tap < TRUE_PEAK_NUM_TAPS; tap++ )
+			phaseSum += filter[tap * TRUE_PEAK_NUM_PHASES + phase];
+
+		for( size_t tap = 0; tap < TRUE_PEAK_NUM_TAPS; tap++ )
+			mTruePeakCoeffs.get()[tap * TRUE_PEAK_NUM_PHASES + phase] = float( filter[tap * TRUE_PEAK_NUM_PHASES + phase] / phaseSum );
+	}
+}
+
+LoudnessMeterNode::~LoudnessMeterNode()
+{
+}
+
+void LoudnessMeterNode::initialize()
+{
+	const size_t numChannels = getNumChannels();
+	const size_t sampleRate = getSampleRate();
+	const size_t framesPerBlock = getFramesPerBlock();
+
+	mKWeighting.setSize( numChannels, 2 );
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		setKWeightingCoefficients( &mKWeighting, ch, (double)sampleRate );
+
+	mWeightedBuffer = Buffer( framesPerBlock, numChannels );
+	mTruePeakHistory = Buffer( TRUE_PEAK_NUM_TAPS - 1, numChannels );
+	mTruePeakScratch.resize( TRUE_PEAK_NUM_TAPS - 1 + framesPerBlock );
+
+	mChannelWeights.resize( numChannels );
+	mChannelWeightIsSet.resize( numChannels, false );
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		if( ! mChannelWeightIsSet[ch] )
+			mChannelWeights[ch] = defaultChannelWeight( ch, numChannels );
+	}
+
+	mSubBlockFrames = max<size_t>( 1, ( sampleRate + 5 ) / 10 );
+	mSubBlockEnergies.resize( NUM_SHORT_TERM_SUB_BLOCKS );
+	mGatingBinEnergies.resize( NUM_HISTOGRAM_BINS );
+	mGatingBinCounts.resize( NUM_HISTOGRAM_BINS );
+
+	resetMeasurements();
+}
+
+void LoudnessMeterNode::setChannelWeight( size_t channel, float weight )
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	if( channel >= mChannelWeights.size() ) {
+		for( size_t ch = mChannelWeights.size(); ch <= channel; ch++ )
+			mChannelWeights.push_back( defaultChannelWeight( ch, getNumChannels() ) );
+
+		mChannelWeightIsSet.resize( channel + 1, false );
+	}
+
+	mChannelWeights[channel] = weight;
+	mChannelWeightIsSet[channel] = true;
+}
+
+float LoudnessMeterNode::getChannelWeight( size_t channel ) const
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	return channel < mChannelWeights.size() ? mChannelWeights[channel] : defaultChannelWeight( channel, getNumChannels() );
+}
+
+void LoudnessMeterNode::process( Buffer *buffer )
+{
+	if( mResetRequested.exchange( false ) )
+		resetMeasurements();
+
+	const size_t numFrames = buffer->getNumFrames();
+	const size_t numChannels = min( buffer->getNumChannels(), mWeightedBuffer.getNumChannels() );
+
+	// true peak of the unweighted input
+	float truePeak = mTruePeakLinear;
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		truePeak = max( truePeak, measureTruePeak( buffer->getChannel( ch ), numFrames, mTruePeakHistory.getChannel( ch ) ) );
+
+	if( truePeak > mTruePeakLinear ) {
+		mTruePeakLinear = truePeak;
+		mTruePeak = linearToDecibels( truePeak );
+	}
+
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		memcpy( mWeightedBuffer.getChannel( ch ), buffer->getChannel( ch ), numFrames * sizeof( float ) );
+
+	mKWeighting.process( &mWeightedBuffer, numFrames );
+
+	// accumulate the weighted energy into sub-blocks, which may end part way through the processing block
+	size_t offset = 0;
+	while( offset < numFrames ) {
+		size_t count = min( numFrames - offset, mSubBlockFrames - mSubBlockPos );
+		for( size_t ch = 0; ch < numChannels; ch++ ) {
+			float weight = mChannelWeights[ch];
+			if( weight != 0 )
+				mSubBlockEnergy += weight * sumSquares( mWeightedBuffer.getChannel( ch ) + offset, count );
+		}
+
+		mSubBlockPos += count;
+		offset += count;
+
+		if( mSubBlockPos == mSubBlockFrames )
+			finishSubBlock();
+	}
+}
+
+void LoudnessMeterNode::finishSubBlock()
+{
+	// update the running sums with the newest sub-block, removing the ones that left each window
+	const size_t index = mNumSubBlocks % NUM_SHORT_TERM_SUB_BLOCKS;
+	const size_t momentaryExpiredIndex = ( index + NUM_SHORT_TERM_SUB_BLOCKS - NUM_MOMENTARY_SUB_BLOCKS ) % NUM_SHORT_TERM_SUB_BLOCKS;
+
+	mMomentarySum += mSubBlockEnergy - mSubBlockEnergies[momentaryExpiredIndex];
+	mShortTermSum += mSubBlockEnergy - mSubBlockEnergies[index];
+	mSubBlockEnergies[index] = mSubBlockEnergy;
+	mNumSubBlocks++;
+	mSubBlockEnergy = 0;
+	mSubBlockPos = 0;
+
+	// recompute the sums once per cycle through the sub-blocks so that rounding errors don't accumulate
+	if( index == NUM_SHORT_TERM_SUB_BLOCKS - 1 ) {
+		mMomentarySum = mShortTermSum = 0;
+		for( size_t i = 0; i < NUM_SHORT_TERM_SUB_BLOCKS; i++ ) {
+			mShortTermSum += mSubBlockEnergies[i];
+			if( i + NUM_MOMENTARY_SUB_BLOCKS >= NUM_SHORT_TERM_SUB_BLOCKS )
+				mMomentarySum += mSubBlockEnergies[i];
+		}
+	}
+
+	const double momentaryMeanSquare = max( 0.0, mMomentarySum ) / double( NUM_MOMENTARY_SUB_BLOCKS * mSubBlockFrames );
+	const double shortTermMeanSquare = max( 0.0, mShortTermSum ) / double( NUM_SHORT_TERM_SUB_BLOCKS * mSubBlockFrames );
+	const float momentaryLoudness = meanSquareToLoudness( momentaryMeanSquare );
+
+	mMomentaryLoudness = momentaryLoudness;
+	mShortTermLoudness = meanSquareToLoudness( shortTermMeanSquare );
+
+	// every sub-block completes a 400 ms gating block once there are enough of them
+	if( mNumSubBlocks < NUM_MOMENTARY_SUB_BLOCKS )
+		return;
+
+	if( momentaryLoudness > mMaxMomentaryLoudness )
+		mMaxMomentaryLoudness = momentaryLoudness;
+
+	if( momentaryLoudness > ABSOLUTE_GATE ) {
+		size_t bin = min( NUM_HISTOGRAM_BINS - 1, size_t( ( momentaryLoudness - ABSOLUTE_GATE ) * HISTOGRAM_BINS_PER_LU ) );
+		mGatingBinEnergies[bin] += momentaryMeanSquare;
+		mGatingBinCounts[bin]++;
+		mGatedEnergy += momentaryMeanSquare;
+		mNumGatedBlocks++;
+
+		updateIntegratedLoudness();
+	}
+}
+
+void LoudnessMeterNode::updateIntegratedLoudness()
+{
+	// the relative gate is measured from the blocks that passed the absolute gate, then applied to the histogram
+	const float relativeGate = meanSquareToLoudness( mGatedEnergy / double( mNumGatedBlocks ) ) + RELATIVE_GATE;
+	const size_t beginBin = relativeGate > ABSOLUTE_GATE ? min( NUM_HISTOGRAM_BINS - 1, size_t( ( relativeGate - ABSOLUTE_GATE ) * HISTOGRAM_BINS_PER_LU ) ) : 0;
+
+	double energy = 0;
+	size_t numBlocks = 0;
+	for( size_t bin = beginBin; bin < NUM_HISTOGRAM_BINS; bin++ ) {
+		energy += mGatingBinEnergies[bin];
+		numBlocks += mGatingBinCounts[bin];
+	}
+
+	if( numBlocks )
+		mIntegratedLoudness = meanSquareToLoudness( energy / double( numBlocks ) );
+}
+
+float LoudnessMeterNode::measureTruePeak( const float *channel, size_t numFrames, float *history )
+{
+	const size_t historySize = TRUE_PEAK_NUM_TAPS - 1;
+	float *x = mTruePeakScratch.data();
+	memcpy( x, history, historySize * sizeof( float ) );
+	memcpy( x + historySize, channel, numFrames * sizeof( float ) );
+
+	const float *coeffs = mTruePeakCoeffs.get();
+	float peak = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	__m128 coeffs4[TRUE_PEAK_NUM_TAPS];
+	for( size_t tap = 0; tap < TRUE_PEAK_NUM_TAPS; tap++ )
+		coeffs4[tap] = _mm_load_ps( coeffs + tap * TRUE_PEAK_NUM_PHASES );
+
+	const __m128 absMask = _mm_castsi128_ps( _mm_set1_epi32( 0x7FFFFFFF ) );
+	__m128 peak4 = _mm_setzero_ps();
+	for( size_t i = 0; i < numFrames; i++ ) {
+		const float *current = x + i + historySize;
+		__m128 sum = _mm_mul_ps( coeffs4[0], _mm_set1_ps( current[0] ) );
+		for( size_t tap = 1; tap < TRUE_PEAK_NUM_TAPS; tap++ )
+			sum = _mm_add_ps( sum, _mm_mul_ps( coeffs4[tap], _mm_set1_ps( current[-(ptrdiff_t)tap] ) ) );
+
+		peak4 = _mm_max_ps( peak4, _mm_and_ps( sum, absMask ) );
+	}
+
+	float peaks[4];
+	_mm_storeu_ps( peaks, peak4 );
+	peak = max( max( peaks[0], peaks[1] ), max( peaks[2], peaks[3] ) );
+#else
+	for( size_t i = 0; i < numFrames; i++ ) {
+		const float *current = x + i + historySize;
+		for( size_t phase = 0; phase < TRUE_PEAK_NUM_PHASES; phase++ ) {
+			float sum = 0;
+			for( size_t tap = 0; tap < TRUE_PEAK_NUM_TAPS; tap++ )
+				sum += coeffs[tap * TRUE_PEAK_NUM_PHASES + phase] * current[-(ptrdiff_t)tap];
+
+			peak = max( peak, fabsf( sum ) );
+		}
+	}
+#endif
+
+	memcpy( history, x + numFrames, historySize * sizeof( float ) );
+
+	// the interpolated phases fall between the input samples, which can be slightly higher
+	for( size_t i = 0; i < numFrames; i++ )
+		peak = max( peak, fabsf( channel[i] ) );
+
+	return peak;
+}
+
+void LoudnessMeterNode::resetMeasurements()
+{
+	mKWeighting.reset();
+	mTruePeakHistory.zero();
+
+	fill( mSubBlockEnergies.begin(), mSubBlockEnergies.end(), 0.0 );
+	fill( mGatingBinEnergies.begin(), mGatingBinEnergies.end(), 0.0 );
+	fill( mGatingBinCounts.begin(), mGatingBinCounts.end(), 0 );
+
+	mSubBlockPos = mNumSubBlocks = mNumGatedBlocks = 0;
+	mSubBlockEnergy = mMomentarySum = mShortTermSum = mGatedEnergy = 0;
+	mTruePeakLinear = 0;
+
+	mMomentaryLoudness = mShortTermLoudness = mIntegratedLoudness = mMaxMomentaryLoudness = mTruePeak = NEGATIVE_INFINITY;
+}
+
+} } // namespace cinder::audio
@@ -0,0 +1,109 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/MappedFile.h"
+#include "cinder/audio/Exception.h"
+
+#include <cerrno>
+
+#if defined( CINDER_MSW )
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+#if defined( CINDER_MSW )
+
+MappedFile::MappedFile( const fs::path &path )
+	: mData( nullptr ), mSize( 0 ), mMapping( nullptr )
+{
+	HANDLE file = ::CreateFileW( path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( file == INVALID_HANDLE_VALUE )
+		throw AudioFileExc( "could not open file: " + path.string(), (int32_t)::GetLastError() );
+
+	LARGE_INTEGER size;
+	if( ! ::GetFileSizeEx( file, &size ) || size.QuadPart == 0 ) {
+		::CloseHandle( file );
+		throw AudioFileExc( "could not get the size of file: " + path.string() );
+	}
+	mSize = (size_t)size.QuadPart;
+
+	// the mapping holds its own reference to the file
+	mMapping = ::CreateFileMappingW( file, NULL, PAGE_WRITECOPY, 0, 0, NULL );
+	::CloseHandle( file );
+	if( ! mMapping )
+		throw AudioFileExc( "could not create file mapping for: " + path.string(), (int32_t)::GetLastError() );
+
+	mData = static_cast<char *>( ::MapViewOfFile( mMapping, FILE_MAP_COPY, 0, 0, 0 ) );
+	if( ! mData ) {
+		::CloseHandle( mMapping );
+		throw AudioFileExc( "could not map file: " + path.string(), (int32_t)::GetLastError() );
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	::UnmapViewOfFile( mData );
+	::CloseHandle( mMapping );
+}
+
+#else
+
+MappedFile::MappedFile( const fs::path &path )
+	: mData( nullptr ), mSize( 0 ), mMapping( nullptr )
+{
+	int fd = ::open( path.string().c_str(), O_RDONLY );
+	if( fd < 0 )
+		throw AudioFileExc( "could not open file: " + path.string(), errno );
+
+	struct stat st;
+	if( ::fstat( fd, &st ) != 0 || st.st_size == 0 ) {
+		::close( fd );
+		throw AudioFileExc( "could not get the size of file: " + path.string() );
+	}
+	mSize = (size_t)st.st_size;
+
+	// the mapping stays valid after the descriptor is closed
+	void *data = ::mmap( nullptr, mSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+	::close( fd );
+	if( data == MAP_FAILED )
+		throw AudioFileExc( "could not map file: " + path.string(), errno );
+
+	mData = static_cast<char *>( data );
+}
+
+MappedFile::~MappedFile()
+{
+	::munmap( mData, mSize );
+}
+
+#endif
+
+} } // namespace cinder::audio
@@ -0,0 +1,307 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/MixerNode.h"
+#include "cinder/audio/Context.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/audio/dsp/Converter.h"
+#include "cinder/CinderMath.h"
+
+#include <limits>
+
+using namespace ci;
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+// sums source * gain into dest, with the gain ramped linearly across the block when it changes. Both loops are simple enough to be auto-vectorized.
+void mixWithGain( const float *source, float *dest, size_t numFrames, float gainBegin, float gainEnd )
+{
+	if( gainBegin == gainEnd ) {
+		for( size_t i = 0; i < numFrames; i++ )
+			dest[i] += source[i] * gainEnd;
+	}
+	else {
+		const float gainIncr = ( gainEnd - gainBegin ) / (float)numFrames;
+		for( size_t i = 0; i < numFrames; i++ )
+			dest[i] += source[i] * ( gainBegin + gainIncr * (float)i );
+	}
+}
+
+float findPeak( const float *array, size_t length )
+{
+	float result = 0;
+	for( size_t i = 0; i < length; i++ )
+		result = max( result, fabsf( array[i] ) );
+
+	return result;
+}
+
+} // anonymous namespace
+
+MixerNode::MixerNode( const Format &format )
+	: Node( format ), mVoices( format.getMaxNumVoices() ), mVoiceStealing( format.getVoiceStealing() ), mNumConnections( 0 ), mNumStolenVoices( 0 )
+{
+	if( ! format.getChannels() ) {
+		setChannelMode( ChannelMode::SPECIFIED );
+		setNumChannels( 2 );
+	}
+}
+
+MixerNode::~MixerNode()
+{
+}
+
+void MixerNode::setVoiceGain( const NodeRef &input, float gain )
+{
+	VoiceSlot *voice = findVoice( input.get() );
+	if( voice )
+		voice->mGain = gain;
+}
+
+float MixerNode::getVoiceGain( const NodeRef &input ) const
+{
+	const VoiceSlot *voice = findVoice( input.get() );
+	return voice ? voice->mGain.load() : 0;
+}
+
+void MixerNode::setVoicePan( const NodeRef &input, float pos )
+{
+	VoiceSlot *voice = findVoice( input.get() );
+	if( voice )
+		voice->mPan = math<float>::clamp( pos );
+}
+
+float MixerNode::getVoicePan( const NodeRef &input ) const
+{
+	const VoiceSlot *voice = findVoice( input.get() );
+	return voice ? voice->mPan.load() : 0.5f;
+}
+
+void MixerNode::connectInput( const NodeRef &input )
+{
+	size_t voiceIndex = 0;
+	while( voiceIndex < mVoices.size() && mVoices[voiceIndex].mInput )
+		voiceIndex++;
+
+	if( voiceIndex == mVoices.size() ) {
+		voiceIndex = findVoiceToSteal();
+		if( voiceIndex == mVoices.size() ) {
+			// undo the output that Node::connect() already recorded on input before bailing
+			input->disconnect( shared_from_this() );
+			throw AudioExc( string( "MixerNode has no voices available, max: " ) + to_string( mVoices.size() ) );
+		}
+
+		// disconnecting calls back into disconnectInput(), which frees the voice
+		NodeRef stolenInput = mVoices[voiceIndex].mInput->shared_from_this();
+		stolenInput->disconnect( shared_from_this() );
+		mNumStolenVoices++;
+	}
+
+	Node::connectInput( input );
+
+	// the voice is only assigned once input is configured, because sumInputs() pulls voices rather than mInputs.
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	VoiceSlot &voice = mVoices[voiceIndex];
+	voice.mGain = 1;
+	voice.mPan = 0.5f;
+	voice.mPeak = numeric_limits<float>::max(); // not a candidate for VoiceStealing::QUIETEST until it has been processed.
+	voice.mConnectedOrder = mNumConnections++;
+	voice.mNeedsGainReset = true;
+	voice.mInput = input.get();
+}
+
+void MixerNode::disconnectInput( const NodeRef &input )
+{
+	{
+		lock_guard<mutex> lock( getContext()->getMutex() );
+
+		VoiceSlot *voice = findVoice( input.get() );
+		if( voice )
+			voice->mInput = nullptr;
+	}
+
+	Node::disconnectInput( input );
+}
+
+void MixerNode::disconnectAllInputs()
+{
+	{
+		lock_guard<mutex> lock( getContext()->getMutex() );
+
+		for( auto &voice : mVoices )
+			voice.mInput = nullptr;
+	}
+
+	Node::disconnectAllInputs();
+}
+
+void MixerNode::sumInputs()
+{
+	Buffer *internalBuffer = getInternalBuffer();
+	BufferDynamic *summingBuffer = getSummingBuffer();
+
+	for( auto &voice : mVoices ) {
+		Node *input = voice.mInput;
+		if( ! input )
+			continue;
+
+		// finished voices only produce silence, so don't bother pulling them
+		if( ! input->isEnabled() && input->getNumConnectedInputs() == 0 ) {
+			voice.mPeak = 0;
+			continue;
+		}
+
+		input->pullInputs( internalBuffer );
+		const Buffer *processedBuffer = input->getProcessesInPlace() ? internalBuffer : input->getInternalBuffer();
+		mixVoice( &voice, processedBuffer, summingBuffer );
+	}
+
+	if( isEnabled() )
+		processInstrumented( summingBuffer );
+
+	dsp::mixBuffers( summingBuffer, internalBuffer );
+}
+
+// Mono sources are spread to all output channels and a mono output down-mixes all source channels, otherwise channels
+// are mixed one to one and extras are dropped, as in dsp::mixBuffers(). With two output channels, the per-channel gains
+// are equal power pan gains as in Pan2dNode.
+void MixerNode::mixVoice( VoiceSlot *voice, const Buffer *sourceBuffer, Buffer *destBuffer )
+{
+	const size_t numFrames = destBuffer->getNumFrames();
+	const size_t sourceChannels = sourceBuffer->getNumChannels();
+	const size_t destChannels = destBuffer->getNumChannels();
+	const float gain = voice->mGain;
+
+	float gains[2];
+	if( destChannels == 2 ) {
+		const float posRadians = voice->mPan * float( M_PI / 2.0 );
+		gains[0] = gain * math<float>::cos( posRadians );
+		gains[1] = gain * math<float>::sin( posRadians );
+	}
+	else
+		gains[0] = gains[1] = gain;
+
+	if( voice->mNeedsGainReset ) {
+		voice->mAppliedGains[0] = gains[0];
+		voice->mAppliedGains[1] = gains[1];
+		voice->mNeedsGainReset = false;
+	}
+
+	if( destChannels == 1 ) {
+		const float normalizer = sourceChannels > 1 ? 1.0f / std::sqrt( 2.0f ) : 1.0f;
+		for( size_t ch = 0; ch < sourceChannels; ch++ )
+			mixWithGain( sourceBuffer->getChannel( ch ), destBuffer->getChannel( 0 ), numFrames, voice->mAppliedGains[0] * normalizer, gains[0] * normalizer );
+	}
+	else {
+		for( size_t ch = 0; ch < destChannels; ch++ ) {
+			const size_t sourceCh = sourceChannels == 1 ? 0 : ch;
+			if( sourceCh >= sourceChannels )
+				break;
+
+			const size_t gainIndex = destChannels == 2 ? ch : 0;
+			mixWithGain( sourceBuffer->getChannel( sourceCh ), destBuffer->getChannel( ch ), numFrames, voice->mAppliedGains[gainIndex], gains[gainIndex] );
+		}
+	}
+
+	voice->mAppliedGains[0] = gains[0];
+	voice->mAppliedGains[1] = gains[1];
+
+	if( mVoiceStealing == VoiceStealing::QUIETEST ) {
+		float peak = 0;
+		for( size_t ch = 0; ch < sourceChannels; ch++ )
+			peak = max( peak, findPeak( sourceBuffer->getChannel( ch ), numFrames ) );
+
+		voice->mPeak = peak * fabsf( gain );
+	}
+}
+
+size_t MixerNode::findVoiceToSteal() const
+{
+	const size_t numVoices = mVoices.size();
+
+	// voices that have finished playing are always preferred
+	for( size_t i = 0; i < numVoices; i++ ) {
+		const Node *input = mVoices[i].mInput;
+		if( input && ! input->isEnabled() && input->getNumConnectedInputs() == 0 )
+			return i;
+	}
+
+	if( mVoiceStealing == VoiceStealing::NONE )
+		return numVoices;
+
+	size_t result = numVoices;
+	for( size_t i = 0; i < numVoices; i++ ) {
+		const VoiceSlot &voice = mVoices[i];
+		if( ! voice.mInput )
+			continue;
+
+		if( result == numVoices ) {
+			result = i;
+			continue;
+		}
+
+		const VoiceSlot &best = mVoices[result];
+		if( mVoiceStealing == VoiceStealing::QUIETEST ) {
+			float peak = voice.mPeak;
+			float bestPeak = best.mPeak;
+			if( peak < bestPeak || ( peak == bestPeak && voice.mConnectedOrder < best.mConnectedOrder ) )
+				result = i;
+		}
+		else if( voice.mConnectedOrder < best.mConnectedOrder )
+			result = i;
+	}
+
+	return result;
+}
+
+MixerNode::VoiceSlot* MixerNode::findVoice( const Node *input )
+{
+	if( ! input )
+		return nullptr;
+
+	for( auto &voice : mVoices ) {
+		if( voice.mInput == input )
+			return &voice;
+	}
+
+	return nullptr;
+}
+
+const MixerNode::VoiceSlot* MixerNode::findVoice( const Node *input ) const
+{
+	if( ! input )
+		return nullptr;
+
+	for( const auto &voice : mVoices ) {
+		if( voice.mInput == input )
+			return &voice;
+	}
+
+	return nullptr;
+}
+
+} } // namespace cinder::audio
@@ -0,0 +1,426 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/MonitorFeatureNode.h"
+#include "cinder/audio/Context.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined( CINDER_AUDIO_SSE )
+	#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+// windows quieter than this (about -80 dBFS RMS) have no pitch or centroid
+const float SILENCE_RMS = 0.0001f;
+
+// magnitudes are compressed with log( 1 + FLUX_COMPRESSION * magnitude ) before the flux is computed, so that quiet partials also contribute
+const float FLUX_COMPRESSION = 1000;
+// an onset peak is compared with the mean spectral flux over this long before it
+const double ONSET_MEAN_SECONDS = 0.2;
+// onset peaks must also exceed this absolute spectral flux, which keeps noise in near silence from being detected
+const float ONSET_MIN_FLUX = 0.01f;
+const double ONSET_MIN_INTERVAL_SECONDS = 0.05;
+
+const double TEMPO_HISTORY_SECONDS = 6;
+// the autocorrelation is weighted by a log-gaussian centered at this tempo, with a deviation in octaves
+const double TEMPO_PRIOR_BPM = 120;
+const double TEMPO_PRIOR_OCTAVES = 1.4;
+
+const float BEAT_MIN_CONFIDENCE = 0.2f;
+// onsets within this fraction of a beat period of a predicted beat pull it by BEAT_PHASE_CORRECTION of the difference
+const double BEAT_PHASE_TOLERANCE = 0.2;
+const double BEAT_PHASE_CORRECTION = 0.5;
+
+float dotProduct( const float *a, const float *b, size_t length )
+{
+	float result = 0;
+	size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	__m128 sum4 = _mm_setzero_ps();
+	for( ; i + 4 <= length; i += 4 )
+		sum4 = _mm_add_ps( sum4, _mm_mul_ps( _mm_loadu_ps( a + i ), _mm_loadu_ps( b + i ) ) );
+
+	float sums[4];
+	_mm_storeu_ps( sums, sum4 );
+	result = ( sums[0] + sums[1] ) + ( sums[2] + sums[3] );
+#endif
+
+	for( ; i < length; i++ )
+		result += a[i] * b[i];
+
+	return result;
+}
+
+// Returns the offset (-0.5 - 0.5) of the vertex of the parabola through \a left, \a center and \a right from \a center.
+float parabolicPeakOffset( float left, float center, float right )
+{
+	const float denom = left - 2 * center + right;
+	if( fabs( denom ) < 1e-12f )
+		return 0;
+
+	return math<float>::clamp( 0.5f * ( left - right ) / denom, -0.5f, 0.5f );
+}
+
+} // anonymous namespace
+
+MonitorFeatureNode::MonitorFeatureNode( const Format &format )
+	: MonitorSpectralNode( MonitorSpectralNode::Format( format ).analysisThread() ), mMinPitchFormat( format.getMinPitch() ), mMaxPitchFormat( format.getMaxPitch() ),
+		mMinTempoFormat( format.getMinTempo() ), mMaxTempoFormat( format.getMaxTempo() ), mSampleRate( 0 ), mFluxHistoryPos( 0 ), mNumFluxValues( 0 ), mOnsetMeanHops( 0 ),
+		mMinPitchLag( 0 ), mMaxPitchLag( 0 ), mMinTempoLag( 0 ), mMaxTempoLag( 0 ), mLastFrame( 0 ), mLastOnsetFrame( 0 ), mNextBeatTime( -1 ), mPrevBeatTime( -1 ),
+		mSpectralCentroid( 0 ), mSpectralFlux( 0 ), mOnsetThreshold( 0.5f ), mTempo( 0 ), mTempoConfidence( 0 ), mPitch( 0 ), mPitchConfidence( 0 ), mPitchThreshold( 0.15f ),
+		mNumOnsets( 0 ), mNumBeats( 0 ), mLastOnsetTime( -1 ), mLastBeatTime( -1 ), mResetRequested( true )
+{
+}
+
+MonitorFeatureNode::~MonitorFeatureNode()
+{
+	// stop the analysis thread before this object's members are destroyed, since it calls analyzeSpectrum()
+	MonitorSpectralNode::uninitialize();
+}
+
+void MonitorFeatureNode::initialize()
+{
+	// the analysis thread isn't running for this node until MonitorSpectralNode::initialize() adds it, so this doesn't race
+	mSampleRate = getSampleRate();
+	mResetRequested = true;
+
+	MonitorSpectralNode::initialize();
+}
+
+void MonitorFeatureNode::resetAnalysis( size_t numBins )
+{
+	const double hopsPerSecond = double( mSampleRate ) / double( mHopSize );
+
+	mMono.assign( mWindowSize, 0 );
+	mLogMagnitudes.assign( numBins, 0 );
+
+	mMinTempoLag = max<size_t>( 2, size_t( floor( 60 * hopsPerSecond / mMaxTempoFormat ) ) );
+	mMaxTempoLag = max<size_t>( mMinTempoLag + 1, size_t( ceil( 60 * hopsPerSecond / mMinTempoFormat ) ) );
+	mOnsetMeanHops = max<size_t>( 1, size_t( ONSET_MEAN_SECONDS * hopsPerSecond ) );
+
+	const size_t historySize = max( size_t( TEMPO_HISTORY_SECONDS * hopsPerSecond ), max( mMaxTempoLag * 2, mOnsetMeanHops + 2 ) );
+	mFluxHistory.assign( historySize, 0 );
+	mOnsetEnvelope.assign( historySize, 0 );
+	mAutocorrelation.assign( mMaxTempoLag + 2, 0 );
+	mFluxHistoryPos = mNumFluxValues = 0;
+
+	// YIN needs two periods of the lowest pitch in the window
+	mMaxPitchLag = min<size_t>( mWindowSize / 2, size_t( ceil( mSampleRate / mMinPitchFormat ) ) );
+	mMinPitchLag = min<size_t>( mMaxPitchLag - 1, max<size_t>( 2, size_t( floor( mSampleRate / mMaxPitchFormat ) ) ) );
+	mYinDifference.assign( mMaxPitchLag + 2, 0 );
+
+	mLastFrame = mLastOnsetFrame = 0;
+	mNextBeatTime = mPrevBeatTime = -1;
+
+	mSpectralCentroid = 0;
+	mSpectralFlux = 0;
+	mTempo = 0;
+	mTempoConfidence = 0;
+	mPitch = 0;
+	mPitchConfidence = 0;
+	mNumOnsets = 0;
+	mNumBeats = 0;
+	mLastOnsetTime = -1;
+	mLastBeatTime = -1;
+}
+
+void MonitorFeatureNode::analyzeSpectrum( const Buffer &samples, const BufferSpectral &spectrum, uint64_t frame )
+{
+	if( mResetRequested.exchange( false ) || mLogMagnitudes.size() != spectrum.getNumFrames() )
+		resetAnalysis( spectrum.getNumFrames() );
+
+	// windows are skipped if this thread falls behind, which is made up for with silent hops so the flux history stays evenly spaced
+	size_t numHops = 1;
+	if( mLastFrame )
+		numHops = size_t( ( frame - mLastFrame + mHopSize / 2 ) / mHopSize );
+	numHops = math<size_t>::clamp( numHops, 1, mFluxHistory.size() );
+	mLastFrame = frame;
+
+	// average to mono
+	const size_t numFrames = samples.getNumFrames();
+	const size_t numChannels = samples.getNumChannels();
+	float *mono = mMono.data();
+	if( numChannels == 1 )
+		memcpy( mono, samples.getData(), numFrames * sizeof( float ) );
+	else {
+		const float scale = 1.0f / numChannels;
+		dsp::mul( samples.getChannel( 0 ), scale, mono, numFrames );
+		for( size_t ch = 1; ch < numChannels; ch++ ) {
+			const float *channel = samples.getChannel( ch );
+			for( size_t i = 0; i < numFrames; i++ )
+				mono[i] += channel[i] * scale;
+		}
+	}
+
+	const bool silent = dsp::rms( mono, numFrames ) < SILENCE_RMS;
+
+	float centroid;
+	const float flux = computeSpectralFlux( spectrum, &centroid );
+	for( size_t i = 0; i < numHops; i++ ) {
+		mFluxHistory[mFluxHistoryPos] = ( i == numHops - 1 ? flux : 0 );
+		mFluxHistoryPos = ( mFluxHistoryPos + 1 ) % mFluxHistory.size();
+	}
+	mNumFluxValues = min( mNumFluxValues + numHops, mFluxHistory.size() );
+
+	mSpectralFlux = flux;
+	mSpectralCentroid = silent ? 0 : centroid;
+
+	uint64_t onsetFrame = 0;
+	const bool onset = detectOnset( frame, &onsetFrame );
+	if( onset ) {
+		mLastOnsetTime = getTimeForFrame( onsetFrame );
+		mNumOnsets++;
+	}
+
+	updateTempo();
+	updateBeats( getTimeForFrame( frame ), onset, onset ? getTimeForFrame( onsetFrame ) : 0 );
+
+	if( silent ) {
+		mPitch = 0;
+		mPitchConfidence = 0;
+	}
+	else
+		updatePitch();
+}
+
+float MonitorFeatureNode::computeSpectralFlux( const BufferSpectral &spectrum, float *centroid )
+{
+	const float *real = spectrum.getReal();
+	const float *imag = spectrum.getImag();
+	const size_t numBins = mLogMagnitudes.size();
+	const float magScale = 1.0f / ( numBins * 2 );
+
+	float flux = 0;
+	double weightedSum = 0, magSum = 0;
+	// bin 0 is skipped, its imaginary component holds the nyquist
+	for( size_t i = 1; i < numBins; i++ ) {
+		const float mag = sqrt( real[i] * real[i] + imag[i] * imag[i] ) * magScale;
+		const float logMag = log( 1 + FLUX_COMPRESSION * mag );
+		flux += max( 0.0f, logMag - mLogMagnitudes[i] );
+		mLogMagnitudes[i] = logMag;
+
+		weightedSum += double( i ) * mag;
+		magSum += mag;
+	}
+
+	*centroid = magSum > 0 ? float( weightedSum / magSum * mSampleRate / ( numBins * 2 ) ) : 0;
+	return flux / numBins;
+}
+
+bool MonitorFeatureNode::detectOnset( uint64_t frame, uint64_t *onsetFrame )
+{
+	if( mNumFluxValues < 3 )
+		return false;
+
+	// the previous hop is an onset if it is a local maximum that is sufficiently above the mean of the hops before it
+	const float candidate = getFlux( 1 );
+	if( candidate <= getFlux( 2 ) || candidate < getFlux( 0 ) || candidate < ONSET_MIN_FLUX )
+		return false;
+
+	const size_t numMeanHops = min( mOnsetMeanHops, mNumFluxValues - 2 );
+	float mean = 0;
+	for( size_t i = 0; i < numMeanHops; i++ )
+		mean += getFlux( i + 2 );
+	mean /= numMeanHops;
+
+	if( candidate < mean * ( 1 + mOnsetThreshold ) )
+		return false;
+
+	// the flux peaks about when the onset reaches the center of the window
+	const uint64_t candidateFrame = frame - min<uint64_t>( frame, mHopSize + mWindowSize / 2 );
+	if( mNumOnsets && candidateFrame < mLastOnsetFrame + uint64_t( ONSET_MIN_INTERVAL_SECONDS * mSampleRate ) )
+		return false;
+
+	mLastOnsetFrame = candidateFrame;
+	*onsetFrame = candidateFrame;
+	return true;
+}
+
+void MonitorFeatureNode::updateTempo()
+{
+	// wait until there are at least two periods of the slowest tempo
+	if( mNumFluxValues < mMaxTempoLag * 2 )
+		return;
+
+	const size_t length = mNumFluxValues;
+	float mean = 0, maxFlux = 0;
+	for( size_t i = 0; i < length; i++ ) {
+		mean += getFlux( i );
+		maxFlux = max( maxFlux, getFlux( i ) );
+	}
+	mean /= length;
+
+	// without anything that could be an onset, the tempo would only reflect noise
+	if( maxFlux < ONSET_MIN_FLUX ) {
+		mTempo = 0;
+		mTempoConfidence = 0;
+		return;
+	}
+
+	// the flux is smoothed so that peaks in the autocorrelation are wide enough to interpolate between hops
+	float *envelope = mOnsetEnvelope.data();
+	for( size_t i = 0; i < length; i++ ) {
+		const size_t hopsAgo = length - 1 - i;
+		const float prev = getFlux( min( hopsAgo + 1, length - 1 ) );
+		const float next = getFlux( hopsAgo ? hopsAgo - 1 : 0 );
+		envelope[i] = 0.25f * prev + 0.5f * getFlux( hopsAgo ) + 0.25f * next - mean;
+	}
+
+	const float energy = dotProduct( envelope, envelope, length );
+	if( energy <= 1e-12f ) {
+		mTempo = 0;
+		mTempoConfidence = 0;
+		return;
+	}
+
+	// unbiased autocorrelation, so that longer lags aren't penalized for overlapping less
+	const size_t lastLag = min( mMaxTempoLag + 1, length - 1 );
+	for( size_t lag = mMinTempoLag - 1; lag <= lastLag; lag++ )
+		mAutocorrelation[lag] = dotProduct( envelope, envelope + lag, length - lag ) * length / float( length - lag );
+
+	// the period is rarely a whole number of hops, so each local maximum is compared by the height of its interpolated peak
+	const double hopsPerSecond = double( mSampleRate ) / double( mHopSize );
+	double bestLag = 0, bestWeighted = 0;
+	float bestHeight = 0;
+	for( size_t lag = mMinTempoLag; lag < lastLag; lag++ ) {
+		const float left = mAutocorrelation[lag - 1];
+		const float center = mAutocorrelation[lag];
+		const float right = mAutocorrelation[lag + 1];
+		if( center <= 0 || center < left || center < right )
+			continue;
+
+		const float offset = parabolicPeakOffset( left, center, right );
+		const float height = center - 0.25f * ( left - right ) * offset;
+		const double octaves = log2( 60 * hopsPerSecond / ( lag + offset ) / TEMPO_PRIOR_BPM ) / TEMPO_PRIOR_OCTAVES;
+		const double weighted = height * exp( -0.5 * octaves * octaves );
+		if( weighted > bestWeighted ) {
+			bestWeighted = weighted;
+			bestLag = lag + offset;
+			bestHeight = height;
+		}
+	}
+
+	if( bestLag <= 0 ) {
+		mTempo = 0;
+		mTempoConfidence = 0;
+		return;
+	}
+
+	mTempo = float( 60 * hopsPerSecond / bestLag );
+	mTempoConfidence = math<float>::clamp( bestHeight / energy );
+}
+
+void MonitorFeatureNode::updateBeats( double time, bool onset, double onsetTime )
+{
+	const float tempo = mTempo;
+	if( tempo <= 0 || mTempoConfidence < BEAT_MIN_CONFIDENCE ) {
+		mNextBeatTime = -1;
+		return;
+	}
+
+	const double period = 60.0 / tempo;
+	if( onset ) {
+		if( mNextBeatTime < 0 )
+			mNextBeatTime = onsetTime;
+		else {
+			// pull the nearest predicted beat, which may already have been counted, towards the onset
+			double error = onsetTime - mNextBeatTime;
+			if( mPrevBeatTime >= 0 && fabs( onsetTime - mPrevBeatTime ) < fabs( error ) )
+				error = onsetTime - mPrevBeatTime;
+
+			if( fabs( error ) < period * BEAT_PHASE_TOLERANCE )
+				mNextBeatTime += error * BEAT_PHASE_CORRECTION;
+		}
+	}
+
+	// beats are counted once the analysis reaches them, which lags the input by the same amount as onsets
+	const double analysisTime = time - double( mHopSize + mWindowSize / 2 ) / mSampleRate;
+	while( mNextBeatTime >= 0 && mNextBeatTime <= analysisTime ) {
+		mPrevBeatTime = mNextBeatTime;
+		mLastBeatTime = mNextBeatTime;
+		mNumBeats++;
+		mNextBeatTime += period;
+	}
+}
+
+void MonitorFeatureNode::updatePitch()
+{
+	// YIN difference function d( lag ) = sum( ( x[j] - x[j + lag] )^2 ), expanded to energy terms and a dot product
+	const float *x = mMono.data();
+	const size_t integrationFrames = mWindowSize - mMaxPitchLag;
+	float *difference = mYinDifference.data();
+
+	double energy0 = 0;
+	for( size_t j = 0; j < integrationFrames; j++ )
+		energy0 += x[j] * x[j];
+
+	double energyLag = energy0;
+	double runningSum = 0;
+	difference[0] = 1;
+	for( size_t lag = 1; lag <= mMaxPitchLag; lag++ ) {
+		energyLag += double( x[lag + integrationFrames - 1] ) * x[lag + integrationFrames - 1] - double( x[lag - 1] ) * x[lag - 1];
+		const double d = max( 0.0, energy0 + energyLag - 2 * dotProduct( x, x + lag, integrationFrames ) );
+
+		// cumulative mean normalization
+		runningSum += d;
+		difference[lag] = runningSum > 0 ? float( d * lag / runningSum ) : 1;
+	}
+
+	// the first dip below the threshold is the period, which avoids choosing one of its multiples
+	const float threshold = mPitchThreshold;
+	size_t lag = mMinPitchLag;
+	for( ; lag < mMaxPitchLag; lag++ ) {
+		if( difference[lag] < threshold ) {
+			while( lag + 1 < mMaxPitchLag && difference[lag + 1] < difference[lag] )
+				lag++;
+			break;
+		}
+	}
+
+	if( lag >= mMaxPitchLag ) {
+		const float minDifference = *min_element( difference + mMinPitchLag, difference + mMaxPitchLag );
+		mPitch = 0;
+		mPitchConfidence = math<float>::clamp( 1 - minDifference );
+		return;
+	}
+
+	const float offset = parabolicPeakOffset( difference[lag - 1], difference[lag], difference[lag + 1] );
+	mPitch = float( mSampleRate / ( lag + offset ) );
+	mPitchConfidence = math<float>::clamp( 1 - difference[lag] );
+}
+
+double MonitorFeatureNode::getTimeForFrame( uint64_t frame ) const
+{
+	return double( frame ) / double( mSampleRate );
+}
+
+} } // namespace cinder::audio
@@ -27,17 +27,100 @@
 #include "cinder/audio/Debug.h"
 #include "cinder/CinderMath.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 using namespace std;
 using namespace ci;
 
 namespace cinder { namespace audio {
 
+namespace {
+
+// MonitorSpectralNode::publishSnapshot() notifies without taking the mutex (it is called from the audio thread), so
+// the idle analysis thread also wakes up periodically in case a notification was missed.
+const chrono::milliseconds ANALYSIS_IDLE_TIMEOUT( 10 );
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SpectralAnalysisThread
+// ----------------------------------------------------------------------------------------------------
+
+//! Worker thread shared by all MonitorSpectralNodes that have Format::analysisThread() enabled. Started when the first one is added.
+class SpectralAnalysisThread {
+  public:
+	static SpectralAnalysisThread* get()
+	{
+		static SpectralAnalysisThread sThread;
+		return &sThread;
+	}
+
+	~SpectralAnalysisThread()
+	{
+		{
+			lock_guard<mutex> lock( mMutex );
+			mShouldQuit = true;
+		}
+		mConditionVariable.notify_one();
+		if( mThread.joinable() )
+			mThread.join();
+	}
+
+	void addNode( MonitorSpectralNode *node )
+	{
+		lock_guard<mutex> lock( mMutex );
+		if( find( mNodes.begin(), mNodes.end(), node ) == mNodes.end() )
+			mNodes.push_back( node );
+
+		if( ! mThread.joinable() )
+			mThread = thread( &SpectralAnalysisThread::run, this );
+	}
+
+	//! Blocks while \a node is being analyzed, so it is safe to destroy afterwards.
+	void removeNode( MonitorSpectralNode *node )
+	{
+		lock_guard<mutex> lock( mMutex );
+		mNodes.erase( remove( mNodes.begin(), mNodes.end(), node ), mNodes.end() );
+	}
+
+	//! Lock-free, though it may make a system call to wake the thread.
+	void notify()
+	{
+		mConditionVariable.notify_one();
+	}
+
+  private:
+	SpectralAnalysisThread() : mShouldQuit( false )	{}
+
+	void run()
+	{
+		unique_lock<mutex> lock( mMutex );
+		while( ! mShouldQuit ) {
+			for( MonitorSpectralNode *node : mNodes )
+				node->analyze();
+
+			mConditionVariable.wait_for( lock, ANALYSIS_IDLE_TIMEOUT );
+		}
+	}
+
+	vector<MonitorSpectralNode *>	mNodes;
+	thread							mThread;
+	mutex							mMutex;
+	condition_variable				mConditionVariable;
+	bool							mShouldQuit;
+};
+
 // ----------------------------------------------------------------------------------------------------
 // MARK: - MonitorNode
 // ----------------------------------------------------------------------------------------------------
 
 MonitorNode::MonitorNode( const Format &format )
-	: NodeAutoPullable( format ), mWindowSize( format.getWindowSize() ), mRingBufferPaddingFactor( 2 )
+	: NodeAutoPullable( format ), mWindowSize( format.getWindowSize() ), mHopSize( format.getHopSize() ), mRingBufferPaddingFactor( 2 ),
+		mSnapshot( format.isSnapshot() ), mHasNewSnapshot( false ), mHistoryPos( 0 ), mFramesSinceSnapshot( 0 ), mSnapshotFrame( 0 )
 {
 }
 
@@ -52,14 +135,57 @@ void MonitorNode::initialize()
 	else if( ! isPowerOf2( mWindowSize ) )
 		mWindowSize = nextPowerOf2( static_cast<uint32_t>( mWindowSize ) );
 
-	for( size_t ch = 0; ch < getNumChannels(); ch++ )
-		mRingBuffers.emplace_back( mWindowSize * mRingBufferPaddingFactor );
+	if( ! mHopSize )
+		mHopSize = mWindowSize;
+
+	if( mSnapshot ) {
+		mRingBuffers.clear();
+		mCopiedBuffer = Buffer();
 
-	mCopiedBuffer = Buffer( mWindowSize, getNumChannels() );
+		mSnapshots.reset( Buffer( mWindowSize, getNumChannels() ) );
+		mHistory = Buffer( mWindowSize, getNumChannels() );
+		mHistoryPos = mFramesSinceSnapshot = 0;
+		mHasNewSnapshot = false;
+	}
+	else {
+		mRingBuffers.clear();
+		for( size_t ch = 0; ch < getNumChannels(); ch++ )
+			mRingBuffers.emplace_back( mWindowSize * mRingBufferPaddingFactor );
+
+		mCopiedBuffer = Buffer( mWindowSize, getNumChannels() );
+	}
 }
 
 void MonitorNode::process( Buffer *buffer )
 {
+	if( mSnapshot ) {
+		// record into the circular history, publishing a window every mHopSize frames
+		const size_t numFrames = buffer->getNumFrames();
+		size_t offset = 0;
+		while( offset < numFrames ) {
+			size_t count = min( numFrames - offset, min( mHopSize - mFramesSinceSnapshot, mWindowSize ) );
+			size_t countA = min( count, mWindowSize - mHistoryPos );
+			for( size_t ch = 0; ch < getNumChannels(); ch++ ) {
+				const float *source = buffer->getChannel( ch ) + offset;
+				float *history = mHistory.getChannel( ch );
+				memcpy( history + mHistoryPos, source, countA * sizeof( float ) );
+				memcpy( history, source + countA, ( count - countA ) * sizeof( float ) );
+			}
+
+			mHistoryPos = ( mHistoryPos + count ) % mWindowSize;
+			mFramesSinceSnapshot += count;
+			offset += count;
+
+			if( mFramesSinceSnapshot >= mHopSize ) {
+				mSnapshotFrame = getContext()->getNumProcessedFrames() + offset;
+				publishSnapshot();
+				mFramesSinceSnapshot = 0;
+			}
+		}
+
+		return;
+	}
+
 	size_t numFrames = min( buffer->getNumFrames(), mRingBuffers[0].getSize() );
 	for( size_t ch = 0; ch < getNumChannels(); ch++ ) {
 		if( ! mRingBuffers[ch].write( buffer->getChannel( ch ), numFrames ) )
@@ -70,26 +196,56 @@ void MonitorNode::process( Buffer *buffer )
 const Buffer& MonitorNode::getBuffer()
 {
 	fillCopiedBuffer();
-	return mCopiedBuffer;
+	return getCopiedBuffer();
 }
 
 float MonitorNode::getVolume()
 {
 	fillCopiedBuffer();
-	return dsp::rms( mCopiedBuffer.getData(), mCopiedBuffer.getSize() );
+	const Buffer &buffer = getCopiedBuffer();
+	return dsp::rms( buffer.getData(), buffer.getSize() );
 }
 
 float MonitorNode::getVolume( size_t channel )
 {
 	fillCopiedBuffer();
-	return dsp::rms( mCopiedBuffer.getChannel( channel ), mCopiedBuffer.getNumFrames() );
+	const Buffer &buffer = getCopiedBuffer();
+	return dsp::rms( buffer.getChannel( channel ), buffer.getNumFrames() );
 }
 
-void MonitorNode::fillCopiedBuffer()
+bool MonitorNode::fillCopiedBuffer()
 {
+	if( mSnapshot ) {
+		bool updated = mSnapshots.update();
+		mHasNewSnapshot = mHasNewSnapshot || updated;
+		return updated;
+	}
+
 	for( size_t ch = 0; ch < getNumChannels(); ch++ ) {
 		if( ! mRingBuffers[ch].read( mCopiedBuffer.getChannel( ch ), mCopiedBuffer.getNumFrames() ) )
-			return;
+			return ch != 0;
+	}
+
+	return true;
+}
+
+void MonitorNode::publishSnapshot()
+{
+	copyWindow( &mSnapshots.getWriteBuffer() );
+	mSnapshots.publish();
+}
+
+void MonitorNode::copyWindow( Buffer *dest ) const
+{
+	CI_ASSERT( dest->getNumFrames() == mWindowSize && dest->getNumChannels() == mHistory.getNumChannels() );
+
+	// the oldest frame is at mHistoryPos
+	const size_t countA = mWindowSize - mHistoryPos;
+	for( size_t ch = 0; ch < mHistory.getNumChannels(); ch++ ) {
+		const float *history = mHistory.getChannel( ch );
+		float *destChannel = dest->getChannel( ch );
+		memcpy( destChannel, history + mHistoryPos, countA * sizeof( float ) );
+		memcpy( destChannel + countA, history, mHistoryPos * sizeof( float ) );
 	}
 }
 
@@ -98,12 +254,17 @@ void MonitorNode::fillCopiedBuffer()
 // ----------------------------------------------------------------------------------------------------
 
 MonitorSpectralNode::MonitorSpectralNode( const Format &format )
-	: MonitorNode( format ), mFftSize( format.getFftSize() ), mWindowType( format.getWindowType() ), mSmoothingFactor( 0.5f )
+	: MonitorNode( format ), mFftSize( format.getFftSize() ), mWindowType( format.getWindowType() ), mSmoothingFactor( 0.5f ),
+		mAnalysisThread( format.isAnalysisThread() )
 {
+	if( mAnalysisThread )
+		mSnapshot = true;
 }
 
 MonitorSpectralNode::~MonitorSpectralNode()
 {
+	if( mAnalysisThread )
+		SpectralAnalysisThread::get()->removeNode( this );
 }
 
 void MonitorSpectralNode::initialize()
@@ -112,8 +273,9 @@ void MonitorSpectralNode::initialize()
 
 	if( mFftSize < mWindowSize )
 		mFftSize = mWindowSize;
-	if( ! isPowerOf2( mFftSize ) )
-		mFftSize = nextPowerOf2( static_cast<uint32_t>( mFftSize ) );
+	// the default Fft backend supports any even size
+	if( mFftSize % 2 )
+		mFftSize++;
 	
 	mFft = unique_ptr<dsp::Fft>( new dsp::Fft( mFftSize ) );
 	mFftBuffer = audio::Buffer( mFftSize );
@@ -127,27 +289,84 @@ void MonitorSpectralNode::initialize()
 
 	mWindowingTable = makeAlignedArray<float>( mWindowSize );
 	generateWindow( mWindowType, mWindowingTable.get(), mWindowSize );
+
+	if( mAnalysisThread ) {
+		AnalysisWindow window;
+		window.mSamples = Buffer( mWindowSize, getNumChannels() );
+		window.mFrame = 0;
+		mAnalysisSnapshots.reset( window );
+		mMagSpectrumSnapshots.reset( mMagSpectrum );
+		SpectralAnalysisThread::get()->addNode( this );
+	}
+}
+
+void MonitorSpectralNode::uninitialize()
+{
+	if( mAnalysisThread )
+		SpectralAnalysisThread::get()->removeNode( this );
+}
+
+void MonitorSpectralNode::publishSnapshot()
+{
+	MonitorNode::publishSnapshot();
+
+	if( mAnalysisThread ) {
+		AnalysisWindow &window = mAnalysisSnapshots.getWriteBuffer();
+		copyWindow( &window.mSamples );
+		window.mFrame = mSnapshotFrame;
+		mAnalysisSnapshots.publish();
+		SpectralAnalysisThread::get()->notify();
+	}
+}
+
+void MonitorSpectralNode::analyze()
+{
+	if( ! mAnalysisSnapshots.update() )
+		return;
+
+	const AnalysisWindow &window = mAnalysisSnapshots.getReadBuffer();
+	computeMagSpectrum( window.mSamples, &mMagSpectrum );
+	analyzeSpectrum( window.mSamples, mBufferSpectral, window.mFrame );
+
+	// copy into the back buffer, which is the same size so this doesn't allocate
+	mMagSpectrumSnapshots.getWriteBuffer() = mMagSpectrum;
+	mMagSpectrumSnapshots.publish();
 }
 
 // TODO: When getNumChannels() > 1, use generic channel converter.
 // - alternatively, this tap can force mono output, which only works if it isn't a tap but is really a leaf node (no output).
 const std::vector<float>& MonitorSpectralNode::getMagSpectrum()
 {
+	if( mAnalysisThread ) {
+		mMagSpectrumSnapshots.update();
+		return mMagSpectrumSnapshots.getReadBuffer();
+	}
+
+	// in snapshot mode, the spectrum is only recomputed when there is a new window, which may have been acquired by another getter
 	fillCopiedBuffer();
+	if( mHasNewSnapshot || ! mSnapshot ) {
+		computeMagSpectrum( getCopiedBuffer(), &mMagSpectrum );
+		mHasNewSnapshot = false;
+	}
+
+	return mMagSpectrum;
+}
 
+void MonitorSpectralNode::computeMagSpectrum( const Buffer &samples, std::vector<float> *magSpectrum )
+{
 	// window the copied buffer and compute forward FFT transform
-	if( getNumChannels() > 1 ) {
+	if( samples.getNumChannels() > 1 ) {
 		// naive average of all channels
 		mFftBuffer.zero();
-		float scale = 1.0f / getNumChannels();
-		for( size_t ch = 0; ch < getNumChannels(); ch++ ) {
+		float scale = 1.0f / samples.getNumChannels();
+		for( size_t ch = 0; ch < samples.getNumChannels(); ch++ ) {
 			for( size_t i = 0; i < mWindowSize; i++ )
-				mFftBuffer[i] += mCopiedBuffer.getChannel( ch )[i] * scale;
+				mFftBuffer[i] += samples.getChannel( ch )[i] * scale;
 		}
 		dsp::mul( mFftBuffer.getData(), mWindowingTable.get(), mFftBuffer.getData(), mWindowSize );
 	}
 	else
-		dsp::mul( mCopiedBuffer.getData(), mWindowingTable.get(), mFftBuffer.getData(), mWindowSize );
+		dsp::mul( samples.getData(), mWindowingTable.get(), mFftBuffer.getData(), mWindowSize );
 
 	mFft->forward( &mFftBuffer, &mBufferSpectral );
 
@@ -160,13 +379,13 @@ const std::vector<float>& MonitorSpectralNode::getMagSpectrum()
 	// compute normalized magnitude spectrum
 	// TODO: break this into vector cartisian -> polar and then vector lowpass. skip lowpass if smoothing factor is very small
 	const float magScale = 1.0f / mFft->getSize();
-	for( size_t i = 0; i < mMagSpectrum.size(); i++ ) {
+	const float smoothingFactor = mSmoothingFactor;
+	std::vector<float> &mag = *magSpectrum;
+	for( size_t i = 0; i < mag.size(); i++ ) {
 		float re = real[i];
 		float im = imag[i];
-		mMagSpectrum[i] = mMagSpectrum[i] * mSmoothingFactor + sqrt( re * re + im * im ) * magScale * ( 1 - mSmoothingFactor );
+		mag[i] = mag[i] * smoothingFactor + sqrt( re * re + im * im ) * magScale * ( 1 - smoothingFactor );
 	}
-
-	return mMagSpectrum;
 }
 
 void MonitorSpectralNode::setSmoothingFactor( float factor )
@@ -398,7 +398,7 @@ void Node::pullInputs( Buffer *inPlaceBuffer )
 			// from InputNode's that aren't filling the entire buffer are zero.
 			inPlaceBuffer->zero();
 			if( mEnabled )
-				process( inPlaceBuffer );
+				processInstrumented( inPlaceBuffer );
 		}
 		else {
 			// First pull the input (can only be one when in-place), then run process() if input did any processing.
@@ -409,7 +409,7 @@ void Node::pullInputs( Buffer *inPlaceBuffer )
 				dsp::mixBuffers( input->getInternalBuffer(), inPlaceBuffer );
 
 			if( mEnabled )
-				process( inPlaceBuffer );
+				processInstrumented( inPlaceBuffer );
 		}
 	}
 	else {
@@ -436,12 +436,28 @@ void Node::sumInputs()
 
 	// Process the summed results if enabled.
 	if( mEnabled )
-		process( &mSummingBuffer );
+		processInstrumented( &mSummingBuffer );
 
 	// copy summed buffer back to internal so downstream can get it.
 	dsp::mixBuffers( &mSummingBuffer, &mInternalBuffer );
 }
 
+void Node::processInstrumented( Buffer *buffer )
+{
+	// when no Profiler is enabled, this single relaxed load is the only overhead
+	if( Profiler::isAnyEnabled() ) {
+		Profiler *profiler = getContext()->getActiveProfiler();
+		if( profiler ) {
+			const uint64_t begin = Profiler::now();
+			process( buffer );
+			profiler->recordNode( this, Profiler::now() - begin );
+			return;
+		}
+	}
+
+	process( buffer );
+}
+
 void Node::setupProcessWithSumming()
 {
 	CI_ASSERT( getContext() );
@@ -471,7 +487,9 @@ bool Node::checkCycle( const NodeRef &sourceNode, const NodeRef &destNode ) cons
 
 void Node::notifyConnectionsDidChange()
 {
-	getContext()->connectionsDidChange( shared_from_this() );
+	auto ctx = getContext();
+	ctx->updateSummingBuffers();
+	ctx->connectionsDidChange( shared_from_this() );
 }
 
 bool Node::canConnectToInput( const NodeRef &input )
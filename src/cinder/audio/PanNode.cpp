@@ -84,7 +84,7 @@ void Pan2dNode::pullInputs( Buffer *destBuffer )
 		}
 
 		if( mEnabled )
-			process( &mSummingBuffer );
+			processInstrumented( &mSummingBuffer );
 
 		// at this point, audio will be in both stereo channels
 
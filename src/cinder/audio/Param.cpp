@@ -32,30 +32,47 @@ using namespace std;
 
 namespace cinder { namespace audio {
 
+// The ramping functions are evaluated in closed form with vector routines, rather than calling an easing function per sample.
+
 void rampLinear( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
 {
-	for( size_t i = 0; i < count; i++ ) {
-		float factor = t;
-		array[i] = lerp( valueRange.first, valueRange.second, factor );
-		t += tIncr;
-	}
+	const float range = valueRange.second - valueRange.first;
+	dsp::ramp( valueRange.first + range * t, range * tIncr, array, count );
 }
 
 void rampInQuad( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
 {
-	for( size_t i = 0; i < count; i++ ) {
-		float factor = t * t;
-		array[i] = lerp( valueRange.first, valueRange.second, factor );
-		t += tIncr;
-	}
+	// factor = t^2
+	dsp::ramp( t, tIncr, array, count );
+	dsp::mul( array, array, array, count );
+	dsp::mul( array, valueRange.second - valueRange.first, array, count );
+	dsp::add( array, valueRange.first, array, count );
 }
 
 void rampOutQuad( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
 {
-	for( size_t i = 0; i < count; i++ ) {
-		float factor = -t * ( t - 2 );
-		array[i] = lerp( valueRange.first, valueRange.second, factor );
-		t += tIncr;
+	// factor = -t * ( t - 2 ) = 1 - ( 1 - t )^2
+	dsp::ramp( 1 - t, -tIncr, array, count );
+	dsp::mul( array, array, array, count );
+	dsp::mul( array, valueRange.first - valueRange.second, array, count );
+	dsp::add( array, valueRange.second, array, count );
+}
+
+void rampExponential( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
+{
+	// only defined when both values are non-zero and of the same sign.
+	if( valueRange.first * valueRange.second <= 0 ) {
+		rampLinear( array, count, t, tIncr, valueRange );
+		return;
+	}
+
+	// value = first * ( second / first )^t. The per-sample ratio is rounded to float, so each segment begins from an exact value.
+	const size_t segmentSize = 64;
+	const double ratio = (double)valueRange.second / (double)valueRange.first;
+	const float ratioIncr = float( pow( ratio, (double)tIncr ) );
+	for( size_t i = 0; i < count; i += segmentSize ) {
+		float segmentBegin = float( valueRange.first * pow( ratio, (double)t + (double)tIncr * (double)i ) );
+		dsp::rampGeometric( segmentBegin, ratioIncr, array + i, min( segmentSize, count - i ) );
 	}
 }
 
@@ -66,7 +83,7 @@ Event::Event( float timeBegin, float timeEnd, float valueBegin, float valueEnd,
 }
 
 Param::Param( Node *parentNode, float initialValue )
-	: mParentNode( parentNode ), mValue( initialValue ), mIsVaryingThisBlock( false )
+	: mParentNode( parentNode ), mValue( initialValue ), mIsVaryingThisBlock( false ), mIsInternalBufferConstant( false )
 {
 }
 
@@ -211,7 +228,13 @@ const float* Param::getValueArray()
 {
 	if( ! mIsVaryingThisBlock ) {
 		initInternalBuffer();
-		dsp::fill( mValue, mInternalBuffer.getData(), mInternalBuffer.getSize() );
+
+		// the buffer only needs to be refilled when the constant value changes
+		float value = mValue;
+		if( ! mIsInternalBufferConstant || mInternalBuffer[0] != value ) {
+			dsp::fill( value, mInternalBuffer.getData(), mInternalBuffer.getSize() );
+			mIsInternalBufferConstant = true;
+		}
 	}
 
 	return mInternalBuffer.getData();
@@ -222,11 +245,19 @@ bool Param::eval()
 	if( mProcessor ) {
 		mProcessor->pullInputs( &mInternalBuffer );
 		mValue = mInternalBuffer[mInternalBuffer.getNumFrames() - 1];
+		mIsInternalBufferConstant = false;
 		return true;
 	}
+	else if( mEvents.empty() ) {
+		mIsVaryingThisBlock = false;
+		return false;
+	}
 	else {
 		auto ctx = getContext();
 		mIsVaryingThisBlock = eval( (float)ctx->getNumProcessedSeconds(), mInternalBuffer.getData(), mInternalBuffer.getSize(), ctx->getSampleRate() );
+
+		// eval() may have written to the buffer even if the result is constant.
+		mIsInternalBufferConstant = false;
 		return mIsVaryingThisBlock;
 	}
 }
@@ -235,6 +266,8 @@ bool Param::eval( float timeBegin, float *array, size_t arrayLength, size_t samp
 {
 	size_t samplesWritten = 0;
 	const float samplePeriod = 1.0f / (float)sampleRate;
+	const float valueBegin = mValue;
+	bool isVarying = false;
 
 	for( auto eventIt = mEvents.begin(); eventIt != mEvents.end(); /* */ ) {
 		EventRef &event = *eventIt;
@@ -269,7 +302,17 @@ bool Param::eval( float timeBegin, float *array, size_t arrayLength, size_t samp
 			if( event->getCopyValueOnBegin() )
 				event->setValueBegin( mValue ); // this is only copied the first block the Event is processed, as next block getCopyValueOnBegin() is false.
 
-			event->mRampFn( array + startIndex, count, timeBeginNormalized, timeIncr, make_pair( event->mValueBegin, event->mValueEnd ) );
+			// flat Events don't need to be rendered, and they only vary the Param if they move it away from its value when the block began.
+			if( event->mValueBegin == event->mValueEnd ) {
+				dsp::fill( event->mValueEnd, array + startIndex, count );
+				if( event->mValueEnd != valueBegin )
+					isVarying = true;
+			}
+			else {
+				event->mRampFn( array + startIndex, count, timeBeginNormalized, timeIncr, make_pair( event->mValueBegin, event->mValueEnd ) );
+				isVarying = true;
+			}
+
 			samplesWritten += count;
 
 			// if this ramp ended with the current processing block, update mValue then remove event
@@ -290,7 +333,7 @@ bool Param::eval( float timeBegin, float *array, size_t arrayLength, size_t samp
 			++eventIt;
 	}
 
-	if( ! samplesWritten )
+	if( ! samplesWritten || ! isVarying )
 		return false;
 	else if( samplesWritten < arrayLength )
 		dsp::fill( mValue, array + (size_t)samplesWritten, size_t( arrayLength - samplesWritten ) );
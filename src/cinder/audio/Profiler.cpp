@@ -0,0 +1,244 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/Profiler.h"
+#include "cinder/audio/Context.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+// a block that begins this much later than one block duration after the previous one is counted as a dropout
+const double LATE_BLOCK_FACTOR = 1.5;
+
+size_t nextPowerOfTwo( size_t value )
+{
+	size_t result = 1;
+	while( result < value )
+		result <<= 1;
+
+	return result;
+}
+
+void collectNodeNames( const NodeRef &node, map<const Node *, string> *names )
+{
+	if( ! node || names->count( node.get() ) )
+		return;
+
+	( *names )[node.get()] = node->getName();
+	for( const auto &input : node->getInputs() )
+		collectNodeNames( input, names );
+}
+
+} // anonymous namespace
+
+atomic<size_t> Profiler::sNumEnabled( 0 );
+
+Profiler::Profiler( Context *context, size_t maxNumNodes, size_t historyLength )
+	: mContext( context ), mNumEntries( nextPowerOfTwo( max<size_t>( maxNumNodes, 1 ) ) ), mResetRequested( false ), mNumUntrackedNodes( 0 ),
+		mBlockBeginTime( 0 ), mLastBlockBeginTime( 0 ), mBlockNanoseconds( 0 ), mLastLoad( 0 ), mPeakLoad( 0 ), mNumDropouts( 0 ),
+		mLoadHistory( historyLength ), mDropoutFrames( historyLength )
+{
+	mEntries.reset( new Entry[mNumEntries] );
+	clearEntries();
+}
+
+void Profiler::clearEntries()
+{
+	for( size_t i = 0; i < mNumEntries; i++ ) {
+		Entry &entry = mEntries[i];
+		entry.mNode.store( nullptr, memory_order_relaxed );
+		entry.mNumCalls.store( 0, memory_order_relaxed );
+		entry.mTotalNanoseconds.store( 0, memory_order_relaxed );
+		entry.mMaxNanoseconds.store( 0, memory_order_relaxed );
+		entry.mTotalBudgetNanoseconds.store( 0, memory_order_relaxed );
+	}
+
+	mNumUntrackedNodes = 0;
+}
+
+void Profiler::beginBlock( uint64_t blockNanoseconds )
+{
+	if( mResetRequested.exchange( false ) ) {
+		clearEntries();
+		mPeakLoad = 0;
+		mNumDropouts = 0;
+		mLastBlockBeginTime = 0;
+	}
+
+	mBlockBeginTime = now();
+	mBlockNanoseconds = blockNanoseconds;
+}
+
+void Profiler::endBlock( uint64_t processedFrames )
+{
+	// profiling may have been enabled part way through this block
+	if( ! mBlockBeginTime || ! mBlockNanoseconds )
+		return;
+
+	const uint64_t elapsed = now() - mBlockBeginTime;
+	const float load = float( (double)elapsed / (double)mBlockNanoseconds );
+
+	mLastLoad.store( load, memory_order_relaxed );
+	if( load > mPeakLoad.load( memory_order_relaxed ) )
+		mPeakLoad.store( load, memory_order_relaxed );
+
+	// if the reader isn't keeping up, the oldest history is kept and newer loads are dropped
+	mLoadHistory.write( &load, 1 );
+
+	const bool isLate = mLastBlockBeginTime && double( mBlockBeginTime - mLastBlockBeginTime ) > LATE_BLOCK_FACTOR * (double)mBlockNanoseconds;
+	if( load > 1 || isLate ) {
+		mNumDropouts.store( mNumDropouts.load( memory_order_relaxed ) + 1, memory_order_relaxed );
+		mDropoutFrames.write( &processedFrames, 1 );
+	}
+
+	mLastBlockBeginTime = mBlockBeginTime;
+	mBlockBeginTime = 0;
+}
+
+// Only the audio thread writes entries, so plain loads and stores are used instead of read-modify-write atomics. Entries are
+// found by open addressing on the Node's address and are never removed until reset(), so readers never see an entry move.
+void Profiler::recordNode( const Node *node, uint64_t nanoseconds )
+{
+	const size_t mask = mNumEntries - 1;
+	size_t index = ( ( reinterpret_cast<uintptr_t>( node ) >> 4 ) * 2654435761u ) & mask;
+
+	for( size_t probe = 0; probe < mNumEntries; probe++ ) {
+		Entry &entry = mEntries[index];
+		const Node *entryNode = entry.mNode.load( memory_order_relaxed );
+
+		if( entryNode == node || ! entryNode ) {
+			entry.mNumCalls.store( entry.mNumCalls.load( memory_order_relaxed ) + 1, memory_order_relaxed );
+			entry.mTotalNanoseconds.store( entry.mTotalNanoseconds.load( memory_order_relaxed ) + nanoseconds, memory_order_relaxed );
+			entry.mTotalBudgetNanoseconds.store( entry.mTotalBudgetNanoseconds.load( memory_order_relaxed ) + mBlockNanoseconds, memory_order_relaxed );
+			if( nanoseconds > entry.mMaxNanoseconds.load( memory_order_relaxed ) )
+				entry.mMaxNanoseconds.store( nanoseconds, memory_order_relaxed );
+
+			// publish the Node last, so that readers only see entries with statistics
+			if( ! entryNode )
+				entry.mNode.store( node, memory_order_release );
+
+			return;
+		}
+
+		index = ( index + 1 ) & mask;
+	}
+
+	mNumUntrackedNodes++;
+}
+
+vector<Profiler::NodeStats> Profiler::getNodeStats( size_t maxCount ) const
+{
+	vector<pair<uint64_t, NodeStats> > sorted;
+
+	for( size_t i = 0; i < mNumEntries; i++ ) {
+		const Entry &entry = mEntries[i];
+		const Node *node = entry.mNode.load( memory_order_acquire );
+		const uint64_t numCalls = entry.mNumCalls.load( memory_order_relaxed );
+		if( ! node || ! numCalls )
+			continue;
+
+		const uint64_t totalNanoseconds = entry.mTotalNanoseconds.load( memory_order_relaxed );
+		const uint64_t totalBudgetNanoseconds = entry.mTotalBudgetNanoseconds.load( memory_order_relaxed );
+
+		NodeStats stats;
+		stats.mNode = node;
+		stats.mNumCalls = numCalls;
+		stats.mAverageMicroseconds = (double)totalNanoseconds / (double)numCalls * 1e-3;
+		stats.mMaxMicroseconds = (double)entry.mMaxNanoseconds.load( memory_order_relaxed ) * 1e-3;
+		stats.mAverageLoad = totalBudgetNanoseconds ? (double)totalNanoseconds / (double)totalBudgetNanoseconds : 0;
+
+		sorted.push_back( make_pair( totalNanoseconds, stats ) );
+	}
+
+	sort( sorted.begin(), sorted.end(), []( const pair<uint64_t, NodeStats> &a, const pair<uint64_t, NodeStats> &b ) { return a.first > b.first; } );
+	if( maxCount && sorted.size() > maxCount )
+		sorted.resize( maxCount );
+
+	// Node's are only identified by address on the audio thread, so look up names from the ones currently in the graph.
+	map<const Node *, string> names;
+	if( mContext ) {
+		lock_guard<mutex> lock( mContext->getMutex() );
+
+		collectNodeNames( mContext->getOutput(), &names );
+		for( const auto &node : mContext->mAutoPulledNodes )
+			collectNodeNames( node, &names );
+	}
+
+	vector<NodeStats> result;
+	result.reserve( sorted.size() );
+	for( auto &entry : sorted ) {
+		auto nameIt = names.find( entry.second.mNode );
+		if( nameIt != names.end() )
+			entry.second.mName = nameIt->second;
+
+		result.push_back( entry.second );
+	}
+
+	return result;
+}
+
+string Profiler::dumpHottestNodes( size_t maxCount ) const
+{
+	stringstream stream;
+	stream << fixed << setprecision( 1 );
+	stream << "block load: last " << getLastLoad() * 100 << "%, peak " << getPeakLoad() * 100 << "%, dropouts: " << getNumDropouts() << endl;
+
+	for( const auto &stats : getNodeStats( maxCount ) ) {
+		stream << setw( 6 ) << stats.mAverageLoad * 100 << "% | avg " << setw( 8 ) << stats.mAverageMicroseconds << " us | max " << setw( 8 ) << stats.mMaxMicroseconds
+				<< " us | calls " << stats.mNumCalls << " | " << ( stats.mName.empty() ? "(disconnected)" : stats.mName ) << endl;
+	}
+
+	if( getNumUntrackedNodes() )
+		stream << "(" << getNumUntrackedNodes() << " Node's not tracked, table is full)" << endl;
+
+	return stream.str();
+}
+
+void Profiler::readLoadHistory( vector<float> *loads )
+{
+	const size_t numAvailable = mLoadHistory.getAvailableRead();
+	const size_t offset = loads->size();
+
+	loads->resize( offset + numAvailable );
+	mLoadHistory.read( loads->data() + offset, numAvailable );
+}
+
+void Profiler::readDropouts( vector<uint64_t> *frames )
+{
+	const size_t numAvailable = mDropoutFrames.getAvailableRead();
+	const size_t offset = frames->size();
+
+	frames->resize( offset + numAvailable );
+	mDropoutFrames.read( frames->data() + offset, numAvailable );
+}
+
+} } // namespace cinder::audio
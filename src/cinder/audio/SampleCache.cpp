@@ -0,0 +1,345 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/SampleCache.h"
+#include "cinder/audio/MappedFile.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/audio/Debug.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+const size_t DEFAULT_MEMORY_BUDGET = 256 * 1024 * 1024;
+
+const char		PRE_DECODED_MAGIC[4] = { 'C', 'I', 'S', 'F' };
+const uint32_t	PRE_DECODED_VERSION = 1;
+const uint32_t	PRE_DECODED_BYTE_ORDER_MARK = 0x01020304;
+// Samples start at this offset (the mapping itself is page aligned), so each channel is SIMD aligned when the number of frames is a multiple of 16.
+const uint64_t	PRE_DECODED_DATA_OFFSET = 64;
+
+struct PreDecodedHeader {
+	char		mMagic[4];
+	uint32_t	mVersion;
+	uint32_t	mByteOrderMark;		// written natively, so files from a machine of different endianness are rejected
+	uint32_t	mNumChannels;
+	uint64_t	mSampleRate;
+	uint64_t	mNumFrames;
+	uint64_t	mDataOffset;
+};
+
+static_assert( sizeof( PreDecodedHeader ) <= PRE_DECODED_DATA_OFFSET, "PreDecodedHeader must fit before the samples" );
+
+
+
+string makeInstanceKey( const void *instance, size_t sampleRate )
+{
+	ostringstream ss;
+	ss << "instance:" << instance << "@" << sampleRate;
+	return ss.str();
+}
+
+} // anonymous namespace
+
+// static
+SampleCache* SampleCache::get()
+{
+	static SampleCache sCache;
+	return &sCache;
+}
+
+SampleCache::SampleCache()
+	: mMemoryBudget( DEFAULT_MEMORY_BUDGET ), mMemoryUsage( 0 )
+{
+}
+
+BufferRef SampleCache::loadBuffer( const DataSourceRef &dataSource, size_t sampleRate )
+{
+	// Files are keyed by path so that all players share them, other DataSource's only by identity.
+	const bool isFilePath = dataSource->isFilePath();
+	const string key = isFilePath ? "file:" + dataSource->getFilePath().string() + "@" + to_string( sampleRate ) : makeInstanceKey( dataSource.get(), sampleRate );
+
+	fs::path preDecodedPath;
+	{
+		lock_guard<mutex> lock( mMutex );
+		BufferRef cached = findLocked( key );
+		if( cached )
+			return cached;
+
+		if( isFilePath && ! mPreDecodedDirectory.empty() )
+			preDecodedPath = getPreDecodedPath( dataSource->getFilePath(), sampleRate );
+	}
+
+	// load outside of the lock so other callers aren't blocked while decoding
+	BufferRef buffer;
+	if( ! preDecodedPath.empty() && fs::exists( preDecodedPath ) ) {
+		try {
+			buffer = loadPreDecoded( preDecodedPath );
+		}
+		catch( AudioFileExc &exc ) {
+			CI_LOG_W( "ignoring pre-decoded file: " << exc.what() );
+		}
+	}
+
+	if( ! buffer ) {
+		auto sourceFile = SourceFile::create( dataSource, sampleRate );
+		buffer = sourceFile->loadBuffer();
+
+		if( ! preDecodedPath.empty() ) {
+			try {
+				writePreDecoded( *buffer, sourceFile->getSampleRate(), preDecodedPath );
+			}
+			catch( AudioFileExc &exc ) {
+				CI_LOG_W( "failed to write pre-decoded file: " << exc.what() );
+			}
+		}
+	}
+
+	return insert( key, buffer, isFilePath ? nullptr : dataSource );
+}
+
+BufferRef SampleCache::loadBuffer( const SourceFileRef &sourceFile, size_t sampleRate )
+{
+	if( ! sampleRate )
+		sampleRate = sourceFile->getSampleRate();
+
+	const string key = makeInstanceKey( sourceFile.get(), sampleRate );
+	{
+		lock_guard<mutex> lock( mMutex );
+		BufferRef cached = findLocked( key );
+		if( cached )
+			return cached;
+	}
+
+	SourceFileRef sf = sampleRate == sourceFile->getSampleRate() ? sourceFile : sourceFile->cloneWithSampleRate( sampleRate );
+	return insert( key, sf->loadBuffer(), sourceFile );
+}
+
+void SampleCache::setMemoryBudget( size_t bytes )
+{
+	lock_guard<mutex> lock( mMutex );
+	mMemoryBudget = bytes;
+	evictLocked();
+}
+
+size_t SampleCache::getMemoryBudget() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mMemoryBudget;
+}
+
+size_t SampleCache::getMemoryUsage() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mMemoryUsage;
+}
+
+size_t SampleCache::getNumEntries() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mEntries.size();
+}
+
+void SampleCache::clear()
+{
+	lock_guard<mutex> lock( mMutex );
+	mEntries.clear();
+	mLruKeys.clear();
+	mMemoryUsage = 0;
+}
+
+void SampleCache::setPreDecodedDirectory( const fs::path &directory )
+{
+	if( ! directory.empty() && ! fs::exists( directory ) )
+		fs::create_directories( directory );
+
+	lock_guard<mutex> lock( mMutex );
+	mPreDecodedDirectory = directory;
+}
+
+fs::path SampleCache::getPreDecodedDirectory() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mPreDecodedDirectory;
+}
+
+BufferRef SampleCache::findLocked( const string &key )
+{
+	auto it = mEntries.find( key );
+	if( it == mEntries.end() )
+		return nullptr;
+
+	Entry &entry = it->second;
+	if( entry.mIsKeyedByInstance && entry.mInstance.expired() ) {
+		// the address has been reused by a different object
+		eraseLocked( it );
+		return nullptr;
+	}
+
+	mLruKeys.splice( mLruKeys.begin(), mLruKeys, entry.mLruPos );
+	return entry.mBuffer;
+}
+
+BufferRef SampleCache::insert( const string &key, const BufferRef &buffer, const shared_ptr<void> &instance )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	// another thread may have loaded the same samples in the meantime, in which case share those.
+	BufferRef existing = findLocked( key );
+	if( existing )
+		return existing;
+
+	size_t numBytes = buffer->getSize() * sizeof( float );
+	if( numBytes > mMemoryBudget )
+		return buffer;
+
+	mLruKeys.push_front( key );
+
+	Entry &entry = mEntries[key];
+	entry.mBuffer = buffer;
+	entry.mInstance = instance;
+	entry.mIsKeyedByInstance = (bool)instance;
+	entry.mLruPos = mLruKeys.begin();
+
+	mMemoryUsage += numBytes;
+	evictLocked();
+
+	return buffer;
+}
+
+void SampleCache::eraseLocked( map<string, Entry>::iterator it )
+{
+	mMemoryUsage -= it->second.mBuffer->getSize() * sizeof( float );
+	mLruKeys.erase( it->second.mLruPos );
+	mEntries.erase( it );
+}
+
+void SampleCache::evictLocked()
+{
+	if( mMemoryUsage <= mMemoryBudget )
+		return;
+
+	// entries whose SourceFile or DataSource is gone can never be hit again, so they go first.
+	for( auto it = mEntries.begin(); it != mEntries.end(); ) {
+		auto current = it++;
+		if( current->second.mIsKeyedByInstance && current->second.mInstance.expired() )
+			eraseLocked( current );
+	}
+
+	while( mMemoryUsage > mMemoryBudget && ! mLruKeys.empty() )
+		eraseLocked( mEntries.find( mLruKeys.back() ) );
+}
+
+fs::path SampleCache::getPreDecodedPath( const fs::path &sourcePath, size_t sampleRate ) const
+{
+	// The name encodes the source's path, size and modification time, so edited files are decoded again.
+	ostringstream ss;
+	ss << sourcePath.string() << "@" << sampleRate;
+	if( fs::exists( sourcePath ) )
+		ss << ":" << fs::file_size( sourcePath ) << ":" << fs::last_write_time( sourcePath );
+
+	ostringstream name;
+	name << sourcePath.stem().string() << "_" << hex << hash<string>()( ss.str() ) << ".f32";
+
+	return mPreDecodedDirectory / name.str();
+}
+
+// static
+void SampleCache::writePreDecoded( const Buffer &buffer, size_t sampleRate, const fs::path &path )
+{
+	PreDecodedHeader header;
+	memset( &header, 0, sizeof( header ) );
+	memcpy( header.mMagic, PRE_DECODED_MAGIC, sizeof( header.mMagic ) );
+	header.mVersion = PRE_DECODED_VERSION;
+	header.mByteOrderMark = PRE_DECODED_BYTE_ORDER_MARK;
+	header.mNumChannels = (uint32_t)buffer.getNumChannels();
+	header.mSampleRate = sampleRate;
+	header.mNumFrames = buffer.getNumFrames();
+	header.mDataOffset = PRE_DECODED_DATA_OFFSET;
+
+	// write to a temporary file first, so that a concurrent reader never maps a partially written file.
+	fs::path tempPath = path;
+	tempPath += ".tmp";
+
+	{
+		ofstream stream( tempPath.string().c_str(), ios::binary | ios::trunc );
+		if( ! stream )
+			throw AudioFileExc( "could not open pre-decoded file for writing: " + tempPath.string() );
+
+		char padding[PRE_DECODED_DATA_OFFSET] = { 0 };
+		stream.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+		stream.write( padding, PRE_DECODED_DATA_OFFSET - sizeof( header ) );
+
+		for( size_t ch = 0; ch < buffer.getNumChannels(); ch++ )
+			stream.write( reinterpret_cast<const char *>( buffer.getChannel( ch ) ), buffer.getNumFrames() * sizeof( float ) );
+
+		if( ! stream ) {
+			stream.close();
+			fs::remove( tempPath );
+			throw AudioFileExc( "failed writing pre-decoded file: " + tempPath.string() );
+		}
+	}
+
+	if( fs::exists( path ) )
+		fs::remove( path );
+
+	fs::rename( tempPath, path );
+}
+
+// static
+BufferRef SampleCache::loadPreDecoded( const fs::path &path, size_t *sampleRate )
+{
+	auto mappedFile = make_shared<MappedFile>( path );
+
+	if( mappedFile->getSize() < PRE_DECODED_DATA_OFFSET )
+		throw AudioFileExc( "file is too small to be pre-decoded: " + path.string() );
+
+	PreDecodedHeader header;
+	memcpy( &header, mappedFile->getData(), sizeof( header ) );
+
+	if( memcmp( header.mMagic, PRE_DECODED_MAGIC, sizeof( header.mMagic ) ) != 0 || header.mVersion != PRE_DECODED_VERSION || header.mByteOrderMark != PRE_DECODED_BYTE_ORDER_MARK )
+		throw AudioFileExc( "not a pre-decoded file: " + path.string() );
+
+	uint64_t numSamples = header.mNumFrames * header.mNumChannels;
+	if( header.mDataOffset < sizeof( header ) || header.mDataOffset + numSamples * sizeof( float ) > mappedFile->getSize() )
+		throw AudioFileExc( "pre-decoded file is truncated: " + path.string() );
+
+	if( sampleRate )
+		*sampleRate = (size_t)header.mSampleRate;
+
+	float *samples = reinterpret_cast<float *>( mappedFile->getData() + header.mDataOffset );
+
+	// the deleter owns the mapping, so it lives exactly as long as the Buffer does.
+	return BufferRef( new Buffer( samples, (size_t)header.mNumFrames, header.mNumChannels ), [mappedFile]( Buffer *buffer ) { delete buffer; } );
+}
+
+} } // namespace cinder::audio
@@ -23,6 +23,7 @@
 
 #include "cinder/audio/SamplePlayerNode.h"
 #include "cinder/audio/Context.h"
+#include "cinder/audio/SampleCache.h"
 #include "cinder/audio/Debug.h"
 #include "cinder/CinderMath.h"
 
@@ -31,17 +32,31 @@ using namespace std;
 
 namespace cinder { namespace audio {
 
+namespace {
+
+const float MIN_STRETCH_RATIO = 1.0f / 16.0f;
+const float MAX_STRETCH_RATIO = 16.0f;
+
+} // anonymous namespace
+
 // ----------------------------------------------------------------------------------------------------
 // MARK: - SamplePlayerNode
 // ----------------------------------------------------------------------------------------------------
 
 SamplePlayerNode::SamplePlayerNode( const Format &format )
 	: InputNode( format ), mNumFrames( 0 ), mReadPos( 0 ), mLoop( false ),
-		mLoopBegin( 0 ), mLoopEnd( 0 )
+		mLoopBegin( 0 ), mLoopEnd( 0 ), mStretchQuality( dsp::PhaseVocoder::Quality::MEDIUM ), mPlaybackRate( 1 ), mPitchShift( 1 ),
+		mStretchResetNeeded( false ), mStretchOutputPos( 0 ), mStretchTailFrames( 0 ), mStretchActive( false ), mStretchDraining( false )
 {
 	setChannelMode( ChannelMode::SPECIFIED );
 }
 
+void SamplePlayerNode::initialize()
+{
+	if( isStretchAllocationNeeded() )
+		allocateStretch();
+}
+
 void SamplePlayerNode::start()
 {
 	seek( 0 );
@@ -112,6 +127,129 @@ double SamplePlayerNode::getNumSeconds() const
 	return (double)mNumFrames / (double)getSampleRate();
 }
 
+bool SamplePlayerNode::isReadEnd() const
+{
+	bool isLooping = mLoop && mLoopBegin < mLoopEnd;
+	return ! isLooping && mReadPos >= mNumFrames;
+}
+
+void SamplePlayerNode::setPlaybackRate( float rate )
+{
+	mPlaybackRate = math<float>::clamp( rate, MIN_STRETCH_RATIO, MAX_STRETCH_RATIO );
+	updateStretch();
+}
+
+void SamplePlayerNode::setPitchShift( float ratio )
+{
+	mPitchShift = math<float>::clamp( ratio, MIN_STRETCH_RATIO, MAX_STRETCH_RATIO );
+	updateStretch();
+}
+
+void SamplePlayerNode::setStretchQuality( dsp::PhaseVocoder::Quality quality )
+{
+	mStretchQuality = quality;
+	updateStretch();
+}
+
+void SamplePlayerNode::updateStretch()
+{
+	// only block the audio thread when something needs to be allocated, so that the rate and pitch can be changed continuously
+	if( isStretchAllocationNeeded() ) {
+		lock_guard<mutex> lock( getContext()->getMutex() );
+		allocateStretch();
+	}
+}
+
+bool SamplePlayerNode::isStretchAllocationNeeded() const
+{
+	if( mPlaybackRate == 1 && mPitchShift == 1 )
+		return false;
+
+	return ! mStretch || mStretch->getNumChannels() != getNumChannels() || mStretch->getQuality() != mStretchQuality;
+}
+
+void SamplePlayerNode::allocateStretch()
+{
+	if( mStretch && mStretch->getNumChannels() == getNumChannels() && mStretch->getQuality() == mStretchQuality )
+		return;
+
+	mStretch.reset( new dsp::PhaseVocoder( getNumChannels(), mStretchQuality ) );
+	mStretchInput = Buffer( mStretch->getMaxInputFramesNeeded(), getNumChannels() );
+	mStretchOutput = Buffer( mStretch->getHopSize(), getNumChannels() );
+	mStretchActive = false;
+}
+
+size_t SamplePlayerNode::getMaxFramesReadPerBlock() const
+{
+	size_t framesPerBlock = getFramesPerBlock();
+	if( ! mStretch )
+		return framesPerBlock;
+
+	// a block can span one more hop than fits in it, each of which reads the analysis hop
+	size_t hopSize = mStretch->getHopSize();
+	size_t analysisHopSize = size_t( ceil( hopSize * mPlaybackRate ) ) + 1;
+	return max( framesPerBlock, ( framesPerBlock / hopSize + 1 ) * analysisHopSize );
+}
+
+bool SamplePlayerNode::processStretched( Buffer *buffer, size_t frameOffset, size_t numFrames )
+{
+	bool isActive = mStretch && ( mPlaybackRate != 1 || mPitchShift != 1 );
+	if( ! isActive ) {
+		mStretchActive = false;
+		return false;
+	}
+
+	if( ! mStretchActive || mStretchResetNeeded.exchange( false ) ) {
+		mStretch->reset();
+		mStretchOutputPos = mStretch->getHopSize();
+		mStretchDraining = false;
+		mStretchActive = true;
+	}
+
+	mStretch->setRate( mPlaybackRate );
+	mStretch->setPitch( mPitchShift );
+
+	const size_t hopSize = mStretch->getHopSize();
+	size_t numWritten = 0;
+	while( numWritten < numFrames ) {
+		if( mStretchOutputPos == hopSize ) {
+			size_t numNeeded = mStretch->getNumInputFramesNeeded();
+			if( ! mStretchDraining ) {
+				size_t numRead = readFrames( &mStretchInput, 0, numNeeded );
+				if( numRead < numNeeded && isReadEnd() ) {
+					// the rest of the input is silence, play until the last sample frame has left the PhaseVocoder
+					mStretchDraining = true;
+					mStretchTailFrames = mStretch->getTailFrames();
+				}
+			}
+			else
+				mStretchInput.zero( 0, numNeeded );
+
+			mStretch->process( mStretchInput, &mStretchOutput );
+			mStretchOutputPos = 0;
+		}
+
+		size_t count = min( hopSize - mStretchOutputPos, numFrames - numWritten );
+		buffer->copyOffset( mStretchOutput, count, frameOffset + numWritten, mStretchOutputPos );
+		mStretchOutputPos += count;
+		numWritten += count;
+
+		if( mStretchDraining ) {
+			if( mStretchTailFrames <= count ) {
+				buffer->zero( frameOffset + numWritten, numFrames - numWritten );
+				mStretchActive = false;
+				mIsEof = true;
+				disable();
+				break;
+			}
+
+			mStretchTailFrames -= count;
+		}
+	}
+
+	return true;
+}
+
 // ----------------------------------------------------------------------------------------------------
 // MARK: - BufferPlayerNode
 // ----------------------------------------------------------------------------------------------------
@@ -145,6 +283,7 @@ void BufferPlayerNode::seek( size_t readPositionFrames )
 {
 	mIsEof = false;
 	mReadPos = math<size_t>::clamp( readPositionFrames, 0, mNumFrames );
+	mStretchResetNeeded = true;
 }
 
 void BufferPlayerNode::setBuffer( const BufferRef &buffer )
@@ -170,43 +309,58 @@ void BufferPlayerNode::setBuffer( const BufferRef &buffer )
 
 void BufferPlayerNode::loadBuffer( const SourceFileRef &sourceFile )
 {
-	size_t sampleRate = getSampleRate();
-	if( sampleRate == sourceFile->getSampleRate() )
-		setBuffer( sourceFile->loadBuffer() );
-	else {
-		auto sf = sourceFile->cloneWithSampleRate( sampleRate );
-		setBuffer( sf->loadBuffer() );
-	}
+	setBuffer( SampleCache::get()->loadBuffer( sourceFile, getSampleRate() ) );
+}
+
+void BufferPlayerNode::loadBuffer( const DataSourceRef &dataSource )
+{
+	setBuffer( SampleCache::get()->loadBuffer( dataSource, getSampleRate() ) );
 }
 
 void BufferPlayerNode::process( Buffer *buffer )
 {
 	const auto &frameRange = getProcessFramesRange();
+	size_t numFrames = frameRange.second - frameRange.first;
+
+	if( processStretched( buffer, frameRange.first, numFrames ) )
+		return;
+
+	size_t readCount = readFrames( buffer, frameRange.first, numFrames );
+	if( readCount < numFrames ) {
+		mIsEof = true;
+		disable();
+	}
+}
 
+size_t BufferPlayerNode::readFrames( Buffer *buffer, size_t frameOffset, size_t numFrames )
+{
 	size_t readPos = mReadPos;
-	size_t numFrames = frameRange.second - frameRange.first;
-	size_t readEnd = mLoop ? mLoopEnd.load() : mNumFrames;
-	size_t readCount = readEnd < readPos ? 0 : min( readEnd - readPos, numFrames );
+	size_t numRead = 0;
 
-	buffer->copyOffset( *mBuffer, readCount, frameRange.first, readPos );
+	while( true ) {
+		size_t readEnd = mLoop ? mLoopEnd.load() : mNumFrames;
+		size_t readCount = readEnd < readPos ? 0 : min( readEnd - readPos, numFrames - numRead );
 
-	if( readCount < numFrames  ) {
-		// End of File. If looping copy from beginning, otherwise disable and mark the mIsEof.
-		if( mLoop ) {
-			size_t readBegin = mLoopBegin;
-			size_t readLeft = min( numFrames - readCount, mNumFrames - readBegin );
+		buffer->copyOffset( *mBuffer, readCount, frameOffset + numRead, readPos );
+		readPos += readCount;
+		numRead += readCount;
 
-			buffer->copyOffset( *mBuffer, readLeft, readCount, readBegin );
-			mReadPos.store( readBegin + readLeft );
-		}
-		else {
-			mIsEof = true;
-			mReadPos = mNumFrames;
-			disable();
+		if( numRead == numFrames )
+			break;
+
+		// End of File. If looping continue from the loop begin, otherwise the read position stays at the end.
+		size_t loopBegin = mLoopBegin;
+		if( ! mLoop || loopBegin >= readEnd ) {
+			buffer->zero( frameOffset + numRead, numFrames - numRead );
+			readPos = mNumFrames;
+			break;
 		}
+
+		readPos = loopBegin;
 	}
-	else
-		mReadPos += readCount;
+
+	mReadPos = readPos;
+	return numRead;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -214,13 +368,14 @@ void BufferPlayerNode::process( Buffer *buffer )
 // ----------------------------------------------------------------------------------------------------
 
 FilePlayerNode::FilePlayerNode( const Format &format )
-	: SamplePlayerNode( format ), mRingBufferPaddingFactor( 2 ), mLastUnderrun( 0 ), mLastOverrun( 0 ), mIsReadAsync( true )
+	: SamplePlayerNode( format ), mReadAheadFrames( 0 ), mLastUnderrun( 0 ), mLastOverrun( 0 ), mNumUnderruns( 0 ),
+		mIsReadAsync( true ), mIsStreaming( false )
 {
 }
 
 FilePlayerNode::FilePlayerNode( const SourceFileRef &sourceFile, bool isReadAsync, const Format &format )
-	: SamplePlayerNode( format ), mSourceFile( sourceFile ), mIsReadAsync( isReadAsync ), mRingBufferPaddingFactor( 2 ),
-		mLastUnderrun( 0 ), mLastOverrun( 0 )
+	: SamplePlayerNode( format ), mSourceFile( sourceFile ), mIsReadAsync( isReadAsync ), mIsStreaming( false ), mReadAheadFrames( 0 ),
+		mLastUnderrun( 0 ), mLastOverrun( 0 ), mNumUnderruns( 0 )
 {
 	if( mSourceFile ) {
 		mNumFrames = mSourceFile->getNumFrames();
@@ -232,12 +387,13 @@ FilePlayerNode::FilePlayerNode( const SourceFileRef &sourceFile, bool isReadAsyn
 
 FilePlayerNode::~FilePlayerNode()
 {
-	if( isInitialized() )
-		destroyReadThreadImpl();
+	stopStreamImpl();
 }
 
 void FilePlayerNode::initialize()
 {
+	SamplePlayerNode::initialize();
+
 	if( mSourceFile ) {
 		// Ensure the SourceFile's output samplerate matches ours.
 		size_t sampleRate = getSampleRate();
@@ -250,22 +406,13 @@ void FilePlayerNode::initialize()
 	if( ! mLoopEnd  || mLoopEnd > mNumFrames )
 		mLoopEnd = mNumFrames;
 
-	mIoBuffer.setSize( mSourceFile->getMaxFramesPerRead(), getNumChannels() );
-
-	for( size_t i = 0; i < getNumChannels(); i++ )
-		mRingBuffers.emplace_back( mSourceFile->getMaxFramesPerRead() * mRingBufferPaddingFactor );
-
-	mBufferFramesThreshold = mRingBuffers[0].getSize() / 2;
-
-	if( mIsReadAsync ) {
-		mAsyncReadShouldQuit = false;
-		mReadThread = unique_ptr<thread>( new thread( bind( &FilePlayerNode::readAsyncImpl, this ) ) );
-	}
+	if( mSourceFile )
+		startStreamImpl();
 }
 
 void FilePlayerNode::uninitialize()
 {
-	destroyReadThreadImpl();
+	stopStreamImpl();
 }
 
 void FilePlayerNode::enableProcessing()
@@ -282,32 +429,24 @@ void FilePlayerNode::disableProcessing()
 {
 }
 
-void FilePlayerNode::stop()
-{
-	if( mIsReadAsync ) {
-		lock_guard<mutex> lock( mAsyncReadMutex );
-		stopImpl();
-	}
-	else {
-		auto ctx = getContext();
-		if( ! ctx->isAudioThread() ) {
-			lock_guard<mutex> lock( ctx->getMutex() );
-			stopImpl();
-		}
-		else {
-			// called from audio thread, lock is already held for the duration of this block
-			stopImpl();
-		}
-	}
-}
-
 void FilePlayerNode::seek( size_t readPositionFrames )
 {
+	if( ! mSourceFile )
+		return;
+
 	if( mIsReadAsync ) {
-		lock_guard<mutex> lock( mAsyncReadMutex );
-		seekImpl( readPositionFrames );
+		// The io thread notices the new generation, seeks and prefetches from there. process() discards whatever was read before it.
+		size_t readPos = math<size_t>::clamp( readPositionFrames, 0, mNumFrames );
+		mSeekPos = readPos;
+		mReadPos = readPos;
+		mIsEof = false;
+		mStretchResetNeeded = true;
+		mSeekGeneration++;
+		requestService();
 	}
 	else {
+		mStretchResetNeeded = true;
+
 		auto ctx = getContext();
 		if( ! ctx->isAudioThread() ) {
 			lock_guard<mutex> lock( ctx->getMutex() );
@@ -327,6 +466,9 @@ void FilePlayerNode::setSourceFile( const SourceFileRef &sourceFile )
 	bool wasEnabled = isEnabled();
 	disable();
 
+	// the io thread must be done with the current SourceFile before it is replaced
+	stopStreamImpl();
+
 	// ensure the source's samplerate matches the context
 	size_t sampleRate = getSampleRate();
 	if( sourceFile->getSampleRate() == sampleRate )
@@ -336,18 +478,33 @@ void FilePlayerNode::setSourceFile( const SourceFileRef &sourceFile )
 
 	mNumFrames = mSourceFile->getNumFrames();
 
+	if( ! mLoopEnd  || mLoopEnd > mNumFrames )
+		mLoopEnd = mNumFrames;
+
 	if( getNumChannels() != mSourceFile->getNumChannels() ) {
 		setNumChannels( mSourceFile->getNumChannels() );
 		configureConnections();
 	}
 
-	if( ! mLoopEnd  || mLoopEnd > mNumFrames )
-		mLoopEnd = mNumFrames;
+	// configureConnections() may have already restarted the stream when it re-initialized this Node
+	if( isInitialized() && ! mIsStreaming )
+		startStreamImpl();
 
 	if( wasEnabled )
 		enable();
 }
 
+void FilePlayerNode::setReadAheadFrames( size_t frames )
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	mReadAheadFrames = frames;
+	if( mIsStreaming ) {
+		stopStreamImpl();
+		startStreamImpl();
+	}
+}
+
 uint64_t FilePlayerNode::getLastUnderrun()
 {
 	uint64_t result = mLastUnderrun;
@@ -362,88 +519,185 @@ uint64_t FilePlayerNode::getLastOverrun()
 	return result;
 }
 
-void FilePlayerNode::process( Buffer *buffer )
+bool FilePlayerNode::isStretchAllocationNeeded() const
 {
-	size_t numFrames = buffer->getNumFrames();
-	size_t readPos = mReadPos;
-	size_t numReadAvail = mRingBuffers[0].getAvailableRead();
+	if( SamplePlayerNode::isStretchAllocationNeeded() )
+		return true;
 
-	if( numReadAvail < mBufferFramesThreshold ) {
-		if( mIsReadAsync )
-			mIssueAsyncReadCond.notify_one();
-		else
-			readImpl();
-	}
+	return mIsStreaming && mRingBuffers[0].getSize() < getRingBufferSize();
+}
 
-	size_t readCount = std::min( numReadAvail, numFrames );
+void FilePlayerNode::allocateStretch()
+{
+	SamplePlayerNode::allocateStretch();
 
-	for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ ) {
-		if( ! mRingBuffers[ch].read( buffer->getChannel( ch ), readCount ) )
-			mLastUnderrun = getContext()->getNumProcessedFrames();
+	// faster playback rates read more frames per block, restart streaming with ring buffers that can hold them.
+	if( mIsStreaming && mRingBuffers[0].getSize() < getRingBufferSize() ) {
+		stopStreamImpl();
+		startStreamImpl();
 	}
+}
 
-	// handle loop or EOF
-	if( readCount < numFrames ) {
-		// TODO: if looping, should fill with samples from the beginning of file
-		// - these should also already be in the ringbuffer, since a seek is done there as well. Rethink this path.
-		readPos += readCount;
-		if( mLoop && readPos >= mLoopEnd )
-			seekImpl( mLoopBegin );
-		else if( readPos >= mNumFrames ) {
-			mIsEof = true;
-			disable();
-		}
+void FilePlayerNode::process( Buffer *buffer )
+{
+	const size_t numFrames = buffer->getNumFrames();
+
+	if( processStretched( buffer, 0, numFrames ) )
+		return;
+
+	size_t readCount = readFrames( buffer, 0, numFrames );
+	if( readCount < numFrames && isReadEnd() ) {
+		mIsEof = true;
+		disable();
 	}
 }
 
-void FilePlayerNode::readAsyncImpl()
+size_t FilePlayerNode::readFrames( Buffer *buffer, size_t frameOffset, size_t numFrames )
 {
-	size_t lastReadPos = mReadPos;
-	while( true ) {
-		unique_lock<mutex> lock( mAsyncReadMutex );
-		mIssueAsyncReadCond.wait( lock );
+	bool seekCompleted = false;
 
-		if( mAsyncReadShouldQuit )
-			return;
+	if( mIsReadAsync ) {
+		uint64_t seekGeneration = mSeekGeneration;
+		if( seekGeneration != mAudioGeneration ) {
+			// frames counted before an unserviced generation is observed were all written before the seek
+			size_t numReadAvail = mRingBuffers[0].getAvailableRead();
+			if( mIoGeneration.load( std::memory_order_acquire ) == seekGeneration ) {
+				// drop the samples that were written before the io thread serviced the seek. The generation's start frame is loaded before the
+				// available count, so the count includes every stale frame the io thread wrote before publishing the new generation.
+				uint64_t startFrame = mIoGenerationStartFrame.load( std::memory_order_acquire );
+				numReadAvail = mRingBuffers[0].getAvailableRead();
+				size_t numStale = startFrame > mNumFramesRead ? (size_t)min<uint64_t>( startFrame - mNumFramesRead, numReadAvail ) : 0;
+				for( auto &ringBuffer : mRingBuffers )
+					ringBuffer.discard( numStale );
+
+				mNumFramesRead += numStale;
+				mReadPos = mIoGenerationStartPos.load();
+				mAudioGeneration = seekGeneration;
+				seekCompleted = true;
+			}
+			else {
+				// the seek hasn't been serviced yet. Everything in the ring buffers is stale, so make room for the io thread and output silence until it is.
+				for( auto &ringBuffer : mRingBuffers )
+					ringBuffer.discard( numReadAvail );
+
+				mNumFramesRead += numReadAvail;
+				buffer->zero( frameOffset, numFrames );
+				requestService();
+				return 0;
+			}
+		}
+	}
+	else if( mRingBuffers[0].getAvailableRead() < mBufferFramesThreshold )
+		serviceStream();
+
+	// channel 0 is written last by the io thread, so the other channels have at least as many samples available.
+	size_t numReadAvail = mRingBuffers[0].getAvailableRead();
+	size_t readCount = std::min( numReadAvail, numFrames );
 
-		size_t readPos = mReadPos;
-		if( readPos != lastReadPos )
-			mSourceFile->seek( readPos );
+	for( size_t ch = 0; ch < mRingBuffers.size(); ch++ )
+		mRingBuffers[ch].read( buffer->getChannel( ch ) + frameOffset, readCount );
 
-		readImpl();
-		lastReadPos = mReadPos;
+	mNumFramesRead += readCount;
+
+	if( readCount < numFrames )
+		buffer->zero( frameOffset + readCount, numFrames - readCount );
+
+	// advance the read position, wrapping at the loop end like the io thread does.
+	size_t readPos = mReadPos + readCount;
+	size_t loopBegin = mLoopBegin;
+	size_t loopEnd = mLoopEnd;
+	bool isLooping = mLoop && loopBegin < loopEnd;
+	if( isLooping && readPos >= loopEnd )
+		readPos = loopBegin + ( readPos - loopEnd ) % ( loopEnd - loopBegin );
+
+	mReadPos = readPos;
+
+	if( mIsReadAsync && numReadAvail - readCount < mBufferFramesThreshold )
+		requestService();
+
+	// running short before the end is an underrun
+	if( readCount < numFrames && ! seekCompleted && ! isReadEnd() ) {
+		mNumUnderruns++;
+		mLastUnderrun = getContext()->getNumProcessedFrames();
 	}
+
+	return readCount;
 }
 
-void FilePlayerNode::readImpl()
+void FilePlayerNode::serviceStream()
 {
-	size_t readPos = mReadPos;
-	size_t availableWrite = mRingBuffers[0].getAvailableWrite();
-	size_t readEnd = mLoop ? mLoopEnd.load() : mNumFrames;
-	size_t numFramesToRead = readEnd < readPos ? 0 : min( availableWrite, readEnd - readPos );
+	const size_t numChannels = mRingBuffers.size();
+	const size_t maxFramesPerRead = std::min( mSourceFile->getMaxFramesPerRead(), mRingBuffers[0].getSize() );
 
-	if( ! numFramesToRead ) {
-		mLastOverrun = getContext()->getNumProcessedFrames();
-		return;
-	}
+	while( true ) {
+		// start a new generation if there was a seek since the last time we were serviced
+		uint64_t seekGeneration = mSeekGeneration;
+		if( mIsReadAsync && seekGeneration != mIoGeneration ) {
+			mIoReadPos = mSeekPos;
+			mSourceFile->seek( mIoReadPos );
+			mIoGenerationStartFrame = mNumFramesWritten;
+			mIoGenerationStartPos = mIoReadPos;
+			mIoGeneration = seekGeneration;
+		}
 
-	// safety check that the SourceFile is on the correct read position, which could happen if two users are simultaneously reading from the same file.
-	if( readPos != mSourceFile->getReadPosition() )
-		mSourceFile->seek( readPos );
+		size_t availableWrite = mRingBuffers[0].getAvailableWrite();
+		for( size_t ch = 1; ch < numChannels; ch++ )
+			availableWrite = std::min( availableWrite, mRingBuffers[ch].getAvailableWrite() );
 
-	mIoBuffer.setNumFrames( numFramesToRead );
+		if( ! availableWrite )
+			break;
 
-	size_t numRead = mSourceFile->read( &mIoBuffer );
-	mReadPos += numRead;
+		size_t loopBegin = mLoopBegin;
+		size_t loopEnd = mLoopEnd;
+		bool isLooping = mLoop && loopBegin < loopEnd;
+		size_t readEnd = isLooping ? loopEnd : mNumFrames;
 
-	for( size_t ch = 0; ch < getNumChannels(); ch++ ) {
-		if( ! mRingBuffers[ch].write( mIoBuffer.getChannel( ch ), numRead ) ) {
-			mLastOverrun = getContext()->getNumProcessedFrames();
-			return;
+		if( mIoReadPos >= readEnd ) {
+			if( ! isLooping )
+				break;
+
+			mIoReadPos = loopBegin;
+		}
+
+		// safety check that the SourceFile is on the correct read position, which could happen if two users are simultaneously reading from the same file.
+		if( mIoReadPos != mSourceFile->getReadPosition() )
+			mSourceFile->seek( mIoReadPos );
+
+		mIoBuffer.setNumFrames( std::min( maxFramesPerRead, std::min( availableWrite, readEnd - mIoReadPos ) ) );
+
+		size_t numRead = mSourceFile->read( &mIoBuffer );
+		if( ! numRead )
+			break;
+
+		// write channel 0 last, process() uses it to determine how many samples are available on all channels.
+		for( size_t ch = numChannels; ch > 0; ch-- ) {
+			if( ! mRingBuffers[ch - 1].write( mIoBuffer.getChannel( ch - 1 ), numRead ) ) {
+				mLastOverrun = getContext()->getNumProcessedFrames();
+				return;
+			}
+		}
+
+		mIoReadPos += numRead;
+		mNumFramesWritten += numRead;
+
+		// don't keep reading stale samples when a seek arrives mid-service
+		if( mIsReadAsync && mSeekGeneration != mIoGeneration ) {
+			requestService();
+			break;
 		}
 	}
 }
 
+float FilePlayerNode::getStreamFill() const
+{
+	size_t size = mRingBuffers[0].getSize();
+	size_t availableWrite = size;
+	for( const auto &ringBuffer : mRingBuffers )
+		availableWrite = std::min( availableWrite, ringBuffer.getAvailableWrite() );
+
+	return 1.0f - (float)availableWrite / (float)size;
+}
+
 void FilePlayerNode::seekImpl( size_t readPos )
 {
 	if( ! mSourceFile )
@@ -451,29 +705,58 @@ void FilePlayerNode::seekImpl( size_t readPos )
 
 	mIsEof = false;
 	mReadPos = math<size_t>::clamp( readPos, 0, mNumFrames );
+	mIoReadPos = mReadPos;
+
+	for( auto &ringBuffer : mRingBuffers )
+		ringBuffer.clear();
 
-	// if async mode, readAsyncImpl() will notice mReadPos was updated and do the seek there.
-	if( ! mIsReadAsync )
-		mSourceFile->seek( mReadPos );
+	mSourceFile->seek( mIoReadPos );
 }
 
-void FilePlayerNode::stopImpl()
+size_t FilePlayerNode::getRingBufferSize() const
 {
-	disable();
+	size_t ringBufferSize = mReadAheadFrames ? mReadAheadFrames : mSourceFile->getMaxFramesPerRead() * 2;
+	return std::max( ringBufferSize, getMaxFramesReadPerBlock() * 2 );
+}
 
-	for( auto &ringBuffer : mRingBuffers )
-		ringBuffer.clear();
+void FilePlayerNode::startStreamImpl()
+{
+	size_t ringBufferSize = getRingBufferSize();
+
+	mIoBuffer.setSize( std::min( ringBufferSize, mSourceFile->getMaxFramesPerRead() ), getNumChannels() );
 
-	seekImpl( 0 );
+	mRingBuffers.clear();
+	for( size_t i = 0; i < getNumChannels(); i++ )
+		mRingBuffers.emplace_back( ringBufferSize );
+
+	mBufferFramesThreshold = ringBufferSize / 2;
+	mReadPos = std::min( mReadPos.load(), mNumFrames );
+	mNumFramesRead = mNumFramesWritten = 0;
+	mIsStreaming = true;
+
+	if( mIsReadAsync ) {
+		// begin a new seek generation so that the first service prefetches from the current read position.
+		mSeekPos = mReadPos.load();
+		mAudioGeneration = 0;
+		mIoGeneration = 0;
+		mSeekGeneration = 1;
+
+		FileStreamScheduler::get()->addClient( this );
+		requestService();
+	}
+	else
+		seekImpl( mReadPos );
 }
 
-void FilePlayerNode::destroyReadThreadImpl()
+void FilePlayerNode::stopStreamImpl()
 {
-	if( mIsReadAsync && mReadThread ) {
-		mAsyncReadShouldQuit = true;
-		mIssueAsyncReadCond.notify_one();
-		mReadThread->join();
-	}
+	if( ! mIsStreaming )
+		return;
+
+	if( mIsReadAsync )
+		FileStreamScheduler::get()->removeClient( this );
+
+	mIsStreaming = false;
 }
 
 } } // namespace cinder::audio
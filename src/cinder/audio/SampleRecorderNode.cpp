@@ -34,6 +34,7 @@ namespace cinder { namespace audio {
 namespace {
 
 const size_t DEFAULT_RECORD_BUFFER_FRAMES = 44100;
+const double DEFAULT_FILE_RING_BUFFER_SECONDS = 2;
 
 void resizeBufferAndShuffleChannels( BufferDynamic *buffer, size_t resultNumFrames )
 {
@@ -195,4 +196,174 @@ void BufferRecorderNode::process( Buffer *buffer )
 	mWritePos += numWriteFrames;
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - FileRecorderNode
+// ----------------------------------------------------------------------------------------------------
+
+FileRecorderNode::FileRecorderNode( const Format &format )
+	: SampleRecorderNode( format ), mRingBufferFrames( 0 ), mServiceThresholdFrames( 0 ), mIsWriting( false ),
+		mNumFramesWritten( 0 ), mLastOverrun( 0 ), mNumDroppedBlocks( 0 )
+{
+}
+
+FileRecorderNode::~FileRecorderNode()
+{
+	// the Node is no longer processing, so only the io thread needs to be stopped before the remaining samples are written.
+	if( mTargetFile ) {
+		mIsWriting = false;
+		FileStreamScheduler::get()->removeClient( this );
+		writeAvailable();
+	}
+}
+
+void FileRecorderNode::start( const fs::path &filePath, SampleType sampleType )
+{
+	if( ! isInitialized() )
+		getContext()->initializeNode( shared_from_this() );
+
+	start( TargetFile::create( filePath, getSampleRate(), getNumChannels(), sampleType ) );
+}
+
+void FileRecorderNode::start( const TargetFileRef &targetFile )
+{
+	if( ! targetFile )
+		throw AudioFileExc( "null TargetFile" );
+
+	stop();
+
+	if( ! isInitialized() )
+		getContext()->initializeNode( shared_from_this() );
+
+	const size_t numChannels = getNumChannels();
+	if( targetFile->getNumChannels() != numChannels )
+		throw AudioFormatExc( "TargetFile channel count (" + to_string( targetFile->getNumChannels() ) + ") does not match FileRecorderNode (" + to_string( numChannels ) + ")" );
+
+	const size_t framesPerBlock = getFramesPerBlock();
+	size_t ringBufferFrames = mRingBufferFrames ? mRingBufferFrames : size_t( DEFAULT_FILE_RING_BUFFER_SECONDS * (double)getSampleRate() );
+	ringBufferFrames = max( ringBufferFrames, framesPerBlock * 2 );
+
+	{
+		lock_guard<mutex> lock( getContext()->getMutex() );
+
+		if( mRingBuffers.size() != numChannels || mRingBuffers[0].getSize() != ringBufferFrames ) {
+			mRingBuffers.clear();
+			for( size_t ch = 0; ch < numChannels; ch++ )
+				mRingBuffers.emplace_back( ringBufferFrames );
+		}
+		else {
+			for( auto &ringBuffer : mRingBuffers )
+				ringBuffer.clear();
+		}
+
+		// wake the io thread once an eighth of the ring buffer is full, which is also the most it writes at once.
+		mServiceThresholdFrames = max( framesPerBlock, ringBufferFrames / 8 );
+		mIoBuffer.setSize( mServiceThresholdFrames, numChannels );
+
+		mTargetFile = targetFile;
+		mWritePos = 0;
+		mNumFramesWritten = 0;
+		mNumDroppedBlocks = 0;
+		mLastOverrun = 0;
+		mIsWriting = true;
+	}
+
+	FileStreamScheduler::get()->addClient( this );
+	enable();
+}
+
+void FileRecorderNode::stop()
+{
+	if( ! mTargetFile )
+		return;
+
+	disable();
+
+	{
+		// once the lock is acquired the audio thread is not in process(), and afterwards it won't push any more samples.
+		lock_guard<mutex> lock( getContext()->getMutex() );
+		mIsWriting = false;
+	}
+
+	// after removing the client, this thread is the only reader so it can write out what remains.
+	FileStreamScheduler::get()->removeClient( this );
+	writeAvailable();
+
+	mTargetFile.reset();
+}
+
+uint64_t FileRecorderNode::getLastOverrun()
+{
+	uint64_t result = mLastOverrun;
+	mLastOverrun = 0;
+	return result;
+}
+
+void FileRecorderNode::process( Buffer *buffer )
+{
+	if( ! mIsWriting )
+		return;
+
+	const size_t numFrames = buffer->getNumFrames();
+	const size_t numChannels = mRingBuffers.size();
+
+	// channel 0 is read last by the io thread, so the other channels have at least as much space available.
+	if( buffer->getNumChannels() != numChannels || mRingBuffers[0].getAvailableWrite() < numFrames ) {
+		mNumDroppedBlocks++;
+		mLastOverrun = getContext()->getNumProcessedFrames();
+		requestService();
+		return;
+	}
+
+	// channel 0 is written last, so when the io thread sees samples on it they are available on all channels.
+	for( size_t ch = 1; ch < numChannels; ch++ )
+		mRingBuffers[ch].write( buffer->getChannel( ch ), numFrames );
+
+	mRingBuffers[0].write( buffer->getChannel( 0 ), numFrames );
+	mWritePos += numFrames;
+
+	if( mRingBuffers[0].getSize() - mRingBuffers[0].getAvailableWrite() >= mServiceThresholdFrames )
+		requestService();
+}
+
+void FileRecorderNode::serviceStream()
+{
+	writeAvailable();
+}
+
+// The scheduler services the lowest fill first, so for a writer this is the space left in the ring buffers.
+float FileRecorderNode::getStreamFill() const
+{
+	if( mRingBuffers.empty() )
+		return 1;
+
+	return (float)mRingBuffers[0].getAvailableWrite() / (float)mRingBuffers[0].getSize();
+}
+
+void FileRecorderNode::writeAvailable()
+{
+	const size_t numChannels = mRingBuffers.size();
+
+	while( mTargetFile ) {
+		const size_t numFrames = min( mRingBuffers[0].getAvailableRead(), mIoBuffer.getNumFrames() );
+		if( ! numFrames )
+			break;
+
+		for( size_t ch = 1; ch < numChannels; ch++ )
+			mRingBuffers[ch].read( mIoBuffer.getChannel( ch ), numFrames );
+
+		mRingBuffers[0].read( mIoBuffer.getChannel( 0 ), numFrames );
+
+		try {
+			mTargetFile->write( &mIoBuffer, numFrames );
+		}
+		catch( std::exception &exc ) {
+			CI_LOG_E( "writing to file failed, recording stopped: " << exc.what() );
+			mIsWriting = false;
+			break;
+		}
+
+		mNumFramesWritten += numFrames;
+	}
+}
+
 } } // namespace cinder::audio
@@ -24,10 +24,15 @@
 #include "cinder/audio/Source.h"
 #include "cinder/audio/dsp/Converter.h"
 #include "cinder/audio/FileOggVorbis.h"
+#include "cinder/audio/FilePcm.h"
+#include "cinder/audio/FileFlac.h"
+#include "cinder/audio/Exception.h"
 #include "cinder/audio/Debug.h"
 
 #include "cinder/Utilities.h"
 
+#include <cstring>
+
 #if defined( CINDER_COCOA )
 	#include "cinder/audio/cocoa/FileCoreAudio.h"
 #elif defined( CINDER_MSW )
@@ -40,14 +45,65 @@ namespace cinder { namespace audio {
 
 // TODO: these should be replaced with a generic registrar derived from the ImageIo stuff.
 
+namespace {
+
+bool contains( const vector<string> &extensions, const string &ext )
+{
+	return find( extensions.begin(), extensions.end(), ext ) != extensions.end();
+}
+
+// Used when the DataSource has no extension to go by, returns the extension of the file type recognized from the first bytes of its data.
+string sniffExtension( const DataSourceRef &dataSource )
+{
+	char header[4] = { 0 };
+	auto stream = dataSource->createStream();
+	if( stream->size() < sizeof( header ) )
+		return string();
+
+	stream->readData( header, sizeof( header ) );
+	if( memcmp( header, "RIFF", 4 ) == 0 || memcmp( header, "RF64", 4 ) == 0 )
+		return "wav";
+	else if( memcmp( header, "FORM", 4 ) == 0 )
+		return "aif";
+	else if( memcmp( header, "fLaC", 4 ) == 0 )
+		return "flac";
+	else if( memcmp( header, "OggS", 4 ) == 0 )
+		return "ogg";
+
+	return string();
+}
+
+} // anonymous namespace
+
 // static
 unique_ptr<SourceFile> SourceFile::create( const DataSourceRef &dataSource, size_t sampleRate )
 {
 	unique_ptr<SourceFile> result;
 
-	if( getPathExtension( dataSource->getFilePathHint().extension().string() ) == "ogg" )
+	string ext = getPathExtension( dataSource->getFilePathHint().extension().string() );
+	transform( ext.begin(), ext.end(), ext.begin(), ::tolower );
+	if( ext.empty() )
+		ext = sniffExtension( dataSource );
+
+	if( ext == "ogg" )
 		result.reset( new SourceFileOggVorbis( dataSource, sampleRate ) );
-	else {
+	else if( contains( SourceFileFlac::getSupportedExtensions(), ext ) )
+		result.reset( new SourceFileFlac( dataSource, sampleRate ) );
+	else if( contains( SourceFilePcm::getSupportedExtensions(), ext ) ) {
+		try {
+			result.reset( new SourceFilePcm( dataSource, sampleRate ) );
+		}
+		catch( AudioFormatExc & ) {
+#if defined( CINDER_COCOA ) || defined( CINDER_MSW )
+			// the platform decoder may still handle compressed encodings, like ADPCM or a-law
+			CI_LOG_V( "unsupported encoding, falling back to the platform decoder" );
+#else
+			throw;
+#endif
+		}
+	}
+
+	if( ! result ) {
 #if defined( CINDER_COCOA )
 		result.reset( new cocoa::SourceFileCoreAudio( dataSource, sampleRate ) );
 #elif defined( CINDER_MSW )
@@ -72,8 +128,13 @@ vector<std::string> SourceFile::getSupportedExtensions()
 	vector<string> result;
 #endif
 
-	if( find( result.begin(), result.end(), "ogg" ) == result.end() )
-		result.push_back( "ogg" );
+	vector<string> nativeExtensions = SourceFilePcm::getSupportedExtensions();
+	nativeExtensions.push_back( "ogg" );
+	nativeExtensions.push_back( "flac" );
+	for( const auto &ext : nativeExtensions ) {
+		if( ! contains( result, ext ) )
+			result.push_back( ext );
+	}
 
 	return result;
 }
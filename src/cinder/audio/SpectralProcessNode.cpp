@@ -0,0 +1,399 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/SpectralProcessNode.h"
+#include "cinder/audio/dsp/Fft.h"
+
+#if defined( CINDER_AUDIO_SSE )
+	#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+// keeps divisions by a silent bin finite
+const float MAGNITUDE_SQUARED_EPSILON = 1e-20f;
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SpectralProcessNode
+// ----------------------------------------------------------------------------------------------------
+
+SpectralProcessNode::SpectralProcessNode( const Format &format )
+	: Node( format ), mFftSize( format.getFftSize() ), mHopSize( format.getHopSize() ), mWindowType( format.getWindowType() ),
+		mMagnitudeScale( 0 ), mFifoPos( 0 )
+{
+}
+
+SpectralProcessNode::SpectralProcessNode( const SpectralProcessFn &processFn, const Format &format )
+	: Node( format ), mProcessFn( processFn ), mFftSize( format.getFftSize() ), mHopSize( format.getHopSize() ), mWindowType( format.getWindowType() ),
+		mMagnitudeScale( 0 ), mFifoPos( 0 )
+{
+}
+
+SpectralProcessNode::~SpectralProcessNode()
+{
+}
+
+void SpectralProcessNode::initialize()
+{
+	// the default Fft backend supports any even size
+	if( mFftSize < 2 )
+		mFftSize = 2;
+	else if( mFftSize % 2 )
+		mFftSize++;
+
+	if( ! mHopSize || mHopSize > mFftSize )
+		mHopSize = max<size_t>( 1, mFftSize / 4 );
+
+	const size_t numChannels = getNumChannels();
+
+	mFft.reset( new dsp::Fft( mFftSize ) );
+	mWindow = makeAlignedArray<float>( mFftSize );
+	dsp::generateWindow( mWindowType, mWindow.get(), mFftSize );
+
+	const float windowSum = dsp::sum( mWindow.get(), mFftSize );
+	mMagnitudeScale = windowSum > 0 ? 2.0f / windowSum : 0;
+
+	// each output frame is the sum of every overlapping frame, windowed twice
+	mNormalization = makeAlignedArray<float>( mHopSize );
+	for( size_t i = 0; i < mHopSize; i++ ) {
+		float windowSquaredSum = 0;
+		for( size_t j = i; j < mFftSize; j += mHopSize )
+			windowSquaredSum += mWindow.get()[j] * mWindow.get()[j];
+
+		mNormalization.get()[i] = windowSquaredSum > 1e-6f ? 1.0f / windowSquaredSum : 0;
+	}
+
+	mInputFifo = Buffer( mFftSize, numChannels );
+	mOutputFifo = Buffer( mHopSize, numChannels );
+	mOutputAccum = Buffer( mFftSize, numChannels );
+	mFrameBuffer = Buffer( mFftSize, numChannels );
+	mSpectra.assign( numChannels, BufferSpectral( mFftSize ) );
+
+	mInputFifo.zero();
+	mOutputFifo.zero();
+	mOutputAccum.zero();
+	mFifoPos = mFftSize - mHopSize;
+}
+
+float SpectralProcessNode::getFreqForBin( size_t bin ) const
+{
+	return float( bin * getSampleRate() ) / (float)mFftSize;
+}
+
+void SpectralProcessNode::process( Buffer *buffer )
+{
+	const size_t numFrames = buffer->getNumFrames();
+	const size_t numChannels = buffer->getNumChannels();
+	const size_t fifoStart = mFftSize - mHopSize;
+
+	size_t framesProcessed = 0;
+	while( framesProcessed < numFrames ) {
+		// input is collected into the last hop of mInputFifo, while the hop that was finished by the previous frame is read out at the same rate
+		const size_t framesThisFrame = min( numFrames - framesProcessed, mFftSize - mFifoPos );
+		for( size_t ch = 0; ch < numChannels; ch++ ) {
+			float *channel = buffer->getChannel( ch ) + framesProcessed;
+			memcpy( mInputFifo.getChannel( ch ) + mFifoPos, channel, framesThisFrame * sizeof( float ) );
+			memcpy( channel, mOutputFifo.getChannel( ch ) + mFifoPos - fifoStart, framesThisFrame * sizeof( float ) );
+		}
+
+		framesProcessed += framesThisFrame;
+		mFifoPos += framesThisFrame;
+
+		if( mFifoPos == mFftSize ) {
+			processFrame();
+			mFifoPos = fifoStart;
+		}
+	}
+}
+
+void SpectralProcessNode::processFrame()
+{
+	const size_t numChannels = mSpectra.size();
+	const size_t overlap = mFftSize - mHopSize;
+	const float *window = mWindow.get();
+
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		dsp::mul( mInputFifo.getChannel( ch ), window, mFrameBuffer.getChannel( ch ), mFftSize );
+
+	mFft->forward( &mFrameBuffer, &mSpectra );
+	processSpectral( &mSpectra );
+	mFft->inverse( mSpectra, &mFrameBuffer );
+
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		float *frame = mFrameBuffer.getChannel( ch );
+		float *accum = mOutputAccum.getChannel( ch );
+		float *input = mInputFifo.getChannel( ch );
+
+		dsp::mul( frame, window, frame, mFftSize );
+		dsp::add( accum, frame, accum, mFftSize );
+
+		// the first hop is now complete, shift everything else down by one hop
+		dsp::mul( accum, mNormalization.get(), mOutputFifo.getChannel( ch ), mHopSize );
+		memmove( accum, accum + mHopSize, overlap * sizeof( float ) );
+		memset( accum + overlap, 0, mHopSize * sizeof( float ) );
+		memmove( input, input + mHopSize, overlap * sizeof( float ) );
+	}
+}
+
+void SpectralProcessNode::processSpectral( vector<BufferSpectral> *spectra )
+{
+	if( mProcessFn )
+		mProcessFn( spectra, getSampleRate() );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SpectralGateNode
+// ----------------------------------------------------------------------------------------------------
+
+SpectralGateNode::SpectralGateNode( const Format &format )
+	: SpectralProcessNode( format ), mThreshold( 0.01f ), mAttenuation( 0 )
+{
+}
+
+void SpectralGateNode::processSpectral( vector<BufferSpectral> *spectra )
+{
+	const float magnitudeScale = getMagnitudeScale();
+	if( magnitudeScale <= 0 )
+		return;
+
+	const float threshold = mThreshold / magnitudeScale;
+	const float thresholdSquared = threshold * threshold;
+	const float attenuation = mAttenuation;
+	const size_t numBins = getNumBins();
+
+	for( auto &spectrum : *spectra ) {
+		float *real = spectrum.getReal();
+		float *imag = spectrum.getImag();
+
+		// the DC and nyquist components packed into bin zero are gated separately, after the loop below has treated them as one bin
+		const float dc = real[0];
+		const float nyquist = imag[0];
+
+		size_t k = 0;
+#if defined( CINDER_AUDIO_SSE )
+		const __m128 thresholdSquared4 = _mm_set1_ps( thresholdSquared );
+		const __m128 attenuation4 = _mm_set1_ps( attenuation );
+		const __m128 passGain4 = _mm_set1_ps( 1 - attenuation );
+		for( ; k + 4 <= numBins; k += 4 ) {
+			const __m128 re = _mm_loadu_ps( real + k );
+			const __m128 im = _mm_loadu_ps( imag + k );
+			const __m128 magSquared = _mm_add_ps( _mm_mul_ps( re, re ), _mm_mul_ps( im, im ) );
+			const __m128 gain = _mm_add_ps( attenuation4, _mm_and_ps( _mm_cmpge_ps( magSquared, thresholdSquared4 ), passGain4 ) );
+			_mm_storeu_ps( real + k, _mm_mul_ps( re, gain ) );
+			_mm_storeu_ps( imag + k, _mm_mul_ps( im, gain ) );
+		}
+#endif
+		for( ; k < numBins; k++ ) {
+			const float magSquared = real[k] * real[k] + imag[k] * imag[k];
+			const float gain = magSquared >= thresholdSquared ? 1.0f : attenuation;
+			real[k] *= gain;
+			imag[k] *= gain;
+		}
+
+		real[0] = dc * dc >= thresholdSquared ? dc : dc * attenuation;
+		imag[0] = nyquist * nyquist >= thresholdSquared ? nyquist : nyquist * attenuation;
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SpectralFreezeNode
+// ----------------------------------------------------------------------------------------------------
+
+SpectralFreezeNode::SpectralFreezeNode( const Format &format )
+	: SpectralProcessNode( format ), mFrozen( false ), mIsCaptured( false )
+{
+}
+
+void SpectralFreezeNode::initialize()
+{
+	SpectralProcessNode::initialize();
+
+	const size_t numChannels = getNumChannels();
+	const size_t fftSize = getFftSize();
+
+	mPrevSpectra.assign( numChannels, BufferSpectral( fftSize ) );
+	mPhasors.assign( numChannels, BufferSpectral( fftSize ) );
+	mRotations.assign( numChannels, BufferSpectral( fftSize ) );
+	mMagnitudes.assign( numChannels, Buffer( getNumBins() ) );
+
+	for( auto &spectrum : mPrevSpectra )
+		spectrum.zero();
+
+	mIsCaptured = false;
+}
+
+void SpectralFreezeNode::processSpectral( vector<BufferSpectral> *spectra )
+{
+	if( ! mFrozen ) {
+		mIsCaptured = false;
+		for( size_t ch = 0; ch < spectra->size(); ch++ )
+			mPrevSpectra[ch].copy( (*spectra)[ch] );
+
+		return;
+	}
+
+	// the frame that is current when freezing passes through unchanged and is the starting point for the following frames
+	if( ! mIsCaptured ) {
+		capture( *spectra );
+		mIsCaptured = true;
+		return;
+	}
+
+	const size_t numBins = getNumBins();
+	for( size_t ch = 0; ch < spectra->size(); ch++ ) {
+		float *real = (*spectra)[ch].getReal();
+		float *imag = (*spectra)[ch].getImag();
+		float *phasorReal = mPhasors[ch].getReal();
+		float *phasorImag = mPhasors[ch].getImag();
+		const float *rotationReal = mRotations[ch].getReal();
+		const float *rotationImag = mRotations[ch].getImag();
+		const float *magnitudes = mMagnitudes[ch].getData();
+
+		for( size_t k = 1; k < numBins; k++ ) {
+			float re = phasorReal[k] * rotationReal[k] - phasorImag[k] * rotationImag[k];
+			float im = phasorReal[k] * rotationImag[k] + phasorImag[k] * rotationReal[k];
+
+			// one newton step towards unit length, which keeps rounding error from accumulating over many frames
+			const float correction = 1.5f - 0.5f * ( re * re + im * im );
+			re *= correction;
+			im *= correction;
+
+			phasorReal[k] = re;
+			phasorImag[k] = im;
+			real[k] = re * magnitudes[k];
+			imag[k] = im * magnitudes[k];
+		}
+
+		real[0] = phasorReal[0];
+		imag[0] = phasorImag[0];
+	}
+}
+
+void SpectralFreezeNode::capture( const vector<BufferSpectral> &spectra )
+{
+	const size_t numBins = getNumBins();
+	for( size_t ch = 0; ch < spectra.size(); ch++ ) {
+		const float *real = spectra[ch].getReal();
+		const float *imag = spectra[ch].getImag();
+		const float *prevReal = mPrevSpectra[ch].getReal();
+		const float *prevImag = mPrevSpectra[ch].getImag();
+		float *phasorReal = mPhasors[ch].getReal();
+		float *phasorImag = mPhasors[ch].getImag();
+		float *rotationReal = mRotations[ch].getReal();
+		float *rotationImag = mRotations[ch].getImag();
+		float *magnitudes = mMagnitudes[ch].getData();
+
+		for( size_t k = 1; k < numBins; k++ ) {
+			const float magSquared = real[k] * real[k] + imag[k] * imag[k];
+			const float invMag = 1.0f / sqrt( magSquared + MAGNITUDE_SQUARED_EPSILON );
+			magnitudes[k] = magSquared * invMag;
+			phasorReal[k] = real[k] * invMag;
+			phasorImag[k] = imag[k] * invMag;
+
+			// current * conj( previous ) has the phase advance over the last hop
+			const float re = real[k] * prevReal[k] + imag[k] * prevImag[k];
+			const float im = imag[k] * prevReal[k] - real[k] * prevImag[k];
+			const float rotationMagSquared = re * re + im * im;
+			if( rotationMagSquared > MAGNITUDE_SQUARED_EPSILON ) {
+				const float invRotationMag = 1.0f / sqrt( rotationMagSquared );
+				rotationReal[k] = re * invRotationMag;
+				rotationImag[k] = im * invRotationMag;
+			}
+			else {
+				rotationReal[k] = 1;
+				rotationImag[k] = 0;
+			}
+		}
+
+		phasorReal[0] = real[0];
+		phasorImag[0] = imag[0];
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - SpectralCrossSynthesisNode
+// ----------------------------------------------------------------------------------------------------
+
+SpectralCrossSynthesisNode::SpectralCrossSynthesisNode( const Format &format )
+	: SpectralProcessNode( format ), mAmount( 1 )
+{
+	setChannelMode( ChannelMode::SPECIFIED );
+	setNumChannels( 2 );
+}
+
+void SpectralCrossSynthesisNode::processSpectral( vector<BufferSpectral> *spectra )
+{
+	if( spectra->size() < 2 )
+		return;
+
+	float *real = (*spectra)[0].getReal();
+	float *imag = (*spectra)[0].getImag();
+	const float *modReal = (*spectra)[1].getReal();
+	const float *modImag = (*spectra)[1].getImag();
+	const float amount = mAmount;
+	const size_t numBins = getNumBins();
+
+	// each carrier bin is scaled by 1 + amount * ( |modulator| / |carrier| - 1 ), bin zero's DC and nyquist components separately after the loop
+	const float dc = real[0];
+	const float nyquist = imag[0];
+
+	size_t k = 0;
+#if defined( CINDER_AUDIO_SSE )
+	const __m128 amount4 = _mm_set1_ps( amount );
+	const __m128 one4 = _mm_set1_ps( 1 );
+	const __m128 epsilon4 = _mm_set1_ps( MAGNITUDE_SQUARED_EPSILON );
+	for( ; k + 4 <= numBins; k += 4 ) {
+		const __m128 re = _mm_loadu_ps( real + k );
+		const __m128 im = _mm_loadu_ps( imag + k );
+		const __m128 modRe = _mm_loadu_ps( modReal + k );
+		const __m128 modIm = _mm_loadu_ps( modImag + k );
+		const __m128 magSquared = _mm_add_ps( _mm_add_ps( _mm_mul_ps( re, re ), _mm_mul_ps( im, im ) ), epsilon4 );
+		const __m128 modMagSquared = _mm_add_ps( _mm_mul_ps( modRe, modRe ), _mm_mul_ps( modIm, modIm ) );
+		const __m128 ratio = _mm_sqrt_ps( _mm_div_ps( modMagSquared, magSquared ) );
+		const __m128 gain = _mm_add_ps( one4, _mm_mul_ps( amount4, _mm_sub_ps( ratio, one4 ) ) );
+		_mm_storeu_ps( real + k, _mm_mul_ps( re, gain ) );
+		_mm_storeu_ps( imag + k, _mm_mul_ps( im, gain ) );
+	}
+#endif
+	for( ; k < numBins; k++ ) {
+		const float magSquared = real[k] * real[k] + imag[k] * imag[k] + MAGNITUDE_SQUARED_EPSILON;
+		const float modMagSquared = modReal[k] * modReal[k] + modImag[k] * modImag[k];
+		const float gain = 1 + amount * ( sqrt( modMagSquared / magSquared ) - 1 );
+		real[k] *= gain;
+		imag[k] *= gain;
+	}
+
+	real[0] = dc * ( 1 + amount * ( abs( modReal[0] ) / sqrt( dc * dc + MAGNITUDE_SQUARED_EPSILON ) - 1 ) );
+	imag[0] = nyquist * ( 1 + amount * ( abs( modImag[0] ) / sqrt( nyquist * nyquist + MAGNITUDE_SQUARED_EPSILON ) - 1 ) );
+
+	for( size_t ch = 1; ch < spectra->size(); ch++ )
+		(*spectra)[ch].copy( (*spectra)[0] );
+}
+
+} } // namespace cinder::audio
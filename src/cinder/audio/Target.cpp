@@ -22,6 +22,8 @@
  */
 
 #include "cinder/audio/Target.h"
+#include "cinder/audio/FilePcm.h"
+#include "cinder/audio/Exception.h"
 #include "cinder/CinderAssert.h"
 
 #include "cinder/Utilities.h"
@@ -41,11 +43,18 @@ namespace cinder { namespace audio {
 std::unique_ptr<TargetFile> TargetFile::create( const DataTargetRef &dataTarget, size_t sampleRate, size_t numChannels, SampleType sampleType, const std::string &extension )
 {
 	std::string ext = ( ! extension.empty() ? extension : getPathExtension( dataTarget->getFilePathHint().extension().string() ) );
+	transform( ext.begin(), ext.end(), ext.begin(), ::tolower );
+
+	auto pcmExtensions = TargetFilePcm::getSupportedExtensions();
+	if( find( pcmExtensions.begin(), pcmExtensions.end(), ext ) != pcmExtensions.end() )
+		return std::unique_ptr<TargetFile>( new TargetFilePcm( dataTarget, sampleRate, numChannels, sampleType, ext ) );
 
 #if defined( CINDER_COCOA )
 	return std::unique_ptr<TargetFile>( new cocoa::TargetFileCoreAudio( dataTarget, sampleRate, numChannels, sampleType, ext ) );
 #elif defined( CINDER_MSW )
 	return std::unique_ptr<TargetFile>( new msw::TargetFileMediaFoundation( dataTarget, sampleRate, numChannels, sampleType, ext ) );
+#else
+	throw AudioFileExc( "unsupported file extension: " + ext );
 #endif
 }
 
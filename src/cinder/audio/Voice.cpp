@@ -23,8 +23,8 @@
 
 #include "cinder/audio/Voice.h"
 #include "cinder/audio/Context.h"
-#include "cinder/audio/GainNode.h"
-#include "cinder/audio/PanNode.h"
+#include "cinder/audio/MixerNode.h"
+#include "cinder/audio/SampleCache.h"
 #include "cinder/audio/Debug.h"
 
 #include <map>
@@ -38,9 +38,15 @@ namespace cinder { namespace audio {
 // MARK: - MixerImpl
 // ----------------------------------------------------------------------------------------------------
 
-// A private mixer implementation, which adds gain and panning to each voice with Node composition.
-// This will hopefully be replaced with a yet-to-be-determined MixerNode class, which has a custom pullInputs
-// and performs the gain / pan as a post-processing step
+// A private mixer implementation, which applies gain and panning to each voice with a MixerNode rather than a GainNode and Pan2dNode
+// per voice. Voices that are connected to master share one MixerNode whose voice pool is allocated up front, so creating a Voice
+// doesn't add any Node's to the graph other than its input. Voices that manage their own output get a single voice MixerNode.
+
+namespace {
+
+const size_t MASTER_MIXER_MAX_VOICES = 1024;
+
+} // anonymous namespace
 
 class MixerImpl {
 public:
@@ -57,21 +63,19 @@ public:
 	void	addVoice( const VoiceRef &source, const Voice::Options &options );
 	void	removeVoice( size_t busId );
 
-	BufferRef loadBuffer( const SourceFileRef &sourceFile );
-
 private:
 	MixerImpl();
 
 	struct Bus {
 		weak_ptr<Voice>		mVoice; // stored as weak reference so that when the user's VoiceRef goes out of scope, it will be removed.
-		GainNodeRef			mGain;
-		Pan2dNodeRef		mPan;
+		NodeRef				mInput; // stored because it can no longer be retrieved from the Voice while it is being destroyed.
+		MixerNodeRef		mMixer; // either the shared master mixer, or one owned by this bus if the Voice isn't connected to master.
 	};
 
 	size_t getFirstAvailableBusId() const;
 
 	map<size_t, Bus> mBusses;							// key is bus id
-	map<SourceFileRef, BufferRef> mBufferCache;		// key is the source file
+	MixerNodeRef mMasterMixer;
 };
 
 MixerImpl* MixerImpl::get()
@@ -85,7 +89,12 @@ MixerImpl* MixerImpl::get()
 
 MixerImpl::MixerImpl()
 {
-	Context::master()->enable();
+	Context *ctx = Context::master();
+
+	mMasterMixer = ctx->makeNode( new MixerNode( MixerNode::Format().maxNumVoices( MASTER_MIXER_MAX_VOICES ) ) );
+	mMasterMixer >> ctx->getOutput();
+
+	ctx->enable();
 }
 
 void MixerImpl::addVoice( const VoiceRef &source, const Voice::Options &options )
@@ -97,13 +106,14 @@ void MixerImpl::addVoice( const VoiceRef &source, const Voice::Options &options
 	MixerImpl::Bus &bus = mBusses[source->mBusId];
 
 	bus.mVoice = source;
-	bus.mGain = ctx->makeNode( new GainNode( Node::Format().channels( options.getChannels() ) ) );
-	bus.mPan = ctx->makeNode( new Pan2dNode() );
-
-	source->getInputNode() >> bus.mGain >> bus.mPan;
+	bus.mInput = source->getInputNode();
 
 	if( options.getConnectToMaster() )
-		bus.mPan >> ctx->getOutput();
+		bus.mMixer = mMasterMixer;
+	else
+		bus.mMixer = ctx->makeNode( new MixerNode( MixerNode::Format().maxNumVoices( 1 ) ) );
+
+	bus.mInput >> bus.mMixer;
 }
 
 void MixerImpl::removeVoice( size_t busId )
@@ -111,20 +121,12 @@ void MixerImpl::removeVoice( size_t busId )
 	auto it = mBusses.find( busId );
 	CI_ASSERT( it != mBusses.end() );
 
-	it->second.mPan->disconnectAllOutputs();
-	mBusses.erase( it );
-}
+	Bus &bus = it->second;
+	bus.mInput->disconnect( bus.mMixer );
+	if( bus.mMixer != mMasterMixer )
+		bus.mMixer->disconnectAllOutputs();
 
-BufferRef MixerImpl::loadBuffer( const SourceFileRef &sourceFile )
-{
-	auto cached = mBufferCache.find( sourceFile );
-	if( cached != mBufferCache.end() )
-		return cached->second;
-	else {
-		BufferRef result = sourceFile->loadBuffer();
-		mBufferCache.insert( make_pair( sourceFile, result ) );
-		return result;
-	}
+	mBusses.erase( it );
 }
 
 size_t MixerImpl::getFirstAvailableBusId() const
@@ -142,38 +144,33 @@ size_t MixerImpl::getFirstAvailableBusId() const
 
 void MixerImpl::setBusVolume( size_t busId, float volume )
 {
-	mBusses[busId].mGain->setValue( volume );
+	const auto &bus = mBusses.at( busId );
+	bus.mMixer->setVoiceGain( bus.mInput, volume );
 }
 
 float MixerImpl::getBusVolume( size_t busId )
 {
-	return mBusses[busId].mGain->getValue();
+	const auto &bus = mBusses.at( busId );
+	return bus.mMixer->getVoiceGain( bus.mInput );
 }
 
 void MixerImpl::setBusPan( size_t busId, float pos )
 {
-	auto pan = mBusses[busId].mPan;
-	if( pan )
-		pan->setPos( pos );
+	const auto &bus = mBusses.at( busId );
+	bus.mMixer->setVoicePan( bus.mInput, pos );
 }
 
 float MixerImpl::getBusPan( size_t busId )
 {
-	auto pan = mBusses[busId].mPan;
-	if( pan )
-		return mBusses[busId].mPan->getPos();
-
-	return 0;
+	const auto &bus = mBusses.at( busId );
+	return bus.mMixer->getVoicePan( bus.mInput );
 }
 
 NodeRef MixerImpl::getOutputNode( size_t busId ) const
 {
+	// the shared master mixer is never returned, so that routing one Voice's output can't affect the others
 	const auto &bus = mBusses.at( busId );
-
-	if( bus.mPan )
-		return bus.mPan;
-	else
-		return bus.mGain;
+	return bus.mMixer == mMasterMixer ? bus.mInput : bus.mMixer;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -257,7 +254,7 @@ VoiceSamplePlayerNode::VoiceSamplePlayerNode( const SourceFileRef &sourceFile, c
 	SourceFileRef sf = requiredSampleRate == sourceFile->getSampleRate() ? sourceFile : sourceFile->cloneWithSampleRate( requiredSampleRate );
 
 	if( sf->getNumFrames() <= options.getMaxFramesForBufferPlayback() ) {
-		BufferRef buffer = MixerImpl::get()->loadBuffer( sf );
+		BufferRef buffer = SampleCache::get()->loadBuffer( sourceFile, requiredSampleRate );
 		mNode = Context::master()->makeNode( new BufferPlayerNode( buffer ) );
 	} else
 		mNode = Context::master()->makeNode( new FilePlayerNode( sf ) );
@@ -70,7 +70,7 @@ inline float tableLookup( const float *table, size_t tableSize, float phase )
 	float val2 = table[index2];
 	float frac = lookup - (float)index1;
 
-	return val2 + frac * ( val2 - val1 );
+	return val1 + frac * ( val2 - val1 );
 }
 
 #endif
@@ -0,0 +1,285 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/dsp/BiquadBank.h"
+#include "cinder/audio/dsp/Biquad.h"
+#include "cinder/audio/dsp/Dsp.h"
+#include "cinder/CinderAssert.h"
+
+#if defined( CINDER_AUDIO_SSE )
+	#include <xmmintrin.h>
+#endif
+
+#include <cmath>
+
+using namespace std;
+
+namespace cinder { namespace audio { namespace dsp {
+
+namespace {
+
+// number of channels that are processed together, which is the number of float lanes in an SSE register
+const size_t kLaneWidth = 4;
+// filter memory below this magnitude is flushed to zero at the end of each block, to avoid denormal slow-downs on decaying tails.
+const float kDenormalThreshold = 1e-15f;
+
+#if defined( CINDER_AUDIO_SSE )
+
+// Coefficients for one section across four lanes. Passed by reference because MSVC x86 cannot pass more than three __m128 by value.
+struct SectionSse {
+	__m128 b0, b1, b2, a1, a2;
+};
+
+// One transposed direct form II step for four lanes.
+inline __m128 tickSse( __m128 x, const SectionSse &c, __m128 &s1, __m128 &s2 )
+{
+	__m128 y = _mm_add_ps( _mm_mul_ps( c.b0, x ), s1 );
+	s1 = _mm_add_ps( _mm_sub_ps( _mm_mul_ps( c.b1, x ), _mm_mul_ps( c.a1, y ) ), s2 );
+	s2 = _mm_sub_ps( _mm_mul_ps( c.b2, x ), _mm_mul_ps( c.a2, y ) );
+	return y;
+}
+
+#endif // defined( CINDER_AUDIO_SSE )
+
+} // anonymous namespace
+
+BiquadBank::BiquadBank( size_t numChannels, size_t numStages )
+{
+	setSize( numChannels, numStages );
+}
+
+void BiquadBank::setSize( size_t numChannels, size_t numStages )
+{
+	mNumChannels = numChannels;
+	mNumStages = numStages;
+	mNumLanes = ( ( numChannels + kLaneWidth - 1 ) / kLaneWidth ) * kLaneWidth;
+
+	// Initialize as pass-thru (straight-wire, no filter effect)
+	size_t size = mNumLanes * mNumStages;
+	mB0.assign( size, 1 );
+	mB1.assign( size, 0 );
+	mB2.assign( size, 0 );
+	mA1.assign( size, 0 );
+	mA2.assign( size, 0 );
+	mS1.assign( size, 0 );
+	mS2.assign( size, 0 );
+	mStateStash.resize( mNumStages * kLaneWidth * 2 );
+}
+
+void BiquadBank::setCoefficients( size_t channel, size_t stage, double b0, double b1, double b2, double a1, double a2 )
+{
+	CI_ASSERT_MSG( channel < mNumChannels, "channel out of range" );
+	CI_ASSERT_MSG( stage < mNumStages, "stage out of range" );
+
+	size_t index = stage * mNumLanes + channel;
+	mB0[index] = (float)b0;
+	mB1[index] = (float)b1;
+	mB2[index] = (float)b2;
+	mA1[index] = (float)a1;
+	mA2[index] = (float)a2;
+}
+
+void BiquadBank::setCoefficients( size_t channel, size_t stage, const Biquad &biquad )
+{
+	double b0, b1, b2, a1, a2;
+	biquad.getCoefficients( &b0, &b1, &b2, &a1, &a2 );
+	setCoefficients( channel, stage, b0, b1, b2, a1, a2 );
+}
+
+void BiquadBank::setCoefficients( size_t stage, const Biquad &biquad )
+{
+	double b0, b1, b2, a1, a2;
+	biquad.getCoefficients( &b0, &b1, &b2, &a1, &a2 );
+	for( size_t ch = 0; ch < mNumChannels; ch++ )
+		setCoefficients( ch, stage, b0, b1, b2, a1, a2 );
+}
+
+void BiquadBank::reset()
+{
+	fill( 0, mS1.data(), mS1.size() );
+	fill( 0, mS2.data(), mS2.size() );
+}
+
+void BiquadBank::process( Buffer *buffer, size_t numFrames )
+{
+	CI_ASSERT( numFrames <= buffer->getNumFrames() );
+
+	const size_t numChannels = std::min( mNumChannels, buffer->getNumChannels() );
+
+#if defined( CINDER_AUDIO_SSE )
+	for( size_t ch = 0; ch < numChannels; ch += kLaneWidth ) {
+		size_t numLanes = std::min( kLaneWidth, numChannels - ch );
+
+		// unused lanes in the last group read the last valid channel, their output is discarded.
+		float *channels[kLaneWidth];
+		for( size_t lane = 0; lane < kLaneWidth; lane++ )
+			channels[lane] = buffer->getChannel( ch + std::min( lane, numLanes - 1 ) );
+
+		processGroup( channels, numLanes, numFrames, ch );
+	}
+#else
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		processLane( buffer->getChannel( ch ), numFrames, ch );
+#endif
+
+	flushDenormals();
+}
+
+void BiquadBank::processLane( float *channel, size_t numFrames, size_t lane )
+{
+	for( size_t stage = 0; stage < mNumStages; stage++ ) {
+		const size_t index = stage * mNumLanes + lane;
+		const float b0 = mB0[index];
+		const float b1 = mB1[index];
+		const float b2 = mB2[index];
+		const float a1 = mA1[index];
+		const float a2 = mA2[index];
+		float s1 = mS1[index];
+		float s2 = mS2[index];
+
+		for( size_t i = 0; i < numFrames; i++ ) {
+			float x = channel[i];
+			float y = b0 * x + s1;
+			s1 = b1 * x - a1 * y + s2;
+			s2 = b2 * x - a2 * y;
+			channel[i] = y;
+		}
+
+		mS1[index] = s1;
+		mS2[index] = s2;
+	}
+}
+
+#if defined( CINDER_AUDIO_SSE )
+
+void BiquadBank::processGroup( float * const *channels, size_t numLanes, size_t numFrames, size_t laneOffset )
+{
+	// Filter memory of unused lanes is restored afterwards, as they may belong to channels that were not part of this buffer.
+	const bool saveState = numLanes < kLaneWidth;
+	float *stash = mStateStash.data();
+	if( saveState ) {
+		size_t s = 0;
+		for( size_t stage = 0; stage < mNumStages; stage++ ) {
+			for( size_t lane = numLanes; lane < kLaneWidth; lane++ ) {
+				size_t index = stage * mNumLanes + laneOffset + lane;
+				stash[s++] = mS1[index];
+				stash[s++] = mS2[index];
+			}
+		}
+	}
+
+	size_t i = 0;
+	for( ; i + kLaneWidth <= numFrames; i += kLaneWidth ) {
+		// load four frames of four channels, then transpose so that each register holds one frame across all lanes.
+		__m128 r0 = _mm_loadu_ps( channels[0] + i );
+		__m128 r1 = _mm_loadu_ps( channels[1] + i );
+		__m128 r2 = _mm_loadu_ps( channels[2] + i );
+		__m128 r3 = _mm_loadu_ps( channels[3] + i );
+		_MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+
+		for( size_t stage = 0; stage < mNumStages; stage++ ) {
+			const size_t index = stage * mNumLanes + laneOffset;
+			SectionSse c;
+			c.b0 = _mm_loadu_ps( &mB0[index] );
+			c.b1 = _mm_loadu_ps( &mB1[index] );
+			c.b2 = _mm_loadu_ps( &mB2[index] );
+			c.a1 = _mm_loadu_ps( &mA1[index] );
+			c.a2 = _mm_loadu_ps( &mA2[index] );
+			__m128 s1 = _mm_loadu_ps( &mS1[index] );
+			__m128 s2 = _mm_loadu_ps( &mS2[index] );
+
+			r0 = tickSse( r0, c, s1, s2 );
+			r1 = tickSse( r1, c, s1, s2 );
+			r2 = tickSse( r2, c, s1, s2 );
+			r3 = tickSse( r3, c, s1, s2 );
+
+			_mm_storeu_ps( &mS1[index], s1 );
+			_mm_storeu_ps( &mS2[index], s2 );
+		}
+
+		_MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+		__m128 result[kLaneWidth] = { r0, r1, r2, r3 };
+		for( size_t lane = 0; lane < numLanes; lane++ )
+			_mm_storeu_ps( channels[lane] + i, result[lane] );
+	}
+
+	// process the remaining frames one at a time, gathering and scattering across channels
+	for( ; i < numFrames; i++ ) {
+		__m128 x = _mm_setr_ps( channels[0][i], channels[1][i], channels[2][i], channels[3][i] );
+
+		for( size_t stage = 0; stage < mNumStages; stage++ ) {
+			const size_t index = stage * mNumLanes + laneOffset;
+			SectionSse c;
+			c.b0 = _mm_loadu_ps( &mB0[index] );
+			c.b1 = _mm_loadu_ps( &mB1[index] );
+			c.b2 = _mm_loadu_ps( &mB2[index] );
+			c.a1 = _mm_loadu_ps( &mA1[index] );
+			c.a2 = _mm_loadu_ps( &mA2[index] );
+			__m128 s1 = _mm_loadu_ps( &mS1[index] );
+			__m128 s2 = _mm_loadu_ps( &mS2[index] );
+
+			x = tickSse( x, c, s1, s2 );
+
+			_mm_storeu_ps( &mS1[index], s1 );
+			_mm_storeu_ps( &mS2[index], s2 );
+		}
+
+		float y[kLaneWidth];
+		_mm_storeu_ps( y, x );
+		for( size_t lane = 0; lane < numLanes; lane++ )
+			channels[lane][i] = y[lane];
+	}
+
+	if( saveState ) {
+		size_t s = 0;
+		for( size_t stage = 0; stage < mNumStages; stage++ ) {
+			for( size_t lane = numLanes; lane < kLaneWidth; lane++ ) {
+				size_t index = stage * mNumLanes + laneOffset + lane;
+				mS1[index] = stash[s++];
+				mS2[index] = stash[s++];
+			}
+		}
+	}
+}
+
+#else
+
+void BiquadBank::processGroup( float * const *channels, size_t numLanes, size_t numFrames, size_t laneOffset )
+{
+	for( size_t lane = 0; lane < numLanes; lane++ )
+		processLane( channels[lane], numFrames, laneOffset + lane );
+}
+
+#endif // defined( CINDER_AUDIO_SSE )
+
+void BiquadBank::flushDenormals()
+{
+	for( size_t i = 0; i < mS1.size(); i++ ) {
+		if( fabsf( mS1[i] ) < kDenormalThreshold )
+			mS1[i] = 0;
+		if( fabsf( mS2[i] ) < kDenormalThreshold )
+			mS2[i] = 0;
+	}
+}
+
+} } } // namespace cinder::audio::dsp
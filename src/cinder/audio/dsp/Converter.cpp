@@ -30,15 +30,37 @@
 	#include "cinder/audio/cocoa/CinderCoreAudio.h"
 #endif
 
+#if defined( CINDER_AUDIO_SSE )
+	#include <emmintrin.h>
+#endif
+
 #include <algorithm>
+#include <cstring>
+#include <mutex>
 
 using namespace ci;
 using namespace std;
 
 namespace cinder { namespace audio { namespace dsp {
 
+namespace {
+
+mutex				sDefaultFactoryMutex;
+ConverterFactoryFn	sDefaultFactory;
+
+// number of samples converted at a time through a stack buffer when interleaving also changes precision
+const size_t CONVERSION_CHUNK_SIZE = 1024;
+
+} // anonymous namespace
+
 unique_ptr<Converter> Converter::create( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock )
 {
+	{
+		lock_guard<mutex> lock( sDefaultFactoryMutex );
+		if( sDefaultFactory )
+			return sDefaultFactory( sourceSampleRate, destSampleRate, sourceNumChannels, destNumChannels, sourceMaxFramesPerBlock );
+	}
+
 #if defined( CINDER_COCOA )
 	return unique_ptr<Converter>( new cocoa::ConverterImplCoreAudio( sourceSampleRate, destSampleRate, sourceNumChannels, destNumChannels, sourceMaxFramesPerBlock ) );
 #else
@@ -46,6 +68,13 @@ unique_ptr<Converter> Converter::create( size_t sourceSampleRate, size_t destSam
 #endif
 }
 
+// static
+void Converter::setDefaultFactory( const ConverterFactoryFn &factory )
+{
+	lock_guard<mutex> lock( sDefaultFactoryMutex );
+	sDefaultFactory = factory;
+}
+
 Converter::Converter( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock )
 	: mSourceSampleRate( sourceSampleRate ), mDestSampleRate( destSampleRate ), mSourceNumChannels( sourceNumChannels ), mDestNumChannels( destNumChannels ), mSourceMaxFramesPerBlock( sourceMaxFramesPerBlock )
 {
@@ -59,6 +88,300 @@ Converter::Converter( size_t sourceSampleRate, size_t destSampleRate, size_t sou
 	mDestMaxFramesPerBlock = (size_t)ceil( (float)mSourceMaxFramesPerBlock * (float)mDestSampleRate / (float)mSourceSampleRate );
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Interleaving
+// ----------------------------------------------------------------------------------------------------
+
+namespace {
+
+#if defined( CINDER_AUDIO_SSE )
+
+// The kernels below move four frames per iteration of a group of two or four channels, starting at firstChannel of an interleaved
+// layout that has numChannels. numFrames must be a multiple of four, the remaining frames are handled by the generic templates.
+
+void deinterleaveStereoSse( const float *interleaved, float *nonInterleaved, size_t numFramesPerChannel, size_t numFrames )
+{
+	float *left = nonInterleaved;
+	float *right = nonInterleaved + numFramesPerChannel;
+
+	for( size_t i = 0; i < numFrames; i += 4 ) {
+		__m128 a = _mm_loadu_ps( interleaved + i * 2 );
+		__m128 b = _mm_loadu_ps( interleaved + i * 2 + 4 );
+		_mm_storeu_ps( left + i, _mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+		_mm_storeu_ps( right + i, _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+	}
+}
+
+void interleaveStereoSse( const float *nonInterleaved, float *interleaved, size_t numFramesPerChannel, size_t numFrames )
+{
+	const float *left = nonInterleaved;
+	const float *right = nonInterleaved + numFramesPerChannel;
+
+	for( size_t i = 0; i < numFrames; i += 4 ) {
+		__m128 l = _mm_loadu_ps( left + i );
+		__m128 r = _mm_loadu_ps( right + i );
+		_mm_storeu_ps( interleaved + i * 2, _mm_unpacklo_ps( l, r ) );
+		_mm_storeu_ps( interleaved + i * 2 + 4, _mm_unpackhi_ps( l, r ) );
+	}
+}
+
+void deinterleaveGroup2Sse( const float *interleaved, float *nonInterleaved, size_t numFramesPerChannel, size_t numChannels, size_t firstChannel, size_t numFrames )
+{
+	float *dest0 = nonInterleaved + firstChannel * numFramesPerChannel;
+	float *dest1 = dest0 + numFramesPerChannel;
+
+	for( size_t i = 0; i < numFrames; i += 4 ) {
+		const float *frame = interleaved + i * numChannels + firstChannel;
+		__m128 a = _mm_loadh_pi( _mm_loadl_pi( _mm_setzero_ps(), (const __m64 *)frame ), (const __m64 *)( frame + numChannels ) );
+		__m128 b = _mm_loadh_pi( _mm_loadl_pi( _mm_setzero_ps(), (const __m64 *)( frame + numChannels * 2 ) ), (const __m64 *)( frame + numChannels * 3 ) );
+		_mm_storeu_ps( dest0 + i, _mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+		_mm_storeu_ps( dest1 + i, _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+	}
+}
+
+void interleaveGroup2Sse( const float *nonInterleaved, float *interleaved, size_t numFramesPerChannel, size_t numChannels, size_t firstChannel, size_t numFrames )
+{
+	const float *source0 = nonInterleaved + firstChannel * numFramesPerChannel;
+	const float *source1 = source0 + numFramesPerChannel;
+
+	for( size_t i = 0; i < numFrames; i += 4 ) {
+		__m128 c0 = _mm_loadu_ps( source0 + i );
+		__m128 c1 = _mm_loadu_ps( source1 + i );
+		__m128 lo = _mm_unpacklo_ps( c0, c1 );
+		__m128 hi = _mm_unpackhi_ps( c0, c1 );
+
+		float *frame = interleaved + i * numChannels + firstChannel;
+		_mm_storel_pi( (__m64 *)frame, lo );
+		_mm_storeh_pi( (__m64 *)( frame + numChannels ), lo );
+		_mm_storel_pi( (__m64 *)( frame + numChannels * 2 ), hi );
+		_mm_storeh_pi( (__m64 *)( frame + numChannels * 3 ), hi );
+	}
+}
+
+void deinterleaveGroup4Sse( const float *interleaved, float *nonInterleaved, size_t numFramesPerChannel, size_t numChannels, size_t firstChannel, size_t numFrames )
+{
+	float *dest0 = nonInterleaved + firstChannel * numFramesPerChannel;
+	float *dest1 = dest0 + numFramesPerChannel;
+	float *dest2 = dest1 + numFramesPerChannel;
+	float *dest3 = dest2 + numFramesPerChannel;
+
+	for( size_t i = 0; i < numFrames; i += 4 ) {
+		const float *frame = interleaved + i * numChannels + firstChannel;
+		__m128 a = _mm_loadu_ps( frame );
+		__m128 b = _mm_loadu_ps( frame + numChannels );
+		__m128 c = _mm_loadu_ps( frame + numChannels * 2 );
+		__m128 d = _mm_loadu_ps( frame + numChannels * 3 );
+		_MM_TRANSPOSE4_PS( a, b, c, d );
+		_mm_storeu_ps( dest0 + i, a );
+		_mm_storeu_ps( dest1 + i, b );
+		_mm_storeu_ps( dest2 + i, c );
+		_mm_storeu_ps( dest3 + i, d );
+	}
+}
+
+void interleaveGroup4Sse( const float *nonInterleaved, float *interleaved, size_t numFramesPerChannel, size_t numChannels, size_t firstChannel, size_t numFrames )
+{
+	const float *source0 = nonInterleaved + firstChannel * numFramesPerChannel;
+	const float *source1 = source0 + numFramesPerChannel;
+	const float *source2 = source1 + numFramesPerChannel;
+	const float *source3 = source2 + numFramesPerChannel;
+
+	for( size_t i = 0; i < numFrames; i += 4 ) {
+		__m128 a = _mm_loadu_ps( source0 + i );
+		__m128 b = _mm_loadu_ps( source1 + i );
+		__m128 c = _mm_loadu_ps( source2 + i );
+		__m128 d = _mm_loadu_ps( source3 + i );
+		_MM_TRANSPOSE4_PS( a, b, c, d );
+
+		float *frame = interleaved + i * numChannels + firstChannel;
+		_mm_storeu_ps( frame, a );
+		_mm_storeu_ps( frame + numChannels, b );
+		_mm_storeu_ps( frame + numChannels * 2, c );
+		_mm_storeu_ps( frame + numChannels * 3, d );
+	}
+}
+
+#endif // defined( CINDER_AUDIO_SSE )
+
+// Processes the largest multiple of four frames with a SIMD kernel for numChannels, returning the number of frames processed (0 if there is no kernel).
+size_t deinterleaveSimd( const float *interleaved, float *nonInterleaved, size_t numFramesPerChannel, size_t numChannels, size_t numFrames )
+{
+#if defined( CINDER_AUDIO_SSE )
+	const size_t numFramesSimd = numFrames & ~size_t( 3 );
+	switch( numChannels ) {
+		case 2:	deinterleaveStereoSse( interleaved, nonInterleaved, numFramesPerChannel, numFramesSimd ); break;
+		case 4:	deinterleaveGroup4Sse( interleaved, nonInterleaved, numFramesPerChannel, 4, 0, numFramesSimd ); break;
+		case 6:
+			deinterleaveGroup4Sse( interleaved, nonInterleaved, numFramesPerChannel, 6, 0, numFramesSimd );
+			deinterleaveGroup2Sse( interleaved, nonInterleaved, numFramesPerChannel, 6, 4, numFramesSimd );
+			break;
+		case 8:
+			deinterleaveGroup4Sse( interleaved, nonInterleaved, numFramesPerChannel, 8, 0, numFramesSimd );
+			deinterleaveGroup4Sse( interleaved, nonInterleaved, numFramesPerChannel, 8, 4, numFramesSimd );
+			break;
+		default: return 0;
+	}
+
+	return numFramesSimd;
+#else
+	return 0;
+#endif
+}
+
+// Processes the largest multiple of four frames with a SIMD kernel for numChannels, returning the number of frames processed (0 if there is no kernel).
+size_t interleaveSimd( const float *nonInterleaved, float *interleaved, size_t numFramesPerChannel, size_t numChannels, size_t numFrames )
+{
+#if defined( CINDER_AUDIO_SSE )
+	const size_t numFramesSimd = numFrames & ~size_t( 3 );
+	switch( numChannels ) {
+		case 2:	interleaveStereoSse( nonInterleaved, interleaved, numFramesPerChannel, numFramesSimd ); break;
+		case 4:	interleaveGroup4Sse( nonInterleaved, interleaved, numFramesPerChannel, 4, 0, numFramesSimd ); break;
+		case 6:
+			interleaveGroup4Sse( nonInterleaved, interleaved, numFramesPerChannel, 6, 0, numFramesSimd );
+			interleaveGroup2Sse( nonInterleaved, interleaved, numFramesPerChannel, 6, 4, numFramesSimd );
+			break;
+		case 8:
+			interleaveGroup4Sse( nonInterleaved, interleaved, numFramesPerChannel, 8, 0, numFramesSimd );
+			interleaveGroup4Sse( nonInterleaved, interleaved, numFramesPerChannel, 8, 4, numFramesSimd );
+			break;
+		default: return 0;
+	}
+
+	return numFramesSimd;
+#else
+	return 0;
+#endif
+}
+
+void convertInt16ToFloat( const int16_t *sourceArray, float *destArray, size_t length )
+{
+	const float floatNormalizer = 3.0517578125e-05f;	// 1.0 / 32768.0
+	size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	const __m128 normalizer = _mm_set1_ps( floatNormalizer );
+	for( ; i + 8 <= length; i += 8 ) {
+		__m128i samples = _mm_loadu_si128( (const __m128i *)( sourceArray + i ) );
+		// unpacking with itself places each sample in the upper half of a 32-bit int, shifting back down sign extends it
+		__m128i lo = _mm_srai_epi32( _mm_unpacklo_epi16( samples, samples ), 16 );
+		__m128i hi = _mm_srai_epi32( _mm_unpackhi_epi16( samples, samples ), 16 );
+		_mm_storeu_ps( destArray + i, _mm_mul_ps( _mm_cvtepi32_ps( lo ), normalizer ) );
+		_mm_storeu_ps( destArray + i + 4, _mm_mul_ps( _mm_cvtepi32_ps( hi ), normalizer ) );
+	}
+#endif
+
+	for( ; i < length; i++ )
+		destArray[i] = (float)sourceArray[i] * floatNormalizer;
+}
+
+void convertFloatToInt16( const float *sourceArray, int16_t *destArray, size_t length )
+{
+	const float intNormalizer = 32768;
+	size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	const __m128 normalizer = _mm_set1_ps( intNormalizer );
+	for( ; i + 8 <= length; i += 8 ) {
+		// truncates like the scalar cast, packing saturates to the int16 range
+		__m128i lo = _mm_cvttps_epi32( _mm_mul_ps( _mm_loadu_ps( sourceArray + i ), normalizer ) );
+		__m128i hi = _mm_cvttps_epi32( _mm_mul_ps( _mm_loadu_ps( sourceArray + i + 4 ), normalizer ) );
+		_mm_storeu_si128( (__m128i *)( destArray + i ), _mm_packs_epi32( lo, hi ) );
+	}
+#endif
+
+	for( ; i < length; i++ )
+		destArray[i] = int16_t( max( -32768.0f, min( sourceArray[i] * intNormalizer, 32767.0f ) ) );
+}
+
+} // anonymous namespace
+
+void deinterleave( const float *interleavedSourceArray, float *nonInterleavedDestArray, size_t numFramesPerChannel, size_t numChannels, size_t numCopyFrames )
+{
+	if( numChannels == 1 ) {
+		memcpy( nonInterleavedDestArray, interleavedSourceArray, numCopyFrames * sizeof( float ) );
+		return;
+	}
+
+	size_t numFramesSimd = deinterleaveSimd( interleavedSourceArray, nonInterleavedDestArray, numFramesPerChannel, numChannels, numCopyFrames );
+	deinterleave<float>( interleavedSourceArray + numFramesSimd * numChannels, nonInterleavedDestArray + numFramesSimd, numFramesPerChannel, numChannels, numCopyFrames - numFramesSimd );
+}
+
+void interleave( const float *nonInterleavedSourceArray, float *interleavedDestArray, size_t numFramesPerChannel, size_t numChannels, size_t numCopyFrames )
+{
+	if( numChannels == 1 ) {
+		memcpy( interleavedDestArray, nonInterleavedSourceArray, numCopyFrames * sizeof( float ) );
+		return;
+	}
+
+	size_t numFramesSimd = interleaveSimd( nonInterleavedSourceArray, interleavedDestArray, numFramesPerChannel, numChannels, numCopyFrames );
+	interleave<float>( nonInterleavedSourceArray + numFramesSimd, interleavedDestArray + numFramesSimd * numChannels, numFramesPerChannel, numChannels, numCopyFrames - numFramesSimd );
+}
+
+void deinterleave( const int16_t *interleavedInt16SourceArray, float *nonInterleavedFloatDestArray, size_t numFramesPerChannel, size_t numChannels, size_t numCopyFrames )
+{
+	if( numChannels > CONVERSION_CHUNK_SIZE ) {
+		deinterleave<float>( interleavedInt16SourceArray, nonInterleavedFloatDestArray, numFramesPerChannel, numChannels, numCopyFrames );
+		return;
+	}
+
+	// convert a chunk of interleaved samples to float on the stack, then de-interleave it
+	float chunk[CONVERSION_CHUNK_SIZE];
+	const size_t chunkFrames = CONVERSION_CHUNK_SIZE / numChannels;
+
+	for( size_t frame = 0; frame < numCopyFrames; frame += chunkFrames ) {
+		size_t numFrames = min( chunkFrames, numCopyFrames - frame );
+		convertInt16ToFloat( interleavedInt16SourceArray + frame * numChannels, chunk, numFrames * numChannels );
+		deinterleave( chunk, nonInterleavedFloatDestArray + frame, numFramesPerChannel, numChannels, numFrames );
+	}
+}
+
+void interleave( const float *nonInterleavedFloatSourceArray, int16_t *interleavedInt16DestArray, size_t numFramesPerChannel, size_t numChannels, size_t numCopyFrames )
+{
+	if( numChannels > CONVERSION_CHUNK_SIZE ) {
+		interleave<float>( nonInterleavedFloatSourceArray, interleavedInt16DestArray, numFramesPerChannel, numChannels, numCopyFrames );
+		return;
+	}
+
+	// interleave a chunk of frames on the stack, then convert it to int16
+	float chunk[CONVERSION_CHUNK_SIZE];
+	const size_t chunkFrames = CONVERSION_CHUNK_SIZE / numChannels;
+
+	for( size_t frame = 0; frame < numCopyFrames; frame += chunkFrames ) {
+		size_t numFrames = min( chunkFrames, numCopyFrames - frame );
+		interleave( nonInterleavedFloatSourceArray + frame, chunk, numFramesPerChannel, numChannels, numFrames );
+		convertFloatToInt16( chunk, interleavedInt16DestArray + frame * numChannels, numFrames * numChannels );
+	}
+}
+
+void convertInt24ToFloat( const char *sourceArray, float *destArray, size_t length )
+{
+	const float floatNormalizer = 1.0f / 8388607.0f;
+	size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	// Each sample is read as the low three bytes of a 32-bit little-endian load, then shifted up and back down to sign extend it.
+	// The load for the fourth sample reads one byte past it, so the loop stops while at least one more sample follows.
+	const __m128 normalizer = _mm_set1_ps( floatNormalizer );
+	for( ; i + 4 < length; i += 4 ) {
+		int32_t s0, s1, s2, s3;
+		memcpy( &s0, sourceArray, 4 );
+		memcpy( &s1, sourceArray + 3, 4 );
+		memcpy( &s2, sourceArray + 6, 4 );
+		memcpy( &s3, sourceArray + 9, 4 );
+
+		__m128i samples = _mm_srai_epi32( _mm_slli_epi32( _mm_set_epi32( s3, s2, s1, s0 ), 8 ), 8 );
+		_mm_storeu_ps( destArray + i, _mm_mul_ps( _mm_cvtepi32_ps( samples ), normalizer ) );
+		sourceArray += 12;
+	}
+#endif
+
+	convertInt24ToFloat<float>( sourceArray, destArray + i, length - i );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Channel Mixing
+// ----------------------------------------------------------------------------------------------------
+
 void mixBuffers( const Buffer *sourceBuffer, Buffer *destBuffer, size_t numFrames )
 {
 	size_t sourceChannels = sourceBuffer->getNumChannels();
@@ -76,8 +399,8 @@ void mixBuffers( const Buffer *sourceBuffer, Buffer *destBuffer, size_t numFrame
 		// down-mix mono destBuffer to sourceChannels, multiply by an equal-power normalizer to help prevent clipping
 		const float downMixNormalizer = 1.0f / std::sqrt( 2.0f );
 		float *destChannel0 = destBuffer->getChannel( 0 );
-		destBuffer->zero();
-		for( size_t c = 0; c < sourceChannels; c++ )
+		mul( sourceBuffer->getChannel( 0 ), downMixNormalizer, destChannel0, numFrames );
+		for( size_t c = 1; c < sourceChannels; c++ )
 			addMul( destChannel0, sourceBuffer->getChannel( c ), downMixNormalizer, destChannel0, numFrames );
 	}
 	else if( destChannels < sourceChannels ) {
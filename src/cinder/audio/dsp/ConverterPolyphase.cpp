@@ -0,0 +1,333 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/dsp/ConverterPolyphase.h"
+#include "cinder/audio/dsp/Dsp.h"
+#include "cinder/CinderAssert.h"
+#include "cinder/CinderMath.h"
+
+#if defined( CINDER_AUDIO_SSE )
+	#include <xmmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder { namespace audio { namespace dsp {
+
+namespace {
+
+// Above this many phases (ex. 44100 -> 44101), the filter is designed with MAX_NUM_PHASES and coefficients are interpolated between adjacent phases.
+const size_t MAX_NUM_PHASES = 512;
+
+struct QualityParams {
+	QualityParams( size_t numTaps, double cutoff, double kaiserBeta )
+		: mNumTaps( numTaps ), mCutoff( cutoff ), mKaiserBeta( kaiserBeta )
+	{}
+
+	size_t	mNumTaps;
+	double	mCutoff;		// relative to the lower of the two nyquist frequencies
+	double	mKaiserBeta;
+};
+
+QualityParams getQualityParams( ConverterImplPolyphase::Quality quality )
+{
+	switch( quality ) {
+		case ConverterImplPolyphase::Quality::LOW:		return QualityParams( 16, 0.85, 6.0 );
+		case ConverterImplPolyphase::Quality::MEDIUM:	return QualityParams( 32, 0.91, 8.0 );
+		case ConverterImplPolyphase::Quality::HIGH:		return QualityParams( 64, 0.95, 10.0 );
+	}
+
+	CI_ASSERT_NOT_REACHABLE();
+	return QualityParams( 32, 0.91, 8.0 );
+}
+
+size_t greatestCommonDivisor( size_t a, size_t b )
+{
+	while( b ) {
+		size_t t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+// zeroth order modified bessel function of the first kind, for the kaiser window
+double besselI0( double x )
+{
+	double sum = 1;
+	double term = 1;
+	const double halfX = x / 2;
+	for( int k = 1; k < 50; k++ ) {
+		term *= halfX / k;
+		const double termSquared = term * term;
+		sum += termSquared;
+		if( termSquared < sum * 1e-16 )
+			break;
+	}
+	return sum;
+}
+
+// Sums coeffs[i] * samples[i] over \a length (a multiple of 4), folding index i into result[i % numChannels]. numChannels must be 1 or 2.
+inline void dotFolded( const float *coeffs, const float *samples, size_t length, size_t numChannels, float *result )
+{
+#if defined( CINDER_AUDIO_SSE )
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	size_t i = 0;
+	for( ; i + 8 <= length; i += 8 ) {
+		acc0 = _mm_add_ps( acc0, _mm_mul_ps( _mm_loadu_ps( coeffs + i ), _mm_loadu_ps( samples + i ) ) );
+		acc1 = _mm_add_ps( acc1, _mm_mul_ps( _mm_loadu_ps( coeffs + i + 4 ), _mm_loadu_ps( samples + i + 4 ) ) );
+	}
+	if( i < length )
+		acc0 = _mm_add_ps( acc0, _mm_mul_ps( _mm_loadu_ps( coeffs + i ), _mm_loadu_ps( samples + i ) ) );
+
+	float lanes[4];
+	_mm_storeu_ps( lanes, _mm_add_ps( acc0, acc1 ) );
+#else
+	float lanes[4] = { 0, 0, 0, 0 };
+	for( size_t i = 0; i < length; i += 4 ) {
+		lanes[0] += coeffs[i] * samples[i];
+		lanes[1] += coeffs[i + 1] * samples[i + 1];
+		lanes[2] += coeffs[i + 2] * samples[i + 2];
+		lanes[3] += coeffs[i + 3] * samples[i + 3];
+	}
+#endif
+
+	if( numChannels == 1 )
+		result[0] = ( lanes[0] + lanes[1] ) + ( lanes[2] + lanes[3] );
+	else {
+		result[0] = lanes[0] + lanes[2];
+		result[1] = lanes[1] + lanes[3];
+	}
+}
+
+// Filters any number of interleaved channels with one coefficient per frame, 4 channels at a time where possible.
+inline void dotInterleaved( const float *coeffs, const float *samples, size_t numTaps, size_t numChannels, float *result )
+{
+	size_t ch = 0;
+#if defined( CINDER_AUDIO_SSE )
+	for( ; ch + 4 <= numChannels; ch += 4 ) {
+		__m128 acc = _mm_setzero_ps();
+		const float *s = samples + ch;
+		for( size_t j = 0; j < numTaps; j++ ) {
+			acc = _mm_add_ps( acc, _mm_mul_ps( _mm_set1_ps( coeffs[j] ), _mm_loadu_ps( s ) ) );
+			s += numChannels;
+		}
+		_mm_storeu_ps( result + ch, acc );
+	}
+#endif
+	for( ; ch < numChannels; ch++ ) {
+		float acc = 0;
+		const float *s = samples + ch;
+		for( size_t j = 0; j < numTaps; j++ ) {
+			acc += coeffs[j] * *s;
+			s += numChannels;
+		}
+		result[ch] = acc;
+	}
+}
+
+} // anonymous namespace
+
+ConverterImplPolyphase::ConverterImplPolyphase( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock, Quality quality )
+	: Converter( sourceSampleRate, destSampleRate, sourceNumChannels, destNumChannels, sourceMaxFramesPerBlock ), mQuality( quality )
+{
+	size_t numChannels = min( mSourceNumChannels, mDestNumChannels );
+	if( mSourceNumChannels > mDestNumChannels )
+		mMixingBuffer = Buffer( mSourceMaxFramesPerBlock, mDestNumChannels );
+	else if( mSourceNumChannels < mDestNumChannels )
+		mMixingBuffer = Buffer( mDestMaxFramesPerBlock, mSourceNumChannels );
+
+	const size_t gcd = greatestCommonDivisor( mSourceSampleRate, mDestSampleRate );
+	mUpFactor = mDestSampleRate / gcd;
+	mDownFactor = mSourceSampleRate / gcd;
+	mNumPhases = min( mUpFactor, MAX_NUM_PHASES );
+	mNumTaps = getQualityParams( mQuality ).mNumTaps;
+	mCoeffStride = numChannels <= 2 ? mNumTaps * numChannels : mNumTaps;
+
+	designFilter();
+
+	// Room for the filter's window plus two blocks, since at most one block of source frames is left over from the previous convert().
+	mHistory.resize( ( mNumTaps + 2 * mSourceMaxFramesPerBlock ) * numChannels );
+	mFrame.resize( numChannels );
+	mFrameNext.resize( numChannels );
+	clear();
+}
+
+ConverterImplPolyphase::~ConverterImplPolyphase()
+{
+}
+
+// static
+ConverterFactoryFn ConverterImplPolyphase::makeFactory( Quality quality )
+{
+	return [quality]( size_t sourceSampleRate, size_t destSampleRate, size_t sourceNumChannels, size_t destNumChannels, size_t sourceMaxFramesPerBlock ) {
+		return unique_ptr<Converter>( new ConverterImplPolyphase( sourceSampleRate, destSampleRate, sourceNumChannels, destNumChannels, sourceMaxFramesPerBlock, quality ) );
+	};
+}
+
+void ConverterImplPolyphase::designFilter()
+{
+	// Kaiser windowed sinc prototype at mNumPhases times the source rate, split into phases. Row p, tap j
+	// holds prototype[p + ( mNumTaps - 1 - j ) * mNumPhases], so that taps line up with the history in time order.
+	// The center is at exactly mNumTaps / 2 source frames, which clear() compensates for.
+	const QualityParams params = getQualityParams( mQuality );
+	const size_t prototypeLength = mNumTaps * mNumPhases;
+	const double center = double( prototypeLength ) / 2.0;
+	const double cutoff = params.mCutoff * 0.5 / double( mNumPhases ) * min( 1.0, double( mUpFactor ) / double( mDownFactor ) );
+	const double windowNormalizer = 1.0 / besselI0( params.mKaiserBeta );
+	const size_t numChannels = mCoeffStride / mNumTaps;
+
+	vector<double> prototype( prototypeLength + mNumPhases, 0.0 ); // padded with zeros for the interpolation row
+	for( size_t n = 0; n < prototypeLength; n++ ) {
+		const double x = double( n ) - center;
+		const double sinc = ( x == 0 ) ? 2 * cutoff : sin( 2 * M_PI * cutoff * x ) / ( M_PI * x );
+		const double r = x / center;
+		const double window = besselI0( params.mKaiserBeta * sqrt( max( 0.0, 1 - r * r ) ) ) * windowNormalizer;
+		prototype[n] = sinc * window * mNumPhases;
+	}
+
+	mCoeffs = makeAlignedArray<float>( ( mNumPhases + 1 ) * mCoeffStride );
+	float *coeffs = mCoeffs.get();
+	for( size_t p = 0; p <= mNumPhases; p++ ) {
+		float *row = coeffs + p * mCoeffStride;
+		for( size_t j = 0; j < mNumTaps; j++ ) {
+			const float c = (float)prototype[p + ( mNumTaps - 1 - j ) * mNumPhases];
+			for( size_t ch = 0; ch < numChannels; ch++ )
+				row[j * numChannels + ch] = c;
+		}
+	}
+}
+
+void ConverterImplPolyphase::clear()
+{
+	// Start with mNumTaps / 2 - 1 frames of silence, so that the first output frame is centered on the first source frame.
+	const size_t numChannels = min( mSourceNumChannels, mDestNumChannels );
+	mNumHistoryFrames = mNumTaps / 2 - 1;
+	fill( mHistory.begin(), mHistory.begin() + mNumHistoryFrames * numChannels, 0.0f );
+	mWindowStart = 0;
+	mPhase = 0;
+}
+
+pair<size_t, size_t> ConverterImplPolyphase::convert( const Buffer *sourceBuffer, Buffer *destBuffer )
+{
+	CI_ASSERT( sourceBuffer->getNumChannels() == mSourceNumChannels && destBuffer->getNumChannels() == mDestNumChannels );
+
+	size_t readCount = min( sourceBuffer->getNumFrames(), mSourceMaxFramesPerBlock );
+
+	if( mSourceSampleRate == mDestSampleRate ) {
+		mixBuffers( sourceBuffer, destBuffer, readCount );
+		return make_pair( readCount, readCount );
+	}
+
+	// append the source frames to the interleaved history, down-mixing first if necessary
+	const Buffer *input = sourceBuffer;
+	if( mSourceNumChannels > mDestNumChannels ) {
+		mixBuffers( sourceBuffer, &mMixingBuffer, readCount );
+		input = &mMixingBuffer;
+	}
+
+	const size_t numChannels = min( mSourceNumChannels, mDestNumChannels );
+	CI_ASSERT( ( mNumHistoryFrames + readCount ) * numChannels <= mHistory.size() );
+
+	float *history = mHistory.data() + mNumHistoryFrames * numChannels;
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		const float *channel = input->getChannel( ch );
+		for( size_t i = 0; i < readCount; i++ )
+			history[i * numChannels + ch] = channel[i];
+	}
+	mNumHistoryFrames += readCount;
+
+	size_t outCount;
+	if( mSourceNumChannels < mDestNumChannels ) {
+		outCount = process( numChannels, &mMixingBuffer );
+		mixBuffers( &mMixingBuffer, destBuffer, outCount );
+	}
+	else
+		outCount = process( numChannels, destBuffer );
+
+	return make_pair( readCount, outCount );
+}
+
+size_t ConverterImplPolyphase::process( size_t numChannels, Buffer *destBuffer )
+{
+	const size_t maxOutFrames = destBuffer->getNumFrames();
+	float *result = mFrame.data();
+
+	size_t outCount = 0;
+	while( outCount < maxOutFrames && mWindowStart + mNumTaps <= mNumHistoryFrames ) {
+		computeFrame( numChannels, result );
+		for( size_t ch = 0; ch < numChannels; ch++ )
+			destBuffer->getChannel( ch )[outCount] = result[ch];
+
+		outCount++;
+		mPhase += mDownFactor;
+		mWindowStart += mPhase / mUpFactor;
+		mPhase %= mUpFactor;
+	}
+
+	// shift the frames still needed to the front of the history
+	const size_t numRemaining = mNumHistoryFrames - min( mWindowStart, mNumHistoryFrames );
+	if( mWindowStart ) {
+		memmove( mHistory.data(), mHistory.data() + mWindowStart * numChannels, numRemaining * numChannels * sizeof( float ) );
+		mNumHistoryFrames = numRemaining;
+		mWindowStart = 0;
+	}
+
+	return outCount;
+}
+
+void ConverterImplPolyphase::computeFrame( size_t numChannels, float *result )
+{
+	const float *samples = mHistory.data() + mWindowStart * numChannels;
+	const float *coeffs = mCoeffs.get();
+
+	auto filter = [&]( const float *row, float *dest ) {
+		if( numChannels <= 2 )
+			dotFolded( row, samples, mCoeffStride, numChannels, dest );
+		else
+			dotInterleaved( row, samples, mNumTaps, numChannels, dest );
+	};
+
+	if( mNumPhases == mUpFactor ) {
+		filter( coeffs + mPhase * mCoeffStride, result );
+		return;
+	}
+
+	// interpolate between the two nearest of the designed phases
+	const double phase = double( mPhase ) * double( mNumPhases ) / double( mUpFactor );
+	const size_t row = (size_t)phase;
+	const float frac = float( phase - row );
+
+	float *nextResult = mFrameNext.data();
+	filter( coeffs + row * mCoeffStride, result );
+	filter( coeffs + ( row + 1 ) * mCoeffStride, nextResult );
+	for( size_t ch = 0; ch < numChannels; ch++ )
+		result[ch] += ( nextResult[ch] - result[ch] ) * frac;
+}
+
+} } } // namespace cinder::audio::dsp
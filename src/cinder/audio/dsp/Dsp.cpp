@@ -25,10 +25,16 @@
 
 #include "cinder/CinderMath.h"
 
+#include <algorithm>
+
 #if defined( CINDER_AUDIO_VDSP )
 	#include <Accelerate/Accelerate.h>
 #endif
 
+#if defined( CINDER_AUDIO_SSE )
+	#include <emmintrin.h>
+#endif
+
 using namespace ci;
 
 namespace cinder { namespace audio { namespace dsp {
@@ -104,6 +110,11 @@ void fill( float value, float *array, size_t length )
 	vDSP_vfill( &value, array, 1, length );
 }
 
+void ramp( float begin, float increment, float *array, size_t length )
+{
+	vDSP_vramp( &begin, &increment, array, 1, length );
+}
+
 float sum( const float *array, size_t length )
 {
 	float result;
@@ -172,6 +183,27 @@ void fill( float value, float *array, size_t length )
 		array[i] = value;
 }
 
+// each value is computed from its index rather than accumulated, so there is no drift over long ramps.
+void ramp( float begin, float increment, float *array, size_t length )
+{
+	size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	const __m128 beginVec = _mm_set1_ps( begin );
+	const __m128 incrementVec = _mm_set1_ps( increment );
+	const __m128 four = _mm_set1_ps( 4 );
+	__m128 index = _mm_set_ps( 3, 2, 1, 0 );
+
+	for( ; i + 4 <= length; i += 4 ) {
+		_mm_storeu_ps( array + i, _mm_add_ps( beginVec, _mm_mul_ps( index, incrementVec ) ) );
+		index = _mm_add_ps( index, four );
+	}
+#endif
+
+	for( ; i < length; i++ )
+		array[i] = begin + (float)i * increment;
+}
+
 float sum( const float *array, size_t length )
 {
 	float result( 0.0f );
@@ -246,6 +278,43 @@ void addMul( const float *arrayA, const float *arrayB, float scalar, float *resu
 
 #endif // ! defined( CINDER_AUDIO_VDSP )
 
+namespace {
+
+// the running product is re-anchored this often to keep accumulated rounding error in check.
+const size_t GEOMETRIC_RAMP_ANCHOR_INTERVAL = 256;
+
+} // anonymous namespace
+
+void rampGeometric( float begin, float ratio, float *array, size_t length )
+{
+	for( size_t anchor = 0; anchor < length; anchor += GEOMETRIC_RAMP_ANCHOR_INTERVAL ) {
+		const float anchorValue = float( begin * std::pow( (double)ratio, (double)anchor ) );
+		const size_t count = std::min( GEOMETRIC_RAMP_ANCHOR_INTERVAL, length - anchor );
+		float *out = array + anchor;
+		size_t i = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+		const float ratio2 = ratio * ratio;
+		const __m128 ratio4 = _mm_set1_ps( ratio2 * ratio2 );
+		__m128 value = _mm_mul_ps( _mm_set1_ps( anchorValue ), _mm_set_ps( ratio2 * ratio, ratio2, ratio, 1 ) );
+
+		for( ; i + 4 <= count; i += 4 ) {
+			_mm_storeu_ps( out + i, value );
+			value = _mm_mul_ps( value, ratio4 );
+		}
+
+		float scalarValue = i < count ? _mm_cvtss_f32( value ) : 0;
+#else
+		float scalarValue = anchorValue;
+#endif
+
+		for( ; i < count; i++ ) {
+			out[i] = scalarValue;
+			scalarValue *= ratio;
+		}
+	}
+}
+
 void normalize( float *array, size_t length, float maxValue )
 {
 	float max = 0;
@@ -22,89 +22,227 @@
 */
 
 #include "cinder/audio/dsp/Fft.h"
+#include "cinder/audio/dsp/FftMixedRadix.h"
 #include "cinder/CinderAssert.h"
 #include "cinder/audio/Exception.h"
 #include "cinder/CinderMath.h"
 
-#if defined( CINDER_AUDIO_FFT_OOURA )
+#include <cstring>
+#include <mutex>
+
+#if defined( CINDER_AUDIO_VDSP )
+	#include <Accelerate/Accelerate.h>
+#elif defined( CINDER_AUDIO_FFT_OOURA )
 	#include "cinder/audio/dsp/ooura/fftsg.h"
 #endif
 
+using namespace std;
+
 namespace cinder { namespace audio { namespace dsp {
 
-Fft::Fft( size_t fftSize )
-: mSize( fftSize )
-{
-	if( mSize < 2 || ! isPowerOf2( mSize ) )
-		throw AudioExc( "invalid fft size" );
+// ----------------------------------------------------------------------------------------------------
+// MARK: - FftBackend
+// ----------------------------------------------------------------------------------------------------
 
-	mSizeOverTwo = mSize / 2;
+void FftBackend::forwardBatch( const float * const *waveforms, float * const *reals, float * const *imags, size_t count )
+{
+	for( size_t i = 0; i < count; i++ )
+		forward( waveforms[i], reals[i], imags[i] );
+}
 
-	init();
+void FftBackend::inverseBatch( const float * const *reals, const float * const *imags, float * const *waveforms, size_t count )
+{
+	for( size_t i = 0; i < count; i++ )
+		inverse( reals[i], imags[i], waveforms[i] );
 }
 
+namespace {
+
 #if defined( CINDER_AUDIO_VDSP )
 
-void Fft::init()
+class FftBackendVDsp : public FftBackend {
+  public:
+	FftBackendVDsp( size_t fftSize )
+		: FftBackend( fftSize ), mSizeOverTwo( fftSize / 2 )
+	{
+		mSplitComplexResult.realp = (float *)malloc( mSizeOverTwo * sizeof( float ) );
+		mSplitComplexResult.imagp = (float *)malloc( mSizeOverTwo * sizeof( float ) );
+
+		mLog2FftSize = log2f( mSize );
+		mFftSetup = vDSP_create_fftsetup( mLog2FftSize, FFT_RADIX2 );
+		CI_ASSERT( mFftSetup );
+	}
+
+	~FftBackendVDsp()
+	{
+		free( mSplitComplexResult.realp );
+		free( mSplitComplexResult.imagp );
+		vDSP_destroy_fftsetup( mFftSetup );
+	}
+
+	void forward( const float *waveform, float *real, float *imag ) override
+	{
+		mSplitComplexSignal.realp = real;
+		mSplitComplexSignal.imagp = imag;
+
+		// in-place transfrom is okay here because we already first copy the data from waveform -> spectral
+		vDSP_ctoz( (::DSPComplex *)waveform, 2, &mSplitComplexSignal, 1, mSizeOverTwo );
+		vDSP_fft_zrip( mFftSetup, &mSplitComplexSignal, 1, mLog2FftSize, FFT_FORWARD );
+
+		// vDSP's forward transform is scaled by two
+		float scale = 0.5f;
+		vDSP_vsmul( real, 1, &scale, real, 1, mSizeOverTwo );
+		vDSP_vsmul( imag, 1, &scale, imag, 1, mSizeOverTwo );
+	}
+
+	void inverse( const float *real, const float *imag, float *waveform ) override
+	{
+		mSplitComplexSignal.realp = const_cast<float *>( real );
+		mSplitComplexSignal.imagp = const_cast<float *>( imag );
+
+		// use out-of-place transfrom so as to not overwrite spectral
+		vDSP_fft_zrop( mFftSetup, &mSplitComplexSignal, 1, &mSplitComplexResult, 1, mLog2FftSize, FFT_INVERSE );
+		vDSP_ztoc( &mSplitComplexResult, 1, (::DSPComplex *)waveform, 2, mSizeOverTwo );
+
+		float scale = 1.0f / float( mSize );
+		vDSP_vsmul( waveform, 1, &scale, waveform, 1, mSize );
+	}
+
+  private:
+	size_t				mSizeOverTwo, mLog2FftSize;
+	::FFTSetup			mFftSetup;
+	::DSPSplitComplex	mSplitComplexSignal, mSplitComplexResult;
+};
+
+typedef FftBackendVDsp FftBackendNative;
+
+#elif defined( CINDER_AUDIO_FFT_OOURA )
+
+class FftBackendOoura : public FftBackend {
+  public:
+	FftBackendOoura( size_t fftSize )
+		: FftBackend( fftSize ), mSizeOverTwo( fftSize / 2 ), mBufferCopy( fftSize )
+	{
+		mOouraIp = (int *)calloc( 2 + (int)sqrt( mSizeOverTwo ), sizeof( int ) );
+		mOouraW = (float *)calloc( mSizeOverTwo, sizeof( float ) );
+	}
+
+	~FftBackendOoura()
+	{
+		free( mOouraIp );
+		free( mOouraW );
+	}
+
+	// Ooura's rdft() uses e^(+2 pi i k n / N) in the forward direction, so the sign of the imaginary parts is flipped when unpacking.
+	void forward( const float *waveform, float *real, float *imag ) override
+	{
+		float *a = mBufferCopy.getData();
+		memcpy( a, waveform, mSize * sizeof( float ) );
+
+		ooura::rdft( (int)mSize, 1, a, mOouraIp, mOouraW );
+
+		real[0] = a[0];
+		imag[0] = a[1];
+
+		for( size_t k = 1; k < mSizeOverTwo; k++ ) {
+			real[k] = a[k * 2];
+			imag[k] = - a[k * 2 + 1];
+		}
+	}
+
+	void inverse( const float *real, const float *imag, float *waveform ) override
+	{
+		float *a = waveform;
+
+		a[0] = real[0];
+		a[1] = imag[0];
+
+		for( size_t k = 1; k < mSizeOverTwo; k++ ) {
+			a[k * 2] = real[k];
+			a[k * 2 + 1] = - imag[k];
+		}
+
+		ooura::rdft( (int)mSize, -1, a, mOouraIp, mOouraW );
+		dsp::mul( a, 2.0f / (float)mSize, a, mSize );
+	}
+
+  private:
+	size_t		mSizeOverTwo;
+	Buffer		mBufferCopy;
+	int			*mOouraIp;
+	float		*mOouraW;
+};
+
+typedef FftBackendOoura FftBackendNative;
+
+#endif
+
+mutex					sDefaultBackendFactoryMutex;
+FftBackendFactoryFn		sDefaultBackendFactory;
+
+} // anonymous namespace
+
+unique_ptr<FftBackend> makeFftBackendNative( size_t fftSize )
 {
-	mSplitComplexResult.realp = (float *)malloc( mSizeOverTwo * sizeof( float ) );
-	mSplitComplexResult.imagp = (float *)malloc( mSizeOverTwo * sizeof( float ) );
+	if( fftSize < 2 || ! isPowerOf2( fftSize ) )
+		throw AudioExc( "invalid fft size, the native backend requires a power of two" );
 
-	mLog2FftSize = log2f( mSize );
-	mFftSetup = vDSP_create_fftsetup( mLog2FftSize, FFT_RADIX2 );
-	CI_ASSERT( mFftSetup );
+	return unique_ptr<FftBackend>( new FftBackendNative( fftSize ) );
 }
 
-Fft::~Fft()
+unique_ptr<FftBackend> makeFftBackendMixedRadix( size_t fftSize )
 {
-	free( mSplitComplexResult.realp );
-	free( mSplitComplexResult.imagp );
-	vDSP_destroy_fftsetup( mFftSetup );
+	return unique_ptr<FftBackend>( new FftMixedRadix( fftSize ) );
 }
 
-void Fft::forward( const Buffer *waveform, BufferSpectral *spectral )
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Fft
+// ----------------------------------------------------------------------------------------------------
+
+namespace {
+
+unique_ptr<FftBackend> makeDefaultBackend( size_t fftSize )
 {
-	CI_ASSERT( waveform->getNumFrames() == mSize );
-	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
+	{
+		lock_guard<mutex> lock( sDefaultBackendFactoryMutex );
+		if( sDefaultBackendFactory )
+			return sDefaultBackendFactory( fftSize );
+	}
 
-	mSplitComplexSignal.realp = spectral->getReal();
-	mSplitComplexSignal.imagp = spectral->getImag();
+	// FftMixedRadix outperforms Ooura's FFT when SSE is available, but not vDSP
+#if defined( CINDER_AUDIO_VDSP ) || ! defined( CINDER_AUDIO_SSE )
+	if( isPowerOf2( fftSize ) )
+		return makeFftBackendNative( fftSize );
+#endif
 
-	// in-place transfrom is okay here because we already first copy the data from waveform -> spectral
-	vDSP_ctoz( (::DSPComplex *)waveform->getData(), 2, &mSplitComplexSignal, 1, mSizeOverTwo );
-	vDSP_fft_zrip( mFftSetup, &mSplitComplexSignal, 1, mLog2FftSize, FFT_FORWARD );
+	return makeFftBackendMixedRadix( fftSize );
 }
 
-void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
-{
-	CI_ASSERT( waveform->getNumFrames() == mSize );
-	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
+} // anonymous namespace
 
-	mSplitComplexSignal.realp = const_cast<float *>( spectral->getReal() );
-	mSplitComplexSignal.imagp = const_cast<float *>( spectral->getImag() );
-	float *data = waveform->getData();
+Fft::Fft( size_t fftSize )
+	: Fft( makeDefaultBackend( fftSize ) )
+{
+}
 
-	// use out-of-place transfrom so as to not overwrite spectral
-	vDSP_fft_zrop( mFftSetup, &mSplitComplexSignal, 1, &mSplitComplexResult, 1, mLog2FftSize, FFT_INVERSE );
-	vDSP_ztoc( &mSplitComplexResult, 1, (::DSPComplex *)data, 2, mSizeOverTwo );
+Fft::Fft( unique_ptr<FftBackend> &&backend )
+	: mBackend( move( backend ) )
+{
+	if( ! mBackend )
+		throw AudioExc( "null fft backend" );
 
-	float scale = 1.0f / float( 2 * mSize );
-	vDSP_vsmul( data, 1, &scale, data, 1, mSize );
+	mSize = mBackend->getSize();
+	mSizeOverTwo = mSize / 2;
 }
 
-#elif defined( CINDER_AUDIO_FFT_OOURA )
-
-void Fft::init()
+Fft::~Fft()
 {
-	mOouraIp = (int *)calloc( 2 + (int)sqrt( mSizeOverTwo ), sizeof( int ) );
-	mOouraW = (float *)calloc( mSizeOverTwo, sizeof( float ) );
-	mBufferCopy = Buffer( mSize );
 }
 
-Fft::~Fft()
+void Fft::setDefaultBackendFactory( const FftBackendFactoryFn &factory )
 {
-	free( mOouraIp );
-	free( mOouraW );
+	lock_guard<mutex> lock( sDefaultBackendFactoryMutex );
+	sDefaultBackendFactory = factory;
 }
 
 void Fft::forward( const Buffer *waveform, BufferSpectral *spectral )
@@ -112,21 +250,7 @@ void Fft::forward( const Buffer *waveform, BufferSpectral *spectral )
 	CI_ASSERT( waveform->getNumFrames() == mSize );
 	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
 
-	mBufferCopy.copy( *waveform );
-
-	float *a = mBufferCopy.getData();
-	float *real = spectral->getReal();
-	float *imag = spectral->getImag();
-
-	ooura::rdft( (int)mSize, 1, a, mOouraIp, mOouraW );
-
-	real[0] = a[0];
-	imag[0] = a[1];
-
-	for( size_t k = 1; k < mSizeOverTwo; k++ ) {
-		real[k] = a[k * 2];
-		imag[k] = a[k * 2 + 1];
-	}
+	mBackend->forward( waveform->getData(), spectral->getReal(), spectral->getImag() );
 }
 
 void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
@@ -134,24 +258,48 @@ void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
 	CI_ASSERT( waveform->getNumFrames() == mSize );
 	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
 
-	mBufferCopy.copy( *spectral );
+	mBackend->inverse( spectral->getReal(), spectral->getImag(), waveform->getData() );
+}
 
-	float *real = mBufferCopy.getData();
-	float *imag = &mBufferCopy.getData()[mSizeOverTwo];
-	float *a = waveform->getData();
+// note: the pointer arrays only allocate when a larger batch than before is transformed
+void Fft::forward( const Buffer *waveforms, vector<BufferSpectral> *spectra )
+{
+	const size_t count = waveforms->getNumChannels();
+	CI_ASSERT( waveforms->getNumFrames() == mSize );
+	CI_ASSERT( spectra->size() >= count );
+
+	mBatchInputs.resize( count );
+	mBatchOutputs.resize( count );
+	mBatchOutputsImag.resize( count );
+	for( size_t i = 0; i < count; i++ ) {
+		CI_ASSERT( (*spectra)[i].getNumFrames() == mSizeOverTwo );
+
+		mBatchInputs[i] = waveforms->getChannel( i );
+		mBatchOutputs[i] = (*spectra)[i].getReal();
+		mBatchOutputsImag[i] = (*spectra)[i].getImag();
+	}
 
-	a[0] = real[0];
-	a[1] = imag[0];
+	mBackend->forwardBatch( mBatchInputs.data(), mBatchOutputs.data(), mBatchOutputsImag.data(), count );
+}
 
-	for( size_t k = 1; k < mSizeOverTwo; k++ ) {
-		a[k * 2] = real[k];
-		a[k * 2 + 1] = imag[k];
+void Fft::inverse( const vector<BufferSpectral> &spectra, Buffer *waveforms )
+{
+	const size_t count = spectra.size();
+	CI_ASSERT( waveforms->getNumFrames() == mSize );
+	CI_ASSERT( waveforms->getNumChannels() >= count );
+
+	// mBatchInputs holds the real parts followed by the imaginary parts
+	mBatchInputs.resize( count * 2 );
+	mBatchOutputs.resize( count );
+	for( size_t i = 0; i < count; i++ ) {
+		CI_ASSERT( spectra[i].getNumFrames() == mSizeOverTwo );
+
+		mBatchInputs[i] = spectra[i].getReal();
+		mBatchInputs[count + i] = spectra[i].getImag();
+		mBatchOutputs[i] = waveforms->getChannel( i );
 	}
 
-	ooura::rdft( (int)mSize, -1, a, mOouraIp, mOouraW );
-	dsp::mul( a, 2.0f / (float)mSize, a, mSize );
+	mBackend->inverseBatch( mBatchInputs.data(), mBatchInputs.data() + count, mBatchOutputs.data(), count );
 }
 
-#endif // defined( CINDER_AUDIO_FFT_OOURA )
-
 } } } // namespace cinder::audio::dsp
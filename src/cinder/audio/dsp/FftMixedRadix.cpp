@@ -0,0 +1,580 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/dsp/FftMixedRadix.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/CinderAssert.h"
+
+#if defined( CINDER_AUDIO_SSE )
+	#include <xmmintrin.h>
+#endif
+
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder { namespace audio { namespace dsp {
+
+namespace {
+
+const double kTwoPi = 6.283185307179586476925286766559;
+
+#if defined( CINDER_AUDIO_SSE )
+
+inline void cmulSse( __m128 ar, __m128 ai, __m128 br, __m128 bi, __m128 *resultRe, __m128 *resultIm )
+{
+	*resultRe = _mm_sub_ps( _mm_mul_ps( ar, br ), _mm_mul_ps( ai, bi ) );
+	*resultIm = _mm_add_ps( _mm_mul_ps( ar, bi ), _mm_mul_ps( ai, br ) );
+}
+
+#endif // defined( CINDER_AUDIO_SSE )
+
+} // anonymous namespace
+
+FftMixedRadix::FftMixedRadix( size_t fftSize )
+	: FftBackend( fftSize ), mComplexSize( fftSize / 2 )
+{
+	if( fftSize < 2 || fftSize % 2 )
+		throw AudioExc( "invalid fft size, FftMixedRadix requires an even size" );
+
+	// factor the complex size, radix-4 first so that all following stages have a stride that is a multiple of four
+	vector<size_t> radices;
+	size_t n = mComplexSize;
+	while( n % 4 == 0 ) {
+		radices.push_back( 4 );
+		n /= 4;
+	}
+	if( n % 2 == 0 ) {
+		radices.push_back( 2 );
+		n /= 2;
+	}
+	for( size_t f = 3; f * f <= n; f += 2 ) {
+		while( n % f == 0 ) {
+			radices.push_back( f );
+			n /= f;
+		}
+	}
+	if( n > 1 )
+		radices.push_back( n );
+
+	n = mComplexSize;
+	size_t stride = 1;
+	for( size_t radix : radices ) {
+		Stage stage;
+		stage.mRadix = radix;
+		stage.mStride = stride;
+		stage.mNumButterflies = n / radix;
+		stage.mTwiddleOffset = mTwiddlesRe.size();
+		stage.mRootsOffset = mRootsRe.size();
+
+		for( size_t k = 1; k < radix; k++ ) {
+			for( size_t p = 0; p < stage.mNumButterflies; p++ ) {
+				double theta = - kTwoPi * double( p * k ) / double( n );
+				mTwiddlesRe.push_back( (float)cos( theta ) );
+				mTwiddlesIm.push_back( (float)sin( theta ) );
+			}
+		}
+
+		if( radix > 5 ) {
+			for( size_t j = 0; j < radix; j++ ) {
+				double theta = - kTwoPi * double( j ) / double( radix );
+				mRootsRe.push_back( (float)cos( theta ) );
+				mRootsIm.push_back( (float)sin( theta ) );
+			}
+		}
+
+		mStages.push_back( stage );
+		n /= radix;
+		stride *= radix;
+	}
+
+	mSplitRe.resize( mComplexSize );
+	mSplitIm.resize( mComplexSize );
+	for( size_t k = 0; k < mComplexSize; k++ ) {
+		double theta = - kTwoPi * double( k ) / double( fftSize );
+		mSplitRe[k] = (float)cos( theta );
+		mSplitIm[k] = (float)sin( theta );
+	}
+
+	mBufferRe.resize( mComplexSize );
+	mBufferIm.resize( mComplexSize );
+	mWorkRe.resize( mComplexSize );
+	mWorkIm.resize( mComplexSize );
+	mResultRe.resize( mComplexSize );
+	mResultIm.resize( mComplexSize );
+}
+
+// The even samples are packed into the real part and the odd samples into the imaginary part of a complex sequence z of
+// length M = N / 2. With Z = FFT( z ), the real spectrum is X[k] = Xe[k] + W^k Xo[k], where
+// Xe[k] = ( Z[k] + conj( Z[M-k] ) ) / 2, Xo[k] = -i ( Z[k] - conj( Z[M-k] ) ) / 2 and W = e^(-2 pi i / N).
+void FftMixedRadix::forward( const float *waveform, float *real, float *imag )
+{
+	const size_t M = mComplexSize;
+	float *zr = mBufferRe.data();
+	float *zi = mBufferIm.data();
+
+	size_t n = 0;
+#if defined( CINDER_AUDIO_SSE )
+	for( ; n + 4 <= M; n += 4 ) {
+		__m128 a = _mm_loadu_ps( waveform + n * 2 );
+		__m128 b = _mm_loadu_ps( waveform + n * 2 + 4 );
+		_mm_storeu_ps( zr + n, _mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+		_mm_storeu_ps( zi + n, _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+	}
+#endif
+	for( ; n < M; n++ ) {
+		zr[n] = waveform[n * 2];
+		zi[n] = waveform[n * 2 + 1];
+	}
+
+	transformComplex( zr, zi, mResultRe.data(), mResultIm.data() );
+
+	const float *Zr = mResultRe.data();
+	const float *Zi = mResultIm.data();
+	const float *wr = mSplitRe.data();
+	const float *wi = mSplitIm.data();
+
+	real[0] = Zr[0] + Zi[0];
+	imag[0] = Zr[0] - Zi[0];
+
+	for( size_t k = 1; k < M; k++ ) {
+		float ar = Zr[k];
+		float ai = Zi[k];
+		float br = Zr[M - k];
+		float bi = - Zi[M - k];
+
+		float evenRe = 0.5f * ( ar + br );
+		float evenIm = 0.5f * ( ai + bi );
+		float oddRe = 0.5f * ( ai - bi );
+		float oddIm = - 0.5f * ( ar - br );
+
+		real[k] = evenRe + oddRe * wr[k] - oddIm * wi[k];
+		imag[k] = evenIm + oddRe * wi[k] + oddIm * wr[k];
+	}
+}
+
+// Reverses the split done in forward() and computes the inverse complex transform as swap( FFT( swap( Z ) ) ) / M,
+// where swap() exchanges the real and imaginary parts.
+void FftMixedRadix::inverse( const float *real, const float *imag, float *waveform )
+{
+	const size_t M = mComplexSize;
+	float *Zr = mBufferRe.data();
+	float *Zi = mBufferIm.data();
+	const float *wr = mSplitRe.data();
+	const float *wi = mSplitIm.data();
+
+	Zr[0] = 0.5f * ( real[0] + imag[0] );
+	Zi[0] = 0.5f * ( real[0] - imag[0] );
+
+	for( size_t k = 1; k < M; k++ ) {
+		float ar = real[k];
+		float ai = imag[k];
+		float br = real[M - k];
+		float bi = - imag[M - k];
+
+		float evenRe = 0.5f * ( ar + br );
+		float evenIm = 0.5f * ( ai + bi );
+		float diffRe = 0.5f * ( ar - br );
+		float diffIm = 0.5f * ( ai - bi );
+		float oddRe = diffRe * wr[k] + diffIm * wi[k];
+		float oddIm = diffIm * wr[k] - diffRe * wi[k];
+
+		Zr[k] = evenRe - oddIm;
+		Zi[k] = evenIm + oddRe;
+	}
+
+	transformComplex( Zi, Zr, mResultIm.data(), mResultRe.data() );
+
+	const float *zr = mResultRe.data();
+	const float *zi = mResultIm.data();
+	const float scale = 1.0f / float( M );
+
+	size_t n = 0;
+#if defined( CINDER_AUDIO_SSE )
+	const __m128 scaleVec = _mm_set1_ps( scale );
+	for( ; n + 4 <= M; n += 4 ) {
+		__m128 re = _mm_mul_ps( _mm_loadu_ps( zr + n ), scaleVec );
+		__m128 im = _mm_mul_ps( _mm_loadu_ps( zi + n ), scaleVec );
+		_mm_storeu_ps( waveform + n * 2, _mm_unpacklo_ps( re, im ) );
+		_mm_storeu_ps( waveform + n * 2 + 4, _mm_unpackhi_ps( re, im ) );
+	}
+#endif
+	for( ; n < M; n++ ) {
+		waveform[n * 2] = zr[n] * scale;
+		waveform[n * 2 + 1] = zi[n] * scale;
+	}
+}
+
+// Each stage reads from one buffer and writes to another (Stockham autosort), so no bit reversal is needed. re and im
+// are overwritten as they are used for intermediate results.
+void FftMixedRadix::transformComplex( float *re, float *im, float *outRe, float *outIm )
+{
+	if( mStages.empty() ) {
+		memcpy( outRe, re, mComplexSize * sizeof( float ) );
+		memcpy( outIm, im, mComplexSize * sizeof( float ) );
+		return;
+	}
+
+	float *srcRe = re;
+	float *srcIm = im;
+	for( size_t i = 0; i < mStages.size(); i++ ) {
+		float *dstRe, *dstIm;
+		if( i + 1 == mStages.size() ) {
+			dstRe = outRe;
+			dstIm = outIm;
+		}
+		else if( srcRe == mWorkRe.data() ) {
+			dstRe = re;
+			dstIm = im;
+		}
+		else {
+			dstRe = mWorkRe.data();
+			dstIm = mWorkIm.data();
+		}
+
+		const Stage &stage = mStages[i];
+		if( stage.mRadix == 4 )
+			processRadix4( stage, srcRe, srcIm, dstRe, dstIm );
+		else if( stage.mRadix == 2 )
+			processRadix2( stage, srcRe, srcIm, dstRe, dstIm );
+		else if( stage.mRadix == 3 )
+			processRadix3( stage, srcRe, srcIm, dstRe, dstIm );
+		else if( stage.mRadix == 5 )
+			processRadix5( stage, srcRe, srcIm, dstRe, dstIm );
+		else
+			processRadixGeneric( stage, srcRe, srcIm, dstRe, dstIm );
+
+		srcRe = dstRe;
+		srcIm = dstIm;
+	}
+}
+
+void FftMixedRadix::processRadix2( const Stage &stage, const float *xr, const float *xi, float *yr, float *yi )
+{
+	const size_t s = stage.mStride;
+	const size_t m = stage.mNumButterflies;
+	const float *twr = &mTwiddlesRe[stage.mTwiddleOffset];
+	const float *twi = &mTwiddlesIm[stage.mTwiddleOffset];
+
+	for( size_t p = 0; p < m; p++ ) {
+		const float *x0r = xr + s * p;
+		const float *x0i = xi + s * p;
+		const float *x1r = x0r + s * m;
+		const float *x1i = x0i + s * m;
+		float *y0r = yr + s * 2 * p;
+		float *y0i = yi + s * 2 * p;
+		float *y1r = y0r + s;
+		float *y1i = y0i + s;
+		const float wr = twr[p];
+		const float wi = twi[p];
+
+		size_t q = 0;
+#if defined( CINDER_AUDIO_SSE )
+		const __m128 wrVec = _mm_set1_ps( wr );
+		const __m128 wiVec = _mm_set1_ps( wi );
+		for( ; q + 4 <= s; q += 4 ) {
+			__m128 ar = _mm_loadu_ps( x0r + q ), ai = _mm_loadu_ps( x0i + q );
+			__m128 br = _mm_loadu_ps( x1r + q ), bi = _mm_loadu_ps( x1i + q );
+			_mm_storeu_ps( y0r + q, _mm_add_ps( ar, br ) );
+			_mm_storeu_ps( y0i + q, _mm_add_ps( ai, bi ) );
+
+			__m128 dr, di;
+			cmulSse( _mm_sub_ps( ar, br ), _mm_sub_ps( ai, bi ), wrVec, wiVec, &dr, &di );
+			_mm_storeu_ps( y1r + q, dr );
+			_mm_storeu_ps( y1i + q, di );
+		}
+#endif
+		for( ; q < s; q++ ) {
+			float ar = x0r[q], ai = x0i[q];
+			float br = x1r[q], bi = x1i[q];
+			y0r[q] = ar + br;
+			y0i[q] = ai + bi;
+
+			float dr = ar - br, di = ai - bi;
+			y1r[q] = dr * wr - di * wi;
+			y1i[q] = dr * wi + di * wr;
+		}
+	}
+}
+
+void FftMixedRadix::processRadix4( const Stage &stage, const float *xr, const float *xi, float *yr, float *yi )
+{
+	const size_t s = stage.mStride;
+	const size_t m = stage.mNumButterflies;
+	const float *tw1r = &mTwiddlesRe[stage.mTwiddleOffset];
+	const float *tw1i = &mTwiddlesIm[stage.mTwiddleOffset];
+	const float *tw2r = tw1r + m;
+	const float *tw2i = tw1i + m;
+	const float *tw3r = tw2r + m;
+	const float *tw3i = tw2i + m;
+
+	size_t pBegin = 0;
+
+#if defined( CINDER_AUDIO_SSE )
+	if( s == 1 ) {
+		// first stage: vectorize across four butterflies, whose outputs are transposed into 16 contiguous values
+		for( ; pBegin + 4 <= m; pBegin += 4 ) {
+			const size_t p = pBegin;
+			__m128 a0r = _mm_loadu_ps( xr + p ), a0i = _mm_loadu_ps( xi + p );
+			__m128 a1r = _mm_loadu_ps( xr + p + m ), a1i = _mm_loadu_ps( xi + p + m );
+			__m128 a2r = _mm_loadu_ps( xr + p + 2 * m ), a2i = _mm_loadu_ps( xi + p + 2 * m );
+			__m128 a3r = _mm_loadu_ps( xr + p + 3 * m ), a3i = _mm_loadu_ps( xi + p + 3 * m );
+
+			__m128 t0r = _mm_add_ps( a0r, a2r ), t0i = _mm_add_ps( a0i, a2i );
+			__m128 t1r = _mm_sub_ps( a0r, a2r ), t1i = _mm_sub_ps( a0i, a2i );
+			__m128 t2r = _mm_add_ps( a1r, a3r ), t2i = _mm_add_ps( a1i, a3i );
+			__m128 t3r = _mm_sub_ps( a1r, a3r ), t3i = _mm_sub_ps( a1i, a3i );
+
+			__m128 b0r = _mm_add_ps( t0r, t2r ), b0i = _mm_add_ps( t0i, t2i );
+			__m128 b1r, b1i, b2r, b2i, b3r, b3i;
+			cmulSse( _mm_add_ps( t1r, t3i ), _mm_sub_ps( t1i, t3r ), _mm_loadu_ps( tw1r + p ), _mm_loadu_ps( tw1i + p ), &b1r, &b1i );
+			cmulSse( _mm_sub_ps( t0r, t2r ), _mm_sub_ps( t0i, t2i ), _mm_loadu_ps( tw2r + p ), _mm_loadu_ps( tw2i + p ), &b2r, &b2i );
+			cmulSse( _mm_sub_ps( t1r, t3i ), _mm_add_ps( t1i, t3r ), _mm_loadu_ps( tw3r + p ), _mm_loadu_ps( tw3i + p ), &b3r, &b3i );
+
+			_MM_TRANSPOSE4_PS( b0r, b1r, b2r, b3r );
+			_MM_TRANSPOSE4_PS( b0i, b1i, b2i, b3i );
+
+			float *outR = yr + 4 * p;
+			float *outI = yi + 4 * p;
+			_mm_storeu_ps( outR, b0r );
+			_mm_storeu_ps( outR + 4, b1r );
+			_mm_storeu_ps( outR + 8, b2r );
+			_mm_storeu_ps( outR + 12, b3r );
+			_mm_storeu_ps( outI, b0i );
+			_mm_storeu_ps( outI + 4, b1i );
+			_mm_storeu_ps( outI + 8, b2i );
+			_mm_storeu_ps( outI + 12, b3i );
+		}
+	}
+#endif
+
+	for( size_t p = pBegin; p < m; p++ ) {
+		const float *x0r = xr + s * p, *x0i = xi + s * p;
+		const float *x1r = x0r + s * m, *x1i = x0i + s * m;
+		const float *x2r = x1r + s * m, *x2i = x1i + s * m;
+		const float *x3r = x2r + s * m, *x3i = x2i + s * m;
+		float *y0r = yr + s * 4 * p, *y0i = yi + s * 4 * p;
+		float *y1r = y0r + s, *y1i = y0i + s;
+		float *y2r = y1r + s, *y2i = y1i + s;
+		float *y3r = y2r + s, *y3i = y2i + s;
+
+		const float w1r = tw1r[p], w1i = tw1i[p];
+		const float w2r = tw2r[p], w2i = tw2i[p];
+		const float w3r = tw3r[p], w3i = tw3i[p];
+
+		size_t q = 0;
+#if defined( CINDER_AUDIO_SSE )
+		const __m128 w1rVec = _mm_set1_ps( w1r ), w1iVec = _mm_set1_ps( w1i );
+		const __m128 w2rVec = _mm_set1_ps( w2r ), w2iVec = _mm_set1_ps( w2i );
+		const __m128 w3rVec = _mm_set1_ps( w3r ), w3iVec = _mm_set1_ps( w3i );
+		for( ; q + 4 <= s; q += 4 ) {
+			__m128 a0r = _mm_loadu_ps( x0r + q ), a0i = _mm_loadu_ps( x0i + q );
+			__m128 a1r = _mm_loadu_ps( x1r + q ), a1i = _mm_loadu_ps( x1i + q );
+			__m128 a2r = _mm_loadu_ps( x2r + q ), a2i = _mm_loadu_ps( x2i + q );
+			__m128 a3r = _mm_loadu_ps( x3r + q ), a3i = _mm_loadu_ps( x3i + q );
+
+			__m128 t0r = _mm_add_ps( a0r, a2r ), t0i = _mm_add_ps( a0i, a2i );
+			__m128 t1r = _mm_sub_ps( a0r, a2r ), t1i = _mm_sub_ps( a0i, a2i );
+			__m128 t2r = _mm_add_ps( a1r, a3r ), t2i = _mm_add_ps( a1i, a3i );
+			__m128 t3r = _mm_sub_ps( a1r, a3r ), t3i = _mm_sub_ps( a1i, a3i );
+
+			_mm_storeu_ps( y0r + q, _mm_add_ps( t0r, t2r ) );
+			_mm_storeu_ps( y0i + q, _mm_add_ps( t0i, t2i ) );
+
+			__m128 br, bi;
+			cmulSse( _mm_add_ps( t1r, t3i ), _mm_sub_ps( t1i, t3r ), w1rVec, w1iVec, &br, &bi );
+			_mm_storeu_ps( y1r + q, br );
+			_mm_storeu_ps( y1i + q, bi );
+
+			cmulSse( _mm_sub_ps( t0r, t2r ), _mm_sub_ps( t0i, t2i ), w2rVec, w2iVec, &br, &bi );
+			_mm_storeu_ps( y2r + q, br );
+			_mm_storeu_ps( y2i + q, bi );
+
+			cmulSse( _mm_sub_ps( t1r, t3i ), _mm_add_ps( t1i, t3r ), w3rVec, w3iVec, &br, &bi );
+			_mm_storeu_ps( y3r + q, br );
+			_mm_storeu_ps( y3i + q, bi );
+		}
+#endif
+		for( ; q < s; q++ ) {
+			float t0r = x0r[q] + x2r[q], t0i = x0i[q] + x2i[q];
+			float t1r = x0r[q] - x2r[q], t1i = x0i[q] - x2i[q];
+			float t2r = x1r[q] + x3r[q], t2i = x1i[q] + x3i[q];
+			float t3r = x1r[q] - x3r[q], t3i = x1i[q] - x3i[q];
+
+			y0r[q] = t0r + t2r;
+			y0i[q] = t0i + t2i;
+
+			// b1 = t1 - i t3, b2 = t0 - t2, b3 = t1 + i t3, each multiplied by its twiddle
+			float br = t1r + t3i, bi = t1i - t3r;
+			y1r[q] = br * w1r - bi * w1i;
+			y1i[q] = br * w1i + bi * w1r;
+
+			br = t0r - t2r;
+			bi = t0i - t2i;
+			y2r[q] = br * w2r - bi * w2i;
+			y2i[q] = br * w2i + bi * w2r;
+
+			br = t1r - t3i;
+			bi = t1i + t3r;
+			y3r[q] = br * w3r - bi * w3i;
+			y3i[q] = br * w3i + bi * w3r;
+		}
+	}
+}
+
+void FftMixedRadix::processRadix3( const Stage &stage, const float *xr, const float *xi, float *yr, float *yi )
+{
+	const size_t s = stage.mStride;
+	const size_t m = stage.mNumButterflies;
+	const float *tw1r = &mTwiddlesRe[stage.mTwiddleOffset];
+	const float *tw1i = &mTwiddlesIm[stage.mTwiddleOffset];
+	const float *tw2r = tw1r + m;
+	const float *tw2i = tw1i + m;
+	const float sin60 = 0.86602540378443864676f;
+
+	for( size_t p = 0; p < m; p++ ) {
+		const float *x0r = xr + s * p, *x0i = xi + s * p;
+		const float *x1r = x0r + s * m, *x1i = x0i + s * m;
+		const float *x2r = x1r + s * m, *x2i = x1i + s * m;
+		float *y0r = yr + s * 3 * p, *y0i = yi + s * 3 * p;
+		float *y1r = y0r + s, *y1i = y0i + s;
+		float *y2r = y1r + s, *y2i = y1i + s;
+
+		const float w1r = tw1r[p], w1i = tw1i[p];
+		const float w2r = tw2r[p], w2i = tw2i[p];
+
+		for( size_t q = 0; q < s; q++ ) {
+			float sumRe = x1r[q] + x2r[q], sumIm = x1i[q] + x2i[q];
+			float diffRe = sin60 * ( x1r[q] - x2r[q] ), diffIm = sin60 * ( x1i[q] - x2i[q] );
+			float midRe = x0r[q] - 0.5f * sumRe, midIm = x0i[q] - 0.5f * sumIm;
+
+			y0r[q] = x0r[q] + sumRe;
+			y0i[q] = x0i[q] + sumIm;
+
+			// b1 = mid - i diff, b2 = mid + i diff
+			float br = midRe + diffIm, bi = midIm - diffRe;
+			y1r[q] = br * w1r - bi * w1i;
+			y1i[q] = br * w1i + bi * w1r;
+
+			br = midRe - diffIm;
+			bi = midIm + diffRe;
+			y2r[q] = br * w2r - bi * w2i;
+			y2i[q] = br * w2i + bi * w2r;
+		}
+	}
+}
+
+void FftMixedRadix::processRadix5( const Stage &stage, const float *xr, const float *xi, float *yr, float *yi )
+{
+	const size_t s = stage.mStride;
+	const size_t m = stage.mNumButterflies;
+	const float *twr = &mTwiddlesRe[stage.mTwiddleOffset];
+	const float *twi = &mTwiddlesIm[stage.mTwiddleOffset];
+	const float cos72 = 0.30901699437494742410f, sin72 = 0.95105651629515357212f;
+	const float cos144 = -0.80901699437494742410f, sin144 = 0.58778525229247312917f;
+
+	for( size_t p = 0; p < m; p++ ) {
+		const float *x0r = xr + s * p, *x0i = xi + s * p;
+		const float *x1r = x0r + s * m, *x1i = x0i + s * m;
+		const float *x2r = x1r + s * m, *x2i = x1i + s * m;
+		const float *x3r = x2r + s * m, *x3i = x2i + s * m;
+		const float *x4r = x3r + s * m, *x4i = x3i + s * m;
+		float *y0r = yr + s * 5 * p, *y0i = yi + s * 5 * p;
+
+		float wr[4], wi[4];
+		for( size_t k = 0; k < 4; k++ ) {
+			wr[k] = twr[k * m + p];
+			wi[k] = twi[k * m + p];
+		}
+
+		for( size_t q = 0; q < s; q++ ) {
+			float t1r = x1r[q] + x4r[q], t1i = x1i[q] + x4i[q];
+			float t2r = x2r[q] + x3r[q], t2i = x2i[q] + x3i[q];
+			float t3r = x1r[q] - x4r[q], t3i = x1i[q] - x4i[q];
+			float t4r = x2r[q] - x3r[q], t4i = x2i[q] - x3i[q];
+
+			float m1r = x0r[q] + cos72 * t1r + cos144 * t2r, m1i = x0i[q] + cos72 * t1i + cos144 * t2i;
+			float m2r = x0r[q] + cos144 * t1r + cos72 * t2r, m2i = x0i[q] + cos144 * t1i + cos72 * t2i;
+			float n1r = sin72 * t3r + sin144 * t4r, n1i = sin72 * t3i + sin144 * t4i;
+			float n2r = sin144 * t3r - sin72 * t4r, n2i = sin144 * t3i - sin72 * t4i;
+
+			y0r[q] = x0r[q] + t1r + t2r;
+			y0i[q] = x0i[q] + t1i + t2i;
+
+			// b1 = m1 - i n1, b2 = m2 - i n2, b3 = m2 + i n2, b4 = m1 + i n1, each multiplied by its twiddle
+			const float br[4] = { m1r + n1i, m2r + n2i, m2r - n2i, m1r - n1i };
+			const float bi[4] = { m1i - n1r, m2i - n2r, m2i + n2r, m1i + n1r };
+			for( size_t k = 0; k < 4; k++ ) {
+				y0r[q + s * ( k + 1 )] = br[k] * wr[k] - bi[k] * wi[k];
+				y0i[q + s * ( k + 1 )] = br[k] * wi[k] + bi[k] * wr[k];
+			}
+		}
+	}
+}
+
+// Direct DFT of size radix for each butterfly, with the stride as the innermost loop so that it vectorizes.
+void FftMixedRadix::processRadixGeneric( const Stage &stage, const float *xr, const float *xi, float *yr, float *yi )
+{
+	const size_t r = stage.mRadix;
+	const size_t s = stage.mStride;
+	const size_t m = stage.mNumButterflies;
+	const float *twr = &mTwiddlesRe[stage.mTwiddleOffset];
+	const float *twi = &mTwiddlesIm[stage.mTwiddleOffset];
+	const float *rootsRe = &mRootsRe[stage.mRootsOffset];
+	const float *rootsIm = &mRootsIm[stage.mRootsOffset];
+
+	for( size_t p = 0; p < m; p++ ) {
+		for( size_t k = 0; k < r; k++ ) {
+			float *outR = yr + s * ( r * p + k );
+			float *outI = yi + s * ( r * p + k );
+
+			memcpy( outR, xr + s * p, s * sizeof( float ) );
+			memcpy( outI, xi + s * p, s * sizeof( float ) );
+
+			for( size_t j = 1; j < r; j++ ) {
+				const float *inR = xr + s * ( p + j * m );
+				const float *inI = xi + s * ( p + j * m );
+				const float cr = rootsRe[( j * k ) % r];
+				const float ci = rootsIm[( j * k ) % r];
+				for( size_t q = 0; q < s; q++ ) {
+					outR[q] += inR[q] * cr - inI[q] * ci;
+					outI[q] += inR[q] * ci + inI[q] * cr;
+				}
+			}
+
+			if( k != 0 && p != 0 ) {
+				const float wr = twr[( k - 1 ) * m + p];
+				const float wi = twi[( k - 1 ) * m + p];
+				for( size_t q = 0; q < s; q++ ) {
+					float re = outR[q];
+					float im = outI[q];
+					outR[q] = re * wr - im * wi;
+					outI[q] = re * wi + im * wr;
+				}
+			}
+		}
+	}
+}
+
+} } } // namespace cinder::audio::dsp
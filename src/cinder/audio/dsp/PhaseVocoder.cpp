@@ -0,0 +1,318 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cinder/audio/dsp/PhaseVocoder.h"
+#include "cinder/audio/dsp/Fft.h"
+#include "cinder/audio/dsp/Dsp.h"
+#include "cinder/CinderMath.h"
+
+#include <cmath>
+
+using namespace std;
+
+namespace cinder { namespace audio { namespace dsp {
+
+namespace {
+
+const float TWO_PI = 6.283185307179586f;
+const float INV_TWO_PI = 1.0f / TWO_PI;
+const float MIN_RATIO = 1.0f / 16.0f;
+const float MAX_RATIO = 16.0f;
+// a frame is a transient when its frequency-weighted energy increase is larger than this times the previous frame's frequency-weighted energy
+const float TRANSIENT_RATIO = 1.0f;
+// frequency-weighted mean squared amplitude below which energy increases are not considered transients
+const float TRANSIENT_FLOOR = 1e-8f;
+
+inline float wrapPhase( float phase )
+{
+	return phase - TWO_PI * floor( phase * INV_TWO_PI + 0.5f );
+}
+
+} // anonymous namespace
+
+PhaseVocoder::PhaseVocoder( size_t numChannels, Quality quality )
+	: mNumChannels( numChannels ), mQuality( quality ), mRate( 1 ), mPitch( 1 ), mTransientDetection( true ), mNumTransients( 0 )
+{
+	size_t overlap;
+	switch( quality ) {
+		case Quality::LOW:		mFftSize = 1024; overlap = 4; break;
+		case Quality::HIGH:		mFftSize = 4096; overlap = 8; break;
+		case Quality::MEDIUM:
+		default:				mFftSize = 2048; overlap = 4; break;
+	}
+
+	mHopSize = mFftSize / overlap;
+	mNumBins = mFftSize / 2;
+
+	mFft.reset( new Fft( mFftSize ) );
+	mWindow = makeAlignedArray<float>( mFftSize );
+	generateWindow( WindowType::HANN, mWindow.get(), mFftSize );
+
+	mNormalization = makeAlignedArray<float>( mHopSize );
+	for( size_t i = 0; i < mHopSize; i++ ) {
+		float windowSquaredSum = 0;
+		for( size_t j = i; j < mFftSize; j += mHopSize )
+			windowSquaredSum += mWindow.get()[j] * mWindow.get()[j];
+
+		mNormalization.get()[i] = windowSquaredSum > 1e-6f ? 1.0f / windowSquaredSum : 0;
+	}
+
+	mFrame = Buffer( mFftSize );
+	mSpectrum = BufferSpectral( mFftSize );
+	mPeaks.reserve( mNumBins );
+
+	mInputWindows = Buffer( mFftSize, numChannels );
+	mOutputAccum = Buffer( mFftSize, numChannels );
+	mMagnitudes = Buffer( mNumBins, numChannels );
+	mPrevMagnitudes = Buffer( mNumBins, numChannels );
+	mRotations = Buffer( mNumBins, numChannels );
+	mSpectra.assign( numChannels, BufferSpectral( mFftSize ) );
+	mPrevSpectra.assign( numChannels, BufferSpectral( mFftSize ) );
+
+	reset();
+}
+
+PhaseVocoder::~PhaseVocoder()
+{
+}
+
+void PhaseVocoder::setRate( float rate )
+{
+	mRate = math<float>::clamp( rate, MIN_RATIO, MAX_RATIO );
+}
+
+void PhaseVocoder::setPitch( float pitch )
+{
+	mPitch = math<float>::clamp( pitch, MIN_RATIO, MAX_RATIO );
+}
+
+size_t PhaseVocoder::getMaxInputFramesNeeded() const
+{
+	return size_t( ceil( mHopSize * MAX_RATIO ) ) + 1;
+}
+
+size_t PhaseVocoder::getTailFrames() const
+{
+	return size_t( ceil( mFftSize / mRate ) ) + getLatency();
+}
+
+void PhaseVocoder::reset()
+{
+	mInputWindows.zero();
+	mOutputAccum.zero();
+	mPrevMagnitudes.zero();
+	mRotations.zero();
+	for( auto &spectrum : mPrevSpectra )
+		spectrum.zero();
+
+	// the input windows start out silent, so the first input frames enter at the end of the window and attacks at the start are not faded in
+	mNumPrimingFrames = mFftSize;
+	mNumInputFramesNeeded = mHopSize;
+	mAnalysisHopRemainder = 0;
+}
+
+void PhaseVocoder::process( const Buffer &input, Buffer *output )
+{
+	CI_ASSERT( input.getNumChannels() >= mNumChannels && input.getNumFrames() >= mNumInputFramesNeeded );
+	CI_ASSERT( output->getNumChannels() >= mNumChannels && output->getNumFrames() >= mHopSize );
+
+	const size_t numNewFrames = mNumInputFramesNeeded;
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		float *window = mInputWindows.getChannel( ch );
+		const float *channel = input.getChannel( ch );
+		if( numNewFrames < mFftSize ) {
+			memmove( window, window + numNewFrames, ( mFftSize - numNewFrames ) * sizeof( float ) );
+			memcpy( window + mFftSize - numNewFrames, channel, numNewFrames * sizeof( float ) );
+		}
+		else
+			memcpy( window, channel + numNewFrames - mFftSize, mFftSize * sizeof( float ) );
+	}
+
+	analyze();
+
+	// Until the input windows are full, the relation between neighboring bins' phases reflects the silence that is still in them,
+	// so the phases are reset instead of propagated. Otherwise each peak would keep sounding from where it was in the first window.
+	bool resetPhases = mNumPrimingFrames > 0;
+	mNumPrimingFrames -= min( mNumPrimingFrames, numNewFrames );
+
+	if( ! resetPhases && mTransientDetection && detectTransient() ) {
+		resetPhases = true;
+		mNumTransients++;
+	}
+
+	synthesize( resetPhases, numNewFrames, output );
+
+	mSpectra.swap( mPrevSpectra );
+	mPrevMagnitudes.copy( mMagnitudes );
+
+	// the analysis hop is fractional in general, the remainder carries over so that the average rate is exact
+	mAnalysisHopRemainder += double( mHopSize ) * double( mRate );
+	mNumInputFramesNeeded = size_t( mAnalysisHopRemainder );
+	mAnalysisHopRemainder -= double( mNumInputFramesNeeded );
+}
+
+void PhaseVocoder::analyze()
+{
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		mul( mInputWindows.getChannel( ch ), mWindow.get(), mFrame.getData(), mFftSize );
+		mFft->forward( &mFrame, &mSpectra[ch] );
+
+		const float *real = mSpectra[ch].getReal();
+		const float *imag = mSpectra[ch].getImag();
+		float *magnitudes = mMagnitudes.getChannel( ch );
+
+		// squared magnitudes are enough for finding peaks and measuring energy. Bin zero holds the DC and nyquist components, which are never peaks.
+		magnitudes[0] = 0;
+		for( size_t k = 1; k < mNumBins; k++ )
+			magnitudes[k] = real[k] * real[k] + imag[k] * imag[k];
+	}
+}
+
+bool PhaseVocoder::detectTransient() const
+{
+	// high frequencies are weighted more, since that's where an attack stands out from the sustained sound before it
+	float increase = 0;
+	float prevEnergy = 0;
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		const float *energies = mMagnitudes.getChannel( ch );
+		const float *prevEnergies = mPrevMagnitudes.getChannel( ch );
+		for( size_t k = 1; k < mNumBins; k++ ) {
+			increase += float( k ) * max( 0.0f, energies[k] - prevEnergies[k] );
+			prevEnergy += float( k ) * prevEnergies[k];
+		}
+	}
+
+	// magnitudes of a sinusoid's bin are a quarter of the FFT size times its amplitude, given the Hann window
+	const float amplitudeScale = 4.0f / float( mFftSize );
+	const float weightSum = 0.5f * float( mNumBins ) * float( mNumBins ) * float( mNumChannels );
+	const float meanIncrease = increase * amplitudeScale * amplitudeScale / weightSum;
+
+	return increase > TRANSIENT_RATIO * prevEnergy && meanIncrease > TRANSIENT_FLOOR;
+}
+
+// Identity phase locking (Laroche and Dolson): only spectral peaks are propagated at their instantaneous frequency, the bins in each peak's
+// region keep their analyzed phase relative to the peak. The whole region is therefore rotated by the same angle, which is applied with a
+// complex multiply, so trigonometry is only computed once per peak. When pitch-shifting, each region is moved as a whole to the bin nearest
+// its peak's scaled frequency, which preserves the shape of its main lobe. The exact frequency comes from the phase advance.
+void PhaseVocoder::synthesize( bool resetPhases, size_t analysisHop, Buffer *output )
+{
+	const float *window = mWindow.get();
+	const float binToRadians = TWO_PI / float( mFftSize );
+	const float invAnalysisHop = 1.0f / float( analysisHop );
+	const float phaseAdvanceScale = mPitch * float( mHopSize );
+	const size_t overlap = mFftSize - mHopSize;
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		const float *real = mSpectra[ch].getReal();
+		const float *imag = mSpectra[ch].getImag();
+		const float *prevReal = mPrevSpectra[ch].getReal();
+		const float *prevImag = mPrevSpectra[ch].getImag();
+		float *rotations = mRotations.getChannel( ch );
+		float *outReal = mSpectrum.getReal();
+		float *outImag = mSpectrum.getImag();
+
+		findPeaks( mMagnitudes.getChannel( ch ) );
+
+		if( resetPhases || mPeaks.empty() ) {
+			// output the analyzed spectrum as is. Without peaks (silence), the rotations are kept for when there are peaks again.
+			if( resetPhases )
+				memset( rotations, 0, mNumBins * sizeof( float ) );
+
+			if( mPitch == 1 )
+				mSpectrum.copy( mSpectra[ch] );
+			else {
+				mSpectrum.zero();
+				outReal[0] = real[0];
+				for( size_t k = 1; k < mNumBins; k++ ) {
+					const size_t j = size_t( float( k ) * mPitch + 0.5f );
+					if( j >= mNumBins )
+						break;
+
+					outReal[j] += real[k];
+					outImag[j] += imag[k];
+				}
+			}
+		}
+		else {
+			mSpectrum.zero();
+			outReal[0] = real[0];
+			if( mPitch == 1 )
+				outImag[0] = imag[0];
+
+			size_t regionBegin = 1;
+			for( size_t i = 0; i < mPeaks.size(); i++ ) {
+				const size_t peak = mPeaks[i];
+				const size_t regionEnd = i + 1 < mPeaks.size() ? ( peak + mPeaks[i + 1] + 1 ) / 2 : mNumBins;
+
+				// phase advance of the peak over the analysis hop, X[peak] * conj( prevX[peak] ), unwrapped around the advance expected for its bin
+				const float advanceReal = real[peak] * prevReal[peak] + imag[peak] * prevImag[peak];
+				const float advanceImag = imag[peak] * prevReal[peak] - real[peak] * prevImag[peak];
+				const float advance = atan2( advanceImag, advanceReal );
+				const float expectedAdvance = binToRadians * float( peak ) * float( analysisHop );
+				const float freq = binToRadians * float( peak ) + wrapPhase( advance - expectedAdvance ) * invAnalysisHop;
+
+				// the synthesized phase advances by the scaled frequency instead, the difference is the rotation applied to the region
+				const float rotation = wrapPhase( rotations[peak] + freq * phaseAdvanceScale - advance );
+				const float rotationReal = cos( rotation );
+				const float rotationImag = sin( rotation );
+
+				const ptrdiff_t shift = mPitch == 1 ? 0 : ptrdiff_t( float( peak ) * mPitch + 0.5f ) - ptrdiff_t( peak );
+				const size_t begin = size_t( max<ptrdiff_t>( ptrdiff_t( regionBegin ), 1 - shift ) );
+				const size_t end = size_t( max<ptrdiff_t>( 0, min<ptrdiff_t>( ptrdiff_t( regionEnd ), ptrdiff_t( mNumBins ) - shift ) ) );
+				for( size_t k = begin; k < end; k++ ) {
+					outReal[k + shift] += real[k] * rotationReal - imag[k] * rotationImag;
+					outImag[k + shift] += real[k] * rotationImag + imag[k] * rotationReal;
+				}
+
+				for( size_t k = regionBegin; k < regionEnd; k++ )
+					rotations[k] = rotation;
+
+				regionBegin = regionEnd;
+			}
+		}
+
+		mFft->inverse( &mSpectrum, &mFrame );
+
+		float *frame = mFrame.getData();
+		float *accum = mOutputAccum.getChannel( ch );
+		mul( frame, window, frame, mFftSize );
+		add( accum, frame, accum, mFftSize );
+
+		// the first hop is now complete, shift everything else down by one hop
+		mul( accum, mNormalization.get(), output->getChannel( ch ), mHopSize );
+		memmove( accum, accum + mHopSize, overlap * sizeof( float ) );
+		memset( accum + overlap, 0, mHopSize * sizeof( float ) );
+	}
+}
+
+void PhaseVocoder::findPeaks( const float *magnitudes )
+{
+	mPeaks.clear();
+	for( size_t k = 2; k + 2 < mNumBins; k++ ) {
+		const float m = magnitudes[k];
+		if( m > magnitudes[k - 1] && m >= magnitudes[k + 1] && m > magnitudes[k - 2] && m >= magnitudes[k + 2] )
+			mPeaks.push_back( k );
+	}
+}
+
+} } } // namespace cinder::audio::dsp
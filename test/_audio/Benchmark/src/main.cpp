@@ -0,0 +1,471 @@
+// Command-line benchmark that builds large synthetic audio graphs and renders them without an audio device,
+// reporting the cost of each graph in nanoseconds per frame per Node and the number of heap allocations made while rendering.
+//
+// usage: Benchmark [--scenario name] [--size n] [--blocks n] [--frames-per-block n] [--profile] [--fail-on-alloc] [--kernels]
+//
+// With --kernels, the Fft backends, samplerate Converters and interleave / sample format conversion routines are timed instead.
+//
+// The process exits with a non-zero code if --fail-on-alloc is specified and any allocations were made while rendering,
+// so it can be run as part of a build to catch regressions in the audio engine.
+
+#include "cinder/audio/Context.h"
+#include "cinder/audio/OutputNode.h"
+#include "cinder/audio/GenNode.h"
+#include "cinder/audio/GainNode.h"
+#include "cinder/audio/FilterNode.h"
+#include "cinder/audio/ChannelRouterNode.h"
+#include "cinder/audio/dsp/Fft.h"
+#include "cinder/audio/dsp/Converter.h"
+#include "cinder/audio/dsp/ConverterPolyphase.h"
+#include "cinder/audio/dsp/ConverterR8brain.h"
+#include "cinder/Rand.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace ci;
+using namespace std;
+
+// MARK: - Allocation tracking
+
+namespace {
+
+// Rendering happens on the main thread, so a plain flag is enough to tell which allocations are made during a processing block.
+bool					sIsRendering = false;
+atomic<uint64_t>		sNumRenderAllocations( 0 );
+
+} // anonymous namespace
+
+void* operator new( size_t size )
+{
+	if( sIsRendering )
+		sNumRenderAllocations++;
+
+	void *result = malloc( size ? size : 1 );
+	if( ! result )
+		throw bad_alloc();
+
+	return result;
+}
+
+void operator delete( void *ptr ) throw()
+{
+	free( ptr );
+}
+
+// MARK: - Headless Context
+
+namespace {
+
+//! OutputNode that renders its inputs when asked to, instead of from a hardware device's callback.
+class BenchmarkOutputNode : public audio::OutputNode {
+  public:
+	BenchmarkOutputNode( size_t sampleRate, size_t framesPerBlock )
+		: OutputNode( Format().channels( 2 ) ), mSampleRate( sampleRate ), mFramesPerBlock( framesPerBlock )
+	{}
+
+	size_t getOutputSampleRate() override		{ return mSampleRate; }
+	size_t getOutputFramesPerBlock() override	{ return mFramesPerBlock; }
+
+	//! Renders one processing block, the same way an OutputDeviceNode does from its device callback.
+	void renderBlock()
+	{
+		auto ctx = getContext();
+		lock_guard<mutex> lock( ctx->getMutex() );
+
+		ctx->preProcess();
+
+		auto internalBuffer = getInternalBuffer();
+		internalBuffer->zero();
+		pullInputs( internalBuffer );
+
+		ctx->postProcess();
+	}
+
+  private:
+	size_t mSampleRate, mFramesPerBlock;
+};
+
+typedef shared_ptr<BenchmarkOutputNode>	BenchmarkOutputNodeRef;
+
+//! Context that has no hardware devices.
+class BenchmarkContext : public audio::Context {
+  public:
+	audio::OutputDeviceNodeRef	createOutputDeviceNode( const audio::DeviceRef &device, const audio::Node::Format &format ) override	{ return nullptr; }
+	audio::InputDeviceNodeRef	createInputDeviceNode( const audio::DeviceRef &device, const audio::Node::Format &format ) override		{ return nullptr; }
+};
+
+} // anonymous namespace
+
+// MARK: - Scenarios
+
+namespace {
+
+const size_t SAMPLE_RATE = 44100;
+const size_t NUM_ROUTER_CHANNELS = 8;
+
+//! Builds a graph of roughly \a size Node's connected to \a output, returning the number of Node's that were created.
+typedef function<size_t ( audio::Context *ctx, const audio::NodeRef &output, size_t size )>	GraphBuilder;
+
+struct Scenario {
+	string			mName, mDescription;
+	size_t			mDefaultSize;
+	GraphBuilder	mBuild;
+};
+
+// A single oscillator followed by a long chain of GainNode's, which measures the per Node overhead of pulling a deep graph.
+size_t buildChain( audio::Context *ctx, const audio::NodeRef &output, size_t size )
+{
+	auto osc = ctx->makeNode( new audio::GenOscNode( audio::WaveformType::SAWTOOTH, 220 ) );
+	osc->enable();
+
+	audio::NodeRef last = osc;
+	for( size_t i = 0; i < size; i++ ) {
+		auto gain = ctx->makeNode( new audio::GainNode( 0.999f ) );
+		last = last >> gain;
+	}
+
+	last >> output;
+	return size + 1;
+}
+
+// Many oscillators summed into one GainNode, which measures band-limited oscillator cost and summing of inputs.
+size_t buildFanIn( audio::Context *ctx, const audio::NodeRef &output, size_t size )
+{
+	auto mix = ctx->makeNode( new audio::GainNode( 1.0f / float( size ) ) );
+	for( size_t i = 0; i < size; i++ ) {
+		auto osc = ctx->makeNode( new audio::GenOscNode( audio::WaveformType::SAWTOOTH, 55.0f + 13.0f * float( i ) ) );
+		osc->enable();
+		osc >> mix;
+	}
+
+	mix >> output;
+	return size + 1;
+}
+
+// One noise source split into a bank of band-pass filters, which measures biquad cost and a Node with many outputs.
+size_t buildFilterBank( audio::Context *ctx, const audio::NodeRef &output, size_t size )
+{
+	auto noise = ctx->makeNode( new audio::GenNoiseNode );
+	noise->enable();
+
+	auto mix = ctx->makeNode( new audio::GainNode( 1.0f / float( size ) ) );
+	for( size_t i = 0; i < size; i++ ) {
+		auto filter = ctx->makeNode( new audio::FilterBandPassNode );
+		filter->setCenterFreq( 100.0f + 17000.0f * float( i ) / float( size ) );
+		filter->setQ( 10 );
+		noise >> filter >> mix;
+	}
+
+	mix >> output;
+	return size + 2;
+}
+
+// Many mono oscillators routed into the channels of a multichannel ChannelRouterNode, which is then folded down to stereo by a second one.
+size_t buildRouterMatrix( audio::Context *ctx, const audio::NodeRef &output, size_t size )
+{
+	auto router = ctx->makeNode( new audio::ChannelRouterNode( audio::Node::Format().channels( NUM_ROUTER_CHANNELS ) ) );
+	for( size_t i = 0; i < size; i++ ) {
+		auto osc = ctx->makeNode( new audio::GenSineNode( 110.0f + 7.0f * float( i ) ) );
+		osc->enable();
+		osc >> router->route( 0, i % NUM_ROUTER_CHANNELS, 1 );
+	}
+
+	auto stereoRouter = ctx->makeNode( new audio::ChannelRouterNode( audio::Node::Format().channels( 2 ) ) );
+	for( size_t ch = 0; ch < NUM_ROUTER_CHANNELS; ch++ )
+		router >> stereoRouter->route( ch, ch % 2, 1 );
+
+	auto gain = ctx->makeNode( new audio::GainNode( 1.0f / float( size ) ) );
+	stereoRouter >> gain >> output;
+	return size + 3;
+}
+
+vector<Scenario> makeScenarios()
+{
+	vector<Scenario> result;
+	result.push_back( { "chain", "GenOscNode >> GainNode x size", 256, buildChain } );
+	result.push_back( { "fan-in", "GenOscNode x size >> GainNode", 256, buildFanIn } );
+	result.push_back( { "filter-bank", "GenNoiseNode >> FilterBandPassNode x size >> GainNode", 128, buildFilterBank } );
+	result.push_back( { "router-matrix", "GenSineNode x size >> ChannelRouterNode (8 ch) >> ChannelRouterNode (2 ch)", 128, buildRouterMatrix } );
+	return result;
+}
+
+} // anonymous namespace
+
+// MARK: - Kernels
+
+namespace {
+
+void fillRandom( audio::Buffer *buffer )
+{
+	for( size_t i = 0; i < buffer->getSize(); i++ )
+		buffer->getData()[i] = randFloat( -1, 1 );
+}
+
+// Returns the average nanoseconds per call of \a fn, called \a numIterations times.
+template <typename FnT>
+double timeNanoseconds( const FnT &fn, size_t numIterations )
+{
+	uint64_t startTime = audio::Profiler::now();
+	for( size_t i = 0; i < numIterations; i++ )
+		fn();
+
+	return double( audio::Profiler::now() - startTime ) / double( numIterations );
+}
+
+// Returns the nanoseconds per forward + inverse transform of \a fft.
+double timeFft( audio::dsp::Fft &fft )
+{
+	const size_t sizeFft = fft.getSize();
+	audio::Buffer waveform( sizeFft );
+	audio::BufferSpectral spectral( sizeFft );
+	fillRandom( &waveform );
+
+	auto transform = [&] {
+		fft.forward( &waveform, &spectral );
+		fft.inverse( &spectral, &waveform );
+	};
+
+	return timeNanoseconds( transform, max<size_t>( 4, ( 1 << 22 ) / sizeFft ) );
+}
+
+// Returns the nanoseconds per source sample of converting blocks with \a converter.
+double timeConverter( audio::dsp::Converter *converter )
+{
+	audio::Buffer source( converter->getSourceMaxFramesPerBlock(), converter->getSourceNumChannels() );
+	audio::Buffer dest( converter->getDestMaxFramesPerBlock(), converter->getDestNumChannels() );
+	fillRandom( &source );
+
+	return timeNanoseconds( [&] { converter->convert( &source, &dest ); }, 400 ) / double( source.getSize() );
+}
+
+void benchmarkFft()
+{
+	printf( "Fft, ns per forward + inverse transform:\n" );
+	printf( "%-10s %14s %14s\n", "size", "native", "mixed radix" );
+	for( size_t sizeFft = 64; sizeFft <= 65536; sizeFft *= 2 ) {
+		audio::dsp::Fft fftNative( audio::dsp::makeFftBackendNative( sizeFft ) );
+		audio::dsp::Fft fftMixedRadix( audio::dsp::makeFftBackendMixedRadix( sizeFft ) );
+		printf( "%-10d %14.1f %14.1f\n", (int)sizeFft, timeFft( fftNative ), timeFft( fftMixedRadix ) );
+	}
+
+	// sizes that aren't a power of two only have the mixed radix backend
+	const size_t mixedRadixSizes[] = { 96, 480, 1536, 6000, 24000, 48000 };
+	for( size_t sizeFft : mixedRadixSizes ) {
+		audio::dsp::Fft fftMixedRadix( audio::dsp::makeFftBackendMixedRadix( sizeFft ) );
+		printf( "%-10d %14s %14.1f\n", (int)sizeFft, "-", timeFft( fftMixedRadix ) );
+	}
+}
+
+void benchmarkConverters( size_t framesPerBlock )
+{
+	typedef audio::dsp::ConverterImplPolyphase::Quality Quality;
+
+	printf( "\nConverter, ns per source sample (stereo):\n" );
+	printf( "%-16s %10s %10s %10s %10s\n", "rates", "r8brain", "low", "medium", "high" );
+
+	const size_t rates[][2] = { { 44100, 48000 }, { 48000, 44100 }, { 44100, 96000 }, { 96000, 44100 }, { 48000, 96000 }, { 96000, 48000 } };
+	for( const auto &rate : rates ) {
+		audio::dsp::ConverterImplR8brain r8brain( rate[0], rate[1], 2, 2, framesPerBlock );
+		audio::dsp::ConverterImplPolyphase low( rate[0], rate[1], 2, 2, framesPerBlock, Quality::LOW );
+		audio::dsp::ConverterImplPolyphase medium( rate[0], rate[1], 2, 2, framesPerBlock, Quality::MEDIUM );
+		audio::dsp::ConverterImplPolyphase high( rate[0], rate[1], 2, 2, framesPerBlock, Quality::HIGH );
+
+		string rateLabel = to_string( rate[0] ) + " -> " + to_string( rate[1] );
+		printf( "%-16s %10.2f %10.2f %10.2f %10.2f\n", rateLabel.c_str(), timeConverter( &r8brain ), timeConverter( &low ), timeConverter( &medium ), timeConverter( &high ) );
+	}
+}
+
+void benchmarkInterleave( size_t framesPerBlock )
+{
+	const size_t numIterations = 2000;
+
+	printf( "\nInterleave, ns per sample (generic / SIMD):\n" );
+	printf( "%-10s %20s %20s %20s\n", "channels", "interleave", "deinterleave", "deinterleave int16" );
+
+	const size_t channelCounts[] = { 1, 2, 4, 6, 8 };
+	for( size_t numChannels : channelCounts ) {
+		audio::Buffer planar( framesPerBlock, numChannels );
+		fillRandom( &planar );
+		vector<float> interleaved( framesPerBlock * numChannels );
+		vector<int16_t> interleavedInt16( framesPerBlock * numChannels );
+		const double numSamples = double( planar.getSize() );
+
+		auto interleaveGeneric = [&] { audio::dsp::interleave<float>( planar.getData(), interleaved.data(), framesPerBlock, numChannels, framesPerBlock ); };
+		auto interleaveSimd = [&] { audio::dsp::interleave( planar.getData(), interleaved.data(), framesPerBlock, numChannels, framesPerBlock ); };
+		auto deinterleaveGeneric = [&] { audio::dsp::deinterleave<float>( interleaved.data(), planar.getData(), framesPerBlock, numChannels, framesPerBlock ); };
+		auto deinterleaveSimd = [&] { audio::dsp::deinterleave( interleaved.data(), planar.getData(), framesPerBlock, numChannels, framesPerBlock ); };
+		auto deinterleaveInt16Generic = [&] { audio::dsp::deinterleave<float>( interleavedInt16.data(), planar.getData(), framesPerBlock, numChannels, framesPerBlock ); };
+		auto deinterleaveInt16Simd = [&] { audio::dsp::deinterleave( interleavedInt16.data(), planar.getData(), framesPerBlock, numChannels, framesPerBlock ); };
+
+		printf( "%-10d %9.3f / %8.3f %9.3f / %8.3f %9.3f / %8.3f\n", (int)numChannels,
+				timeNanoseconds( interleaveGeneric, numIterations ) / numSamples, timeNanoseconds( interleaveSimd, numIterations ) / numSamples,
+				timeNanoseconds( deinterleaveGeneric, numIterations ) / numSamples, timeNanoseconds( deinterleaveSimd, numIterations ) / numSamples,
+				timeNanoseconds( deinterleaveInt16Generic, numIterations ) / numSamples, timeNanoseconds( deinterleaveInt16Simd, numIterations ) / numSamples );
+	}
+
+	vector<char> int24( framesPerBlock * 2 * 3 );
+	vector<float> converted( framesPerBlock * 2 );
+	const double numSamples = double( converted.size() );
+	auto int24Generic = [&] { audio::dsp::convertInt24ToFloat<float>( int24.data(), converted.data(), converted.size() ); };
+	auto int24Simd = [&] { audio::dsp::convertInt24ToFloat( int24.data(), converted.data(), converted.size() ); };
+	printf( "\nint24 to float, ns per sample: %.3f / %.3f\n", timeNanoseconds( int24Generic, numIterations ) / numSamples, timeNanoseconds( int24Simd, numIterations ) / numSamples );
+}
+
+} // anonymous namespace
+
+// MARK: - Runner
+
+namespace {
+
+struct Options {
+	Options() : mSize( 0 ), mNumBlocks( 1000 ), mFramesPerBlock( 512 ), mProfile( false ), mFailOnAlloc( false ), mKernels( false )	{}
+
+	string	mScenario;
+	size_t	mSize, mNumBlocks, mFramesPerBlock;
+	bool	mProfile, mFailOnAlloc, mKernels;
+};
+
+struct Result {
+	size_t		mNumNodes;
+	double		mNanosecondsPerFrame, mNanosecondsPerFramePerNode, mLoad;
+	uint64_t	mNumAllocations;
+	size_t		mSummingArenaBytes;
+	string		mProfile;
+};
+
+const size_t NUM_WARMUP_BLOCKS = 8;
+
+Result runScenario( const Scenario &scenario, const Options &options )
+{
+	auto ctx = make_shared<BenchmarkContext>();
+	auto output = ctx->makeNode( new BenchmarkOutputNode( SAMPLE_RATE, options.mFramesPerBlock ) );
+	ctx->setOutput( output );
+
+	Result result;
+	result.mNumNodes = scenario.mBuild( ctx.get(), output, options.mSize ? options.mSize : scenario.mDefaultSize );
+	result.mSummingArenaBytes = ctx->getSummingArenaSize() * sizeof( float );
+	ctx->enable();
+
+	// allocations are counted from the very first block, since lazy allocations are also a problem on the audio thread
+	sNumRenderAllocations = 0;
+
+	sIsRendering = true;
+	for( size_t i = 0; i < NUM_WARMUP_BLOCKS; i++ )
+		output->renderBlock();
+
+	uint64_t startTime = audio::Profiler::now();
+	for( size_t i = 0; i < options.mNumBlocks; i++ )
+		output->renderBlock();
+
+	uint64_t elapsed = audio::Profiler::now() - startTime;
+	sIsRendering = false;
+
+	result.mNumAllocations = sNumRenderAllocations;
+
+	double numFrames = double( options.mNumBlocks * options.mFramesPerBlock );
+	result.mNanosecondsPerFrame = double( elapsed ) / numFrames;
+	result.mNanosecondsPerFramePerNode = result.mNanosecondsPerFrame / double( result.mNumNodes );
+	result.mLoad = double( elapsed ) / ( numFrames * 1.0e9 / double( SAMPLE_RATE ) );
+
+	if( options.mProfile ) {
+		// profiled separately so that the timings above do not include the Profiler's overhead
+		ctx->setProfilingEnabled();
+		for( size_t i = 0; i < options.mNumBlocks; i++ )
+			output->renderBlock();
+
+		ctx->setProfilingEnabled( false );
+		result.mProfile = ctx->getProfiler()->dumpHottestNodes( 5 );
+	}
+
+	ctx->disable();
+	ctx->disconnectAllNodes();
+	return result;
+}
+
+bool parseOptions( int argc, char *argv[], Options *options )
+{
+	for( int i = 1; i < argc; i++ ) {
+		string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if( arg == "--scenario" && hasValue )
+			options->mScenario = argv[++i];
+		else if( arg == "--size" && hasValue )
+			options->mSize = (size_t)atoi( argv[++i] );
+		else if( arg == "--blocks" && hasValue )
+			options->mNumBlocks = (size_t)atoi( argv[++i] );
+		else if( arg == "--frames-per-block" && hasValue )
+			options->mFramesPerBlock = (size_t)atoi( argv[++i] );
+		else if( arg == "--profile" )
+			options->mProfile = true;
+		else if( arg == "--fail-on-alloc" )
+			options->mFailOnAlloc = true;
+		else if( arg == "--kernels" )
+			options->mKernels = true;
+		else {
+			cerr << "unknown argument: " << arg << endl;
+			return false;
+		}
+	}
+
+	return options->mNumBlocks > 0 && options->mFramesPerBlock > 0;
+}
+
+} // anonymous namespace
+
+int main( int argc, char *argv[] )
+{
+	Options options;
+	if( ! parseOptions( argc, argv, &options ) ) {
+		cerr << "usage: " << argv[0] << " [--scenario name] [--size n] [--blocks n] [--frames-per-block n] [--profile] [--fail-on-alloc] [--kernels]" << endl;
+		return 2;
+	}
+
+	if( options.mKernels ) {
+		printf( "frames per block: %d\n\n", (int)options.mFramesPerBlock );
+		benchmarkFft();
+		benchmarkConverters( options.mFramesPerBlock );
+		benchmarkInterleave( options.mFramesPerBlock );
+		return 0;
+	}
+
+	printf( "samplerate: %d, frames per block: %d, blocks: %d\n\n", (int)SAMPLE_RATE, (int)options.mFramesPerBlock, (int)options.mNumBlocks );
+	printf( "%-16s %8s %14s %18s %8s %12s %12s\n", "scenario", "nodes", "ns / frame", "ns / frame / node", "load", "allocations", "arena (KB)" );
+
+	uint64_t totalAllocations = 0;
+	bool ranAny = false;
+	for( const auto &scenario : makeScenarios() ) {
+		if( ! options.mScenario.empty() && options.mScenario != scenario.mName )
+			continue;
+
+		Result result = runScenario( scenario, options );
+		printf( "%-16s %8d %14.1f %18.2f %7.1f%% %12llu %12.1f\n", scenario.mName.c_str(), (int)result.mNumNodes, result.mNanosecondsPerFrame,
+				result.mNanosecondsPerFramePerNode, result.mLoad * 100.0, (unsigned long long)result.mNumAllocations, result.mSummingArenaBytes / 1024.0 );
+
+		if( options.mProfile )
+			cout << endl << scenario.mDescription << endl << result.mProfile << endl;
+
+		totalAllocations += result.mNumAllocations;
+		ranAny = true;
+	}
+
+	if( ! ranAny ) {
+		cerr << "unknown scenario: " << options.mScenario << endl;
+		return 2;
+	}
+
+	if( options.mFailOnAlloc && totalAllocations > 0 ) {
+		cerr << endl << "error: " << totalAllocations << " allocations were made while rendering." << endl;
+		return 1;
+	}
+
+	return 0;
+}
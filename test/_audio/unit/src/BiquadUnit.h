@@ -0,0 +1,85 @@
+#pragma once
+
+#include "utils.h"
+#include "cinder/audio/dsp/Biquad.h"
+#include "cinder/audio/dsp/BiquadBank.h"
+
+BOOST_AUTO_TEST_SUITE( test_biquad )
+
+using namespace ci::audio;
+
+namespace {
+
+	const float kBiquadBankMaxError = 0.0001f;
+
+	// processes each channel of \a buffer through \a numStages cascaded Biquads, which is the reference for BiquadBank.
+	void processReference( Buffer *buffer, size_t numStages, size_t numBlocks, size_t framesPerBlock )
+	{
+		for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ ) {
+			std::vector<dsp::Biquad> biquads( numStages );
+			for( size_t stage = 0; stage < numStages; stage++ )
+				biquads[stage].setLowpassParams( 0.05 + 0.1 * stage + 0.02 * ch, 3.0 );
+
+			for( size_t block = 0; block < numBlocks; block++ ) {
+				float *channel = buffer->getChannel( ch ) + block * framesPerBlock;
+				for( auto &biquad : biquads )
+					biquad.process( channel, channel, framesPerBlock );
+			}
+		}
+	}
+
+	void computeBank( size_t numChannels, size_t numStages, size_t framesPerBlock )
+	{
+		const size_t numBlocks = 4;
+		Buffer input( framesPerBlock * numBlocks, numChannels );
+		fillRandom( &input );
+
+		Buffer expected( input );
+		processReference( &expected, numStages, numBlocks, framesPerBlock );
+
+		dsp::BiquadBank bank( numChannels, numStages );
+		for( size_t ch = 0; ch < numChannels; ch++ ) {
+			for( size_t stage = 0; stage < numStages; stage++ ) {
+				dsp::Biquad biquad;
+				biquad.setLowpassParams( 0.05 + 0.1 * stage + 0.02 * ch, 3.0 );
+				bank.setCoefficients( ch, stage, biquad );
+			}
+		}
+
+		Buffer result( input );
+		Buffer block( framesPerBlock, numChannels );
+		for( size_t b = 0; b < numBlocks; b++ ) {
+			for( size_t ch = 0; ch < numChannels; ch++ )
+				block.copyChannel( ch, result.getChannel( ch ) + b * framesPerBlock );
+
+			bank.process( &block );
+
+			for( size_t ch = 0; ch < numChannels; ch++ )
+				std::memcpy( result.getChannel( ch ) + b * framesPerBlock, block.getChannel( ch ), framesPerBlock * sizeof( float ) );
+		}
+
+		float maxErr = maxError( result, expected );
+		BOOST_REQUIRE_MESSAGE( maxErr < kBiquadBankMaxError, "BiquadBank output differs from Biquad, channels: " << numChannels << ", stages: " << numStages << ", max error: " << maxErr );
+	}
+
+}
+
+BOOST_AUTO_TEST_CASE( test_bank_matches_biquad )
+{
+	for( size_t numChannels = 1; numChannels <= 9; numChannels++ )
+		computeBank( numChannels, 1, 512 );
+}
+
+BOOST_AUTO_TEST_CASE( test_bank_cascade )
+{
+	computeBank( 2, 3, 512 );
+	computeBank( 5, 4, 512 );
+}
+
+BOOST_AUTO_TEST_CASE( test_bank_odd_block_size )
+{
+	computeBank( 3, 2, 127 );
+	computeBank( 8, 1, 33 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -29,6 +29,69 @@ BOOST_AUTO_TEST_CASE( test_copy )
 	BOOST_CHECK( maxErr < ACCEPTABLE_FLOAT_ERROR );
 }
 
+BOOST_AUTO_TEST_CASE( test_external_data )
+{
+	float data[8] = { 0, 1, 2, 3, 10, 11, 12, 13 };
+	Buffer a( data, 4, 2 );
+
+	BOOST_REQUIRE( ! a.isDataOwned() );
+	BOOST_REQUIRE_EQUAL( a.getData(), data );
+	BOOST_CHECK_EQUAL( a.getChannel( 1 )[2], 12 );
+
+	// copies reference the same samples
+	Buffer b( a );
+	b.getChannel( 0 )[0] = 5;
+	BOOST_CHECK_EQUAL( data[0], 5 );
+
+	a.zero();
+	for( float sample : data )
+		BOOST_CHECK_EQUAL( sample, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_aligned_storage )
+{
+	Buffer a( 17, 3 );
+	BOOST_CHECK_EQUAL( reinterpret_cast<uintptr_t>( a.getData() ) % 64, 0 );
+
+	BufferDynamic b;
+	for( size_t numFrames = 1; numFrames < 2048; numFrames *= 3 ) {
+		b.setNumFrames( numFrames );
+		BOOST_CHECK_EQUAL( reinterpret_cast<uintptr_t>( b.getData() ) % 64, 0 );
+	}
+
+	AlignedArrayPtr c = makeAlignedArray<float>( 100, 32 );
+	BOOST_CHECK_EQUAL( reinterpret_cast<uintptr_t>( c.get() ) % 32, 0 );
+	for( size_t i = 0; i < 100; i++ )
+		BOOST_CHECK_EQUAL( c.get()[i], 0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_dynamic_external_storage )
+{
+	float data[12] = { 0 };
+	BufferDynamic a( 4, 1 );
+	a.setExternalStorage( data, 12 );
+
+	BOOST_REQUIRE( ! a.isDataOwned() );
+	BOOST_CHECK_EQUAL( a.getAllocatedSize(), 12 );
+
+	// resizing within capacity keeps referencing data
+	a.setSize( 4, 3 );
+	BOOST_REQUIRE_EQUAL( a.getData(), data );
+	a.getChannel( 2 )[3] = 7;
+	BOOST_CHECK_EQUAL( data[11], 7 );
+
+	// growing beyond capacity returns to owned storage, keeping the samples
+	a.setSize( 8, 2 );
+	BOOST_REQUIRE( a.isDataOwned() );
+	BOOST_CHECK_EQUAL( a[11], 7 );
+
+	a.setExternalStorage( data, 12 );
+	BOOST_CHECK_EQUAL( a.getNumFrames(), 6 );
+	a.setExternalStorage( nullptr, 0 );
+	BOOST_REQUIRE( a.isDataOwned() );
+	BOOST_CHECK_EQUAL( a.getSize(), 12 );
+}
+
 BOOST_AUTO_TEST_CASE( test_interleave_3x3 )
 {
 	BufferInterleavedT<int> interleaved( 3, 3 );
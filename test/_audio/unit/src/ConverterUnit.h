@@ -0,0 +1,191 @@
+#pragma once
+
+#include "cinder/audio/dsp/ConverterPolyphase.h"
+#include "cinder/audio/dsp/ConverterR8brain.h"
+#include "cinder/audio/dsp/Dsp.h"
+#include "utils.h"
+
+#include <cmath>
+
+BOOST_AUTO_TEST_SUITE( test_converter )
+
+using namespace std;
+using namespace ci;
+using namespace ci::audio;
+
+namespace {
+
+const size_t BLOCK_SIZE = 512;
+
+// Converts a sine at \\a freq through \\a converter in blocks, writing channel ch as the sine scaled by ( ch + 1 ), and returns the concatenated output.
+audio::Buffer convertSine( dsp::Converter *converter, float freq, size_t numSourceFrames )
+{
+	const size_t numSourceChannels = converter->getSourceNumChannels();
+	audio::Buffer source( BLOCK_SIZE, numSourceChannels );
+	audio::Buffer dest( converter->getDestMaxFramesPerBlock(), converter->getDestNumChannels() );
+
+	size_t numBlocks = ( numSourceFrames + BLOCK_SIZE - 1 ) / BLOCK_SIZE;
+	size_t numDestFrames = numBlocks * converter->getDestMaxFramesPerBlock();
+	audio::Buffer result( numDestFrames, converter->getDestNumChannels() );
+
+	size_t readPos = 0, writePos = 0;
+	while( readPos < numSourceFrames ) {
+		for( size_t ch = 0; ch < numSourceChannels; ch++ ) {
+			for( size_t i = 0; i < BLOCK_SIZE; i++ )
+				source.getChannel( ch )[i] = float( ch + 1 ) * sin( 2 * M_PI * freq * double( readPos + i ) / double( converter->getSourceSampleRate() ) );
+		}
+
+		auto count = converter->convert( &source, &dest );
+		BOOST_REQUIRE_EQUAL( count.first, BLOCK_SIZE );
+		BOOST_REQUIRE( writePos + count.second <= result.getNumFrames() );
+
+		result.copyOffset( dest, count.second, writePos, 0 );
+		readPos += count.first;
+		writePos += count.second;
+	}
+
+	audio::Buffer trimmed( writePos, result.getNumChannels() );
+	trimmed.copy( result, writePos );
+	return trimmed;
+}
+
+// Returns the largest difference between \\a channel of \\a buffer and a sine at \\a freq scaled by \\a gain, skipping the filter's edges.
+float sineError( const audio::Buffer &buffer, size_t channel, float freq, size_t sampleRate, float gain )
+{
+	float maxErr = 0;
+	for( size_t i = 200; i + 200 < buffer.getNumFrames(); i++ ) {
+		float expected = gain * (float)sin( 2 * M_PI * freq * double( i ) / double( sampleRate ) );
+		maxErr = max( maxErr, fabs( buffer.getChannel( channel )[i] - expected ) );
+	}
+	return maxErr;
+}
+
+// frame counts that exercise the SIMD kernels, their scalar remainders and the int conversion chunks
+const size_t INTERLEAVE_FRAME_COUNTS[] = { 0, 1, 3, 4, 5, 17, 512, 1000 };
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE( test_polyphase_sine )
+{
+	const float freq = 1000;
+	const size_t rates[][2] = { { 44100, 48000 }, { 48000, 44100 }, { 48000, 96000 }, { 96000, 44100 }, { 44100, 44101 } };
+	const dsp::ConverterImplPolyphase::Quality qualities[] = { dsp::ConverterImplPolyphase::Quality::LOW, dsp::ConverterImplPolyphase::Quality::MEDIUM, dsp::ConverterImplPolyphase::Quality::HIGH };
+	const float tolerances[] = { 0.001f, 0.0001f, 0.00001f };
+
+	for( const auto &rate : rates ) {
+		for( size_t q = 0; q < 3; q++ ) {
+			dsp::ConverterImplPolyphase converter( rate[0], rate[1], 2, 2, BLOCK_SIZE, qualities[q] );
+			audio::Buffer result = convertSine( &converter, freq, 20000 );
+
+			// all but the filter's latency is output
+			const float expectedNumFrames = float( 20480 - converter.getLatencyFrames() ) * rate[1] / rate[0];
+			BOOST_CHECK( fabs( (float)result.getNumFrames() - expectedNumFrames ) < 2 );
+			BOOST_CHECK_SMALL( sineError( result, 0, freq, rate[1], 1 ), tolerances[q] );
+			BOOST_CHECK_SMALL( sineError( result, 1, freq, rate[1], 2 ), tolerances[q] * 2 );
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_polyphase_anti_aliasing )
+{
+	// a tone above the destination's nyquist is removed rather than folded back
+	dsp::ConverterImplPolyphase converter( 96000, 44100, 1, 1, BLOCK_SIZE, dsp::ConverterImplPolyphase::Quality::HIGH );
+	audio::Buffer result = convertSine( &converter, 30000, 20000 );
+
+	audio::Buffer steadyState( result.getNumFrames() - 400 );
+	steadyState.copyOffset( result, steadyState.getNumFrames(), 0, 200 );
+	BOOST_CHECK_SMALL( dsp::rms( steadyState.getData(), steadyState.getSize() ), 0.0001f );
+}
+
+BOOST_AUTO_TEST_CASE( test_polyphase_channels )
+{
+	const float freq = 1000;
+
+	// 3 and 5 channels exercise the generic interleaved path
+	for( size_t numChannels : { 1, 3, 4, 5 } ) {
+		dsp::ConverterImplPolyphase converter( 44100, 48000, numChannels, numChannels, BLOCK_SIZE );
+		audio::Buffer result = convertSine( &converter, freq, 10000 );
+		for( size_t ch = 0; ch < numChannels; ch++ )
+			BOOST_CHECK_SMALL( sineError( result, ch, freq, 48000, float( ch + 1 ) ), 0.001f * ( ch + 1 ) );
+	}
+
+	// mono to stereo up-mixes after conversion
+	dsp::ConverterImplPolyphase upMix( 44100, 48000, 1, 2, BLOCK_SIZE );
+	audio::Buffer upMixed = convertSine( &upMix, freq, 10000 );
+	BOOST_CHECK_SMALL( sineError( upMixed, 0, freq, 48000, 1 ), 0.001f );
+	BOOST_CHECK_SMALL( sineError( upMixed, 1, freq, 48000, 1 ), 0.001f );
+}
+
+// The float overloads of interleave() and deinterleave() must match the generic templates exactly, for all channel counts.
+// The channel stride is larger than the number of copied frames to catch kernels that confuse the two.
+BOOST_AUTO_TEST_CASE( test_interleave_float )
+{
+	for( size_t numChannels = 1; numChannels <= 9; numChannels++ ) {
+		for( size_t numFrames : INTERLEAVE_FRAME_COUNTS ) {
+			audio::Buffer source( numFrames + 3, numChannels );
+			fillRandom( &source );
+
+			vector<float> interleaved( numFrames * numChannels ), interleavedExpected( numFrames * numChannels );
+			dsp::interleave( source.getData(), interleaved.data(), source.getNumFrames(), numChannels, numFrames );
+			dsp::interleave<float>( source.getData(), interleavedExpected.data(), source.getNumFrames(), numChannels, numFrames );
+			BOOST_REQUIRE( interleaved == interleavedExpected );
+
+			audio::Buffer result( numFrames + 3, numChannels ), resultExpected( numFrames + 3, numChannels );
+			dsp::deinterleave( interleaved.data(), result.getData(), result.getNumFrames(), numChannels, numFrames );
+			dsp::deinterleave<float>( interleaved.data(), resultExpected.getData(), resultExpected.getNumFrames(), numChannels, numFrames );
+			BOOST_REQUIRE_EQUAL( maxError( result, resultExpected ), 0 );
+
+			for( size_t ch = 0; ch < numChannels; ch++ ) {
+				for( size_t i = 0; i < numFrames; i++ )
+					BOOST_REQUIRE_EQUAL( result.getChannel( ch )[i], source.getChannel( ch )[i] );
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_interleave_int16 )
+{
+	for( size_t numChannels = 1; numChannels <= 9; numChannels++ ) {
+		for( size_t numFrames : INTERLEAVE_FRAME_COUNTS ) {
+			// scaled so that no sample reaches 1, which the generic version wraps and the SIMD version clamps
+			audio::Buffer source( numFrames + 3, numChannels );
+			fillRandom( &source );
+			dsp::mul( source.getData(), 0.999f, source.getData(), source.getSize() );
+
+			vector<int16_t> interleaved( numFrames * numChannels ), interleavedExpected( numFrames * numChannels );
+			dsp::interleave( source.getData(), interleaved.data(), source.getNumFrames(), numChannels, numFrames );
+			dsp::interleave<float>( source.getData(), interleavedExpected.data(), source.getNumFrames(), numChannels, numFrames );
+			BOOST_REQUIRE( interleaved == interleavedExpected );
+
+			audio::Buffer result( numFrames + 3, numChannels ), resultExpected( numFrames + 3, numChannels );
+			dsp::deinterleave( interleaved.data(), result.getData(), result.getNumFrames(), numChannels, numFrames );
+			dsp::deinterleave<float>( interleaved.data(), resultExpected.getData(), resultExpected.getNumFrames(), numChannels, numFrames );
+			BOOST_REQUIRE_EQUAL( maxError( result, resultExpected ), 0 );
+		}
+	}
+
+	// full scale is clamped rather than wrapped
+	float fullScale[8] = { 1, -1, 2, -2, 1, -1, 2, -2 };
+	int16_t clamped[8];
+	dsp::interleave( fullScale, clamped, 8, 1, 8 );
+	BOOST_CHECK_EQUAL( clamped[0], 32767 );
+	BOOST_CHECK_EQUAL( clamped[1], -32768 );
+	BOOST_CHECK_EQUAL( clamped[2], 32767 );
+	BOOST_CHECK_EQUAL( clamped[3], -32768 );
+}
+
+BOOST_AUTO_TEST_CASE( test_int24_to_float )
+{
+	for( size_t length : INTERLEAVE_FRAME_COUNTS ) {
+		vector<char> source( length * 3 );
+		for( auto &byte : source )
+			byte = (char)ci::randInt( 256 );
+
+		vector<float> result( length ), resultExpected( length );
+		dsp::convertInt24ToFloat( source.data(), result.data(), length );
+		dsp::convertInt24ToFloat<float>( source.data(), resultExpected.data(), length );
+		BOOST_REQUIRE( result == resultExpected );
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
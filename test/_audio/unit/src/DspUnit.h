@@ -0,0 +1,43 @@
+#pragma once
+
+#include "cinder/audio/dsp/Dsp.h"
+#include "utils.h"
+
+#include <cmath>
+
+BOOST_AUTO_TEST_SUITE( test_dsp )
+
+using namespace std;
+using namespace ci;
+using namespace ci::audio;
+
+BOOST_AUTO_TEST_CASE( test_ramp )
+{
+	// odd lengths exercise the scalar tail
+	for( size_t length : { 0, 1, 3, 7, 64, 1001 } ) {
+		vector<float> a( length );
+		const float begin = 0.25f;
+		const float increment = 0.001f;
+
+		dsp::ramp( begin, increment, a.data(), length );
+
+		for( size_t i = 0; i < length; i++ )
+			BOOST_REQUIRE_CLOSE( a[i], begin + (float)i * increment, 0.001f );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_ramp_geometric )
+{
+	for( size_t length : { 0, 1, 3, 7, 64, 1001 } ) {
+		vector<float> a( length );
+		const float begin = 2;
+		const float ratio = 0.999f;
+
+		dsp::rampGeometric( begin, ratio, a.data(), length );
+
+		for( size_t i = 0; i < length; i++ )
+			BOOST_REQUIRE_CLOSE( a[i], begin * pow( ratio, (float)i ), 0.01f );
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,7 @@
 #include "cinder/audio/dsp/Fft.h"
 
 #include <iostream>
+#include <cmath>
 
 BOOST_AUTO_TEST_SUITE( test_fft )
 
@@ -11,9 +12,9 @@ using namespace ci::audio;
 
 namespace {
 
-	void computeRoundTrip( size_t sizeFft )
+	void computeRoundTrip( dsp::Fft &fft )
 	{
-		dsp::Fft fft( sizeFft );
+		const size_t sizeFft = fft.getSize();
 		Buffer waveform( sizeFft );
 		BufferSpectral spectral( sizeFft );
 
@@ -39,13 +40,122 @@ namespace {
 		BOOST_REQUIRE_MESSAGE( maxErr < ACCEPTABLE_FLOAT_ERROR, "unacceptable max error after rountrip FFT -> IFFT transforms" );
 	}
 
+	// compares against a direct DFT computed in double precision
+	float computeMaxErrorVersusDft( dsp::Fft &fft )
+	{
+		const size_t sizeFft = fft.getSize();
+		Buffer waveform( sizeFft );
+		BufferSpectral spectral( sizeFft );
+
+		fillRandom( &waveform );
+		fft.forward( &waveform, &spectral );
+
+		float maxErr = 0;
+		for( size_t k = 0; k <= sizeFft / 2; k++ ) {
+			double re = 0, im = 0;
+			for( size_t n = 0; n < sizeFft; n++ ) {
+				double theta = -2.0 * M_PI * double( ( k * n ) % sizeFft ) / double( sizeFft );
+				re += waveform[n] * cos( theta );
+				im += waveform[n] * sin( theta );
+			}
+
+			float resultRe, resultIm;
+			if( k == 0 ) {
+				resultRe = spectral.getReal()[0];
+				resultIm = 0;
+			}
+			else if( k == sizeFft / 2 ) {
+				resultRe = spectral.getImag()[0];
+				resultIm = 0;
+			}
+			else {
+				resultRe = spectral.getReal()[k];
+				resultIm = spectral.getImag()[k];
+			}
+
+			maxErr = std::max( maxErr, (float)std::fabs( re - resultRe ) );
+			maxErr = std::max( maxErr, (float)std::fabs( im - resultIm ) );
+		}
+
+		return maxErr;
+	}
+
+	const size_t kMixedRadixSizes[] = { 6, 10, 12, 26, 30, 48, 96, 154, 360, 480, 1000, 1536, 1920, 6000 };
+
 }
 
 BOOST_AUTO_TEST_CASE( test_round_trip )
 {
 	std::cout << "... Fft round trip max acceptable error: " << ACCEPTABLE_FLOAT_ERROR << std::endl;
-	for( size_t i = 0; i < 14; i ++ )
-		computeRoundTrip( 2 << i );
+	for( size_t i = 0; i < 14; i ++ ) {
+		dsp::Fft fft( 2 << i );
+		computeRoundTrip( fft );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_round_trip_native )
+{
+	std::cout << "... Fft (native backend) round trip max acceptable error: " << ACCEPTABLE_FLOAT_ERROR << std::endl;
+	for( size_t i = 0; i < 14; i ++ ) {
+		dsp::Fft fft( dsp::makeFftBackendNative( 2 << i ) );
+		computeRoundTrip( fft );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_round_trip_mixed_radix )
+{
+	std::cout << "... Fft (mixed radix backend) round trip max acceptable error: " << ACCEPTABLE_FLOAT_ERROR << std::endl;
+	for( size_t sizeFft : kMixedRadixSizes ) {
+		dsp::Fft fft( sizeFft );
+		computeRoundTrip( fft );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_matches_dft )
+{
+	for( size_t i = 0; i < 10; i ++ ) {
+		dsp::Fft fftNative( dsp::makeFftBackendNative( 2 << i ) );
+		dsp::Fft fftMixedRadix( dsp::makeFftBackendMixedRadix( 2 << i ) );
+
+		float errNative = computeMaxErrorVersusDft( fftNative );
+		float errMixedRadix = computeMaxErrorVersusDft( fftMixedRadix );
+		float acceptableErr = ACCEPTABLE_FLOAT_ERROR * ( 2 << i );
+
+		BOOST_REQUIRE_MESSAGE( errNative < acceptableErr, "native backend does not match the DFT" );
+		BOOST_REQUIRE_MESSAGE( errMixedRadix < acceptableErr, "mixed radix backend does not match the DFT" );
+	}
+
+	for( size_t sizeFft : kMixedRadixSizes ) {
+		dsp::Fft fft( sizeFft );
+		float err = computeMaxErrorVersusDft( fft );
+		BOOST_REQUIRE_MESSAGE( err < ACCEPTABLE_FLOAT_ERROR * sizeFft, "mixed radix backend does not match the DFT" );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_batch )
+{
+	const size_t sizeFft = 480;
+	const size_t numChannels = 5;
+
+	dsp::Fft fft( sizeFft );
+	Buffer waveforms( sizeFft, numChannels );
+	fillRandom( &waveforms );
+
+	std::vector<BufferSpectral> spectra( numChannels, BufferSpectral( sizeFft ) );
+	fft.forward( &waveforms, &spectra );
+
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		Buffer waveform( sizeFft );
+		BufferSpectral spectral( sizeFft );
+		memcpy( waveform.getData(), waveforms.getChannel( ch ), sizeFft * sizeof( float ) );
+		fft.forward( &waveform, &spectral );
+
+		BOOST_REQUIRE( maxError( spectral, spectra[ch] ) < ACCEPTABLE_FLOAT_ERROR );
+	}
+
+	Buffer result( sizeFft, numChannels );
+	fft.inverse( spectra, &result );
+	BOOST_REQUIRE( maxError( result, waveforms ) < ACCEPTABLE_FLOAT_ERROR );
 }
 
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,562 @@
+#pragma once
+
+#include "cinder/audio/Source.h"
+#include "cinder/audio/Target.h"
+#include "cinder/audio/FileOggVorbis.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/DataSource.h"
+#include "utils.h"
+
+#include "vorbis/vorbisenc.h"
+
+#include <fstream>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE( test_file )
+
+using namespace std;
+using namespace ci;
+using namespace ci::audio;
+
+namespace {
+
+// 657 frames of stereo, 16-bit FLAC with 64 frame blocks, generated by expectedFlacSamples() below. It covers every subframe type
+// (constant, verbatim, fixed, LPC, wasted bits), stereo decorrelation mode, both rice codings and escaped partitions, and has a SEEKTABLE
+// and VORBIS_COMMENT block.
+const uint8_t FLAC_DATA[] = {
+	0x66, 0x4C, 0x61, 0x43, 0x00, 0x00, 0x00, 0x22, 0x00, 0x40, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x0A, 0xC4, 0x42, 0xF0, 0x00, 0x00, 0x02, 0x91, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x48, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x94,
+	0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x05, 0xC3, 0x00, 0x40, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x84, 0x00, 0x00, 0x3A, 0x13, 0x00, 0x00, 0x00, 0x63, 0x69,
+	0x6E, 0x64, 0x65, 0x72, 0x20, 0x74, 0x65, 0x73, 0x74, 0x20, 0x65, 0x6E, 0x63, 0x6F, 0x64, 0x65,
+	0x72, 0x02, 0x00, 0x00, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x54, 0x49, 0x54, 0x4C, 0x45, 0x3D, 0x75,
+	0x6E, 0x69, 0x74, 0x0D, 0x00, 0x00, 0x00, 0x41, 0x52, 0x54, 0x49, 0x53, 0x54, 0x3D, 0x43, 0x69,
+	0x6E, 0x64, 0x65, 0x72, 0xFF, 0xF8, 0x69, 0x18, 0x00, 0x3F, 0x02, 0x14, 0xB1, 0xC6, 0xB3, 0x8E,
+	0x11, 0xDD, 0x2C, 0xE6, 0x29, 0x98, 0x0A, 0x2C, 0x8C, 0xFE, 0x52, 0xEA, 0x92, 0xCE, 0xCF, 0x29,
+	0x5F, 0x5B, 0x41, 0x20, 0xAF, 0x25, 0x76, 0x28, 0x1E, 0xB6, 0x65, 0x04, 0x1F, 0x6C, 0x4D, 0x05,
+	0x94, 0xD8, 0x6D, 0x66, 0x84, 0x9C, 0x4A, 0xCC, 0x61, 0xF0, 0xA4, 0x92, 0xCB, 0x45, 0x75, 0x2E,
+	0x46, 0x16, 0x13, 0x12, 0xD4, 0xB6, 0x97, 0x8D, 0xEA, 0xA8, 0x99, 0xF9, 0x53, 0x11, 0xDC, 0xB6,
+	0xCC, 0x5C, 0xDA, 0x20, 0x31, 0x14, 0xC7, 0xDA, 0xCA, 0xC2, 0x11, 0xDD, 0x4C, 0xD6, 0x2A, 0x17,
+	0xCA, 0x4C, 0x6C, 0x40, 0x28, 0xF6, 0x4A, 0x67, 0x57, 0xA4, 0x9F, 0xCD, 0x9C, 0x8E, 0x58, 0x94,
+	0xBA, 0x93, 0x8F, 0x9A, 0xB2, 0x7A, 0x17, 0xC6, 0x16, 0x84, 0xCC, 0x6B, 0x37, 0x33, 0x3A, 0x56,
+	0x15, 0x5E, 0x81, 0x44, 0x33, 0xBB, 0x8C, 0xDD, 0xD0, 0x12, 0x99, 0x64, 0xB0, 0xA3, 0xC4, 0xC3,
+	0x02, 0xA2, 0x9A, 0x8E, 0xE2, 0xE9, 0xC1, 0x54, 0x92, 0x90, 0x14, 0xB1, 0x21, 0xC7, 0x74, 0xB5,
+	0xD1, 0x9F, 0xE6, 0x40, 0x19, 0xED, 0xFF, 0xF8, 0x69, 0x88, 0x01, 0x3F, 0xBE, 0x4E, 0x15, 0xEE,
+	0x17, 0x53, 0x19, 0x18, 0x1A, 0x7D, 0x1C, 0x0D, 0x1D, 0xCA, 0x1F, 0x5E, 0x20, 0xD6, 0xB5, 0x22,
+	0x30, 0x02, 0x7F, 0xA7, 0xFE, 0x80, 0x0F, 0xFF, 0x7F, 0xEF, 0xE0, 0x07, 0xE1, 0x82, 0x2C, 0x51,
+	0x88, 0x11, 0x54, 0x2C, 0xC5, 0xB8, 0xB1, 0x12, 0x08, 0x39, 0x44, 0x60, 0xC3, 0x19, 0x62, 0xC0,
+	0x70, 0x09, 0xB1, 0xDA, 0x82, 0xDC, 0x5F, 0x8E, 0x31, 0xA2, 0x38, 0xC7, 0xB8, 0xDA, 0x1C, 0x69,
+	0x62, 0x4B, 0xE9, 0x3C, 0x30, 0xC5, 0xC8, 0xD0, 0xD6, 0x9A, 0x41, 0x70, 0x9B, 0x34, 0xC9, 0x35,
+	0x9B, 0x4F, 0x97, 0x67, 0xCD, 0xD4, 0xB6, 0xEF, 0x5D, 0x94, 0x3A, 0x84, 0x87, 0xE1, 0x77, 0x5B,
+	0x55, 0xCA, 0xB1, 0x4E, 0xB5, 0xCB, 0xB6, 0xCA, 0x77, 0xE7, 0x73, 0xEF, 0xED, 0xF6, 0xD0, 0xFA,
+	0x75, 0x7C, 0xD6, 0xBE, 0x44, 0x9F, 0x09, 0xCF, 0x76, 0xE5, 0xAD, 0xE8, 0xC0, 0x03, 0xFC, 0x80,
+	0x1B, 0xFF, 0x00, 0x03, 0xFB, 0x80, 0x58, 0x3F, 0x0E, 0x54, 0x1E, 0x9A, 0xA0, 0x00, 0x46, 0x82,
+	0xA9, 0x95, 0x40, 0xB5, 0x55, 0x6C, 0xAA, 0xE9, 0x4D, 0x10, 0xE1, 0x0A, 0x5C, 0xA3, 0x48, 0xF0,
+	0x9F, 0x5E, 0xE9, 0x31, 0xA5, 0xDB, 0x3A, 0x27, 0xE4, 0xDC, 0x1C, 0x33, 0x98, 0x60, 0xCB, 0xA2,
+	0x5A, 0x62, 0xFA, 0xF1, 0x95, 0x32, 0x22, 0x22, 0x92, 0x9F, 0x2D, 0xFC, 0xAE, 0xFD, 0x67, 0x6C,
+	0x8F, 0x6C, 0x1C, 0x1E, 0xDF, 0x87, 0x06, 0x20, 0x00, 0xF3, 0xC3, 0xBD, 0x0D, 0xA2, 0x60, 0xA2,
+	0x76, 0x6B, 0x15, 0x48, 0x39, 0xFA, 0x51, 0xDA, 0xB7, 0x58, 0xAC, 0x15, 0xEA, 0x97, 0xA9, 0x5C,
+	0x80, 0xA0, 0xA0, 0xFF, 0xF8, 0x69, 0x98, 0x02, 0x3F, 0x23, 0x02, 0x12, 0xD6, 0x08, 0x40, 0x83,
+	0x83, 0x41, 0x75, 0xC0, 0x97, 0xA0, 0x37, 0x80, 0x13, 0x10, 0x04, 0xDA, 0xFF, 0xF8, 0x7E, 0xE2,
+	0x3E, 0xD1, 0xDF, 0x1E, 0x8F, 0x68, 0x17, 0xA3, 0x1B, 0xC7, 0xF5, 0xDF, 0x52, 0xED, 0x2E, 0x75,
+	0x6B, 0xBA, 0x28, 0x1C, 0xC6, 0x21, 0xD9, 0x70, 0xD9, 0xC8, 0x63, 0xEC, 0x2D, 0x6E, 0x14, 0x63,
+	0x09, 0x0A, 0x83, 0xE4, 0x41, 0xA5, 0x00, 0xAE, 0xD0, 0x44, 0xE8, 0x18, 0xB4, 0x07, 0xAA, 0x01,
+	0x9B, 0x7F, 0xA5, 0xBF, 0x33, 0x5F, 0x54, 0xCF, 0x82, 0xE7, 0xAE, 0x3B, 0xCE, 0x79, 0xE2, 0x5C,
+	0xEE, 0xD8, 0x76, 0x46, 0x3A, 0x89, 0x9C, 0xFC, 0x4E, 0x58, 0x17, 0x17, 0xDB, 0x82, 0xCD, 0xBC,
+	0xB2, 0xDC, 0x18, 0x6C, 0xDE, 0x35, 0xD1, 0xDA, 0xA0, 0x6D, 0x29, 0xA6, 0x82, 0xC3, 0x38, 0x01,
+	0x97, 0x52, 0xC9, 0x63, 0x00, 0x73, 0xBF, 0x96, 0x5F, 0x7F, 0x0F, 0x9C, 0x77, 0xBB, 0x53, 0xD4,
+	0x4D, 0xE5, 0x7A, 0x02, 0xFC, 0xCA, 0xFF, 0xE7, 0x03, 0x23, 0x06, 0x4A, 0x09, 0x46, 0x0C, 0x98,
+	0x0F, 0x8C, 0x12, 0xAB, 0x15, 0xE8, 0x18, 0xE4, 0x1C, 0x29, 0x1F, 0x44, 0x22, 0x7F, 0x25, 0x65,
+	0x28, 0x93, 0x2B, 0xAF, 0x2E, 0xF2, 0x32, 0x11, 0x35, 0x10, 0x38, 0x47, 0xC7, 0xD9, 0xCA, 0xFF,
+	0xCE, 0x05, 0xD1, 0x11, 0xD4, 0x2D, 0xD7, 0x43, 0xDA, 0x8F, 0xDD, 0xC0, 0xE0, 0xC3, 0xE3, 0xDB,
+	0xE7, 0x13, 0xEA, 0x33, 0xED, 0x35, 0xF0, 0x4D, 0xF3, 0x93, 0xF6, 0x82, 0xF9, 0xC2, 0xFC, 0xF1,
+	0xFF, 0xE2, 0x03, 0x1A, 0x06, 0x38, 0x09, 0x4C, 0x0C, 0x7A, 0x0F, 0x86, 0x12, 0xAF, 0x15, 0xFD,
+	0x19, 0x0D, 0x1C, 0x2F, 0x1F, 0x38, 0x22, 0x5C, 0x25, 0x99, 0x28, 0xA5, 0x2B, 0xD6, 0x2E, 0xE0,
+	0x32, 0x00, 0x35, 0x1F, 0x38, 0x2D, 0xC7, 0xA1, 0xCA, 0xF7, 0xCE, 0x20, 0xD1, 0x19, 0xD4, 0x3E,
+	0xD7, 0x5D, 0xDA, 0x7B, 0x5B, 0x28, 0xFF, 0xF8, 0x69, 0xA8, 0x03, 0x3F, 0xD7, 0x4E, 0xCE, 0x00,
+	0xCE, 0xC8, 0xCF, 0x90, 0xD0, 0x58, 0xD1, 0x20, 0xD1, 0xE8, 0xD2, 0xB0, 0xD3, 0x78, 0xB5, 0xBD,
+	0x27, 0xFE, 0xFF, 0xEF, 0xFE, 0xFF, 0xEF, 0xFE, 0xFF, 0xEF, 0xEE, 0x27, 0xF0, 0xA0, 0x10, 0x57,
+	0x25, 0x87, 0x51, 0xD0, 0x3D, 0xFD, 0xEE, 0x6A, 0x88, 0x95, 0xA3, 0x7C, 0x8A, 0x2D, 0x0D, 0xF1,
+	0x14, 0x2D, 0x4B, 0xAB, 0xEB, 0x14, 0xB6, 0xAB, 0xC0, 0xC1, 0x4C, 0x6A, 0x00, 0x07, 0x6F, 0xC0,
+	0xD9, 0xA7, 0x78, 0x62, 0x26, 0x1D, 0x86, 0x21, 0x45, 0xED, 0x12, 0x59, 0x76, 0x13, 0xB4, 0x98,
+	0x30, 0xCE, 0xD1, 0x30, 0x4A, 0x86, 0x5B, 0x8C, 0xC1, 0xC3, 0x3D, 0xC2, 0x32, 0x28, 0x82, 0xDC,
+	0x52, 0x99, 0x2C, 0x42, 0xEF, 0x31, 0x93, 0x44, 0x36, 0xF3, 0x9A, 0x3C, 0x42, 0x77, 0x83, 0x03,
+	0xB8, 0x25, 0xD7, 0x82, 0xE9, 0x3F, 0x73, 0x7A, 0xB9, 0x2A, 0x9C, 0x46, 0xAE, 0x00, 0x05, 0xAD,
+	0xF3, 0xC0, 0x1F, 0xFE, 0xFF, 0xDF, 0xFF, 0x80, 0x2B, 0xFC, 0x3F, 0x85, 0x2F, 0xB2, 0x35, 0xB1,
+	0x3A, 0xEB, 0xAD, 0x6A, 0xF0, 0xAC, 0xC2, 0xD4, 0x6C, 0xE5, 0x9A, 0x17, 0xD1, 0xFE, 0xA0, 0xF5,
+	0x1B, 0xAD, 0xDD, 0x6E, 0xE9, 0x17, 0x79, 0xBA, 0x61, 0xDF, 0xAE, 0xE8, 0xF7, 0x2B, 0xB6, 0x7D,
+	0xF9, 0x80, 0x03, 0x67, 0xD6, 0xF9, 0x53, 0xA8, 0xB7, 0xCB, 0x60, 0xB0, 0xBB, 0xAA, 0xAE, 0x9E,
+	0xD5, 0xCE, 0x3C, 0x17, 0x9A, 0xF4, 0x1E, 0xBB, 0xD3, 0xF8, 0x2F, 0xA7, 0x45, 0x95, 0x73, 0x14,
+	0x99, 0x46, 0xF4, 0x5B, 0x43, 0xD4, 0x93, 0x4F, 0x55, 0x77, 0x4E, 0x94, 0xF5, 0x57, 0x75, 0xAD,
+	0x55, 0x76, 0x0D, 0x5A, 0xF6, 0x8F, 0xA9, 0x53, 0xFF, 0xF8, 0x69, 0x18, 0x04, 0x3F, 0x56, 0x14,
+	0x09, 0x6A, 0x0B, 0x0A, 0x11, 0x0E, 0xAE, 0xA8, 0x3D, 0x18, 0x31, 0x5E, 0x54, 0xDE, 0x60, 0xD4,
+	0x76, 0x12, 0xDA, 0x91, 0xA6, 0x67, 0x85, 0xFD, 0xC9, 0xD7, 0x0A, 0xCD, 0xF3, 0xFB, 0xD1, 0x6E,
+	0x89, 0x22, 0xB5, 0xB1, 0xA8, 0x48, 0x81, 0x14, 0x60, 0x93, 0x38, 0x30, 0xAC, 0xF8, 0x8C, 0x60,
+	0x1C, 0xF9, 0x2E, 0x59, 0x93, 0x56, 0xD8, 0x14, 0x94, 0xF4, 0xA4, 0xA3, 0xC6, 0xD0, 0x65, 0x21,
+	0x4C, 0x64, 0xD7, 0xC3, 0x4F, 0x81, 0x23, 0x1F, 0x61, 0x3A, 0x31, 0x04, 0x64, 0xE1, 0x83, 0x66,
+	0x99, 0x19, 0x99, 0x17, 0xD1, 0x89, 0xA9, 0x90, 0x19, 0xA9, 0x9E, 0x98, 0xAA, 0x98, 0xF1, 0x84,
+	0x1A, 0x71, 0x8C, 0xA9, 0x86, 0x18, 0xC9, 0x8D, 0x98, 0xBA, 0x99, 0x39, 0xA2, 0x18, 0xB9, 0x85,
+	0xA9, 0x92, 0x98, 0x31, 0x93, 0x19, 0x72, 0x99, 0x19, 0x95, 0x18, 0x89, 0x8D, 0x29, 0x90, 0x19,
+	0xC9, 0x9A, 0x18, 0x12, 0x99, 0x19, 0x96, 0x19, 0x61, 0x91, 0xB4, 0x04, 0x2D, 0x33, 0x1C, 0x4D,
+	0x25, 0x32, 0xD5, 0x2E, 0x73, 0x2F, 0x34, 0x22, 0xF7, 0x53, 0x1E, 0x34, 0xC3, 0x1C, 0x2F, 0x35,
+	0x32, 0x23, 0x47, 0x32, 0x33, 0x15, 0x53, 0x01, 0x35, 0x43, 0x13, 0x30, 0xD5, 0x33, 0x42, 0xF6,
+	0x34, 0xB3, 0x2F, 0x00, 0xF1, 0x23, 0xFF, 0xF8, 0x69, 0x88, 0x05, 0x3F, 0xEA, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0xBA, 0x91, 0xFF, 0xF8, 0x69, 0x98, 0x06, 0x3F, 0x77, 0x12, 0xEB, 0xB0,
+	0x09, 0x45, 0xD3, 0x2A, 0xB9, 0x52, 0xE8, 0x97, 0xE6, 0x0F, 0x28, 0x79, 0x5B, 0xE8, 0xB2, 0xE4,
+	0x8B, 0x2F, 0x19, 0x62, 0xE8, 0xB1, 0xE4, 0x7B, 0x2E, 0x19, 0x6A, 0xE8, 0x9C, 0xFF, 0x4F, 0x57,
+	0xEE, 0xBD, 0x8F, 0x0E, 0x31, 0x78, 0x99, 0xC0, 0x48, 0x01, 0x2B, 0xFD, 0xB5, 0xAC, 0xB7, 0x7F,
+	0x29, 0x6D, 0xBF, 0xB7, 0x76, 0xB7, 0x29, 0x2D, 0xFB, 0xA5, 0x36, 0xCF, 0x2D, 0x9D, 0x9B, 0xA6,
+	0x36, 0x8F, 0x2C, 0xCD, 0x8F, 0xB5, 0xF6, 0x8F, 0x2B, 0x8D, 0x69, 0xB9, 0xF6, 0x7F, 0x2C, 0x5D,
+	0x2F, 0xBB, 0xF4, 0xEF, 0x2E, 0x5D, 0x4F, 0xB6, 0x36, 0x87, 0x2C, 0x7D, 0x6F, 0xB0, 0x77, 0xAF,
+	0xA0, 0x24, 0x30, 0x8A, 0x9E, 0x3A, 0xB8, 0xC2, 0xC4, 0xBC, 0xE0, 0x04, 0xA6, 0x7A, 0x63, 0xC6,
+	0x36, 0xA5, 0xF0, 0x69, 0x86, 0x18, 0x64, 0x8A, 0x65, 0xC5, 0xD6, 0x68, 0x26, 0x56, 0xA6, 0x58,
+	0x5C, 0xE6, 0x72, 0x66, 0x6A, 0x60, 0x46, 0x9A, 0x60, 0x86, 0x26, 0xD9, 0xA4, 0xA6, 0x3C, 0x97,
+	0x90, 0x04, 0x1D, 0xF4, 0xC6, 0x0C, 0xCC, 0xC2, 0xCD, 0x21, 0x4B, 0xBC, 0xCE, 0x0C, 0xD8, 0xCB,
+	0xD4, 0xBA, 0xCD, 0x58, 0xBB, 0x4C, 0xC9, 0x4C, 0xC8, 0xC9, 0x8B, 0xC4, 0xCA, 0x94, 0xC9, 0x4C,
+	0x80, 0xCC, 0x0C, 0xA9, 0x4C, 0x44, 0xC3, 0x4D, 0x00, 0xCA, 0x14, 0xC7, 0x8B, 0xC0, 0xD2, 0x0B,
+	0xD9, 0x4C, 0xF8, 0xC0, 0x0C, 0xC4, 0xCA, 0x54, 0xC8, 0x0C, 0x40, 0xC6, 0x8D, 0x39, 0xA0, 0x21,
+	0x07, 0x98, 0x12, 0x68, 0x69, 0x8D, 0x80, 0xFB, 0x54, 0xFF, 0xF8, 0x69, 0xA8, 0x07, 0x3F, 0x83,
+	0x15, 0x7A, 0x23, 0xEA, 0xE4, 0x40, 0xC2, 0x44, 0x87, 0x87, 0x87, 0x87, 0x87, 0x22, 0xD2, 0x77,
+	0x00, 0x43, 0x39, 0x46, 0x72, 0x40, 0x10, 0x78, 0x11, 0x30, 0xC8, 0x81, 0xEB, 0x00, 0x13, 0xC1,
+	0x00, 0xA6, 0x4C, 0x4B, 0xD0, 0x99, 0x14, 0x3C, 0x46, 0x4F, 0x73, 0x5F, 0x65, 0x37, 0x56, 0x56,
+	0x36, 0x5B, 0x63, 0x6F, 0x4B, 0x67, 0xF4, 0xF6, 0x75, 0x76, 0x77, 0x5B, 0x73, 0x5F, 0x64, 0xB7,
+	0xF4, 0xB7, 0x76, 0x5B, 0x63, 0x6F, 0x59, 0x66, 0x15, 0x36, 0x56, 0x1A, 0x8C, 0x60, 0x23, 0x74,
+	0x69, 0x89, 0xEC, 0xD6, 0xB6, 0xE6, 0xC6, 0xCC, 0xAA, 0x2D, 0xEC, 0x6C, 0xD6, 0x9E, 0xC2, 0xCA,
+	0xCD, 0x6A, 0xEE, 0x6C, 0x6F, 0xAE, 0x5F, 0x93, 0xE5, 0x7B, 0x94, 0x25, 0xE9, 0x2A, 0x58, 0xB9,
+	0x4A, 0x5F, 0x93, 0x25, 0x18, 0xB0, 0xAE, 0xFF, 0xF8, 0x69, 0x18, 0x08, 0x3F, 0xAA, 0x14, 0x3B,
+	0x59, 0x39, 0xC3, 0x10, 0x88, 0xCA, 0x5C, 0x6B, 0x6B, 0x46, 0xE3, 0x69, 0xA5, 0xA1, 0x73, 0x2C,
+	0x3D, 0xB9, 0x6C, 0x28, 0x18, 0xF4, 0xDA, 0x91, 0x13, 0x48, 0xEE, 0xCE, 0xC7, 0xC1, 0x40, 0x29,
+	0xAB, 0x16, 0x97, 0x2C, 0x62, 0x80, 0xAF, 0x16, 0x30, 0x2E, 0xA5, 0xB5, 0x25, 0x8F, 0xC4, 0x75,
+	0x5B, 0x44, 0xE0, 0xD5, 0x4D, 0xAD, 0x3B, 0x34, 0x5F, 0x8F, 0xCD, 0x35, 0x6C, 0xFE, 0x4E, 0x4E,
+	0xEB, 0x29, 0x20, 0xCC, 0x90, 0x48, 0xA2, 0x9C, 0x4A, 0x64, 0xC6, 0x44, 0x63, 0xED, 0x97, 0xC2,
+	0x64, 0x60, 0x10, 0x75, 0xCC, 0x41, 0x4C, 0xA4, 0xC7, 0x0D, 0x44, 0xC7, 0x54, 0xC9, 0xCC, 0x04,
+	0xCC, 0x0C, 0xA5, 0x4C, 0x8C, 0xBF, 0xCC, 0xE0, 0xCA, 0xD4, 0xC5, 0x8B, 0xD0, 0xC6, 0xCD, 0x7D,
+	0x4B, 0xE0, 0xC7, 0x0C, 0xF4, 0xBF, 0x54, 0xCA, 0x0D, 0x04, 0xC9, 0xCC, 0x81, 0x4C, 0x88, 0xBB,
+	0x8C, 0xD0, 0xCF, 0x54, 0xBB, 0x4C, 0x70, 0xD0, 0x8C, 0x35, 0xB3, 0x0A, 0x4C, 0x89, 0x32, 0x30,
+	0x08, 0x2E, 0xE9, 0x93, 0x99, 0x31, 0x85, 0x19, 0xAA, 0x98, 0x51, 0x88, 0x99, 0xF9, 0x8A, 0xA9,
+	0x83, 0x19, 0xB1, 0x86, 0x18, 0xBA, 0x99, 0x59, 0xA4, 0x17, 0x79, 0x95, 0xA9, 0x97, 0x18, 0x61,
+	0xA3, 0x19, 0x20, 0x75, 0x28, 0xFF, 0xF8, 0x69, 0x88, 0x09, 0x3F, 0x16, 0x4E, 0xD7, 0x47, 0xD5,
+	0xD5, 0xD4, 0x5E, 0xD2, 0xC1, 0xD1, 0x21, 0xCF, 0x95, 0xCD, 0xFE, 0xCC, 0x56, 0xB5, 0x22, 0x07,
+	0xFF, 0x00, 0x07, 0xFE, 0x7F, 0xEF, 0xFF, 0x80, 0x07, 0xE0, 0x07, 0xE1, 0x94, 0x6E, 0xB2, 0x58,
+	0x9A, 0x5D, 0x64, 0xAA, 0x95, 0x55, 0xAF, 0x19, 0x65, 0xAB, 0x9D, 0x53, 0xB4, 0x15, 0x6A, 0xCB,
+	0x5A, 0x7B, 0x35, 0x83, 0xEE, 0x20, 0x06, 0x50, 0xAB, 0x10, 0x04, 0x99, 0x5C, 0xBE, 0x32, 0x01,
+	0x8B, 0x91, 0x61, 0xD8, 0xEC, 0xB4, 0xDC, 0xE9, 0xC5, 0xA2, 0x21, 0xC0, 0x84, 0x72, 0x3C, 0x9A,
+	0x0E, 0xB2, 0x24, 0x94, 0x44, 0xB1, 0x58, 0xBE, 0x2F, 0x19, 0x0E, 0xF6, 0x2C, 0x0C, 0xA3, 0x18,
+	0xB6, 0x38, 0x0B, 0xA7, 0xB2, 0x77, 0x37, 0x3B, 0x92, 0xB5, 0xC4, 0xDC, 0xE0, 0x09, 0x6E, 0xD0,
+	0xB6, 0xD3, 0x5B, 0x1D, 0xCD, 0x67, 0xE5, 0xAD, 0xE8, 0xBF, 0xF7, 0xFD, 0xC0, 0x0B, 0xFF, 0x7F,
+	0xDC, 0x00, 0x00, 0x2C, 0x3F, 0x0D, 0x92, 0x02, 0x53, 0xF9, 0x71, 0xA5, 0x4D, 0x98, 0xFA, 0x5F,
+	0xE9, 0x8C, 0xE6, 0xA9, 0xE0, 0x00, 0x21, 0xED, 0xB9, 0x3D, 0x8D, 0xEE, 0xD7, 0x68, 0x3C, 0x3B,
+	0xDF, 0x8F, 0x0D, 0x6D, 0xAB, 0x68, 0x0F, 0x42, 0x6A, 0x08, 0x50, 0x5A, 0x93, 0x74, 0x20, 0xA5,
+	0x56, 0x8A, 0x92, 0x4B, 0xF2, 0xE5, 0x95, 0x14, 0xB7, 0xE5, 0x71, 0x32, 0xE9, 0x9C, 0x68, 0xCA,
+	0x26, 0x63, 0x37, 0x49, 0x9F, 0x4E, 0xC6, 0x6E, 0xD3, 0x7F, 0x9D, 0xB7, 0x37, 0xC3, 0xB6, 0x5E,
+	0x36, 0xEF, 0x57, 0x7A, 0x20, 0x00, 0xD3, 0x14, 0x63, 0xE4, 0x97, 0x09, 0x7A, 0x7B, 0xDD, 0x8C,
+	0xDC, 0xD8, 0xF2, 0x22, 0x73, 0x40, 0x43, 0xFC, 0xFF, 0xF8, 0x69, 0x98, 0x0A, 0x10, 0x46, 0x14,
+	0x03, 0x15, 0x01, 0x30, 0x80, 0x74, 0x7B, 0x01, 0x1F, 0x86, 0x80, 0x8F, 0x69, 0x92, 0x08, 0x78,
+	0x0F, 0x8A, 0x3E, 0xF6, 0xE3, 0x2C, 0x53, 0xA8, 0xAF, 0xB4, 0xDC, 0x06, 0x48, 0x5F, 0x48, 0xC5,
+	0xFE, 0x43, 0x51, 0x1D, 0x12, 0x07, 0xBA, 0x5E, 0x1B, 0x59, 0x80, 0x64, 0x66,
+};
+
+const size_t FLAC_NUM_FRAMES = 657;
+const size_t FLAC_BLOCK_SIZE = 64;
+
+// integer signal that was encoded into FLAC_DATA, with the fifth block silenced and the seventh block's low bits cleared
+vector<int32_t> expectedFlacSamples( size_t channel )
+{
+	vector<int32_t> result;
+	uint32_t seed = 1;
+	for( size_t i = 0; i < FLAC_NUM_FRAMES; i++ ) {
+		seed = ( seed * 1103515245 + 12345 ) & 0x7FFFFFFF;
+		int32_t noise = int32_t( ( seed >> 16 ) % 64 ) - 32;
+		int32_t triangle = ( ( i / 100 ) % 2 == 0 ) ? int32_t( i % 100 ) * 400 - 20000 : 20000 - int32_t( i % 100 ) * 400;
+		int32_t saw = int32_t( i % 37 ) * 800 - 14400;
+		int32_t sample = ( channel == 0 ? triangle + noise : saw - noise );
+
+		size_t block = i / FLAC_BLOCK_SIZE;
+		if( block == 5 )
+			sample = 0;
+		else if( block == 7 )
+			sample &= ~0x7;
+
+		result.push_back( sample );
+	}
+
+	return result;
+}
+
+DataSourceRef makeFlacDataSource( const vector<uint8_t> &bytes )
+{
+	cinder::Buffer buffer( bytes.size() );
+	memcpy( buffer.getData(), bytes.data(), bytes.size() );
+	return DataSourceBuffer::create( buffer, "unit.flac" );
+}
+
+void checkFlacSamples( const audio::Buffer &buffer, size_t fileFrameOffset, size_t numFrames )
+{
+	for( size_t ch = 0; ch < 2; ch++ ) {
+		vector<int32_t> expected = expectedFlacSamples( ch );
+		size_t numErrors = 0;
+		for( size_t i = 0; i < numFrames; i++ ) {
+			if( buffer.getChannel( ch )[i] != float( expected[fileFrameOffset + i] ) / 32768.0f )
+				numErrors++;
+		}
+
+		BOOST_CHECK_EQUAL( numErrors, 0 );
+	}
+}
+
+void checkFlacSeeks( SourceFile *sourceFile )
+{
+	const size_t positions[] = { 500, 64, 0, 650, 320, 321 };
+	for( size_t pos : positions ) {
+		sourceFile->seek( pos );
+
+		audio::Buffer buffer( 5, 2 );
+		BOOST_REQUIRE_EQUAL( sourceFile->read( &buffer ), 5 );
+		checkFlacSamples( buffer, pos, 5 );
+	}
+}
+
+// Encodes \a numFrames of a stereo test signal as a logical ogg vorbis stream with \a serialNumber, in memory.
+vector<uint8_t> encodeOggVorbis( size_t numFrames, int serialNumber = 1 )
+{
+	vector<uint8_t> bytes;
+	auto appendPage = [&bytes]( const ogg_page &page ) {
+		bytes.insert( bytes.end(), page.header, page.header + page.header_len );
+		bytes.insert( bytes.end(), page.body, page.body + page.body_len );
+	};
+
+	vorbis_info info;
+	vorbis_comment comment;
+	vorbis_dsp_state dspState;
+	vorbis_block block;
+	ogg_stream_state stream;
+	ogg_page page;
+	ogg_packet packet, header, headerComment, headerCode;
+
+	vorbis_info_init( &info );
+	vorbis_encode_init_vbr( &info, 2, 44100, 0.4f );
+	vorbis_comment_init( &comment );
+	vorbis_analysis_init( &dspState, &info );
+	vorbis_block_init( &dspState, &block );
+	ogg_stream_init( &stream, serialNumber );
+
+	vorbis_analysis_headerout( &dspState, &comment, &header, &headerComment, &headerCode );
+	ogg_stream_packetin( &stream, &header );
+	ogg_stream_packetin( &stream, &headerComment );
+	ogg_stream_packetin( &stream, &headerCode );
+	while( ogg_stream_flush( &stream, &page ) )
+		appendPage( page );
+
+	bool endOfStream = false;
+	for( size_t frame = 0; ! endOfStream; ) {
+		const size_t numWrite = min<size_t>( 1024, numFrames - frame );
+		if( numWrite == 0 )
+			vorbis_analysis_wrote( &dspState, 0 );
+		else {
+			float **channels = vorbis_analysis_buffer( &dspState, 1024 );
+			for( size_t i = 0; i < numWrite; i++ ) {
+				float t = float( frame + i ) / 44100.0f;
+				channels[0][i] = 0.5f * sin( 2 * float( M_PI ) * 440 * t );
+				channels[1][i] = 0.5f * sin( 2 * float( M_PI ) * ( 220 + 100 * t ) * t );
+			}
+
+			vorbis_analysis_wrote( &dspState, int( numWrite ) );
+			frame += numWrite;
+		}
+
+		while( vorbis_analysis_blockout( &dspState, &block ) == 1 ) {
+			vorbis_analysis( &block, nullptr );
+			vorbis_bitrate_addblock( &block );
+			while( vorbis_bitrate_flushpacket( &dspState, &packet ) ) {
+				ogg_stream_packetin( &stream, &packet );
+				while( ogg_stream_pageout( &stream, &page ) ) {
+					appendPage( page );
+					endOfStream = endOfStream || ogg_page_eos( &page );
+				}
+			}
+		}
+	}
+
+	ogg_stream_clear( &stream );
+	vorbis_block_clear( &block );
+	vorbis_dsp_clear( &dspState );
+	vorbis_comment_clear( &comment );
+	vorbis_info_clear( &info );
+
+	return bytes;
+}
+
+DataSourceRef makeOggVorbisDataSource( const vector<uint8_t> &bytes )
+{
+	cinder::Buffer buffer( bytes.size() );
+	memcpy( buffer.getData(), bytes.data(), bytes.size() );
+	return DataSourceBuffer::create( buffer, "unit.ogg" );
+}
+
+DataSourceRef makeOggVorbisDataSource( size_t numFrames )
+{
+	return makeOggVorbisDataSource( encodeOggVorbis( numFrames ) );
+}
+
+// Reads 300 frames at each of \a positions and checks that they match a full decode.
+void checkOggVorbisSeeks( SourceFile *sourceFile, const vector<size_t> &positions )
+{
+	auto expected = sourceFile->loadBuffer();
+	audio::Buffer buffer( 300, 2 );
+
+	auto clone = sourceFile->clone();
+	for( size_t pos : positions ) {
+		clone->seek( pos );
+		BOOST_REQUIRE_EQUAL( clone->read( &buffer ), buffer.getNumFrames() );
+
+		float error = 0;
+		for( size_t ch = 0; ch < 2; ch++ ) {
+			for( size_t i = 0; i < buffer.getNumFrames(); i++ )
+				error = max( error, fabs( buffer.getChannel( ch )[i] - expected->getChannel( ch )[pos + i] ) );
+		}
+
+		BOOST_CHECK_EQUAL( error, 0 );
+	}
+}
+
+fs::path tempPath( const string &fileName )
+{
+	return fs::temp_directory_path() / fileName;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE( test_pcm_round_trip )
+{
+	const char *extensions[] = { "wav", "aiff" };
+	const SampleType sampleTypes[] = { SampleType::INT_16, SampleType::INT_24, SampleType::FLOAT_32 };
+	const size_t channelCounts[] = { 1, 2, 3 };
+
+	for( auto ext : extensions ) {
+		for( auto sampleType : sampleTypes ) {
+			for( auto numChannels : channelCounts ) {
+				// an odd number of frames makes the 24-bit mono data chunk need a pad byte
+				audio::Buffer buffer( 1001, numChannels );
+				fillRandom( &buffer );
+
+				fs::path path = tempPath( string( "FileUnit." ) + ext );
+				{
+					auto target = TargetFile::create( path, 48000, numChannels, sampleType );
+					target->write( &buffer, 600 );
+					target->write( &buffer, 401, 600 );
+				}
+
+				auto source = SourceFile::create( loadFile( path ) );
+				BOOST_REQUIRE( source );
+				BOOST_CHECK_EQUAL( source->getSampleRate(), 48000 );
+				BOOST_REQUIRE_EQUAL( source->getNumChannels(), numChannels );
+				BOOST_REQUIRE_EQUAL( source->getNumFrames(), buffer.getNumFrames() );
+
+				float tolerance = ( sampleType == SampleType::INT_16 ? 2.0f / 32768.0f : ( sampleType == SampleType::INT_24 ? 2.0f / 8388607.0f : 0 ) );
+				BOOST_CHECK_LE( maxError( buffer, *source->loadBuffer() ), tolerance );
+
+				source.reset();
+				fs::remove( path );
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_pcm_seek )
+{
+	audio::Buffer buffer( 10000, 2 );
+	fillRandom( &buffer );
+
+	fs::path path = tempPath( "FileUnitSeek.wav" );
+	TargetFile::create( path, 44100, 2, SampleType::FLOAT_32 )->write( &buffer );
+
+	auto source = SourceFile::create( loadFile( path ) );
+	source->seek( 7777 );
+
+	audio::Buffer readBuffer( 100, 2 );
+	BOOST_REQUIRE_EQUAL( source->read( &readBuffer ), 100 );
+	for( size_t ch = 0; ch < 2; ch++ )
+		BOOST_CHECK_EQUAL( readBuffer.getChannel( ch )[0], buffer.getChannel( ch )[7777] );
+
+	// clones share the mapping, but not the read position
+	auto clone = source->clone();
+	BOOST_REQUIRE_EQUAL( clone->read( &readBuffer ), 100 );
+	BOOST_CHECK_EQUAL( readBuffer.getChannel( 1 )[99], buffer.getChannel( 1 )[99] );
+
+	source.reset();
+	clone.reset();
+	fs::remove( path );
+}
+
+BOOST_AUTO_TEST_CASE( test_pcm_invalid )
+{
+	fs::path path = tempPath( "FileUnitInvalid.wav" );
+
+	// an ADPCM encoded WAV header
+	{
+		const uint8_t header[] = {
+			'R', 'I', 'F', 'F', 36, 0, 0, 0, 'W', 'A', 'V', 'E',
+			'f', 'm', 't', ' ', 16, 0, 0, 0, 2, 0, 1, 0, 0x44, 0xAC, 0, 0, 0x88, 0x58, 1, 0, 2, 0, 4, 0,
+			'd', 'a', 't', 'a', 0, 0, 0, 0
+		};
+		ofstream stream( path.string().c_str(), ios::binary );
+		stream.write( reinterpret_cast<const char *>( header ), sizeof( header ) );
+	}
+
+#if defined( CINDER_COCOA ) || defined( CINDER_MSW )
+	BOOST_CHECK_THROW( SourceFile::create( loadFile( path ) ), AudioExc );
+#else
+	BOOST_CHECK_THROW( SourceFile::create( loadFile( path ) ), AudioFormatExc );
+#endif
+
+	// a WAV file without its format chunk
+	{
+		ofstream stream( path.string().c_str(), ios::binary );
+		stream << "RIFF\x04\x00\x00\x00WAVE";
+	}
+
+	BOOST_CHECK_THROW( SourceFile::create( loadFile( path ) ), AudioExc );
+
+	// a chunk size that would wrap the chunk walk around on 32-bit builds
+	{
+		const uint8_t header[] = {
+			'R', 'I', 'F', 'F', 28, 0, 0, 0, 'W', 'A', 'V', 'E',
+			'J', 'U', 'N', 'K', 0xF3, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0, 0, 0, 0, 0
+		};
+		ofstream stream( path.string().c_str(), ios::binary );
+		stream.write( reinterpret_cast<const char *>( header ), sizeof( header ) );
+	}
+
+	BOOST_CHECK_THROW( SourceFile::create( loadFile( path ) ), AudioExc );
+	fs::remove( path );
+}
+
+BOOST_AUTO_TEST_CASE( test_flac_decode )
+{
+	vector<uint8_t> bytes( FLAC_DATA, FLAC_DATA + sizeof( FLAC_DATA ) );
+	auto source = SourceFile::create( makeFlacDataSource( bytes ) );
+
+	BOOST_REQUIRE( source );
+	BOOST_CHECK_EQUAL( source->getSampleRate(), 44100 );
+	BOOST_REQUIRE_EQUAL( source->getNumChannels(), 2 );
+	BOOST_REQUIRE_EQUAL( source->getNumFrames(), FLAC_NUM_FRAMES );
+	BOOST_CHECK( source->getMetaData().find( "TITLE: unit" ) != string::npos );
+
+	// reads are not aligned to blocks
+	source->setMaxFramesPerRead( 100 );
+	auto buffer = source->loadBuffer();
+	BOOST_REQUIRE_EQUAL( buffer->getNumFrames(), FLAC_NUM_FRAMES );
+	checkFlacSamples( *buffer, 0, FLAC_NUM_FRAMES );
+}
+
+BOOST_AUTO_TEST_CASE( test_flac_seek )
+{
+	vector<uint8_t> bytes( FLAC_DATA, FLAC_DATA + sizeof( FLAC_DATA ) );
+	checkFlacSeeks( SourceFile::create( makeFlacDataSource( bytes ) ).get() );
+
+	// without a seek table, by turning it into a padding block
+	const size_t seekTableOffset = 4 + 4 + 34;
+	BOOST_REQUIRE_EQUAL( bytes[seekTableOffset], 3 );
+	bytes[seekTableOffset] = 1;
+	checkFlacSeeks( SourceFile::create( makeFlacDataSource( bytes ) ).get() );
+
+	// without the total number of samples, which are then counted from the last frame
+	const size_t totalSamplesOffset = 4 + 4 + 13;
+	bytes[totalSamplesOffset] &= 0xF0;
+	fill( bytes.begin() + totalSamplesOffset + 1, bytes.begin() + totalSamplesOffset + 5, 0 );
+	auto source = SourceFile::create( makeFlacDataSource( bytes ) );
+	BOOST_CHECK_EQUAL( source->getNumFrames(), FLAC_NUM_FRAMES );
+	checkFlacSeeks( source.get() );
+}
+
+BOOST_AUTO_TEST_CASE( test_ogg_vorbis_seek )
+{
+	const size_t numFrames = 44100 * 20;
+	auto source = make_shared<SourceFileOggVorbis>( makeOggVorbisDataSource( numFrames ), 0 );
+	BOOST_REQUIRE_EQUAL( source->getNumFrames(), numFrames );
+
+	// the first seek away from the beginning builds the seek index, clones share it
+	const size_t positions[] = { 500000, 100, 0, 44100 * 19, 123456, 123457, 800000 };
+	checkOggVorbisSeeks( source.get(), vector<size_t>( begin( positions ), end( positions ) ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_ogg_vorbis_seek_chained )
+{
+	// two logical streams back to back leave the seek index empty, seeks fall back to libvorbisfile
+	auto bytes = encodeOggVorbis( 44100 * 3, 1 );
+	auto second = encodeOggVorbis( 44100 * 2, 2 );
+	bytes.insert( bytes.end(), second.begin(), second.end() );
+
+	auto source = make_shared<SourceFileOggVorbis>( makeOggVorbisDataSource( bytes ), 0 );
+	BOOST_REQUIRE_EQUAL( source->getNumFrames(), 44100 * 5 );
+
+	const size_t positions[] = { 44100 * 4, 1000, 44100 * 3 + 10, 44100 * 2 };
+	checkOggVorbisSeeks( source.get(), vector<size_t>( begin( positions ), end( positions ) ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_ogg_vorbis_seek_truncated )
+{
+	// cutting the file inside the header of its last page stops the index scan early
+	auto bytes = encodeOggVorbis( 44100 * 5 );
+	size_t lastPage = bytes.size() - 4;
+	while( memcmp( &bytes[lastPage], "OggS", 4 ) != 0 )
+		lastPage--;
+
+	bytes.resize( lastPage + 10 );
+
+	auto source = make_shared<SourceFileOggVorbis>( makeOggVorbisDataSource( bytes ), 0 );
+	const size_t numFrames = source->getNumFrames();
+	BOOST_REQUIRE( numFrames > 44100 * 4 );
+
+	const size_t positions[] = { numFrames - 300, 2000, numFrames - 1000, 44100 * 3 };
+	checkOggVorbisSeeks( source.get(), vector<size_t>( begin( positions ), end( positions ) ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_ogg_vorbis_decode_ahead )
+{
+	const size_t numFrames = 44100 * 10;
+	auto source = make_shared<SourceFileOggVorbis>( makeOggVorbisDataSource( numFrames ), 0 );
+	auto expected = source->loadBuffer();
+
+	auto decodeAhead = dynamic_pointer_cast<SourceFileOggVorbis>( source->clone() );
+	decodeAhead->setDecodeAheadFrames( 8192 );
+	BOOST_CHECK_EQUAL( decodeAhead->getDecodeAheadFrames(), 8192 );
+
+	// reads, short seeks forward that skip over what was decoded ahead and seeks elsewhere, with pauses for the I/O threads
+	audio::Buffer buffer( 512, 2 );
+	size_t pos = 0;
+	float error = 0;
+	for( size_t i = 0; i < 400; i++ ) {
+		if( i % 100 == 50 )
+			pos = ( pos * 7 + 12345 ) % ( numFrames / 2 );
+		else if( i % 20 == 10 )
+			pos += 1000;
+
+		if( i % 20 == 10 || i % 100 == 50 )
+			decodeAhead->seek( pos );
+
+		size_t numRead = decodeAhead->read( &buffer );
+		BOOST_REQUIRE_EQUAL( numRead, buffer.getNumFrames() );
+		for( size_t ch = 0; ch < 2; ch++ ) {
+			for( size_t j = 0; j < numRead; j++ )
+				error = max( error, fabs( buffer.getChannel( ch )[j] - expected->getChannel( ch )[pos + j] ) );
+		}
+
+		pos += numRead;
+		if( i % 10 == 0 )
+			this_thread::sleep_for( chrono::milliseconds( 1 ) );
+	}
+
+	BOOST_CHECK_EQUAL( error, 0 );
+
+	// disabling it keeps the read position
+	decodeAhead->setDecodeAheadFrames( 0 );
+	BOOST_REQUIRE_EQUAL( decodeAhead->read( &buffer ), buffer.getNumFrames() );
+	BOOST_CHECK_EQUAL( buffer.getChannel( 1 )[0], expected->getChannel( 1 )[pos] );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "utils.h"
+#include "cinder/audio/dsp/PhaseVocoder.h"
+
+#include <cmath>
+
+BOOST_AUTO_TEST_SUITE( test_phase_vocoder )
+
+using namespace ci::audio;
+
+namespace {
+
+	const float kSampleRate = 44100;
+	const float kFreqMaxError = 0.01f;	// relative
+	const float kRmsMaxError = 0.15f;	// relative
+
+	// generates \a numFrames of a sine at \a freq starting at \a offset, with the amplitude halved on each channel after the first.
+	void fillSine( Buffer *buffer, size_t offset, size_t numFrames, float freq )
+	{
+		for( size_t ch = 0; ch < buffer->getNumChannels(); ch++ ) {
+			float amp = 0.5f / float( 1 << ch );
+			for( size_t i = 0; i < numFrames; i++ )
+				buffer->getChannel( ch )[i] = amp * std::sin( 2 * float( M_PI ) * freq * float( offset + i ) / kSampleRate );
+		}
+	}
+
+	struct Result {
+		float mFreq, mRms;
+		size_t mNumOutputFrames, mNumInputFrames;
+	};
+
+	// processes a sine through \a vocoder for \a numHops hops, then measures frequency by zero crossings and rms of the last half of channel 0.
+	Result process( dsp::PhaseVocoder *vocoder, float freq, size_t numHops )
+	{
+		const size_t hopSize = vocoder->getHopSize();
+		Buffer input( vocoder->getMaxInputFramesNeeded(), vocoder->getNumChannels() );
+		Buffer hop( hopSize, vocoder->getNumChannels() );
+		Buffer output( hopSize * numHops, vocoder->getNumChannels() );
+
+		Result result;
+		result.mNumInputFrames = 0;
+		for( size_t i = 0; i < numHops; i++ ) {
+			size_t numNeeded = vocoder->getNumInputFramesNeeded();
+			fillSine( &input, result.mNumInputFrames, numNeeded, freq );
+			result.mNumInputFrames += numNeeded;
+
+			vocoder->process( input, &hop );
+			output.copyOffset( hop, hopSize, i * hopSize, 0 );
+		}
+
+		result.mNumOutputFrames = output.getNumFrames();
+
+		size_t begin = output.getNumFrames() / 2;
+		size_t numMeasured = output.getNumFrames() - begin;
+		const float *channel = output.getChannel( 0 ) + begin;
+		size_t numZeroCrossings = 0;
+		double sumSquares = 0;
+		for( size_t i = 0; i < numMeasured; i++ ) {
+			if( i > 0 && ( channel[i - 1] < 0 ) != ( channel[i] < 0 ) )
+				numZeroCrossings++;
+
+			sumSquares += channel[i] * channel[i];
+		}
+
+		result.mFreq = float( numZeroCrossings ) / 2.0f / ( float( numMeasured ) / kSampleRate );
+		result.mRms = float( std::sqrt( sumSquares / numMeasured ) );
+		return result;
+	}
+
+	void checkResult( const Result &result, float expectedFreq )
+	{
+		const float expectedRms = 0.5f / std::sqrt( 2.0f );
+
+		BOOST_CHECK_MESSAGE( std::fabs( result.mFreq - expectedFreq ) < expectedFreq * kFreqMaxError, "frequency: " << result.mFreq << ", expected: " << expectedFreq );
+		BOOST_CHECK_MESSAGE( std::fabs( result.mRms - expectedRms ) < expectedRms * kRmsMaxError, "rms: " << result.mRms << ", expected: " << expectedRms );
+	}
+
+}
+
+BOOST_AUTO_TEST_CASE( test_unity )
+{
+	dsp::PhaseVocoder vocoder( 2 );
+	auto result = process( &vocoder, 441, 200 );
+
+	checkResult( result, 441 );
+	BOOST_CHECK_EQUAL( result.mNumInputFrames, result.mNumOutputFrames );
+}
+
+BOOST_AUTO_TEST_CASE( test_time_stretch )
+{
+	const float rates[] = { 0.5f, 0.8f, 1.5f, 2.0f, 3.3f };
+	for( float rate : rates ) {
+		dsp::PhaseVocoder vocoder( 2 );
+		vocoder.setRate( rate );
+		auto result = process( &vocoder, 441, 200 );
+
+		checkResult( result, 441 );
+
+		// the first hop reads one hop, the rest read the analysis hop
+		size_t hopSize = vocoder.getHopSize();
+		double expectedInputFrames = hopSize + double( hopSize ) * rate * 199;
+		BOOST_CHECK_MESSAGE( std::fabs( result.mNumInputFrames - expectedInputFrames ) <= 1, "rate: " << rate << ", input frames: " << result.mNumInputFrames << ", expected: " << expectedInputFrames );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_pitch_shift )
+{
+	const float pitches[] = { 0.5f, 0.75f, 1.5f, 2.0f };
+	for( float pitch : pitches ) {
+		dsp::PhaseVocoder vocoder( 1 );
+		vocoder.setPitch( pitch );
+		auto result = process( &vocoder, 441, 200 );
+
+		checkResult( result, 441 * pitch );
+		BOOST_CHECK_EQUAL( result.mNumInputFrames, result.mNumOutputFrames );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_stretch_and_pitch_shift )
+{
+	dsp::PhaseVocoder vocoder( 2, dsp::PhaseVocoder::Quality::HIGH );
+	vocoder.setRate( 0.7f );
+	vocoder.setPitch( 1.25f );
+	auto result = process( &vocoder, 441, 300 );
+
+	checkResult( result, 441 * 1.25f );
+}
+
+BOOST_AUTO_TEST_CASE( test_quality )
+{
+	dsp::PhaseVocoder low( 1, dsp::PhaseVocoder::Quality::LOW );
+	dsp::PhaseVocoder medium( 1, dsp::PhaseVocoder::Quality::MEDIUM );
+	dsp::PhaseVocoder high( 1, dsp::PhaseVocoder::Quality::HIGH );
+
+	BOOST_CHECK( low.getFftSize() < medium.getFftSize() && medium.getFftSize() < high.getFftSize() );
+	BOOST_CHECK_EQUAL( low.getLatency(), low.getFftSize() - low.getHopSize() );
+
+	checkResult( process( &low, 882, 400 ), 882 );
+}
+
+BOOST_AUTO_TEST_CASE( test_transients )
+{
+	dsp::PhaseVocoder vocoder( 1 );
+	vocoder.setRate( 0.5f );
+
+	// a click every 8192 frames on top of silence
+	const size_t hopSize = vocoder.getHopSize();
+	Buffer input( vocoder.getMaxInputFramesNeeded() );
+	Buffer hop( hopSize );
+	size_t readPos = 0;
+	for( size_t i = 0; i < 256; i++ ) {
+		size_t numNeeded = vocoder.getNumInputFramesNeeded();
+		input.zero();
+		for( size_t frame = 0; frame < numNeeded; frame++ ) {
+			if( ( readPos + frame ) % 8192 == 4096 )
+				input[frame] = 1;
+		}
+
+		readPos += numNeeded;
+		vocoder.process( input, &hop );
+	}
+
+	size_t numClicks = readPos / 8192;
+	BOOST_CHECK_MESSAGE( vocoder.getNumTransients() >= numClicks, "transients: " << vocoder.getNumTransients() << ", clicks: " << numClicks );
+
+	size_t numTransients = vocoder.getNumTransients();
+	vocoder.setTransientDetectionEnabled( false );
+	vocoder.reset();
+	for( size_t i = 0; i < 32; i++ )
+		vocoder.process( input, &hop );
+
+	BOOST_CHECK_EQUAL( vocoder.getNumTransients(), numTransients );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -28,6 +28,33 @@ BOOST_AUTO_TEST_CASE( test_full_write_read )
 		BOOST_CHECK_EQUAL( a[i], b[i] );
 }
 
+BOOST_AUTO_TEST_CASE( test_discard )
+{
+	dsp::RingBufferT<int> rb( 10 );
+	vector<int> a( 8 );
+	vector<int> b( 8 );
+
+	for( size_t i = 0; i < a.size(); i++ )
+		a[i] = i + 1;
+
+	// wrap the indices around the end of the internal buffer
+	rb.write( a.data(), 6 );
+	BOOST_CHECK_EQUAL( rb.discard( 6 ), 6 );
+	rb.write( a.data(), a.size() );
+
+	BOOST_CHECK_EQUAL( rb.discard( 3 ), 3 );
+	BOOST_CHECK_EQUAL( rb.getAvailableRead(), 5 );
+
+	rb.read( b.data(), 5 );
+	for( size_t i = 0; i < 5; i++ )
+		BOOST_CHECK_EQUAL( b[i], a[i + 3] );
+
+	// only discards what is available
+	rb.write( a.data(), 2 );
+	BOOST_CHECK_EQUAL( rb.discard( 5 ), 2 );
+	BOOST_CHECK_EQUAL( rb.getAvailableRead(), 0 );
+}
+
 BOOST_AUTO_TEST_CASE( test_threaded_stress )
 {
 	dsp::RingBufferT<uint32_t> rb( 100 );
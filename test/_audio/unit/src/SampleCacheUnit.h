@@ -0,0 +1,115 @@
+#pragma once
+
+#include "cinder/audio/SampleCache.h"
+#include "cinder/audio/Exception.h"
+#include "utils.h"
+
+#include <fstream>
+
+BOOST_AUTO_TEST_SUITE( test_sample_cache )
+
+using namespace std;
+using namespace ci;
+using namespace ci::audio;
+
+namespace {
+
+// SourceFile that produces a ramp and counts how many times it has been read.
+class RampSourceFile : public SourceFile {
+  public:
+	RampSourceFile( size_t numFrames, size_t sampleRate = 44100 )
+		: SourceFile( sampleRate ), mNumReads( 0 )
+	{
+		mFileNumFrames = mNumFrames = numFrames;
+	}
+
+	size_t getNumChannels() const override			{ return 1; }
+	size_t getSampleRateNative() const override		{ return 44100; }
+	SourceFileRef cloneWithSampleRate( size_t sampleRate ) const override	{ return SourceFileRef( new RampSourceFile( mNumFrames, sampleRate ) ); }
+
+	size_t mNumReads;
+
+  protected:
+	size_t performRead( audio::Buffer *buffer, size_t bufferFrameOffset, size_t numFramesNeeded ) override
+	{
+		mNumReads++;
+		for( size_t i = 0; i < numFramesNeeded; i++ )
+			buffer->getChannel( 0 )[bufferFrameOffset + i] = float( mReadPos + i );
+
+		return numFramesNeeded;
+	}
+
+	void performSeek( size_t readPositionFrames ) override	{}
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE( test_lru_eviction )
+{
+	SampleCache *cache = SampleCache::get();
+	cache->clear();
+	cache->setMemoryBudget( 1000 * sizeof( float ) );
+
+	auto a = make_shared<RampSourceFile>( 400 );
+	auto b = make_shared<RampSourceFile>( 400 );
+	auto c = make_shared<RampSourceFile>( 400 );
+
+	BufferRef bufferA = cache->loadBuffer( a );
+	BOOST_CHECK_EQUAL( bufferA->getChannel( 0 )[399], 399 );
+	BOOST_CHECK_EQUAL( cache->loadBuffer( a ), bufferA );
+	BOOST_CHECK_EQUAL( a->mNumReads, 1 );
+
+	cache->loadBuffer( b );
+	cache->loadBuffer( a ); // a is now more recently used than b
+	cache->loadBuffer( c ); // over budget, evicts b
+
+	BOOST_CHECK_EQUAL( cache->getNumEntries(), 2 );
+	BOOST_CHECK_EQUAL( cache->getMemoryUsage(), 800 * sizeof( float ) );
+
+	cache->loadBuffer( a );
+	BOOST_CHECK_EQUAL( a->mNumReads, 1 );
+	cache->loadBuffer( b );
+	BOOST_CHECK_EQUAL( b->mNumReads, 2 );
+
+	cache->clear();
+	cache->setMemoryBudget( 256 * 1024 * 1024 );
+}
+
+BOOST_AUTO_TEST_CASE( test_pre_decoded_round_trip )
+{
+	audio::Buffer buffer( 1000, 2 );
+	fillRandom( &buffer );
+
+	fs::path path = fs::temp_directory_path() / "SampleCacheUnit.f32";
+	SampleCache::writePreDecoded( buffer, 48000, path );
+
+	size_t sampleRate = 0;
+	BufferRef mapped = SampleCache::loadPreDecoded( path, &sampleRate );
+
+	BOOST_CHECK_EQUAL( sampleRate, 48000 );
+	BOOST_CHECK( ! mapped->isDataOwned() );
+	BOOST_REQUIRE_EQUAL( mapped->getNumFrames(), buffer.getNumFrames() );
+	BOOST_REQUIRE_EQUAL( mapped->getNumChannels(), buffer.getNumChannels() );
+	BOOST_CHECK_EQUAL( maxError( buffer, *mapped ), 0 );
+
+	// writes to the mapped Buffer are private to it
+	mapped->zero();
+	BOOST_CHECK_EQUAL( maxError( buffer, *SampleCache::loadPreDecoded( path ) ), 0 );
+
+	mapped.reset();
+	fs::remove( path );
+}
+
+BOOST_AUTO_TEST_CASE( test_pre_decoded_invalid )
+{
+	fs::path path = fs::temp_directory_path() / "SampleCacheUnit.invalid";
+	{
+		ofstream stream( path.string().c_str() );
+		stream << "this is not a pre-decoded file, though it is long enough to contain the header of one.";
+	}
+
+	BOOST_CHECK_THROW( SampleCache::loadPreDecoded( path ), AudioFileExc );
+	fs::remove( path );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "cinder/audio/dsp/TripleBuffer.h"
+
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( test_triple_buffer )
+
+using namespace std;
+using namespace ci;
+using namespace ci::audio;
+
+BOOST_AUTO_TEST_CASE( test_latest_value )
+{
+	dsp::TripleBuffer<int> tb;
+	tb.reset( -1 );
+
+	BOOST_CHECK( ! tb.update() );
+
+	tb.getWriteBuffer() = 1;
+	tb.publish();
+	tb.getWriteBuffer() = 2;
+	tb.publish();
+
+	// intermediate values are skipped
+	BOOST_REQUIRE( tb.update() );
+	BOOST_CHECK_EQUAL( tb.getReadBuffer(), 2 );
+	BOOST_CHECK( ! tb.update() );
+	BOOST_CHECK_EQUAL( tb.getReadBuffer(), 2 );
+
+	tb.getWriteBuffer() = 3;
+	tb.publish();
+	BOOST_REQUIRE( tb.update() );
+	BOOST_CHECK_EQUAL( tb.getReadBuffer(), 3 );
+}
+
+BOOST_AUTO_TEST_CASE( test_threaded_stress )
+{
+	// each published vector is filled with one value, so a torn read would show up as mixed values
+	const size_t kSize = 256;
+	const int kNumWrites = 100000;
+
+	dsp::TripleBuffer<vector<int> > tb;
+	tb.reset( vector<int>( kSize, 0 ) );
+
+	thread writer( [&] {
+		for( int value = 1; value <= kNumWrites; value++ ) {
+			vector<int> &buf = tb.getWriteBuffer();
+			for( size_t i = 0; i < kSize; i++ )
+				buf[i] = value;
+
+			tb.publish();
+		}
+	} );
+
+	int lastValue = 0;
+	while( lastValue < kNumWrites ) {
+		if( ! tb.update() )
+			continue;
+
+		const vector<int> &buf = tb.getReadBuffer();
+		BOOST_REQUIRE( buf[0] > lastValue );
+		for( size_t i = 1; i < kSize; i++ )
+			BOOST_REQUIRE( buf[i] == buf[0] );
+
+		lastValue = buf[0];
+	}
+
+	writer.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
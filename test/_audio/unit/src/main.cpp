@@ -5,6 +5,13 @@
 // the single header variant of Boost Test cannot handle multiple .cpp's,
 // so they are included as headers.
 
+#include "BiquadUnit.h"
 #include "BufferUnit.h"
+#include "ConverterUnit.h"
+#include "DspUnit.h"
 #include "FftUnit.h"
+#include "FileUnit.h"
+#include "PhaseVocoderUnit.h"
 #include "RingbufferUnit.h"
+#include "SampleCacheUnit.h"
+#include "TripleBufferUnit.h"